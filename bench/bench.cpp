@@ -0,0 +1,202 @@
+#include "Dersbiander/dersbiander.hpp"
+#include <fstream>
+#include <string>
+
+DISABLE_WARNINGS_PUSH(
+    4005 4201 4459 4514 4625 4626 4820 6244 6285 6385 6386 26409 26415 26418 26429 26432 26437 26438 26440 26446 26447 26450 26451 26455 26457 26459 26460 26461 26467 26472 26473 26474 26475 26481 26482 26485 26490 26491 26493 26494 26495 26496 26497 26498 26800 26814 26818 26821 26826)
+
+#include <CLI/CLI.hpp>
+
+DISABLE_WARNINGS_POP()
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+namespace {
+    /// A kind of input: the lines of its body, repeated with a growing counter, between a header and a footer.
+    struct Corpus {
+        std::string_view name;
+        std::string_view header;
+        std::string (*line)(std::size_t counter);
+        std::string_view footer;
+    };
+
+    const std::array<Corpus, 5> corpora{{
+        {"identifiers", "main {\n",
+         [](std::size_t counter) {
+             return FORMAT("\tvar identifier{}Value: int = anotherIdentifier{} + yetAnotherName{}\n", counter, counter, counter);
+         },
+         "}\n"},
+        {"operators", "main {\n",
+         [](std::size_t counter) {
+             return FORMAT("\tx += (a + b) * -c - d / e * f ^ {}\n\tq = a <= b && c != d || !e >= {}\n", counter % 10,
+                           counter % 7);
+         },
+         "}\n"},
+        {"comments", "main {\n",
+         [](std::size_t counter) {
+             return FORMAT("\t// line comment {} describing the statement below it\n\t/* block comment {} */ x = {}\n", counter,
+                           counter, counter % 10);
+         },
+         "}\n"},
+        {"strings", "main {\n",
+         [](std::size_t counter) {
+             return FORMAT("\tvar s: string = \"string literal {} with some words in it\"\n", counter);
+         },
+         "}\n"},
+        // Assignments to a fixed set of variables: the program stays valid and compiles to a bounded register file at
+        // any size.
+        {"program", "main {\n\tvar a: int = 1\n\tvar b: int = 2\n\tvar c: double = 0.5\n",
+         [](std::size_t counter) {
+             return FORMAT("\ta = a + b * 3 - {}\n\tb = (a - b) / 7 + 1\n\tc = c * 0.5 + {}.25\n", counter % 97, counter % 5);
+         },
+         "}\n"},
+    }};
+
+    [[nodiscard]] const Corpus &findCorpus(std::string_view name) {
+        const auto found = std::ranges::find(corpora, name, &Corpus::name);
+        if(found == corpora.end()) [[unlikely]] { throw RuntimeError(FORMAT("no corpus named {}", name)); }
+        return *found;
+    }
+
+    /// The corpus repeated until it is at least @p size bytes long.
+    [[nodiscard]] std::string generate(const Corpus &corpus, std::size_t size) {
+        std::string text{corpus.header};
+        text.reserve(size + 256);
+        for(std::size_t counter = 0; text.size() + corpus.footer.size() < size; ++counter) { text.append(corpus.line(counter)); }
+        text.append(corpus.footer);
+        return text;
+    }
+
+    [[nodiscard]] std::string sizeName(std::size_t size) {
+        if(size >= 1U << 30U) { return FORMAT("{}GB", size >> 30U); }
+        if(size >= 1U << 20U) { return FORMAT("{}MB", size >> 20U); }
+        return FORMAT("{}KB", size >> 10U);
+    }
+
+    [[nodiscard]] std::size_t countTokens(const std::string &text) {
+        Tokenizer tokenizer(text);
+        return tokenizer.tokenize().size();
+    }
+
+    /// Runs a fresh Instruction over every line, as the Validator does on a cache miss, and returns the tokens it accepted.
+    [[nodiscard]] std::size_t checkLines(const std::vector<Token> &tokens, const std::vector<std::size_t> &lineStarts) {
+        std::size_t accepted = 0;
+        for(std::size_t line = 0; line + 1 < lineStarts.size(); ++line) {
+            Instruction instruction;
+            for(std::size_t index = lineStarts[line]; index < lineStarts[line + 1]; ++index) {
+                if(tokens[index].getType() == TokenType::COMMENT) [[unlikely]] { continue; }
+                if(!instruction.checkToken(tokens[index]).first) [[unlikely]] { break; }
+                ++accepted;
+            }
+        }
+        return accepted;
+    }
+
+    /// The front end and the bytecode compiler over @p text: throws a RuntimeError when a phase reports a diagnostic.
+    std::size_t compile(const std::string &text) {
+        Tokenizer tokenizer(text);
+        const std::vector<Token> tokens = tokenizer.tokenize();
+        Ast ast(tokens);
+        AstBuilder astBuilder(ast);
+        Validator validator(tokens);
+        validator.setAstBuilder(&astBuilder);
+        const auto require = [](const std::vector<Diagnostic> &diagnostics, std::string_view phase) {
+            if(!diagnostics.empty()) [[unlikely]] { throw RuntimeError(FORMAT("{}: {}", phase, diagnostics.front())); }
+        };
+        require(validator.validate(), "validate");
+        NameResolver resolver(ast);
+        require(resolver.resolve(), "resolve names");
+        ConstantFolder folder(ast, resolver);
+        require(folder.fold(), "fold constants");
+        TypeChecker typeChecker(ast, resolver);
+        typeChecker.setFolder(&folder);
+        require(typeChecker.check(), "check types");
+        ParallelChecker parallelChecker(ast, resolver);
+        require(parallelChecker.check(), "check parallel loops");
+        BytecodeCompiler compiler(ast, resolver, typeChecker);
+        compiler.setFolder(&folder);
+        compiler.setParallel(&parallelChecker);
+        require(compiler.compile(), "compile bytecode");
+        doNotOptimize(compiler.getChunk());
+        return tokens.size();
+    }
+}  // namespace
+
+/**
+ * Throughput of the tokenizer, of Instruction::checkToken and of the whole front end, on generated inputs from
+ * --min-size to --max-size bytes, growing 32 times at every step: 1 KB to 32 MB unless --max-size opts into 1 GB.
+ * Every result reports MB/s and tokens/s; --json writes them with the keys of Benchmark::toJson for comparing releases.
+ */
+// NOLINTNEXTLINE(bugprone-exception-escape)
+int main(int argc, const char **argv) {
+    try {
+        CLI::App app{"Dersbiander throughput benchmarks"};
+        std::size_t min_size = std::size_t{1} << 10U;
+        std::size_t max_size = std::size_t{32} << 20U;
+        std::string filter;
+        std::string json;
+        BenchmarkOptions options{.warmup = 0.1, .sampleTime = 0.05, .samples = 10};
+        app.add_option("--min-size", min_size, "Size in bytes of the smallest input");
+        app.add_option("--max-size", max_size,
+                       "Size in bytes of the largest input, 32 MB by default. 1073741824 adds the 1 GB inputs, which need tens of "
+                       "GB of memory end to end");
+        app.add_option("--filter", filter, "Run only the benchmarks whose name contains this text");
+        app.add_option("--samples", options.samples, "Timed samples of every benchmark");
+        app.add_option("--sample-time", options.sampleTime, "Shortest time of a sample, in seconds");
+        app.add_option("--json", json, "Write the results to this file as JSON");
+        CLI11_PARSE(app, argc, argv);
+        initLogger(0);
+
+        Benchmark benchmark(options);
+        std::vector<BenchmarkResult> results;
+        const auto report = [&results](BenchmarkResult result, std::size_t bytes, std::size_t tokens) {
+            result.bytes = bytes;
+            result.items = tokens;
+            LINFO("{}", result.to_string());
+            results.push_back(std::move(result));
+        };
+        for(std::size_t size = min_size; size <= max_size; size *= 32) {
+            const auto selected = [&filter](const std::string &name) { return name.find(filter) != std::string::npos; };
+            for(const std::string_view kind : {"identifiers", "operators", "comments", "strings"}) {
+                const std::string name = FORMAT("tokenize/{}/{}", kind, sizeName(size));
+                if(!selected(name)) { continue; }
+                const std::string text = generate(findCorpus(kind), size);
+                report(benchmark.run(name,
+                                     [&text] {
+                                         Tokenizer tokenizer(text);
+                                         doNotOptimize(tokenizer.tokenize());
+                                     }),
+                       text.size(), countTokens(text));
+            }
+            if(const std::string name = FORMAT("checkToken/{}", sizeName(size)); selected(name)) {
+                const std::string text = generate(findCorpus("program"), size);
+                Tokenizer tokenizer(text);
+                const std::vector<Token> tokens = tokenizer.tokenize();
+                std::vector<std::size_t> lineStarts;
+                for(std::size_t index = 0; index < tokens.size(); ++index) {
+                    if(index == 0 || tokens[index].getLine() != tokens[index - 1].getLine()) { lineStarts.push_back(index); }
+                }
+                lineStarts.push_back(tokens.size());
+                report(benchmark.run(name, [&] { doNotOptimize(checkLines(tokens, lineStarts)); }), text.size(),
+                       checkLines(tokens, lineStarts));
+            }
+            if(const std::string name = FORMAT("end-to-end/{}", sizeName(size)); selected(name)) {
+                const std::string text = generate(findCorpus("program"), size);
+                const std::size_t tokens = compile(text);
+                report(benchmark.run(name, [&text] { doNotOptimize(compile(text)); }), text.size(), tokens);
+            }
+            if(size > max_size / 32) { break; }
+        }
+        if(!json.empty()) {
+            std::ofstream out(json);
+            out << Benchmark::toJson(results);
+            if(!out) [[unlikely]] { throw RuntimeError(FORMAT("cannot write {}", json)); }
+        }
+    } catch(const std::exception &e) {
+        LERROR("Unhandled exception in the benchmarks: {}", e.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+DISABLE_WARNINGS_POP()
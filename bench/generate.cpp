@@ -0,0 +1,55 @@
+#include "Dersbiander/dersbiander.hpp"
+#include <fstream>
+#include <iostream>
+#include <string>
+
+DISABLE_WARNINGS_PUSH(
+    4005 4201 4459 4514 4625 4626 4820 6244 6285 6385 6386 26409 26415 26418 26429 26432 26437 26438 26440 26446 26447 26450 26451 26455 26457 26459 26460 26461 26467 26472 26473 26474 26475 26481 26482 26485 26490 26491 26493 26494 26495 26496 26497 26498 26800 26814 26818 26821 26826)
+
+#include <CLI/CLI.hpp>
+
+DISABLE_WARNINGS_POP()
+
+/// Writes a program of ProgramGenerator to a file or to the standard output, as it is generated.
+// NOLINTNEXTLINE(bugprone-exception-escape)
+int main(int argc, const char **argv) {
+    try {
+        CLI::App app{"Generates random Dersbiander programs"};
+        GeneratorOptions options;
+        GeneratorMix &mix = options.mix;
+        std::string output;
+        app.add_option("-o,--output", output, "The file to write, the standard output by default");
+        app.add_option("--seed", options.seed, "The same seed and options give the same program");
+        app.add_option("--size", options.size, "Bytes the program reaches before it is closed");
+        app.add_option("--depth", options.depth, "Blocks nested in main and in functions");
+        app.add_option("--expression-depth", options.expressionDepth, "Operators nested in an expression");
+        app.add_option("--error-rate", options.errorRate, "Share of the statements written with a syntax error");
+        app.add_option("--declarations", mix.declarations, "Weight of declarations");
+        app.add_option("--assignments", mix.assignments, "Weight of assignments");
+        app.add_option("--loops", mix.loops, "Weight of for and parallel for loops");
+        app.add_option("--conditions", mix.conditions, "Weight of if and while blocks");
+        app.add_option("--arrays", mix.arrays, "Weight of array statements");
+        app.add_option("--functions", mix.functions, "Weight of function calls, 0 for programs the bytecode compiler takes");
+        app.add_option("--strings", mix.strings, "Weight of strings, 0 for programs the bytecode compiler takes");
+        app.add_option("--comments", mix.comments, "Weight of comments");
+        CLI11_PARSE(app, argc, argv);
+        initLogger(0);
+
+        ProgramGenerator generator(options);
+        if(output.empty()) {
+            generator.generate(std::cout);
+        } else {
+            std::ofstream out(output, std::ios::out | std::ios::binary);
+            generator.generate(out);
+            if(!out) [[unlikely]] { throw RuntimeError(FORMAT("cannot write {}", output)); }
+            LINFO("{} bytes, {} lines and {} errors written to {}", generator.getBytes(), generator.getLines(),
+                  generator.getErrors(), output);
+        }
+    } catch(const std::exception &e) {
+        LERROR("Unhandled exception in the generator: {}", e.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+DISABLE_WARNINGS_POP()
@@ -1,22 +1,74 @@
-#include <fmt/format.h>
-#include <iterator>
-#include <utility>
+#include "Dersbiander/dersbiander.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
 
-[[nodiscard]] auto sum_values(const uint8_t *Data, size_t Size)
-{
-  constexpr auto scale = 1000;
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
 
-  int value = 0;
-  for (std::size_t offset = 0; offset < Size; ++offset) {
-    value += static_cast<int>(*std::next(Data, static_cast<long>(offset))) * scale;
-  }
-  return value;
-}
+namespace {
+    /// Inputs are checked for superlinear work from this size: shorter ones are dominated by constant costs.
+    constexpr std::size_t minCheckedSize = 32;
+    /// An input is repeated this many times and must not cost more than this many times as much.
+    constexpr std::size_t repeats = 8;
+    /// Linear work takes repeats times as long, quadratic work repeats squared times: the bound sits between them.
+    constexpr double maxGrowth = 32.0;
+    /// Timings are the fastest of a few runs, so a preemption does not read as a slow input.
+    constexpr int timings = 3;
+
+    /// The timing check only runs when DERSBIANDER_FUZZ_TIMING is set to something other than 0: wall-clock bounds fail
+    /// at random on a loaded machine, so by default only crashes count.
+    [[nodiscard]] bool timingEnabled() noexcept {
+        const char *value = std::getenv("DERSBIANDER_FUZZ_TIMING");  // NOLINT(concurrency-mt-unsafe)
+        return value != nullptr && *value != '\0' && std::string_view{value} != "0";
+    }
+
+    /// Tokenizes and validates @p input as the CLI does, with unknown characters as tokens instead of an exit.
+    void process(const std::string &input) {
+        Tokenizer tokenizer(input);
+        tokenizer.setExitOnError(false);
+        const std::vector<Token> tokens = tokenizer.tokenize();
+        Validator validator(tokens);
+        doNotOptimize(validator.validate());
+    }
 
-// Fuzzer that attempts to invoke undefined behavior for signed integer overflow
+    [[nodiscard]] double fastest(const std::string &input) {
+        double best = std::numeric_limits<double>::max();
+        for(int run = 0; run < timings; ++run) {
+            const auto start = std::chrono::steady_clock::now();
+            process(input);
+            best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+        }
+        return best;
+    }
+}  // namespace
+
+/**
+ * Runs every input through the Tokenizer and the Validator. With DERSBIANDER_FUZZ_TIMING set, it then times the input
+ * against the same input repeated: an input whose cost grows faster than its size aborts, so libFuzzer keeps it as a
+ * crash and -minimize_crash=1 shrinks it. Minimized inputs go to fuzz_test/corpus, which the fuzz_tester_regression
+ * test replays.
+ */
 // cppcheck-suppress unusedFunction symbolName=LLVMFuzzerTestOneInput
-extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
-{
-  fmt::print("Value sum: {}, len{}\n", sum_values(Data, Size), Size);
-  return 0;
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, std::size_t size) {
+    const std::string input(reinterpret_cast<const char *>(data), size);  // NOLINT(*-reinterpret-cast)
+    process(input);
+    static const bool timed = timingEnabled();
+    if(!timed || size < minCheckedSize) { return 0; }
+    std::string repeated;
+    repeated.reserve(size * repeats);
+    for(std::size_t copy = 0; copy < repeats; ++copy) { repeated.append(input); }
+    const double single = fastest(input);
+    const double scaled = fastest(repeated);
+    if(scaled > single * maxGrowth) [[unlikely]] {
+        std::fprintf(stderr, "superlinear input: %zu bytes in %.0f ns, %zu bytes in %.0f ns (%.2f ns per byte)\n", size, single,
+                     repeated.size(), scaled, scaled / static_cast<double>(repeated.size()));
+        std::abort();
+    }
+    return 0;
 }
+
+DISABLE_WARNINGS_POP()
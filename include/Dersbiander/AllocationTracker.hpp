@@ -0,0 +1,85 @@
+#pragma once
+
+#include "headers.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef DERSBIANDER_TRACK_ALLOCATIONS
+/// The global operator new and delete go through AllocationTracker::global(): set by Dersbiander_TRACK_ALLOCATIONS.
+inline constexpr bool allocationTracking = true;
+#else
+inline constexpr bool allocationTracking = false;
+#endif
+
+/**
+ * @brief Counts the allocations, the bytes and the peak live bytes of every phase.
+ *
+ * The phase of a thread is the innermost ProfileZone it is in, whether the Profiler is enabled or not; allocations
+ * outside any zone belong to the phase "(none)". Every block carries a header with its size and the phase that
+ * allocated it, so freeing it in another phase, or on another thread, lowers the live bytes of the right one.
+ *
+ * allocate() and deallocate() only touch atomics and a fixed table of phases, so they can back the global operator new
+ * without allocating themselves. That only happens in builds with Dersbiander_TRACK_ALLOCATIONS: elsewhere nothing
+ * calls them and a ProfileZone does not enter a phase.
+ */
+class AllocationTracker {
+public:
+    static inline constexpr std::size_t maxPhases = 64;
+    /// Longer phase names are cut.
+    static inline constexpr std::size_t maxNameLength = 47;
+
+    struct PhaseStats {
+        std::string name;
+        std::uint64_t allocations;
+        std::uint64_t deallocations;
+        std::uint64_t bytes;
+        /// Bytes allocated in the phase and not freed yet.
+        std::uint64_t live;
+        std::uint64_t peak;
+    };
+
+    [[nodiscard]] static AllocationTracker &global() noexcept;
+
+    /// Makes @p name the phase of the calling thread and returns the previous one, for leave().
+    [[nodiscard]] std::uint32_t enter(std::string_view name) noexcept;
+    void leave(std::uint32_t previous) noexcept;
+
+    /// malloc() with a header, counted in the phase of the calling thread: nullptr when it fails.
+    [[nodiscard]] void *allocate(std::size_t size) noexcept;
+    /// Frees a block of allocate(), counted in the phase that allocated it.
+    void deallocate(void *pointer) noexcept;
+
+    /// One entry per phase that allocated, the most allocations first.
+    [[nodiscard]] std::vector<PhaseStats> summary() const;
+    /// The summary as a table, one phase per line, with the totals and the peak of the process.
+    [[nodiscard]] std::string report() const;
+    [[nodiscard]] inline std::uint64_t totalAllocations() const noexcept { return allocations.load(std::memory_order_relaxed); }
+    /// Drops the counts: the live bytes stay and become the peaks.
+    void clear() noexcept;
+
+private:
+    struct Phase {
+        std::array<char, maxNameLength + 1> name{};
+        std::atomic_uint64_t allocations = 0;
+        std::atomic_uint64_t deallocations = 0;
+        std::atomic_uint64_t bytes = 0;
+        std::atomic_uint64_t live = 0;
+        std::atomic_uint64_t peak = 0;
+    };
+
+    std::array<Phase, maxPhases> phases{};
+    /// Phases are only appended, under the mutex, and published by this count: readers do not lock.
+    std::atomic_uint32_t phaseCount = 0;
+    std::mutex mutex;
+    std::atomic_uint64_t allocations = 0;
+    std::atomic_uint64_t live = 0;
+    std::atomic_uint64_t peak = 0;
+
+    AllocationTracker() noexcept;
+    [[nodiscard]] std::uint32_t find(std::string_view name) const noexcept;
+};
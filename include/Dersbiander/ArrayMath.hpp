@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Bytecode.hpp"
+
+/**
+ * @brief Array operations of the VirtualMachine.
+ *
+ * Results go to the Array @p out of the destination register, and every operand is read before it changes, so @p out
+ * may hold one of them. Operations on unboxed arrays run as one loop over the contiguous elements, with the lengths
+ * checked once before it; tagged arrays go element by element. Invalid operands throw a RuntimeError.
+ */
+
+/// The value built by ARRAY from the @p count registers @p elements: unboxed when they are all scalars.
+[[nodiscard]] Value buildArray(const Value *elements, std::size_t count, Array &out);
+/// The value built by FILL: @p length copies of @p element.
+[[nodiscard]] Value fillArray(const Value &length, const Value &element, Array &out);
+/**
+ * @brief ADD, SUB, MUL, DIV, POW, NEG or a comparison with an array operand, element by element.
+ *
+ * Two arrays pair their elements and must have the same length, a scalar pairs with every element. Every element
+ * computes as the same operation on scalars does and comparisons give arrays of bools. Nested arrays recurse.
+ */
+[[nodiscard]] Value arrayArithmetic(OpCode op, const Value &left, const Value &right, Array &out);
+/// The element @p position of @p array, which must exist: a nested array is copied to @p out.
+[[nodiscard]] Value taggedElement(Array &array, std::size_t position, Array &out);
+/// ELEMENT: the element @p position of @p array without checking it.
+[[nodiscard]] inline Value element(Array &array, std::size_t position, Array &out) {
+    // NOLINTBEGIN(*-pro-bounds-constant-array-index)
+    switch(array.element) {
+    case ValueKind::INT:
+        return Value::fromInt(array.integers[position]);
+    case ValueKind::DOUBLE:
+        return Value::fromDouble(array.reals[position]);
+    case ValueKind::BOOL:
+        return Value::fromBool(array.integers[position] != 0);
+    default:
+        return taggedElement(array, position, out);
+    }
+    // NOLINTEND(*-pro-bounds-constant-array-index)
+}
+/// INDEX: the element @p position of @p array, checked.
+[[nodiscard]] Value indexArray(const Value &array, const Value &position, Array &out);
+/**
+ * @brief STORE: writes @p value to the element @p position of @p array, checked.
+ *
+ * The array keeps its layout: an unboxed one takes scalars its element kind can hold, a tagged element the same sort
+ * of value, scalar or array, it holds. Parallel loops can then write distinct elements of one array at the same time.
+ */
+void storeElement(const Value &array, const Value &position, const Value &value);
+/// LENGTH: the number of elements of @p array.
+[[nodiscard]] Value arrayLength(const Value &array);
+/// BOUND: throws the error of the first index out of bounds when a loop from @p start to @p bound indexes @p array.
+void checkBound(const Value &array, const Value &bound, const Value &start);
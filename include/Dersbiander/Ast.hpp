@@ -0,0 +1,150 @@
+#pragma once
+
+#include "ExpressionParser.hpp"
+#include "Token.hpp"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+enum class AstKind : std::uint16_t {
+    PROGRAM,
+    BLOCK,
+    MAIN,
+    DECLARATION,
+    ASSIGNMENT,
+    EXPRESSION_STATEMENT,
+    FOR,
+    STRUCTURE,
+    FUNCTION,
+    PARAMETER,
+    RETURN,
+    TYPE,
+    LIST,
+    IDENTIFIER,
+    EXPRESSION,
+    EMPTY
+};
+
+template <> struct fmt::formatter<AstKind> : fmt::formatter<std::string_view> {  // NOLINT(*-include-cleaner)
+    template <typename FormatContext> auto format(AstKind kind, FormatContext &ctx) {
+        std::string_view name;
+        switch(kind) {
+            using enum AstKind;
+        case PROGRAM:
+            name = "PROGRAM";
+            break;
+        case BLOCK:
+            name = "BLOCK";
+            break;
+        case MAIN:
+            name = "MAIN";
+            break;
+        case DECLARATION:
+            name = "DECLARATION";
+            break;
+        case ASSIGNMENT:
+            name = "ASSIGNMENT";
+            break;
+        case EXPRESSION_STATEMENT:
+            name = "EXPRESSION_STATEMENT";
+            break;
+        case FOR:
+            name = "FOR";
+            break;
+        case STRUCTURE:
+            name = "STRUCTURE";
+            break;
+        case FUNCTION:
+            name = "FUNCTION";
+            break;
+        case PARAMETER:
+            name = "PARAMETER";
+            break;
+        case RETURN:
+            name = "RETURN";
+            break;
+        case TYPE:
+            name = "TYPE";
+            break;
+        case LIST:
+            name = "LIST";
+            break;
+        case IDENTIFIER:
+            name = "IDENTIFIER";
+            break;
+        case EXPRESSION:
+            name = "EXPRESSION";
+            break;
+        case EMPTY:
+            name = "EMPTY";
+            break;
+        default:
+            name = "UNKNOWN";
+            break;
+        }
+        return fmt::formatter<std::string_view>::format(name, ctx);
+    }
+};
+
+using NodeIndex = std::uint32_t;
+static inline constexpr NodeIndex invalidNode = std::numeric_limits<NodeIndex>::max();
+
+/**
+ * @brief A node of the syntax tree.
+ *
+ * Nodes never point to each other: the token is an index in the token vector and the children are a contiguous range
+ * of the Ast children array, so a node is 16 bytes and the whole tree is a few flat vectors. EXPRESSION nodes have no
+ * children: their range selects the postfix code of the expression instead.
+ */
+struct AstNode {
+    AstKind kind;
+    std::uint32_t token;
+    std::uint32_t firstChild;
+    std::uint32_t childCount;
+};
+
+/**
+ * @brief The syntax tree of a token stream.
+ *
+ * Storage is a bump arena: nodes are only ever appended, the arena is sized once from the token count and nothing is
+ * freed until the whole Ast is destroyed. Node references are 32 bit indices, which keeps them valid while the arena
+ * grows and halves their size compared to pointers.
+ */
+class Ast {
+public:
+    explicit Ast(const std::vector<Token> &tokenList);
+
+    [[nodiscard]] inline NodeIndex getRoot() const noexcept { return root; }
+    [[nodiscard]] inline const AstNode &node(NodeIndex index) const noexcept { return nodes[index]; }
+    [[nodiscard]] inline const Token &token(NodeIndex index) const noexcept { return tokens[nodes[index].token]; }
+    [[nodiscard]] inline std::span<const NodeIndex> children(NodeIndex index) const noexcept {
+        const AstNode &current = nodes[index];
+        return {children_.data() + current.firstChild, current.childCount};
+    }
+    [[nodiscard]] inline std::span<const PostfixOp> code(NodeIndex index) const noexcept {
+        const AstNode &current = nodes[index];
+        return {postfix.data() + current.firstChild, current.childCount};
+    }
+    [[nodiscard]] inline std::size_t size() const noexcept { return nodes.size(); }
+    [[nodiscard]] inline const std::vector<Token> &getTokens() const noexcept { return tokens; }
+    [[nodiscard]] std::string to_string() const;  // NOLINT(*-include-cleaner)
+
+private:
+    friend class AstBuilder;
+
+    const std::vector<Token> &tokens;
+    std::vector<AstNode> nodes;
+    std::vector<NodeIndex> children_;
+    std::vector<PostfixOp> postfix;
+    NodeIndex root = invalidNode;
+
+    [[nodiscard]] NodeIndex allocate(AstKind kind, std::size_t tokenIndex, std::span<const NodeIndex> nodeChildren);
+    void dump(std::string &out, NodeIndex index, std::size_t depth) const;
+};
+
+template <> struct fmt::formatter<Ast> : fmt::formatter<std::string_view> {  // NOLINT(*-include-cleaner)
+    template <typename FormatContext> auto format(const Ast &val, FormatContext &ctx) {
+        return fmt::formatter<std::string_view>::format(val.to_string(), ctx);
+    }
+};
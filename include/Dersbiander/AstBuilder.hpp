@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Ast.hpp"
+#include <vector>
+
+/**
+ * @brief Builds an Ast one validated statement at a time.
+ *
+ * The Validator hands every statement it accepted to statement(), so the builder never has to deal with invalid input
+ * and never re-scans the token stream. Children are collected on a scratch stack and copied to the Ast in one go when
+ * their parent is created, which is what keeps every child list contiguous. Block bodies span several statements, so
+ * the node that owns a block (main, for, if/while, func) is only created when the matching '}' arrives. Expressions are
+ * handed to the ExpressionParser and stored as postfix code.
+ */
+class AstBuilder {
+public:
+    explicit AstBuilder(Ast &tree) noexcept;
+
+    /// Adds the statement made of the tokens in [first, last) to the tree.
+    void statement(std::size_t first, std::size_t last);
+    /// Closes the blocks still open and creates the PROGRAM root.
+    void finish();
+
+private:
+    struct Frame {
+        AstKind kind;
+        std::size_t token;
+        std::size_t headerMark;
+        std::size_t blockMark;
+        std::size_t blockToken;
+    };
+
+    Ast &ast;
+    std::vector<NodeIndex> scratch;
+    std::vector<Frame> frames;
+    std::size_t position = 0;
+    std::size_t end = 0;
+
+    [[nodiscard]] TokenType peek() const noexcept;
+    [[nodiscard]] const Token &current() const noexcept { return ast.tokens[position]; }
+    std::size_t advance() noexcept;
+    bool match(TokenType type) noexcept;
+    void skipComments() noexcept;
+    [[nodiscard]] NodeIndex commit(AstKind kind, std::size_t token, std::size_t mark);
+
+    void parseStatement();
+    void parseDeclaration();
+    void parseFor();
+    void parseStructure();
+    void parseFunction();
+    void parseReturn();
+    void parseAssignmentOrExpression();
+    void openBlock(AstKind kind, std::size_t token, std::size_t headerMark);
+    void closeBlock();
+    [[nodiscard]] NodeIndex parseType();
+    [[nodiscard]] NodeIndex parseExpressionList(std::size_t token);
+    [[nodiscard]] NodeIndex parseExpression();
+};
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "headers.hpp"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+/// Keeps the compiler from dropping the computation of @p value as unused.
+template <typename T> inline void doNotOptimize(const T &value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");  // NOLINT(*-no-assembler)
+#else
+    const volatile auto *sink = &value;
+    (void)sink;
+#endif
+}
+
+/// Hardware events counted while a benchmark ran, per iteration.
+struct HardwareCounters {
+    bool available = false;
+    double cycles = 0.0;
+    double instructions = 0.0;
+    double branchMisses = 0.0;
+    double cacheMisses = 0.0;
+};
+
+/**
+ * @brief Cycles, instructions, branch misses and cache misses of the calling thread, read with perf_event_open.
+ *
+ * The four events form one group, so they are counted over exactly the same instructions. Where perf events do not
+ * exist or are not allowed, as outside Linux or with a high perf_event_paranoid, isAvailable() is false and every
+ * count stays zero.
+ */
+class PerfCounters {
+public:
+    PerfCounters();
+    PerfCounters(const PerfCounters &other) = delete;
+    PerfCounters(PerfCounters &&other) = delete;
+    PerfCounters &operator=(const PerfCounters &other) = delete;
+    PerfCounters &operator=(PerfCounters &&other) = delete;
+    ~PerfCounters();
+
+    [[nodiscard]] inline bool isAvailable() const noexcept { return leader >= 0; }
+    void start() noexcept;
+    /// Stops counting and adds the events since start() to the totals.
+    void stop() noexcept;
+    /// The totals divided by @p iterations.
+    [[nodiscard]] HardwareCounters perIteration(std::uint64_t iterations) const noexcept;
+
+private:
+    int leader = -1;
+    std::array<int, 4> descriptors{-1, -1, -1, -1};
+    std::array<std::uint64_t, 4> totals{};
+};
+
+struct BenchmarkOptions {
+    /// Time spent running the body before anything is measured, in seconds.
+    double warmup = 0.1;
+    /// The shortest a sample may take, in seconds: the iterations per sample double until one takes this long.
+    double sampleTime = 0.01;
+    std::size_t samples = 30;
+    /// Samples further than this many interquartile ranges out of the quartiles are dropped as outliers.
+    double outlierFences = 1.5;
+};
+
+/// The nanoseconds per iteration of a benchmark, after outliers are dropped.
+struct BenchmarkResult {
+    std::string name;
+    std::uint64_t iterations = 0;
+    std::size_t samples = 0;
+    std::size_t outliers = 0;
+    double mean = 0.0;
+    double median = 0.0;
+    double stddev = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+    /// The 95% confidence interval of the mean, from Student's t distribution.
+    double low = 0.0;
+    double high = 0.0;
+    HardwareCounters counters;
+    /// Bytes and items, as tokens, one iteration processes: the throughputs are reported when they are set.
+    std::uint64_t bytes = 0;
+    std::uint64_t items = 0;
+
+    /// Half the confidence interval over the mean: 0.01 means the mean is known within 1%.
+    [[nodiscard]] inline double resolution() const noexcept { return mean > 0.0 ? (high - low) / 2.0 / mean : 0.0; }
+    [[nodiscard]] std::string to_string() const;
+    [[nodiscard]] std::string to_json() const;
+};
+
+/**
+ * @brief Measures a callable with warmup, adaptive iteration counts, outlier rejection and confidence intervals.
+ *
+ * run() calls the body for the warmup time, doubles the iterations of a sample until it lasts sampleTime, then times
+ * the samples: the per iteration times outside the outlier fences are dropped and the rest give the mean, its
+ * confidence interval and the spread. The body is called directly, without a std::function in between, and the
+ * hardware counters run around the samples only.
+ */
+class Benchmark {
+public:
+    explicit Benchmark(BenchmarkOptions benchmarkOptions = {}) noexcept : options(benchmarkOptions) {}
+
+    template <typename Body> BenchmarkResult run(std::string name, Body &&body) {
+        const auto measure = [&body](std::uint64_t iterations) {
+            const auto start = clock::now();
+            for(std::uint64_t i = 0; i < iterations; ++i) { body(); }
+            return std::chrono::duration<double>(clock::now() - start).count();
+        };
+        for(double spent = 0.0; spent < options.warmup;) { spent += measure(1); }
+        std::uint64_t iterations = 1;
+        while(measure(iterations) < options.sampleTime && iterations < (std::uint64_t{1} << 40U)) { iterations *= 2; }
+        std::vector<double> times;
+        times.reserve(options.samples);
+        PerfCounters counters;
+        for(std::size_t sample = 0; sample < options.samples; ++sample) {
+            counters.start();
+            const double seconds = measure(iterations);
+            counters.stop();
+            times.push_back(seconds * 1e9 / static_cast<double>(iterations));
+        }
+        return summarize(std::move(name), iterations, std::move(times), counters.perIteration(iterations * options.samples));
+    }
+
+    /// The results as one JSON document, with the same keys for every run so two of them can be compared.
+    [[nodiscard]] static std::string toJson(std::span<const BenchmarkResult> results);
+    /// How @p after differs from @p before, and whether their confidence intervals overlap.
+    [[nodiscard]] static std::string compare(const BenchmarkResult &before, const BenchmarkResult &after);
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    BenchmarkOptions options;
+
+    [[nodiscard]] BenchmarkResult summarize(std::string name, std::uint64_t iterations, std::vector<double> times,
+                                            const HardwareCounters &counters) const;
+};
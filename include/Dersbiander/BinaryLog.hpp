@@ -0,0 +1,102 @@
+#pragma once
+
+#include "format.hpp"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Records log calls as a format string and raw arguments, and formats them only when the trace is read.
+ *
+ * A record is the id of its format string, its level and its arguments: integers, floating point values, bools and
+ * chars are copied as they are and strings as their bytes. Any other argument is recorded as the text of its
+ * formatter, the only formatting done while recording. write() saves the format strings and the records in a compact
+ * binary file, read() formats a saved trace offline.
+ */
+class BinaryLog {
+public:
+    enum class Argument : std::uint8_t { INT, UINT, DOUBLE, BOOL, CHAR, STRING };
+
+    /// The log the L macros record to while it is enabled.
+    [[nodiscard]] static BinaryLog &global() noexcept;
+
+    [[nodiscard]] inline bool isEnabled() const noexcept { return enabled.load(std::memory_order_relaxed); }
+    inline void setEnabled(bool on) noexcept { enabled.store(on, std::memory_order_relaxed); }
+
+    template <typename... Args> void record(int level, std::string_view format, const Args &...args) {
+        const std::scoped_lock lock(mutex);
+        put(intern(format));
+        put(static_cast<std::uint8_t>(level));
+        put(static_cast<std::uint8_t>(sizeof...(Args)));
+        (append(args), ...);
+        ++records;
+    }
+
+    [[nodiscard]] inline std::size_t size() const noexcept { return records; }
+    /// The records formatted as `[level] message`.
+    [[nodiscard]] std::vector<std::string> format() const;
+    void write(std::ostream &out) const;
+    /// Formats the trace saved by write() in @p in, throws a RuntimeError when it is not one.
+    [[nodiscard]] static std::vector<std::string> read(std::istream &in);
+    void clear() noexcept;
+
+private:
+    struct Hash {
+        using is_transparent = void;
+        [[nodiscard]] inline std::size_t operator()(std::string_view text) const noexcept {
+            return std::hash<std::string_view>{}(text);
+        }
+    };
+
+    std::atomic_bool enabled = false;
+    mutable std::mutex mutex;
+    std::vector<std::string> formats;
+    std::unordered_map<std::string, std::uint32_t, Hash, std::equal_to<>> formatIds;
+    std::vector<char> bytes;
+    std::size_t records = 0;
+
+    [[nodiscard]] std::uint32_t intern(std::string_view format);
+    [[nodiscard]] static std::vector<std::string> decode(const std::vector<std::string> &formats, std::string_view bytes);
+
+    template <typename T> void put(const T &value) {
+        const std::size_t size = bytes.size();
+        bytes.resize(size + sizeof(T));
+        std::memcpy(bytes.data() + size, &value, sizeof(T));  // NOLINT(*-pro-bounds-pointer-arithmetic)
+    }
+    inline void putText(std::string_view text) {
+        put(static_cast<std::uint32_t>(text.size()));
+        bytes.insert(bytes.end(), text.begin(), text.end());
+    }
+    template <typename T> void append(const T &value) {
+        if constexpr(std::is_same_v<T, bool>) {
+            put(Argument::BOOL);
+            put(value);
+        } else if constexpr(std::is_same_v<T, char>) {
+            put(Argument::CHAR);
+            put(value);
+        } else if constexpr(std::is_integral_v<T> && std::is_signed_v<T>) {
+            put(Argument::INT);
+            put(static_cast<std::int64_t>(value));
+        } else if constexpr(std::is_integral_v<T>) {
+            put(Argument::UINT);
+            put(static_cast<std::uint64_t>(value));
+        } else if constexpr(std::is_floating_point_v<T>) {
+            put(Argument::DOUBLE);
+            put(static_cast<double>(value));
+        } else if constexpr(std::is_convertible_v<const T &, std::string_view>) {
+            put(Argument::STRING);
+            putText(value);
+        } else {
+            put(Argument::STRING);
+            putText(FORMAT("{}", value));
+        }
+    }
+};
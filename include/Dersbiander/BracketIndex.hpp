@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Diagnostic.hpp"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Matching-partner index of every bracket of a token stream.
+ *
+ * Built by a pre-pass before validation: the token types are classified through a lookup table into a flat byte
+ * array, round and square bracket depths are a prefix sum over it, and a single stack pass over the bracket positions
+ * pairs them up. Afterwards jumping over a balanced group or asking how many groups are open at a token is O(1), and
+ * every unbalanced bracket is already known before the state machine runs.
+ */
+class BracketIndex {
+public:
+    static inline constexpr std::uint32_t noPartner = std::numeric_limits<std::uint32_t>::max();
+
+    explicit BracketIndex(const std::vector<Token> &tokens);
+
+    /// Index of the bracket matching the one at @p index, noPartner for unbalanced brackets and other tokens.
+    [[nodiscard]] inline std::uint32_t partner(std::size_t index) const noexcept { return partners[index]; }
+    /// Round and square brackets opened and not yet closed before the token at @p index.
+    [[nodiscard]] inline long depth(std::size_t index) const noexcept { return depths[index]; }
+    /// Unbalanced brackets, in source order.
+    [[nodiscard]] inline const std::vector<Diagnostic> &getDiagnostics() const noexcept { return diagnostics; }
+    [[nodiscard]] inline bool isBalanced() const noexcept { return diagnostics.empty(); }
+    /// The most brackets of any kind, curly ones included, open at the same time.
+    [[nodiscard]] inline std::size_t getMaxDepth() const noexcept { return maxDepth; }
+
+private:
+    std::vector<std::uint32_t> partners;
+    std::vector<std::int32_t> depths;
+    std::vector<Diagnostic> diagnostics;
+    std::size_t maxDepth = 0;
+};
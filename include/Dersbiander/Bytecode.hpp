@@ -0,0 +1,367 @@
+#pragma once
+
+#include "Token.hpp"
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Operations of the register virtual machine.
+ *
+ * Three-address form: `a` is the destination, `b` and `c` the operands. Jumps keep their absolute target in `b` and
+ * `c` (low and high half). FOR_TEST checks the condition `a` of a for loop against its variable `b` and skips the
+ * JUMP that follows it while the loop continues. PARALLEL_FOR runs the loop `a` of Chunk::loops and goes on with the
+ * next instruction once every iteration is over. VECTOR builds the vector or matrix described by the VectorShape `c`
+ * from the registers starting at `b`, SWIZZLE picks the components of `b` encoded by swizzlePattern() in `c`.
+ *
+ * ARRAY builds an array of the `c` registers starting at `b`, FILL one of `b` copies of `c`. INDEX reads the element
+ * `c` of the array `b` and ELEMENT does the same without checking the index, which a BOUND before the loop around it
+ * proved: BOUND checks that the array `a` has an element for every value from the loop variable `c` up to the bound
+ * `b`. STORE writes `c` to the element `b` of the array `a` and LENGTH gives the number of elements of `b`.
+ *
+ * The order of the enumerators is the order of the dispatch table in VirtualMachine::run().
+ */
+enum class OpCode : std::uint16_t {
+    MOVE,
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+    POW,
+    NEG,
+    NOT,
+    AND,
+    OR,
+    EQ,
+    NE,
+    LT,
+    LE,
+    GT,
+    GE,
+    POSTINC,
+    POSTDEC,
+    VECTOR,
+    SWIZZLE,
+    ARRAY,
+    FILL,
+    INDEX,
+    ELEMENT,
+    STORE,
+    LENGTH,
+    BOUND,
+    JUMP,
+    JUMP_FALSE,
+    FOR_TEST,
+    PARALLEL_FOR,
+    HALT
+};
+
+template <> struct fmt::formatter<OpCode> : fmt::formatter<std::string_view> {  // NOLINT(*-include-cleaner)
+    template <typename FormatContext> auto format(OpCode code, FormatContext &ctx) {
+        std::string_view name;
+        switch(code) {
+            using enum OpCode;
+        case MOVE:
+            name = "MOVE";
+            break;
+        case ADD:
+            name = "ADD";
+            break;
+        case SUB:
+            name = "SUB";
+            break;
+        case MUL:
+            name = "MUL";
+            break;
+        case DIV:
+            name = "DIV";
+            break;
+        case POW:
+            name = "POW";
+            break;
+        case NEG:
+            name = "NEG";
+            break;
+        case NOT:
+            name = "NOT";
+            break;
+        case AND:
+            name = "AND";
+            break;
+        case OR:
+            name = "OR";
+            break;
+        case EQ:
+            name = "EQ";
+            break;
+        case NE:
+            name = "NE";
+            break;
+        case LT:
+            name = "LT";
+            break;
+        case LE:
+            name = "LE";
+            break;
+        case GT:
+            name = "GT";
+            break;
+        case GE:
+            name = "GE";
+            break;
+        case POSTINC:
+            name = "POSTINC";
+            break;
+        case POSTDEC:
+            name = "POSTDEC";
+            break;
+        case VECTOR:
+            name = "VECTOR";
+            break;
+        case SWIZZLE:
+            name = "SWIZZLE";
+            break;
+        case ARRAY:
+            name = "ARRAY";
+            break;
+        case FILL:
+            name = "FILL";
+            break;
+        case INDEX:
+            name = "INDEX";
+            break;
+        case ELEMENT:
+            name = "ELEMENT";
+            break;
+        case STORE:
+            name = "STORE";
+            break;
+        case LENGTH:
+            name = "LENGTH";
+            break;
+        case BOUND:
+            name = "BOUND";
+            break;
+        case JUMP:
+            name = "JUMP";
+            break;
+        case JUMP_FALSE:
+            name = "JUMP_FALSE";
+            break;
+        case FOR_TEST:
+            name = "FOR_TEST";
+            break;
+        case PARALLEL_FOR:
+            name = "PARALLEL_FOR";
+            break;
+        case HALT:
+            name = "HALT";
+            break;
+        default:
+            name = "UNKNOWN";
+            break;
+        }
+        return fmt::formatter<std::string_view>::format(name, ctx);
+    }
+};
+
+enum class ValueKind : std::uint8_t { BOOL, INT, DOUBLE, VECTOR, MATRIX, ARRAY };
+
+/**
+ * @brief The components of a vector or matrix register: a column-major 4x4 matrix of floats.
+ *
+ * A vector uses the first column only. Lanes outside the size of the value are always zero, so values of every size
+ * can go through the same 4x4 operations.
+ */
+struct alignas(16) Lanes {
+    std::array<float, 16> values{};
+};
+
+struct Array;
+
+/**
+ * @brief A register of the virtual machine: 16 bytes, no allocation.
+ *
+ * Vectors and matrices keep their components in the Lanes of the register that computed them and arrays their elements
+ * in its Array, which the virtual machine owns; the value only points to them.
+ */
+struct Value {
+    ValueKind kind = ValueKind::INT;
+    /// Components of a VECTOR, columns of a square MATRIX.
+    std::uint8_t size = 0;
+    union {
+        bool boolean;
+        std::int64_t integer = 0;
+        double real;
+        const Lanes *lanes;
+        Array *array;
+    };
+
+    [[nodiscard]] static inline Value fromBool(bool value) noexcept {
+        Value result;
+        result.kind = ValueKind::BOOL;
+        result.boolean = value;
+        return result;
+    }
+    [[nodiscard]] static inline Value fromInt(std::int64_t value) noexcept {
+        Value result;
+        result.integer = value;
+        return result;
+    }
+    [[nodiscard]] static inline Value fromDouble(double value) noexcept {
+        Value result;
+        result.kind = ValueKind::DOUBLE;
+        result.real = value;
+        return result;
+    }
+    /// A VECTOR or MATRIX of @p size components or columns stored in @p storage.
+    [[nodiscard]] static inline Value fromLanes(ValueKind kind, std::uint8_t size, const Lanes &storage) noexcept {
+        Value result;
+        result.kind = kind;
+        result.size = size;
+        result.lanes = &storage;
+        return result;
+    }
+    /// An ARRAY whose elements are in @p storage.
+    [[nodiscard]] static inline Value fromArray(Array &storage) noexcept {
+        Value result;
+        result.kind = ValueKind::ARRAY;
+        result.array = &storage;
+        return result;
+    }
+    [[nodiscard]] inline bool isScalar() const noexcept { return kind <= ValueKind::DOUBLE; }
+    [[nodiscard]] inline bool isWide() const noexcept { return kind == ValueKind::VECTOR || kind == ValueKind::MATRIX; }
+    [[nodiscard]] inline bool isTruthy() const noexcept {
+        switch(kind) {
+        case ValueKind::BOOL:
+            return boolean;
+        case ValueKind::DOUBLE:
+            return real != 0.0;
+        default:
+            return integer != 0;
+        }
+    }
+    [[nodiscard]] inline std::int64_t asInt() const noexcept {
+        return kind == ValueKind::BOOL ? static_cast<std::int64_t>(boolean) : integer;
+    }
+    [[nodiscard]] inline double asDouble() const noexcept {
+        return kind == ValueKind::DOUBLE ? real : static_cast<double>(asInt());
+    }
+    [[nodiscard]] bool operator==(const Value &other) const noexcept;
+    [[nodiscard]] std::string to_string() const;  // NOLINT(*-include-cleaner)
+};
+
+/**
+ * @brief The elements of an array register.
+ *
+ * An array of scalars is unboxed: its elements are contiguous, in `integers` when `element` is BOOL (0 or 1) or INT
+ * and in `reals` when it is DOUBLE, so element-wise operations run over plain buffers. Any other array is tagged:
+ * `element` is ARRAY and `values` holds every element, a nested array as an ARRAY value whose `integer` is its
+ * position in `nested`. An array never holds vectors or matrices.
+ */
+struct Array {
+    ValueKind element = ValueKind::INT;
+    std::vector<std::int64_t> integers;
+    std::vector<double> reals;
+    std::vector<Value> values;
+    std::vector<Array> nested;
+
+    [[nodiscard]] inline bool isTagged() const noexcept { return element == ValueKind::ARRAY; }
+    [[nodiscard]] inline std::size_t size() const noexcept {
+        switch(element) {
+        case ValueKind::DOUBLE:
+            return reals.size();
+        case ValueKind::ARRAY:
+            return values.size();
+        default:
+            return integers.size();
+        }
+    }
+    [[nodiscard]] bool operator==(const Array &other) const noexcept;
+    [[nodiscard]] std::string to_string() const;  // NOLINT(*-include-cleaner)
+};
+
+template <> struct fmt::formatter<Value> : fmt::formatter<std::string_view> {  // NOLINT(*-include-cleaner)
+    template <typename FormatContext> auto format(const Value &val, FormatContext &ctx) {
+        return fmt::formatter<std::string_view>::format(val.to_string(), ctx);
+    }
+};
+
+/// The opcode of a binary operator, nullopt for the ones the machine has no instruction for.
+[[nodiscard]] std::optional<OpCode> binaryOpCode(std::string_view value) noexcept;
+/// The value of a bool, char, integer or double literal; integers too large for 64 bits become doubles.
+[[nodiscard]] Value literalValue(const Token &token);
+/**
+ * @brief Operand `c` of SWIZZLE for the member @p letters of a vector of @p size components.
+ *
+ * One to four letters all from xyzw, rgba or stpq give the count in the high byte and two bits per picked component
+ * in the low one; anything else, or a component the vector does not have, gives nullopt.
+ */
+[[nodiscard]] std::optional<std::uint16_t> swizzlePattern(std::string_view letters, std::uint8_t size = 4) noexcept;
+
+/// Operand `c` of VECTOR: what it builds and how many registers, starting at `b`, it is built from.
+struct VectorShape {
+    bool matrix;
+    std::uint8_t size;
+    /// 0 for zero, 1 for a scalar repeated on every component or on the diagonal, else one per component or column.
+    std::uint8_t arguments;
+
+    [[nodiscard]] constexpr std::uint16_t encode() const noexcept {
+        return static_cast<std::uint16_t>(size | (matrix ? 8U : 0U) | (static_cast<unsigned>(arguments) << 4U));
+    }
+    [[nodiscard]] static constexpr VectorShape decode(std::uint16_t operand) noexcept {
+        return VectorShape{(operand & 8U) != 0, static_cast<std::uint8_t>(operand & 7U),
+                           static_cast<std::uint8_t>(operand >> 4U)};
+    }
+};
+
+struct Bytecode {
+    OpCode op;
+    std::uint16_t a;
+    std::uint16_t b;
+    std::uint16_t c;
+
+    [[nodiscard]] inline std::uint32_t target() const noexcept { return static_cast<std::uint32_t>(b) | (static_cast<std::uint32_t>(c) << 16U); }
+};
+
+/**
+ * @brief A `parallel for` loop of a Chunk.
+ *
+ * The loop variable runs from its value when PARALLEL_FOR starts, up to the bound and by the step read at the same
+ * time. The body is a separate stretch of code ending with HALT, run once per iteration on a private copy of the
+ * registers. Every reduction register starts each copy from the identity of its operator and the partial results are
+ * combined into the register in iteration order.
+ */
+struct ParallelLoop {
+    std::uint16_t variable;
+    std::uint16_t bound;
+    std::uint16_t step;
+    std::uint32_t body;
+    /// Register and operator, ADD or MUL, of every reduction.
+    std::vector<std::pair<std::uint16_t, OpCode>> reductions;
+};
+
+/**
+ * @brief A compiled program.
+ *
+ * Registers are laid out as [variables][constants][temporaries]: constants are copied into their registers once when
+ * the machine starts, so no instruction ever loads a constant.
+ */
+struct Chunk {
+    std::vector<Bytecode> code;
+    std::vector<Value> constants;
+    /// Name and register of every variable, for dumps.
+    std::vector<std::pair<std::string, std::uint16_t>> variables;
+    std::vector<ParallelLoop> loops;
+    std::uint16_t constantBase = 0;
+    std::uint16_t registerCount = 0;
+    /// Whether the code builds vectors or matrices: only then the machine gives every register its Lanes.
+    bool vectors = false;
+    /// Whether the code builds arrays: only then the machine gives every register its Array.
+    bool arrays = false;
+
+    [[nodiscard]] std::string disassemble() const;
+};
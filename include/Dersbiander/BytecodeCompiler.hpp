@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Bytecode.hpp"
+#include "ConstantFolder.hpp"
+#include "NameResolver.hpp"
+#include "ParallelChecker.hpp"
+#include "TypeChecker.hpp"
+#include <map>
+#include <vector>
+
+/**
+ * @brief Compiles a checked Ast to register bytecode.
+ *
+ * Supports `main` blocks and plain blocks, declarations, assignments (including `a, b = b, a` and `+=`), `if`,
+ * `while` and `for` loops over bool, char, int and double values and arrays of them. Every symbol owns a register,
+ * literals live in constant registers and expression temporaries are allocated as a stack above them. Strings, calls
+ * and member accesses are reported as UNSUPPORTED diagnostics, except calls of the vector and matrix types, which
+ * become VECTOR, swizzles, which become SWIZZLE, and `len()`, which becomes LENGTH; function definitions are skipped.
+ *
+ * Array literals become ARRAY, indices INDEX and `a[i] = v` a STORE. When a `for` goes up by 1 to a bound its body
+ * does not change, the indices `a[i]` every iteration reaches are checked by one BOUND before the loop and read with
+ * ELEMENT inside it.
+ *
+ * `for i = start, condition, step {` runs while a bool condition holds, or while `i` is below a numeric one, and adds
+ * the step (1 by default) after every iteration.
+ *
+ * With a ConstantFolder set, every constant subexpression becomes one constant register: nothing is recomputed at
+ * run time, in loops included.
+ *
+ * With a ParallelChecker set, a `parallel for` that passed it becomes a PARALLEL_FOR over a body compiled apart;
+ * otherwise it runs as a sequential loop, which is always a valid order for its iterations.
+ */
+class BytecodeCompiler {
+public:
+    BytecodeCompiler(const Ast &tree, const NameResolver &resolver, const TypeChecker &checker);
+
+    [[nodiscard]] std::vector<Diagnostic> compile();
+    [[nodiscard]] inline const Chunk &getChunk() const noexcept { return chunk; }
+    inline void setFolder(const ConstantFolder *constantFolder) noexcept { folder = constantFolder; }
+    inline void setParallel(const ParallelChecker *checker) noexcept { parallel = checker; }
+
+private:
+    const Ast &ast;
+    const NameResolver &names;
+    const TypeChecker &types;
+    const ConstantFolder *folder = nullptr;
+    const ParallelChecker *parallel = nullptr;
+    Chunk chunk;
+    std::map<std::pair<ValueKind, std::int64_t>, std::uint16_t> constantRegisters;
+    std::vector<std::uint16_t> operands;
+    std::uint16_t tempBase = 0;
+    std::uint16_t nextTemp = 0;
+    std::uint16_t maxTemp = 0;
+    /// The pairs of an array and a loop variable whose indices a BOUND before the loop being compiled checked.
+    std::vector<std::pair<SymbolIndex, SymbolIndex>> proven;
+    std::vector<Diagnostic> diagnostics;
+
+    void collectConstants();
+    [[nodiscard]] std::uint16_t constant(Value value);
+    /// The folded subtree starting at @p position of the expression @p index, nullptr without one or without a folder.
+    [[nodiscard]] const ConstantFolder::Folded *folded(NodeIndex index, std::size_t position) const noexcept;
+    void compileNode(NodeIndex index);
+    void compileDeclaration(NodeIndex index);
+    void compileAssignment(NodeIndex index);
+    void compileFor(NodeIndex index);
+    void compileParallelFor(NodeIndex index, std::uint16_t loopVariable, std::span<const ParallelChecker::Reduction> reductions);
+    /// Emits a BOUND for every array the body of the `for` @p index indexes with its variable and pushes it on proven.
+    void hoistBounds(NodeIndex index, std::uint32_t variableToken, std::uint16_t loopVariable);
+    /// Whether the statements under @p index declare @p symbol, assign it as a whole or change it with `++` or `--`.
+    [[nodiscard]] bool assigns(NodeIndex index, SymbolIndex symbol) const;
+    /// Whether the INDEX at @p position of @p code reads an element a BOUND checked.
+    [[nodiscard]] bool isProven(std::span<const PostfixOp> code, std::size_t position) const;
+    void compileStructure(NodeIndex index);
+    void compileChildren(NodeIndex index);
+    /// Compiles an expression and returns the register holding its value, @p destination when given.
+    std::uint16_t compileExpression(NodeIndex index, std::optional<std::uint16_t> destination = std::nullopt);
+    /// Compiles the ops from @p first to before @p last of the expression @p index, leaving their values in operands.
+    void compileCode(NodeIndex index, std::size_t first, std::size_t last);
+    /// `a[i] = value`, or `a[i] op= value` with @p op, on the array variable the expression @p target starts with.
+    void compileElementAssignment(NodeIndex target, NodeIndex value, std::optional<OpCode> op);
+    /// Fills @p target with the zeros of the array type @p type, from its innermost dimension out.
+    void compileZeroArray(NodeIndex type, std::uint16_t target, Value zero);
+    /// Builds a @p type from the top @p arguments operands, which sit above the placeholder of the callee.
+    void compileConstructor(TypeId type, std::uint32_t arguments);
+    /// Moves the top @p count operands to consecutive temporaries and returns the first one.
+    [[nodiscard]] std::uint16_t gather(std::uint32_t count);
+    [[nodiscard]] std::uint16_t variableRegister(std::uint32_t token);
+    [[nodiscard]] std::uint16_t allocateTemp();
+    void release(std::uint16_t reg) noexcept;
+    void emit(OpCode op, std::uint16_t a, std::uint16_t b = 0, std::uint16_t c = 0);
+    void emitVector(std::uint16_t target, TypeId type, std::uint16_t first, std::uint8_t arguments);
+    [[nodiscard]] std::size_t emitJump(OpCode op, std::uint16_t condition = 0);
+    void patchJump(std::size_t jump, std::size_t target) noexcept;
+    void unsupported(std::uint32_t token, std::string_view what);
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Bytecode.hpp"
+#include "Errors.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DERSBIANDER_C_BACKEND
+#endif
+
+/**
+ * @brief A shared object built from the output of a CTranspiler, loaded with dlopen.
+ *
+ * Calling it runs the entry point on a register array of CTranspiler::getRegisterCount() values and returns 0, or 1
+ * after an integer division by zero.
+ */
+class SharedLibrary {
+public:
+    SharedLibrary() noexcept = default;
+    /// Loads @p path and looks up the entry point, throws a RuntimeError when either fails.
+    explicit SharedLibrary(const std::filesystem::path &path);
+    SharedLibrary(const SharedLibrary &other) = delete;
+    SharedLibrary(SharedLibrary &&other) noexcept;
+    SharedLibrary &operator=(const SharedLibrary &other) = delete;
+    SharedLibrary &operator=(SharedLibrary &&other) noexcept;
+    ~SharedLibrary();
+
+    [[nodiscard]] inline bool isValid() const noexcept { return handle != nullptr; }
+    int operator()(Value *registers) const;
+
+private:
+    using Entry = int (*)(Value *);
+
+    void *handle = nullptr;
+    Entry entry = nullptr;
+
+    void release() noexcept;
+};
+
+/**
+ * @brief Compiles C sources with the system compiler and keeps the shared objects on disk.
+ *
+ * Objects are named after a 64 bit FNV-1a hash of the compiler command, the first line of its `--version` output and the
+ * source, so running an unchanged program again only costs a dlopen and upgrading the compiler rebuilds everything. A
+ * new object is compiled to a temporary name and renamed into place, so concurrent runs never load a half written file.
+ * The directory is created with mode 0700, and a directory or an object that the user does not own, or that others can
+ * write, is refused with a RuntimeError instead of being loaded.
+ */
+class CBuildCache {
+public:
+    explicit CBuildCache(std::filesystem::path cacheDirectory = defaultDirectory(), std::string compilerCommand = "cc -O2");
+
+    /// Loads the object built from @p source, compiling it first on a miss. Throws a RuntimeError when cc fails or the
+    /// cache is not the user's own.
+    [[nodiscard]] SharedLibrary load(std::string_view source);
+    [[nodiscard]] std::filesystem::path objectPath(std::string_view source) const;
+    [[nodiscard]] inline bool lastWasHit() const noexcept { return hit; }
+    [[nodiscard]] inline const std::filesystem::path &getDirectory() const noexcept { return directory; }
+    [[nodiscard]] static std::filesystem::path defaultDirectory();
+
+private:
+    std::filesystem::path directory;
+    std::string compiler;
+    std::string version;
+    bool hit = false;
+
+    void prepareDirectory() const;
+    [[nodiscard]] std::uint64_t hash(std::string_view source) const noexcept;
+    void build(std::string_view source, const std::filesystem::path &object) const;
+};
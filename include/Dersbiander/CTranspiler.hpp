@@ -0,0 +1,94 @@
+#pragma once
+
+#include "NameResolver.hpp"
+#include "TypeChecker.hpp"
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Translates a checked Ast to portable C99.
+ *
+ * Supports `main` blocks and plain blocks, `func` definitions with at most one return type, `var`/`const`
+ * declarations, assignments (including `a, b = b, a`, `+=` and element targets), `if`, `while` and `for` loops over
+ * bool, char, int and double values and arrays of fixed length. Every symbol becomes one C variable named after its
+ * index, declared at the top of the function that owns it, so the C scopes never have to mirror the resolver ones.
+ * Strings, member accesses, user types, overloaded functions, functions reading variables of an enclosing block and
+ * integer powers whose exponent is not an integer literal are reported as UNSUPPORTED diagnostics.
+ *
+ * Statements outside any function become the entry point `int dersbiander_main(Value *registers)`. When it finishes
+ * it stores every scalar variable it owns in `registers[symbol]` with the Value layout, so the results read back like
+ * those of the VirtualMachine; it returns divisionByZero after an integer division by zero and indexOutOfBounds after
+ * an index outside its array, checked for every index but the literals within the length. Integer arithmetic wraps
+ * around as in the interpreter, which the generated code relies on `-fwrapv` for.
+ */
+class CTranspiler {
+public:
+    static inline constexpr const char *entryPoint = "dersbiander_main";
+    /// The results of the entry point that stopped the program, the values dsb_abort is jumped to with.
+    static inline constexpr int divisionByZero = 1;
+    static inline constexpr int indexOutOfBounds = 2;
+
+    CTranspiler(const Ast &tree, const NameResolver &resolver, const TypeChecker &checker);
+
+    [[nodiscard]] std::vector<Diagnostic> transpile();
+    [[nodiscard]] inline const std::string &getSource() const noexcept { return source; }
+    /// Name and register of every value the entry point stores.
+    [[nodiscard]] inline const std::vector<std::pair<std::string, SymbolIndex>> &getVariables() const noexcept { return variables; }
+    /// Size of the register array the entry point expects.
+    [[nodiscard]] inline std::size_t getRegisterCount() const noexcept { return names.getSymbols().symbolCount(); }
+
+private:
+    /// The entry point or one function, with the symbols it declares.
+    struct Context {
+        NodeIndex function;
+        std::vector<SymbolIndex> locals;
+    };
+    struct Operand {
+        std::string text;
+        TypeId type;
+        SymbolIndex function = noSymbol;
+        /// A brace initializer built from an array literal, only valid as the whole value of an array target.
+        bool initializer = false;
+        /// The value of an integer literal, never negative as the sign is a separate operator; -1 for other operands.
+        std::int64_t integer = -1;
+    };
+    static inline constexpr std::uint32_t noContext = std::numeric_limits<std::uint32_t>::max();
+
+    const Ast &ast;
+    const NameResolver &names;
+    const TypeChecker &types;
+    std::vector<Context> contexts;
+    std::vector<std::uint32_t> owners;
+    std::uint32_t current = 0;
+    std::size_t depth = 0;
+    std::string code;
+    std::string source;
+    std::vector<std::pair<std::string, SymbolIndex>> variables;
+    std::vector<Operand> operands;
+    std::vector<Diagnostic> diagnostics;
+
+    void collect(NodeIndex index, std::uint32_t context);
+    [[nodiscard]] std::string signature(const Context &context);
+    /// The statements of @p context, its locals first.
+    [[nodiscard]] std::string body(std::uint32_t context);
+    void emitExports();
+    void emitNode(NodeIndex index);
+    void emitBlock(NodeIndex index);
+    void emitDeclaration(NodeIndex index);
+    void emitAssignment(NodeIndex index);
+    void emitFor(NodeIndex index);
+    void emitStructure(NodeIndex index);
+    void emitReturn(NodeIndex index);
+    void emitStore(const Operand &target, const Operand &value, std::uint32_t token);
+    [[nodiscard]] Operand expression(NodeIndex index);
+    [[nodiscard]] Operand variable(std::uint32_t token);
+    [[nodiscard]] Operand literal(std::uint32_t token);
+    [[nodiscard]] Operand binary(std::uint32_t token, std::string_view oper, const Operand &left, const Operand &right);
+    [[nodiscard]] Operand call(std::uint32_t token, std::span<const Operand> values);
+    /// The C declaration of @p name with type @p type, empty when the type has no C equivalent.
+    [[nodiscard]] std::string declarator(TypeId type, std::string_view name) const;
+    [[nodiscard]] std::string symbolName(SymbolIndex symbol) const;
+    void line(std::string_view text);
+    void unsupported(std::uint32_t token, std::string_view what);
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Bytecode.hpp"
+#include "NameResolver.hpp"
+#include <optional>
+#include <vector>
+
+/**
+ * @brief Evaluates the constant subexpressions of a resolved Ast once, before any backend sees them.
+ *
+ * A subexpression is constant when it only combines bool, char, int and double literals, names of `const` declarations
+ * with a constant value, unary and binary operators and `.len()` of a string literal, an array literal or a fixed-length
+ * array. Constants propagate in source order, so `const b = a * 2` folds as soon as `a` did. Values are computed by
+ * VirtualMachine::evaluate(), so a folded expression gives the same value the interpreter would.
+ *
+ * Every constant subtree is recorded at the position of its first postfix operation and the largest one wins: a
+ * backend walking the postfix code replaces the subtree with its value and skips to its last operation. Integer
+ * divisions by zero and constant indices outside a literal or fixed-length array are reported as CONSTANT_ERROR.
+ */
+class ConstantFolder {
+public:
+    struct Folded {
+        /// Position of the last operation of the subtree in the postfix code of its expression.
+        std::uint32_t last;
+        Value value;
+    };
+
+    ConstantFolder(const Ast &tree, const NameResolver &resolver);
+
+    [[nodiscard]] std::vector<Diagnostic> fold();
+    /// The largest constant subtree starting at @p position in the code of @p expression, nullptr when there is none.
+    [[nodiscard]] const Folded *folded(NodeIndex expression, std::size_t position) const noexcept;
+    /// The value of the whole expression @p expression when it is constant.
+    [[nodiscard]] std::optional<Value> value(NodeIndex expression) const noexcept;
+    /// How many operators and constant names were evaluated at compile time.
+    [[nodiscard]] inline std::size_t getFoldedCount() const noexcept { return foldedCount; }
+
+private:
+    static inline constexpr std::uint32_t unknownLength = std::numeric_limits<std::uint32_t>::max();
+
+    struct Operand {
+        std::optional<Value> value;
+        std::uint32_t start;
+        /// Elements of a string literal, an array literal or a fixed-length array.
+        std::uint32_t length = unknownLength;
+        /// `.len` of a value with a known length, waiting for its call.
+        bool lengthMember = false;
+    };
+
+    const Ast &ast;
+    const NameResolver &names;
+    /// Indexed by position in the postfix array of the whole Ast.
+    std::vector<std::optional<Folded>> foldAt;
+    std::vector<std::optional<Value>> constants;
+    std::vector<std::uint32_t> lengths;
+    std::vector<Operand> stack;
+    std::size_t foldedCount = 0;
+    std::vector<Diagnostic> diagnostics;
+
+    void foldNode(NodeIndex index);
+    void foldDeclaration(NodeIndex index);
+    void foldExpression(NodeIndex index);
+    [[nodiscard]] Operand apply(const PostfixOp &oper, std::uint32_t position, std::span<const Operand> operands);
+    [[nodiscard]] std::optional<Value> evaluate(std::uint32_t token, OpCode op, const Value &left, const Value &right);
+    void checkIndex(std::uint32_t token, const Operand &base, const Value &position);
+    /// Elements of the array or string that the expression @p index always has, unknownLength when they can change.
+    [[nodiscard]] std::uint32_t lengthOf(NodeIndex index) const noexcept;
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "Token.hpp"
+#include <string>
+#include <vector>
+
+enum class DiagnosticKind : short {
+    UNEXPECTED_TOKEN,
+    UNEXPECTED_ENDL,
+    UNBALANCED_BRACKET,
+    UNDECLARED_IDENTIFIER,
+    DUPLICATE_DECLARATION,
+    CONST_REASSIGNMENT,
+    TYPE_MISMATCH,
+    CONSTANT_ERROR,
+    LOOP_DEPENDENCY,
+    UNSUPPORTED
+};
+
+template <> struct fmt::formatter<DiagnosticKind> : fmt::formatter<std::string_view> {  // NOLINT(*-include-cleaner)
+    template <typename FormatContext> auto format(DiagnosticKind kind, FormatContext &ctx) {
+        std::string_view name;
+        switch(kind) {
+            using enum DiagnosticKind;
+        case UNEXPECTED_TOKEN:
+            name = "UNEXPECTED_TOKEN";
+            break;
+        case UNEXPECTED_ENDL:
+            name = "UNEXPECTED_ENDL";
+            break;
+        case UNBALANCED_BRACKET:
+            name = "UNBALANCED_BRACKET";
+            break;
+        case UNDECLARED_IDENTIFIER:
+            name = "UNDECLARED_IDENTIFIER";
+            break;
+        case DUPLICATE_DECLARATION:
+            name = "DUPLICATE_DECLARATION";
+            break;
+        case CONST_REASSIGNMENT:
+            name = "CONST_REASSIGNMENT";
+            break;
+        case TYPE_MISMATCH:
+            name = "TYPE_MISMATCH";
+            break;
+        case CONSTANT_ERROR:
+            name = "CONSTANT_ERROR";
+            break;
+        case LOOP_DEPENDENCY:
+            name = "LOOP_DEPENDENCY";
+            break;
+        case UNSUPPORTED:
+            name = "UNSUPPORTED";
+            break;
+        default:
+            name = "UNKNOWN";
+            break;
+        }
+        return fmt::formatter<std::string_view>::format(name, ctx);
+    }
+};
+
+/**
+ * @brief A single error found while validating a token stream, resolving its names, checking its types, folding its
+ * constants or checking its parallel loops.
+ *
+ * Besides the position and the offending lexeme, a diagnostic keeps the token types that the validator would have
+ * accepted at that point, so callers can report them without re-running the state machine. Type errors, errors in
+ * constant expressions, dependencies between parallel iterations and the constructs a backend cannot compile carry a
+ * message instead.
+ */
+class Diagnostic {
+public:
+    Diagnostic(DiagnosticKind kind, const Token &token, std::vector<TokenType> expected)
+      : _kind(kind), _value(token.getType() == eofTokenType ? "EOFT" : token.getValue()), _line(token.getLine()),
+        _column(token.getColumn()), _expected(std::move(expected)) {}
+    Diagnostic(DiagnosticKind kind, const Token &token, std::string message)
+      : _kind(kind), _value(token.getType() == eofTokenType ? "EOFT" : token.getValue()), _line(token.getLine()),
+        _column(token.getColumn()), _message(std::move(message)) {}
+
+    [[nodiscard]] inline DiagnosticKind getKind() const noexcept { return _kind; }
+    [[nodiscard]] inline const std::string &getValue() const noexcept { return _value; }
+    [[nodiscard]] inline std::size_t getLine() const noexcept { return _line; }
+    [[nodiscard]] inline std::size_t getColumn() const noexcept { return _column; }
+    [[nodiscard]] inline const std::vector<TokenType> &getExpected() const noexcept { return _expected; }
+    [[nodiscard]] inline const std::string &getMessage() const noexcept { return _message; }
+    [[nodiscard]] std::string to_string() const;  // NOLINT(*-include-cleaner)
+
+private:
+    DiagnosticKind _kind;
+    std::string _value;
+    std::size_t _line;
+    std::size_t _column;
+    std::vector<TokenType> _expected;
+    std::string _message;
+};
+
+template <> struct fmt::formatter<Diagnostic> : fmt::formatter<std::string_view> {  // NOLINT(*-include-cleaner)
+    template <typename FormatContext> auto format(const Diagnostic &val, FormatContext &ctx) {
+        return fmt::formatter<std::string_view>::format(val.to_string(), ctx);
+    }
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+
+/// A failure while running or loading a program, or while reading a file the library wrote: the callers report its
+/// message and stop.
+class RuntimeError : public std::runtime_error {
+public:
+    explicit RuntimeError(const std::string &message) : std::runtime_error(message) {}
+};
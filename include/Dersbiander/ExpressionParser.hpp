@@ -0,0 +1,103 @@
+#pragma once
+
+#include "Token.hpp"
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+enum class PostfixKind : std::uint8_t { IDENTIFIER, LITERAL, EMPTY, UNARY, BINARY, POSTFIX, CALL, INDEX, MEMBER, ARRAY };
+
+template <> struct fmt::formatter<PostfixKind> : fmt::formatter<std::string_view> {  // NOLINT(*-include-cleaner)
+    template <typename FormatContext> auto format(PostfixKind kind, FormatContext &ctx) {
+        std::string_view name;
+        switch(kind) {
+            using enum PostfixKind;
+        case IDENTIFIER:
+            name = "IDENTIFIER";
+            break;
+        case LITERAL:
+            name = "LITERAL";
+            break;
+        case EMPTY:
+            name = "EMPTY";
+            break;
+        case UNARY:
+            name = "UNARY";
+            break;
+        case BINARY:
+            name = "BINARY";
+            break;
+        case POSTFIX:
+            name = "POSTFIX";
+            break;
+        case CALL:
+            name = "CALL";
+            break;
+        case INDEX:
+            name = "INDEX";
+            break;
+        case MEMBER:
+            name = "MEMBER";
+            break;
+        case ARRAY:
+            name = "ARRAY";
+            break;
+        default:
+            name = "UNKNOWN";
+            break;
+        }
+        return fmt::formatter<std::string_view>::format(name, ctx);
+    }
+};
+
+/**
+ * @brief One entry of an expression in postfix (reverse polish) order.
+ *
+ * Operands come before their operator and @c arity tells how many values the entry pops: 0 for identifiers, literals
+ * and `()`, 1 for unary, postfix and member access, 2 for binary operators and indexing, the callee plus the arguments
+ * for a call and the element count for an array literal. Evaluating the array left to right with a value stack needs no
+ * tree and no pointer chasing.
+ */
+struct PostfixOp {
+    PostfixKind kind;
+    std::uint32_t token;
+    std::uint32_t arity;
+};
+
+/**
+ * @brief Pratt parser turning the tokens of one expression into a flat postfix array.
+ *
+ * Binding powers, from the loosest: `||`, `&&`, `==` `!=`, `<` `>` `<=` `>=`, `+` `-`, `*` `/`, the prefix `-` and
+ * `!`, `^` (right associative), and finally calls, indexing, member access and `++`/`--`. As in mathematics `-2 ^ 2`
+ * is -4, while an exponent may still be negative: `2 ^ -1` is 0.5.
+ */
+class ExpressionParser {
+public:
+    ExpressionParser(const std::vector<Token> &tokenList, std::size_t first, std::size_t last) noexcept;
+
+    /**
+     * @brief Parses one expression starting at the first token and appends it to @p out.
+     * @return The index of the first token after the expression.
+     */
+    std::size_t parse(std::vector<PostfixOp> &out);
+
+    [[nodiscard]] static std::string to_string(const std::vector<Token> &tokens, std::span<const PostfixOp> code);
+
+private:
+    const std::vector<Token> &tokens;
+    std::vector<PostfixOp> *output = nullptr;
+    std::size_t position;
+    std::size_t end;
+
+    void parseExpression(int minBindingPower);
+    void parsePrefix();
+    [[nodiscard]] bool parsePostfix();
+    std::uint32_t parseList(TokenType close);
+    [[nodiscard]] TokenType peek() const noexcept;
+    std::size_t advance() noexcept;
+    bool match(TokenType type) noexcept;
+    void skipComments() noexcept;
+    void emit(PostfixKind kind, std::size_t token, std::uint32_t arity);
+    [[nodiscard]] std::pair<int, int> infixBindingPower() const noexcept;
+};
@@ -2,6 +2,7 @@
 
 #include "InstructionType.hpp"
 #include "Token.hpp"
+#include <array>
 #include <vector>
 
 class Instruction {
@@ -9,13 +10,20 @@ public:
     explicit Instruction() noexcept;
     [[nodiscard]] std::vector<std::string> typeToString() const noexcept;
     [[nodiscard]] std::pair<bool, std::string> checkToken(const Token &token);
-    [[nodiscard]] inline bool canTerminate() {
+    [[nodiscard]] inline bool canTerminate() const {
         return std::ranges::find(this->allowedTokens, eofTokenType) != this->allowedTokens.end();
     }
+    [[nodiscard]] inline const std::vector<TokenType> &getAllowedTokens() const noexcept { return this->allowedTokens; }
+    [[nodiscard]] inline InstructionType getLastInstructionType() const noexcept { return this->instructionTypes.back(); }
+    /// The kind of the statement: the bottom of the instruction stack.
+    [[nodiscard]] inline InstructionType getFirstInstructionType() const noexcept {
+        return this->instructionTypes.empty() ? InstructionType::BLANK : this->instructionTypes.front();
+    }
 
 private:
-    std::vector<Token> tokens;
-    std::vector<Token> previousTokens;
+    /// Only the type of the previous token matters, so copying an Instruction never copies token text.
+    TokenType previousType = eofTokenType;
+    bool previousEmpty = true;
     std::vector<InstructionType> instructionTypes;
     std::vector<TokenType> allowedTokens;
     std::vector<bool> booleanOperatorPresent;
@@ -39,6 +47,7 @@ private:
     void checkKeywordVar();
     void checkKeywordStructure();
     void checkKeywordFor();
+    void checkKeywordParallel();
     void checkKeywordFunc();
     void checkKeywordReturn();
     void emplaceCommaEoft() noexcept;
@@ -46,8 +55,8 @@ private:
     [[nodiscard]] inline bool isExpression() noexcept;
     // NOLINTNEXTLINE
     [[nodiscard]] inline bool isForExpression() noexcept;
-    [[nodiscard]] TokenType previousTokensLast() noexcept { return this->previousTokens.back().getType(); }
-    [[nodiscard]] bool isPreviousEmpty() const noexcept { return this->previousTokens.empty(); }
+    [[nodiscard]] TokenType previousTokensLast() const noexcept { return this->previousType; }
+    [[nodiscard]] bool isPreviousEmpty() const noexcept { return this->previousEmpty; }
     [[nodiscard]] InstructionType &lastInstructionType() noexcept { return this->instructionTypes.back(); }
     [[nodiscard]] inline bool lastInstructionTypeIs(const InstructionType &type) noexcept {
         return this->lastInstructionType() == type;
@@ -89,9 +98,8 @@ private:
         if(type != TokenType::UNARY_OPERATOR) { this->allowedTokens.emplace_back(TokenType::UNARY_OPERATOR); }
     }
     inline bool emplaceForTokens() noexcept;
-    std::vector<TokenType> expressionStart = {TokenType::IDENTIFIER,     TokenType::INTEGER,
-                                              TokenType::DOUBLE,         TokenType::CHAR,
-                                              TokenType::STRING,         TokenType::BOOLEAN,
-                                              TokenType::MINUS_OPERATOR, TokenType::NOT_OPERATOR,
-                                              TokenType::OPEN_BRACKETS,  TokenType::OPEN_SQUARE_BRACKETS};
+    static inline constexpr std::array<TokenType, 10> expressionStart = {
+        TokenType::IDENTIFIER, TokenType::INTEGER,        TokenType::DOUBLE,       TokenType::CHAR,
+        TokenType::STRING,     TokenType::BOOLEAN,        TokenType::MINUS_OPERATOR, TokenType::NOT_OPERATOR,
+        TokenType::OPEN_BRACKETS, TokenType::OPEN_SQUARE_BRACKETS};
 };
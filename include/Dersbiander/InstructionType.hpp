@@ -25,6 +25,9 @@ enum class InstructionType : short {
     CLOSE_SCOPE,
     BLANK
 };
+/// Entries of a table indexed by InstructionType.
+static inline constexpr std::size_t instructionTypeCount = static_cast<std::size_t>(InstructionType::BLANK) + 1;
+
 template <> struct fmt::formatter<InstructionType> : fmt::formatter<std::string_view> {  // NOLINT(*-include-cleaner)
     template <typename FormatContext> auto format(InstructionType tokenType, FormatContext &ctx) {
         std::string_view name;
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "Profiler.hpp"
+#include "headers.hpp"
+#include "macros.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// One switch per subsystem, set from the Dersbiander_INSTRUMENT_<SUBSYSTEM> CMake options: 1 compiles its
+// instrumentation points in, 0 leaves nothing of them, not even the evaluation of their arguments.
+#ifndef DERSBIANDER_INSTRUMENT_LEXER
+#define DERSBIANDER_INSTRUMENT_LEXER 0
+#endif
+#ifndef DERSBIANDER_INSTRUMENT_VALIDATOR
+#define DERSBIANDER_INSTRUMENT_VALIDATOR 0
+#endif
+#ifndef DERSBIANDER_INSTRUMENT_IO
+#define DERSBIANDER_INSTRUMENT_IO 0
+#endif
+
+inline constexpr bool instrumentationEnabled =
+    DERSBIANDER_INSTRUMENT_LEXER != 0 || DERSBIANDER_INSTRUMENT_VALIDATOR != 0 || DERSBIANDER_INSTRUMENT_IO != 0;
+
+/**
+ * @brief Named counters and timers that every thread updates in its own block of slots.
+ *
+ * A slot is only written by the thread that owns it, with a relaxed load and store and no read-modify-write, so an
+ * update costs about as much as incrementing a plain variable. The block of a thread is registered the first time it
+ * counts something and stays with the Instrumentation after the thread exits; summary() adds up the blocks of every
+ * thread. Names are registered once per instrumentation point, on its first run.
+ *
+ * Use the INSTRUMENT_ macros rather than this class: they compile to nothing in subsystems that are switched off.
+ */
+class Instrumentation {
+public:
+    static inline constexpr std::size_t maxSlots = 256;
+
+    struct Stats {
+        std::string name;
+        /// Runs of a timer, or the value of a counter.
+        std::uint64_t count;
+        /// Nanoseconds spent in a timer, 0 for counters.
+        std::uint64_t nanoseconds;
+        bool timer;
+    };
+
+    [[nodiscard]] static Instrumentation &global() noexcept;
+
+    /// The slot of the counter @p name. A full table sends every new counter to the overflow counter slot.
+    [[nodiscard]] ATTR_NOINLINE std::uint32_t counter(std::string_view name);
+    /// The first of the two slots of the timer @p name: its runs, then its nanoseconds. A full table sends every new
+    /// timer to the overflow timer slots.
+    [[nodiscard]] ATTR_NOINLINE std::uint32_t timer(std::string_view name);
+
+    static inline void add(std::uint32_t slot, std::uint64_t amount) noexcept {
+        std::atomic_uint64_t &value = threadSlots()[slot];
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    /// Every counter and timer, in the order they were registered.
+    [[nodiscard]] std::vector<Stats> summary() const;
+    /// The summary as a table, one counter or timer per line.
+    [[nodiscard]] std::string report() const;
+
+private:
+    using Slots = std::array<std::atomic_uint64_t, maxSlots>;
+
+    /// The slots the counters and the timers share once the table is full, kept apart so that they stay of one kind.
+    static inline constexpr std::uint32_t overflowCounter = 0;
+    static inline constexpr std::uint32_t overflowTimer = 1;
+    static inline constexpr std::uint32_t firstSlot = 3;
+
+    struct Entry {
+        std::string name;
+        std::uint32_t slot;
+        bool timer;
+    };
+
+    mutable std::mutex mutex;
+    std::vector<Entry> entries;
+    std::uint32_t used = firstSlot;
+    std::vector<std::unique_ptr<Slots>> threads;
+
+    [[nodiscard]] std::uint32_t reserve(std::string_view name, bool timer);
+    [[nodiscard]] ATTR_NOINLINE Slots &registerThread();
+
+    [[nodiscard]] static inline Slots &threadSlots() {
+        thread_local Slots *slots = nullptr;
+        if(slots == nullptr) [[unlikely]] { slots = &global().registerThread(); }
+        return *slots;
+    }
+};
+
+/// Adds the time between its construction and its destruction to a timer of the Instrumentation.
+class InstrumentTimer {
+public:
+    explicit InstrumentTimer(std::uint32_t slot) noexcept : slot_(slot), start(clock::now()) {}
+    InstrumentTimer(const InstrumentTimer &other) = delete;
+    InstrumentTimer(InstrumentTimer &&other) = delete;
+    InstrumentTimer &operator=(const InstrumentTimer &other) = delete;
+    InstrumentTimer &operator=(InstrumentTimer &&other) = delete;
+    ~InstrumentTimer() {
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start);
+        Instrumentation::add(slot_, 1);
+        Instrumentation::add(slot_ + 1, static_cast<std::uint64_t>(elapsed.count()));
+    }
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    std::uint32_t slot_;
+    clock::time_point start;
+};
+
+#define INSTRUMENT_CONCAT_(a, b) a##b
+#define INSTRUMENT_CONCAT(a, b) INSTRUMENT_CONCAT_(a, b)
+#define INSTRUMENT_WHEN_0(...) static_cast<void>(0)
+#define INSTRUMENT_WHEN_1(...) __VA_ARGS__
+/// Expands to the rest of the arguments when @p subsystem is switched on, to nothing otherwise.
+#define INSTRUMENT_IF(subsystem, ...) INSTRUMENT_CONCAT(INSTRUMENT_WHEN_, DERSBIANDER_INSTRUMENT_##subsystem)(__VA_ARGS__)
+
+/// Adds @p amount to the counter @p name of @p subsystem: LEXER, VALIDATOR or IO.
+#define INSTRUMENT_COUNT(subsystem, name, amount)                                                                                \
+    INSTRUMENT_IF(subsystem, do {                                                                                                \
+        static const std::uint32_t instrumentSlot = Instrumentation::global().counter(name);                                    \
+        Instrumentation::add(instrumentSlot, (amount));                                                                          \
+    } while(false))
+/// Times the rest of the enclosing scope as the timer @p name of @p subsystem.
+#define INSTRUMENT_TIMER(subsystem, name)                                                                                        \
+    INSTRUMENT_IF(subsystem, static const std::uint32_t INSTRUMENT_CONCAT(instrumentSlot, __LINE__) =                          \
+                                 Instrumentation::global().timer(name);                                                          \
+                  const InstrumentTimer INSTRUMENT_CONCAT(instrumentTimer, __LINE__)(INSTRUMENT_CONCAT(instrumentSlot, __LINE__)))
+/// Records the rest of the enclosing scope as a zone of the Profiler, when @p subsystem is switched on.
+#define INSTRUMENT_TRACE(subsystem, name) INSTRUMENT_IF(subsystem, PROFILE_ZONE(name))
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "Bytecode.hpp"
+#include "SymbolTable.hpp"
+#include "TypeTable.hpp"
+#include <string>
+#include <utility>
+#include <vector>
+
+using IrValue = std::uint32_t;
+using BlockIndex = std::uint32_t;
+static inline constexpr IrValue noValue = std::numeric_limits<IrValue>::max();
+static inline constexpr BlockIndex noBlock = std::numeric_limits<BlockIndex>::max();
+
+/// CONSTANT holds a value, PHI merges one operand per predecessor, OPERATION applies an arithmetic OpCode. REMOVED
+/// values were eliminated and are never referenced again.
+enum class IrKind : std::uint8_t { CONSTANT, PHI, OPERATION, REMOVED };
+
+template <> struct fmt::formatter<IrKind> : fmt::formatter<std::string_view> {  // NOLINT(*-include-cleaner)
+    template <typename FormatContext> auto format(IrKind kind, FormatContext &ctx) {
+        std::string_view name;
+        switch(kind) {
+            using enum IrKind;
+        case CONSTANT:
+            name = "CONSTANT";
+            break;
+        case PHI:
+            name = "PHI";
+            break;
+        case OPERATION:
+            name = "OPERATION";
+            break;
+        case REMOVED:
+            name = "REMOVED";
+            break;
+        default:
+            name = "UNKNOWN";
+            break;
+        }
+        return fmt::formatter<std::string_view>::format(name, ctx);
+    }
+};
+
+/**
+ * @brief How a basic block ends.
+ *
+ * JUMP goes to `target`. BRANCH goes to `target` when `condition` is truthy and to `otherwise` when it is not.
+ * FOR_BRANCH tests `condition` against `loopVariable` like the FOR_TEST instruction. HALT ends the program.
+ */
+enum class IrTerminator : std::uint8_t { JUMP, BRANCH, FOR_BRANCH, HALT };
+
+/// One SSA value: each is defined exactly once, by the instruction that computes it.
+struct IrInstruction {
+    IrKind kind;
+    OpCode op;
+    TypeId type;
+    BlockIndex block;
+    Value constant;
+    /// Operands of an OPERATION, or of a PHI in the order of the predecessors of its block.
+    std::vector<IrValue> operands;
+};
+
+struct IrBlock {
+    /// Phis first, then operations in execution order. Constants live in the entry block.
+    std::vector<IrValue> instructions;
+    std::vector<BlockIndex> predecessors;
+    IrTerminator terminator = IrTerminator::HALT;
+    IrValue condition = noValue;
+    IrValue loopVariable = noValue;
+    BlockIndex target = noBlock;
+    BlockIndex otherwise = noBlock;
+    bool removed = false;
+
+    [[nodiscard]] std::vector<BlockIndex> successors() const;
+};
+
+/**
+ * @brief A program in SSA form: a control flow graph of basic blocks over typed values.
+ *
+ * Values and blocks are indices in two flat vectors, so passes rewrite them in place and nothing is ever freed:
+ * eliminated values become REMOVED and unreachable blocks are marked removed. When the program halts, every variable
+ * listed in `outputs` gets its final value, so lowered code leaves the same results in the same registers as the
+ * BytecodeCompiler does.
+ */
+class IrFunction {
+public:
+    static inline constexpr BlockIndex entry = 0;
+
+    std::vector<IrBlock> blocks;
+    std::vector<IrInstruction> values;
+    std::vector<std::pair<SymbolIndex, IrValue>> outputs;
+
+    [[nodiscard]] BlockIndex addBlock();
+    /// Appends an instruction to @p block; constants always go to the entry block.
+    IrValue add(BlockIndex block, IrKind kind, OpCode op, TypeId type, std::vector<IrValue> operands = {});
+    [[nodiscard]] IrValue constant(Value value);
+    /// Adds the edge @p from -> @p to; the phis of @p to must receive their operand for it.
+    void link(BlockIndex from, BlockIndex to);
+    /// Removes the edge @p from -> @p to along with the matching operand of every phi of @p to.
+    void unlink(BlockIndex from, BlockIndex to);
+    /// Applies @p forward, mapping values to their replacement (noValue for none), to every operand and output.
+    void replaceUses(const std::vector<IrValue> &forward);
+    /// Replaces phis whose operands are all one value (or the phi itself) by that value, until none is left.
+    std::size_t removeTrivialPhis();
+    /// Inserts an empty block on every edge from a block with two successors to a block with phis and other predecessors.
+    void splitCriticalEdges();
+    /// Reachable blocks, every block before its successors except along back edges.
+    [[nodiscard]] std::vector<BlockIndex> reversePostorder() const;
+    /// Immediate dominator of every reachable block, noBlock for the entry and unreachable blocks.
+    [[nodiscard]] std::vector<BlockIndex> dominators() const;
+    [[nodiscard]] static bool dominates(const std::vector<BlockIndex> &idom, BlockIndex dominator, BlockIndex block) noexcept;
+    /// Phis and operations that were not eliminated.
+    [[nodiscard]] std::size_t instructionCount() const noexcept;
+    [[nodiscard]] std::string to_string(const TypeTable &types) const;
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "ConstantFolder.hpp"
+#include "Ir.hpp"
+#include "NameResolver.hpp"
+#include "TypeChecker.hpp"
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Builds the SSA form of a checked Ast.
+ *
+ * Only covers scalar programs: array types, elements, `len()`, strings, vectors, matrices and functions are reported as
+ * UNSUPPORTED, although the BytecodeCompiler accepts some of them, and `--ssa` inherits these limits.
+ *
+ * `if` and `while` split the graph at their condition, `for` gets a header testing its condition and a latch adding its
+ * step. Values are numbered on the fly with the algorithm of Braun et al. (Simple and Efficient Construction of Static
+ * Single Assignment Form): a variable read looks for its last write in the current block and in the predecessors, and
+ * blocks whose predecessors are not all known yet (loop headers) get placeholder phis that are completed when the back
+ * edge is added. Trivial phis are removed at the end, so the result is minimal for these structured programs.
+ *
+ * Every value is typed: phis take the type of their variable, operations the promoted type of their operands.
+ */
+class IrBuilder {
+public:
+    IrBuilder(const Ast &tree, const NameResolver &resolver, const TypeChecker &checker);
+
+    [[nodiscard]] std::vector<Diagnostic> build();
+    [[nodiscard]] inline IrFunction &getFunction() noexcept { return function; }
+    [[nodiscard]] inline const IrFunction &getFunction() const noexcept { return function; }
+    inline void setFolder(const ConstantFolder *constantFolder) noexcept { folder = constantFolder; }
+
+private:
+    /// An operand of the expression being built; `symbol` is the variable it was read from, if any.
+    struct Operand {
+        IrValue value;
+        SymbolIndex symbol;
+    };
+
+    const Ast &ast;
+    const NameResolver &names;
+    const TypeChecker &types;
+    const ConstantFolder *folder = nullptr;
+    IrFunction function;
+    BlockIndex current = IrFunction::entry;
+    std::vector<std::unordered_map<SymbolIndex, IrValue>> definitions;
+    std::vector<std::vector<std::pair<SymbolIndex, IrValue>>> incompletePhis;
+    std::vector<bool> sealed;
+    std::vector<Operand> operands;
+    std::vector<Diagnostic> diagnostics;
+
+    [[nodiscard]] BlockIndex newBlock();
+    void seal(BlockIndex block);
+    void jump(BlockIndex from, BlockIndex to);
+    void write(SymbolIndex symbol, BlockIndex block, IrValue value);
+    [[nodiscard]] IrValue read(SymbolIndex symbol, BlockIndex block);
+    [[nodiscard]] IrValue readRecursive(SymbolIndex symbol, BlockIndex block);
+    void addPhiOperands(SymbolIndex symbol, IrValue phi);
+    void buildNode(NodeIndex index);
+    void buildDeclaration(NodeIndex index);
+    void buildAssignment(NodeIndex index);
+    void buildFor(NodeIndex index);
+    void buildStructure(NodeIndex index);
+    [[nodiscard]] IrValue buildExpression(NodeIndex index);
+    [[nodiscard]] IrValue operation(OpCode op, IrValue left, IrValue right = noValue);
+    [[nodiscard]] SymbolIndex variable(std::uint32_t token);
+    void unsupported(std::uint32_t token, std::string_view what);
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Ast.hpp"
+#include "Bytecode.hpp"
+#include "Diagnostic.hpp"
+#include "Ir.hpp"
+#include "NameResolver.hpp"
+#include <map>
+#include <vector>
+
+/**
+ * @brief Lowers an IrFunction to register bytecode.
+ *
+ * The register layout is the one of the BytecodeCompiler: [variables][constants][values]. Every phi and operation
+ * gets its own register and constants their constant register, so no value is ever overwritten and the only moves
+ * are the phi copies, placed at the end of each predecessor after critical edges are split, and the final store of
+ * the outputs in the variable registers before HALT. Phi copies run as a parallel copy, with one scratch register to
+ * break cycles such as the swap in `a, b = b, a`. Blocks are laid out in reverse postorder, so most jumps fall through.
+ */
+class IrCompiler {
+public:
+    IrCompiler(const Ast &tree, const NameResolver &resolver, IrFunction &ir);
+
+    [[nodiscard]] std::vector<Diagnostic> compile();
+    [[nodiscard]] inline const Chunk &getChunk() const noexcept { return chunk; }
+
+private:
+    const Ast &ast;
+    const NameResolver &names;
+    IrFunction &function;
+    Chunk chunk;
+    std::map<std::pair<ValueKind, std::int64_t>, std::uint16_t> constantRegisters;
+    std::vector<std::uint16_t> registers;
+    std::uint16_t scratch = 0;
+    /// Jumps to patch once every block has its address: instruction and target block.
+    std::vector<std::pair<std::size_t, BlockIndex>> jumps;
+    std::vector<Diagnostic> diagnostics;
+
+    [[nodiscard]] bool allocate(const std::vector<BlockIndex> &order);
+    [[nodiscard]] std::uint16_t constant(Value value);
+    void emitCopies(BlockIndex from, BlockIndex to);
+    void emitJump(OpCode op, BlockIndex target, std::uint16_t condition = 0);
+    void emit(OpCode op, std::uint16_t a, std::uint16_t b = 0, std::uint16_t c = 0);
+    void unsupported(std::string_view what);
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Ir.hpp"
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Folds branches on constants, removes unreachable blocks and deletes the values no output, condition or
+ * possibly trapping division depends on.
+ * @return How many branches, blocks and values were removed.
+ */
+std::size_t eliminateDeadCode(IrFunction &function);
+
+/**
+ * @brief Global value numbering over the dominator tree: an operation computed again with the same operands in a
+ * block dominated by the first one reuses its value. Commutative operators match in either operand order and equal
+ * constants are merged.
+ * @return How many values were replaced.
+ */
+std::size_t eliminateCommonSubexpressions(IrFunction &function);
+
+/**
+ * @brief Moves the operations of a loop whose operands are all defined outside it to the preheader, innermost loops
+ * first so an invariant of a loop nest climbs as far as it can. Divisions that could trap stay where they are, since
+ * the loop might not run at all.
+ * @return How many values were hoisted.
+ */
+std::size_t hoistLoopInvariants(IrFunction &function);
+
+/**
+ * @brief Runs a sequence of passes over an IrFunction and times each run with a Timer.
+ */
+class IrPassManager {
+public:
+    using Pass = std::function<std::size_t(IrFunction &)>;
+    struct PassRun {
+        std::string name;
+        std::size_t changes;
+        long double nanoseconds;
+    };
+
+    void add(std::string name, Pass pass);
+    void run(IrFunction &function);
+    [[nodiscard]] inline const std::vector<PassRun> &getRuns() const noexcept { return runs; }
+    /// One line per run: name, changes and time.
+    [[nodiscard]] std::string report() const;
+    /// dce, cse, licm and dce again for what the others left unused.
+    [[nodiscard]] static IrPassManager standard();
+
+private:
+    std::vector<std::pair<std::string, Pass>> passes;
+    std::vector<PassRun> runs;
+};
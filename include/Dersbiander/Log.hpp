@@ -14,10 +14,45 @@ DISABLE_WARNINGS_PUSH(
 
 DISABLE_WARNINGS_POP()
 
-#define LTRACE(...) SPDLOG_TRACE(__VA_ARGS__)
-#define LDEBUG(...) SPDLOG_DEBUG(__VA_ARGS__)
-#define LINFO(...) SPDLOG_INFO(__VA_ARGS__)
+#include "BinaryLog.hpp"
+
+/**
+ * Calls below SPDLOG_ACTIVE_LEVEL, which the Dersbiander_LOG_LEVEL CMake option sets, compile to nothing: their
+ * arguments are not even evaluated. While the BinaryLog is enabled, trace, debug and info calls are recorded there
+ * instead of being formatted; warnings and errors always reach the logger.
+ */
+#define DERSBIANDER_DEFERRED(level, log, ...)                                                                                    \
+    do {                                                                                                                         \
+        if(BinaryLog::global().isEnabled()) {                                                                                    \
+            BinaryLog::global().record(level, __VA_ARGS__);                                                                      \
+        } else {                                                                                                                 \
+            log(__VA_ARGS__);                                                                                                    \
+        }                                                                                                                        \
+    } while(false)
+
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
+#define LTRACE(...) DERSBIANDER_DEFERRED(SPDLOG_LEVEL_TRACE, SPDLOG_TRACE, __VA_ARGS__)
+#else
+#define LTRACE(...) (void)0
+#endif
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
+#define LDEBUG(...) DERSBIANDER_DEFERRED(SPDLOG_LEVEL_DEBUG, SPDLOG_DEBUG, __VA_ARGS__)
+#else
+#define LDEBUG(...) (void)0
+#endif
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_INFO
+#define LINFO(...) DERSBIANDER_DEFERRED(SPDLOG_LEVEL_INFO, SPDLOG_INFO, __VA_ARGS__)
+#else
+#define LINFO(...) (void)0
+#endif
 #define LWARN(...) SPDLOG_WARN(__VA_ARGS__)
 #define LERROR(...) SPDLOG_ERROR(__VA_ARGS__)
 #define LCRITICAL(...) SPDLOG_CRITICAL(__VA_ARGS__)
+
+/**
+ * Makes a colored stdout logger the default one, or a stderr one with @p toStderr, for runs whose stdout carries data.
+ * With a @p queueSize it is asynchronous: messages are formatted and written by a background thread, a full queue
+ * blocks the caller, and the queue is flushed at exit.
+ */
+void initLogger(std::size_t queueSize, bool toStderr = false);
 // NOLINTEND
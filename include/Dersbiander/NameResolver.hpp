@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Ast.hpp"
+#include "Diagnostic.hpp"
+#include "SymbolTable.hpp"
+#include "TypeTable.hpp"
+#include <vector>
+
+/**
+ * @brief Binds every identifier of an Ast to its declaration.
+ *
+ * Blocks, functions and for loops open a scope. Functions are hoisted to the top of the block that declares them and
+ * may be overloaded, variables and constants are visible from the statement after their declaration. Member names
+ * (`a.name`) and type names are not resolved, nor are the builtin vector and matrix types called as constructors.
+ * Reports undeclared identifiers, duplicate declarations in the same scope and assignments or `++`/`--` applied to
+ * constants.
+ *
+ * The result of the pass is a binding for every identifier token, declarations included, so later passes never look
+ * a name up again.
+ */
+class NameResolver {
+public:
+    explicit NameResolver(const Ast &tree);
+
+    [[nodiscard]] std::vector<Diagnostic> resolve();
+    [[nodiscard]] inline const SymbolTable &getSymbols() const noexcept { return symbols; }
+    /// The symbol the token at @p token refers to or declares, noSymbol when it is not a resolved name.
+    [[nodiscard]] inline SymbolIndex binding(std::size_t token) const noexcept { return bindings[token]; }
+
+private:
+    const Ast &ast;
+    SymbolTable symbols;
+    std::vector<SymbolIndex> bindings;
+    std::vector<Diagnostic> diagnostics;
+
+    void resolveNode(NodeIndex index);
+    void resolveBlock(NodeIndex index);
+    void resolveDeclaration(NodeIndex index);
+    void resolveAssignment(NodeIndex index);
+    void resolveFor(NodeIndex index);
+    void resolveFunction(NodeIndex index);
+    void resolveExpression(NodeIndex index);
+    void resolveChildren(NodeIndex index);
+    void declare(std::uint32_t token, SymbolKind kind);
+    void checkAssignable(std::uint32_t token);
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "Bytecode.hpp"
+#include "VirtualMachine.hpp"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) && (defined(__linux__) || defined(__unix__))
+#define DERSBIANDER_NATIVE_X86_64
+#endif
+
+/**
+ * @brief Machine code mapped into executable memory.
+ *
+ * The pages are written while mapped read-write and only then switched to read-execute, so they are never writable
+ * and executable at the same time. The entry point takes the register file of a VirtualMachine and returns 0, or 1
+ * after an integer division by zero.
+ */
+class NativeProgram {
+public:
+    NativeProgram() noexcept = default;
+    /// Maps @p machineCode, throws a RuntimeError when the memory cannot be mapped.
+    explicit NativeProgram(std::span<const std::uint8_t> machineCode);
+    NativeProgram(const NativeProgram &other) = delete;
+    NativeProgram(NativeProgram &&other) noexcept;
+    NativeProgram &operator=(const NativeProgram &other) = delete;
+    NativeProgram &operator=(NativeProgram &&other) noexcept;
+    ~NativeProgram();
+
+    [[nodiscard]] inline bool isValid() const noexcept { return memory != nullptr; }
+    int operator()(Value *registers) const;
+
+private:
+    void *memory = nullptr;
+    std::size_t mappedSize = 0;
+
+    void release() noexcept;
+};
+
+/**
+ * @brief Translates a Chunk to x86-64 machine code.
+ *
+ * The generated code works on the VirtualMachine register file in place: every Value keeps its 16 byte layout, so
+ * the interpreter and the native code are interchangeable and the results are read back the same way. The kind of
+ * every register is known at compile time (variables keep the kind of their first assignment, temporaries are
+ * written before they are read within one statement), so no type tag is tested at run time and the tags of the
+ * variables are only written once, when the program ends. Integers live in rax/rcx and doubles in xmm0/xmm1.
+ *
+ * compile() returns false when the chunk has to stay on the interpreter: on other architectures, when a variable
+ * changes kind, or for `^` between integers with a non constant exponent, whose result kind is only known at run time.
+ */
+class NativeCompiler {
+public:
+    explicit NativeCompiler(const Chunk &program) noexcept;
+
+    [[nodiscard]] bool compile();
+    [[nodiscard]] inline const std::vector<std::uint8_t> &getCode() const noexcept { return code; }
+    [[nodiscard]] inline const std::string &getFallbackReason() const noexcept { return fallbackReason; }
+    /// The machine code of every bytecode instruction as hex bytes, one instruction per line.
+    [[nodiscard]] std::string dump() const;
+    [[nodiscard]] NativeProgram load() const;
+
+private:
+    struct Fixup {
+        std::size_t position;
+        std::size_t target;
+    };
+
+    const Chunk &chunk;
+    std::vector<std::uint8_t> code;
+    std::vector<ValueKind> kinds;
+    std::vector<bool> assigned;
+    /// Native offset of every bytecode instruction, plus the epilogue and the error exit.
+    std::vector<std::uint32_t> offsets;
+    std::vector<Fixup> fixups;
+    std::string fallbackReason;
+
+    [[nodiscard]] bool translate(std::size_t index);
+    [[nodiscard]] bool define(std::uint16_t reg, ValueKind kind);
+    [[nodiscard]] bool isConstant(std::uint16_t reg) const noexcept;
+    [[nodiscard]] bool fallback(std::size_t index, std::string_view reason);
+
+    void bytes(std::initializer_list<std::uint8_t> values);
+    void imm32(std::uint32_t value);
+    void imm64(std::uint64_t value);
+    void memory(std::uint8_t reg, std::uint16_t valueRegister);
+    void loadInt(std::uint8_t gpr, std::uint16_t reg);
+    void loadDouble(std::uint8_t xmm, std::uint16_t reg);
+    void storeInt(std::uint16_t reg);
+    void storeDouble(std::uint16_t reg);
+    void truth(std::uint16_t reg);
+    void storeFlag(std::uint8_t setcc, std::uint16_t reg);
+    void jump(std::uint8_t condition, std::size_t target);
+    void call(std::uintptr_t function);
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Ast.hpp"
+#include "Bytecode.hpp"
+#include "Diagnostic.hpp"
+#include "NameResolver.hpp"
+#include <map>
+#include <vector>
+
+/**
+ * @brief Proves that the iterations of every `parallel for` are independent.
+ *
+ * Runs after the NameResolver and looks at how the body uses the names declared outside the loop:
+ * - names only read are shared by all iterations;
+ * - names only changed by `+=`, `-=`, `++` and `--`, or only by `*=`, and never read in the body are reductions: each
+ *   iteration range accumulates its own partial result;
+ * - arrays only accessed at the loop variable, `a[i]`, have one element per iteration;
+ * - anything else written by the body, the loop variable included, is reported as a LOOP_DEPENDENCY, as is a bound
+ *   or step that the body changes or that reads the loop variable.
+ *
+ * Names declared in the body are private to each iteration. Function calls are assumed to have no side effects.
+ */
+class ParallelChecker {
+public:
+    struct Reduction {
+        SymbolIndex symbol;
+        /// ADD or MUL.
+        OpCode op;
+    };
+
+    ParallelChecker(const Ast &tree, const NameResolver &resolver);
+
+    [[nodiscard]] std::vector<Diagnostic> check();
+    /// The reductions of the FOR node @p loop, nullptr when it is not a parallel for that passed the check.
+    [[nodiscard]] const std::vector<Reduction> *reductions(NodeIndex loop) const noexcept;
+    [[nodiscard]] inline std::size_t getLoopCount() const noexcept { return loops.size(); }
+
+private:
+    /// How the body of one loop uses a name declared outside it.
+    struct Access {
+        std::uint32_t token = 0;
+        bool read = false;
+        bool written = false;
+        bool additive = false;
+        bool multiplicative = false;
+        bool indexedRead = false;
+        bool indexedWrite = false;
+    };
+    /// What an operand of the postfix code refers to.
+    enum class PlaceKind : std::uint8_t { VALUE, NAME, ELEMENT, DERIVED };
+    struct Place {
+        PlaceKind kind;
+        SymbolIndex symbol;
+        std::uint32_t token;
+    };
+
+    const Ast &ast;
+    const NameResolver &names;
+    std::map<NodeIndex, std::vector<Reduction>> loops;
+    std::map<SymbolIndex, Access> accesses;
+    std::vector<bool> local;
+    std::vector<Place> places;
+    SymbolIndex variable = noSymbol;
+    std::vector<Diagnostic> diagnostics;
+
+    void checkLoop(NodeIndex index);
+    void collect(NodeIndex index);
+    void collectAssignment(NodeIndex index);
+    /// Records the accesses of the expression @p index except the use of its result, which is returned.
+    [[nodiscard]] Place walk(NodeIndex index);
+    /// Records @p place as read.
+    void consume(const Place &place);
+    /// The symbol a name token refers to, noSymbol for functions and unresolved names.
+    [[nodiscard]] SymbolIndex variableSymbol(std::uint32_t token) const noexcept;
+    Access &access(const Place &place);
+    void dependency(std::uint32_t token, std::string message);
+};
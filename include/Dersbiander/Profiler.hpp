@@ -0,0 +1,130 @@
+#pragma once
+
+#include "AllocationTracker.hpp"
+#include "headers.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Records nested timing zones of every thread and exports them as a Chrome trace.
+ *
+ * A ProfileZone records its name, its nesting depth and its start and end into a buffer of the thread it runs on: only
+ * that thread writes it, without locks, and the buffer is registered with the Profiler the first time the thread
+ * opens a zone. While the Profiler is disabled a zone costs one relaxed load. Zone names are copied once per thread,
+ * so they may be temporaries. summary() and writeChromeTrace() read every buffer: call them once the profiled work is
+ * over, as after ThreadPool::run() returns.
+ */
+class Profiler {
+public:
+    struct Event {
+        std::uint32_t name;
+        std::uint32_t depth;
+        std::uint64_t start;
+        std::uint64_t end;
+    };
+
+    /// The count, total and distribution of the durations of one zone name, in nanoseconds.
+    struct ZoneStats {
+        std::string name;
+        std::size_t count;
+        std::uint64_t total;
+        std::uint64_t min;
+        std::uint64_t max;
+        std::uint64_t p50;
+        std::uint64_t p99;
+    };
+
+    /// The events of one thread, which only that thread writes.
+    struct ThreadBuffer {
+        struct Hash {
+            using is_transparent = void;
+            [[nodiscard]] inline std::size_t operator()(std::string_view text) const noexcept {
+                return std::hash<std::string_view>{}(text);
+            }
+        };
+
+        std::uint32_t thread;
+        std::uint32_t depth = 0;
+        std::vector<Event> events;
+        std::vector<std::string> names;
+        std::unordered_map<const char *, std::uint32_t> nameIds;
+        std::unordered_map<std::string, std::uint32_t, Hash, std::equal_to<>> nameContents;
+
+        [[nodiscard]] std::uint32_t intern(std::string_view name);
+    };
+
+    [[nodiscard]] static Profiler &global() noexcept;
+
+    [[nodiscard]] inline bool isEnabled() const noexcept { return enabled.load(std::memory_order_relaxed); }
+    inline void setEnabled(bool on) noexcept { enabled.store(on, std::memory_order_relaxed); }
+    /// Nanoseconds since the Profiler was created.
+    [[nodiscard]] inline std::uint64_t now() const noexcept {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - epoch).count());
+    }
+    /// The buffer of the calling thread, registered on first use.
+    [[nodiscard]] ThreadBuffer &buffer();
+
+    /// One entry per zone name, the longest total first.
+    [[nodiscard]] std::vector<ZoneStats> summary() const;
+    /// The summary as a table, one zone per line.
+    [[nodiscard]] std::string report() const;
+    /// Writes the zones as complete events of the Chrome trace event format, with the thread of every zone.
+    void writeChromeTrace(std::ostream &out) const;
+    /// Drops every recorded zone: the buffers stay registered.
+    void clear();
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    std::atomic_bool enabled = false;
+    clock::time_point epoch = clock::now();
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> threads;
+};
+
+/**
+ * Records the time between its construction and its destruction as a zone of the global Profiler, when it is enabled.
+ * In builds that track allocations it is also the phase of the AllocationTracker until it is destroyed.
+ */
+class ProfileZone {
+public:
+    explicit ProfileZone(std::string_view name) {
+        if constexpr(allocationTracking) { previousPhase = AllocationTracker::global().enter(name); }
+        if(!Profiler::global().isEnabled()) [[likely]] { return; }
+        buffer = &Profiler::global().buffer();
+        name_ = buffer->intern(name);
+        depth = buffer->depth++;
+        start = Profiler::global().now();
+    }
+    ProfileZone(const ProfileZone &other) = delete;
+    ProfileZone(ProfileZone &&other) = delete;
+    ProfileZone &operator=(const ProfileZone &other) = delete;
+    ProfileZone &operator=(ProfileZone &&other) = delete;
+    ~ProfileZone() {
+        if constexpr(allocationTracking) { AllocationTracker::global().leave(previousPhase); }
+        if(buffer == nullptr) [[likely]] { return; }
+        buffer->events.push_back(Profiler::Event{name_, depth, start, Profiler::global().now()});
+        --buffer->depth;
+    }
+
+private:
+    Profiler::ThreadBuffer *buffer = nullptr;
+    std::uint32_t name_ = 0;
+    std::uint32_t depth = 0;
+    std::uint64_t start = 0;
+    std::uint32_t previousPhase = 0;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+/// Profiles the rest of the enclosing scope as the zone @p name.
+#define PROFILE_ZONE(name) const ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
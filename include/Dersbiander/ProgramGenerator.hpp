@@ -0,0 +1,137 @@
+#pragma once
+
+#include "headers.hpp"
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// Relative weights of the statements a ProgramGenerator writes: 0 leaves a construct out.
+struct GeneratorMix {
+    unsigned declarations = 4;
+    unsigned assignments = 6;
+    /// `for` and `parallel for` loops.
+    unsigned loops = 2;
+    /// `if` and `while` blocks.
+    unsigned conditions = 2;
+    /// Array declarations, element assignments and `.len()`.
+    unsigned arrays = 2;
+    /// Functions defined before `main` and called from it. The bytecode compiler does not support them.
+    unsigned functions = 1;
+    /// String declarations. The bytecode compiler does not support them.
+    unsigned strings = 1;
+    /// Line and block comments.
+    unsigned comments = 1;
+};
+
+struct GeneratorOptions {
+    std::uint64_t seed = 1;
+    /// The program is closed as soon as it is at least this many bytes long.
+    std::uint64_t size = std::uint64_t{1} << 20U;
+    /// Blocks nested in `main` or in a function.
+    std::size_t depth = 3;
+    /// Brackets and operators nested in an expression.
+    std::size_t expressionDepth = 3;
+    /// The share of statements written with one syntax error.
+    double errorRate = 0.0;
+    GeneratorMix mix{};
+};
+
+/**
+ * @brief Writes random valid programs, the same for the same options, that exercise every construct of the language.
+ *
+ * A program is a run of functions followed by `main`: declarations of every type, assignments and compound
+ * assignments, `for`, `parallel for`, `if` and `while` blocks, nested expressions, arrays, calls, strings and comments.
+ * Names are declared before they are used, types match and constant divisors and indices are in range, so a program
+ * without injected errors goes through every checking phase. Loops have short constant bounds and terminate.
+ *
+ * The output is streamed in chunks and only the names in scope are remembered, so the memory used does not grow with
+ * the size. The random numbers come from a fixed xorshift generator rather than the standard distributions, whose
+ * results differ between standard libraries.
+ */
+class ProgramGenerator {
+public:
+    explicit ProgramGenerator(GeneratorOptions generatorOptions) noexcept : options(generatorOptions), state(seedState()) {}
+
+    void generate(std::ostream &out);
+    [[nodiscard]] std::string generate();
+
+    [[nodiscard]] inline std::uint64_t getBytes() const noexcept { return bytes; }
+    [[nodiscard]] inline std::uint64_t getLines() const noexcept { return lines; }
+    /// The statements written with a syntax error: the Validator reports one diagnostic for each of them.
+    [[nodiscard]] inline std::uint64_t getErrors() const noexcept { return errors; }
+
+private:
+    enum class Type : std::uint8_t { INT, DOUBLE, BOOL, ARRAY, STRING };
+
+    struct Variable {
+        std::string name;
+        Type type;
+        /// Elements of an array.
+        std::uint32_t length = 0;
+        /// False for constants and for the counters of loops.
+        bool assignable = true;
+    };
+
+    struct Function {
+        std::string name;
+        std::vector<Type> parameters;
+        Type result;
+    };
+
+    GeneratorOptions options;
+    std::uint64_t state;
+    std::ostream *out = nullptr;
+    std::string buffer;
+    std::uint64_t bytes = 0;
+    std::uint64_t lines = 0;
+    std::uint64_t errors = 0;
+    std::uint64_t names = 0;
+    std::vector<std::vector<Variable>> scopes;
+    /// The last functions defined, the ones main calls.
+    std::vector<Function> functions;
+    /// The first scope of the `parallel for` being written, 0 outside of one: its body only writes the variables of
+    /// its own scopes and the array it fills, which it does not read otherwise.
+    std::size_t parallelScope = 0;
+    std::string filled;
+
+    [[nodiscard]] std::uint64_t seedState() const noexcept;
+    [[nodiscard]] std::uint64_t next() noexcept;
+    [[nodiscard]] std::size_t below(std::size_t bound) noexcept;
+    [[nodiscard]] bool chance(double probability) noexcept;
+
+    void write(std::string_view text);
+    void line(std::size_t depth, std::string_view text);
+    void flush();
+    [[nodiscard]] bool full() const noexcept { return bytes + buffer.size() >= options.size; }
+    [[nodiscard]] std::size_t innerDepth() const noexcept {
+        return options.expressionDepth == 0 ? 0 : options.expressionDepth - 1;
+    }
+
+    [[nodiscard]] std::string newName();
+    [[nodiscard]] const Variable *pick(Type type, bool assignable) noexcept;
+    [[nodiscard]] bool hasRoom() const noexcept;
+    void declare(Variable variable);
+
+    void function();
+    void block(std::size_t depth, std::string_view header, std::vector<Variable> locals = {});
+    void statement(std::size_t depth);
+    void declaration(std::size_t depth);
+    void assignment(std::size_t depth);
+    void arrayStatement(std::size_t depth);
+    void loop(std::size_t depth);
+    void condition(std::size_t depth);
+    void callStatement(std::size_t depth);
+    void stringStatement(std::size_t depth);
+    void comment(std::size_t depth);
+    void error(std::size_t depth);
+
+    [[nodiscard]] std::string expression(Type type, std::size_t depth);
+    [[nodiscard]] std::string intExpression(std::size_t depth);
+    [[nodiscard]] std::string doubleExpression(std::size_t depth);
+    [[nodiscard]] std::string boolExpression(std::size_t depth);
+    [[nodiscard]] std::string call(Type result, std::size_t depth);
+    [[nodiscard]] std::string words(std::size_t count);
+    [[nodiscard]] static std::string_view typeName(Type type) noexcept;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "InstructionType.hpp"
+#include "Token.hpp"
+#include "headers.hpp"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The numbers of one run, written as a single JSON object for monitoring.
+ *
+ * The counts are read from the Tokenizer, the BracketIndex and the Validator, which fill them while they run: nothing
+ * walks the tokens again. Every TokenType and InstructionType is written, zeros included, so the keys of the object do
+ * not depend on the input.
+ */
+struct RunStats {
+    struct Phase {
+        std::string name;
+        std::uint64_t nanoseconds;
+    };
+
+    std::size_t inputBytes = 0;
+    std::size_t lines = 0;
+    std::array<std::size_t, tokenTypeCount> tokens{};
+    std::array<std::size_t, instructionTypeCount> instructions{};
+    std::size_t maxDepth = 0;
+    std::vector<Phase> phases;
+
+    /// Records the time from @p start to now as the phase @p name.
+    void record(std::string name, std::chrono::steady_clock::time_point start) {
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        phases.push_back(Phase{std::move(name), static_cast<std::uint64_t>(elapsed.count())});
+    }
+
+    /// One line, with the throughput of every phase in MB/s of input.
+    [[nodiscard]] std::string to_json() const;
+};
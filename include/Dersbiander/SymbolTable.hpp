@@ -0,0 +1,91 @@
+#pragma once
+
+#include "headers.hpp"
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+enum class SymbolKind : std::uint8_t { VARIABLE, CONSTANT, FUNCTION, PARAMETER };
+
+template <> struct fmt::formatter<SymbolKind> : fmt::formatter<std::string_view> {  // NOLINT(*-include-cleaner)
+    template <typename FormatContext> auto format(SymbolKind kind, FormatContext &ctx) {
+        std::string_view name;
+        switch(kind) {
+            using enum SymbolKind;
+        case VARIABLE:
+            name = "VARIABLE";
+            break;
+        case CONSTANT:
+            name = "CONSTANT";
+            break;
+        case FUNCTION:
+            name = "FUNCTION";
+            break;
+        case PARAMETER:
+            name = "PARAMETER";
+            break;
+        default:
+            name = "UNKNOWN";
+            break;
+        }
+        return fmt::formatter<std::string_view>::format(name, ctx);
+    }
+};
+
+using SymbolIndex = std::uint32_t;
+static inline constexpr SymbolIndex noSymbol = std::numeric_limits<SymbolIndex>::max();
+
+struct Symbol {
+    SymbolKind kind;
+    /// Index of the declaring token.
+    std::uint32_t token;
+    /// Scope depth of the declaration, 0 is the outermost scope.
+    std::uint32_t depth;
+};
+
+/**
+ * @brief Scope stack over a single open-addressing hash table.
+ *
+ * Every name has one slot holding its innermost visible symbol. Declaring a name that is already visible records the
+ * shadowed symbol in an undo log, and closing a scope replays the log back to the mark taken when it was opened, so
+ * leaving a scope costs one table lookup per declaration it made and nothing is ever copied. Names are views into the
+ * token values, which must outlive the table.
+ */
+class SymbolTable {
+public:
+    explicit SymbolTable(std::size_t expectedNames = 0);
+
+    void openScope();
+    void closeScope() noexcept;
+    /**
+     * @brief Declares @p name in the current scope.
+     * @return noSymbol on success, otherwise the symbol that already declares the name in this scope (nothing is
+     * declared in that case).
+     */
+    SymbolIndex declare(std::string_view name, SymbolKind kind, std::uint32_t token);
+    /// The innermost visible symbol named @p name, or noSymbol.
+    [[nodiscard]] SymbolIndex lookup(std::string_view name) const noexcept;
+
+    [[nodiscard]] inline const Symbol &symbol(SymbolIndex index) const noexcept { return symbols[index]; }
+    [[nodiscard]] inline std::size_t depth() const noexcept { return scopes.size(); }
+    [[nodiscard]] inline std::size_t symbolCount() const noexcept { return symbols.size(); }
+
+private:
+    struct Slot {
+        std::string_view name;
+        SymbolIndex symbol = noSymbol;
+    };
+    struct Undo {
+        std::string_view name;
+        SymbolIndex previous;
+    };
+
+    std::vector<Slot> slots;
+    std::size_t used = 0;
+    std::vector<Symbol> symbols;
+    std::vector<Undo> undo;
+    std::vector<std::size_t> scopes;
+
+    [[nodiscard]] std::size_t findSlot(std::string_view name) const noexcept;
+    void grow();
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "headers.hpp"
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief A fixed set of worker threads running batches of indexed tasks with work stealing.
+ *
+ * run() splits the task indices in contiguous ranges, one per queue: every worker and the calling thread own a queue,
+ * take their own tasks from the back and, once it is empty, steal from the front of the others, so a range that turns
+ * out slower than the rest is finished by whoever is idle. A task that calls run() again runs the nested batch inline
+ * on its own thread. The first exception thrown by a task is rethrown by run() once the whole batch is over.
+ */
+class ThreadPool {
+public:
+    /// @p threads workers besides the calling thread, by default one less than the hardware threads.
+    explicit ThreadPool(std::size_t threads = defaultThreads());
+    ThreadPool(const ThreadPool &other) = delete;
+    ThreadPool(ThreadPool &&other) = delete;
+    ThreadPool &operator=(const ThreadPool &other) = delete;
+    ThreadPool &operator=(ThreadPool &&other) = delete;
+    ~ThreadPool();
+
+    /// Calls @p task with every index in [0, @p tasks) and returns when all calls are over.
+    void run(std::size_t tasks, const std::function<void(std::size_t)> &task);
+    /// Threads running a batch, the caller included.
+    [[nodiscard]] inline std::size_t size() const noexcept { return queues.size(); }
+    /// The pool shared by the virtual machines of the process, created on first use.
+    [[nodiscard]] static ThreadPool &shared();
+    [[nodiscard]] static std::size_t defaultThreads() noexcept;
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::size_t> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex batchMutex;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    const std::function<void(std::size_t)> *job = nullptr;
+    std::size_t generation = 0;
+    std::size_t remaining = 0;
+    std::exception_ptr error;
+    bool stopping = false;
+
+    void work(std::size_t self);
+    /// Runs tasks from the queue @p self, then stolen ones, until every queue is empty.
+    void drain(std::size_t self);
+    [[nodiscard]] bool take(std::size_t self, std::size_t &task);
+};
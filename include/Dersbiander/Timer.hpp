@@ -1,5 +1,6 @@
 #pragma once
 #include "Log.hpp"
+#include "Profiler.hpp"
 #include "disableWarn.hpp"
 #include "format.hpp"
 #include "headers.hpp"
@@ -139,11 +140,14 @@ public:
     }
 };
 
-/// This class prints out the time upon destruction
+/// This class prints out the time upon destruction, and is a zone of the Profiler while it is enabled
 class AutoTimer : public Timer {
+    ProfileZone zone_;
+
 public:
     /// Reimplementing the constructor is required in GCC 4.7
-    explicit AutoTimer(const std::string &title = "Timer", const time_print_t &time_print = Simple) : Timer(title, time_print) {}
+    explicit AutoTimer(const std::string &title = "Timer", const time_print_t &time_print = Simple)
+      : Timer(title, time_print), zone_(title_) {}
 
     // GCC 4.7 does not support using inheriting constructors.
     AutoTimer(const AutoTimer &other) = delete;              // Delete copy constructor
@@ -152,7 +156,7 @@ public:
     AutoTimer &operator=(const AutoTimer &&other) = delete;  // Delete move assignment operator
 
     /// This destructor prints the string
-    ~AutoTimer() { LINFO(to_string()); }
+    ~AutoTimer() { LINFO("{}", to_string()); }
 };
 
 template <> struct fmt::formatter<Timer> : formatter<std::string_view> { // NOLINT(*-include-cleaner)
@@ -31,6 +31,7 @@ enum class TokenType : int {
     KEYWORD_VAR,
     KEYWORD_STRUCTURE,
     KEYWORD_FOR,
+    KEYWORD_PARALLEL,
     KEYWORD_FUNC,
     KEYWORD_RETURN,
     COMMENT,
@@ -126,6 +127,9 @@ template <> struct fmt::formatter<TokenType> : fmt::formatter<std::string_view>
         case KEYWORD_FOR:
             name = "KEYWORD_FOR";
             break;
+        case KEYWORD_PARALLEL:
+            name = "KEYWORD_PARALLEL";
+            break;
         case KEYWORD_FUNC:
             name = "KEYWORD_FUNC";
             break;
@@ -152,6 +156,8 @@ template <> struct fmt::formatter<TokenType> : fmt::formatter<std::string_view>
 };
 
 static inline constexpr TokenType eofTokenType = TokenType::EOFT;
+/// Entries of a table indexed by TokenType.
+static inline constexpr std::size_t tokenTypeCount = static_cast<std::size_t>(TokenType::UNKNOWN) + 1;
 
 class Token {
 public:
@@ -160,7 +166,7 @@ public:
       : _type(type), _value(value), _line(line), _column(column) {}
 
     [[nodiscard]] inline TokenType getType() const noexcept { return _type; }
-    [[nodiscard]] inline std::string getValue() const noexcept { return _value; }
+    [[nodiscard]] inline const std::string &getValue() const noexcept { return _value; }
     [[nodiscard]] inline std::size_t getLine() const noexcept { return _line; }
     [[nodiscard]] inline std::size_t getColumn() const noexcept { return _column; }
     [[nodiscard]] std::string to_string() const;  // NOLINT(*-include-cleaner)
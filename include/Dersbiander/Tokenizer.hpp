@@ -4,6 +4,7 @@
 #include "Token.hpp"
 #include "TokenizerUtils.hpp"
 #include "headers.hpp"
+#include <array>
 #include <string>
 #include <vector>
 
@@ -21,6 +22,12 @@ public:
     std::vector<Token> tokenize();
 
     void handleError(const std::string &values, const std::string &errorMsg);
+    /// When off, an unknown character becomes an UNKNOWN token and nothing is logged, for callers that handle errors.
+    inline void setExitOnError(bool exit) noexcept { exitOnError = exit; }
+    /// Tokens of every type made by the last tokenize() call, indexed by TokenType.
+    [[nodiscard]] inline const std::array<std::size_t, tokenTypeCount> &getTypeCounts() const noexcept { return typeCounts; }
+    /// The line tokenize() stopped on: the number of lines of the input.
+    [[nodiscard]] inline std::size_t getLineCount() const noexcept { return line; }
 
 private:
     std::string_view _input;
@@ -28,6 +35,8 @@ private:
     std::size_t position = 0;
     std::size_t line = 1;
     std::size_t column = 1;
+    bool exitOnError = true;
+    std::array<std::size_t, tokenTypeCount> typeCounts{};
 
     inline void appendCharToValue(std::string &value);
     [[nodiscard]] bool isPositionInText() const noexcept;
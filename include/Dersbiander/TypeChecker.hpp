@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Ast.hpp"
+#include "ConstantFolder.hpp"
+#include "Diagnostic.hpp"
+#include "NameResolver.hpp"
+#include "TypeTable.hpp"
+#include <vector>
+
+/**
+ * @brief Infers the type of every expression and checks declarations, assignments, conditions and returns.
+ *
+ * Runs after the NameResolver and reads its bindings, so it needs no scopes of its own. Expression types are inferred
+ * bottom-up in one pass over the postfix code with a type stack. Rules:
+ * - bool < char < int < double are scalars; arithmetic promotes to the widest operand and at least to int;
+ * - `+` with a string operand concatenates and yields a string;
+ * - comparisons and logical operators yield bool, indexing needs an integral index;
+ * - arithmetic, comparisons and `-` apply to every element of an array, paired with the element of an array of the
+ *   same length or with a scalar, and yield an array of the results, see elementwise();
+ * - vec2, vec3, vec4, mat2, mat3 and mat4 are built by calling them; vectors combine component by component with
+ *   vectors of their type and numbers, matrices multiply matrices, vectors and numbers, see wideArithmetic();
+ *   vectors, and only vectors, have swizzle members such as `v.x` or `v.zyx`, with the letters of xyzw, rgba or stpq;
+ * - user types (`type`), other member accesses and calls of overloaded functions are opaque and accept everything.
+ *
+ * Array dimensions are fixed when they are integer literals or, with a ConstantFolder set, constant expressions. The
+ * variable, the bound and the step of a `parallel for` are integral.
+ */
+class TypeChecker {
+public:
+    TypeChecker(const Ast &tree, const NameResolver &resolver);
+
+    [[nodiscard]] std::vector<Diagnostic> check();
+    inline void setFolder(const ConstantFolder *constantFolder) noexcept { folder = constantFolder; }
+    /// Type of an EXPRESSION node, unknownType for other nodes.
+    [[nodiscard]] inline TypeId typeOf(NodeIndex index) const noexcept { return nodeTypes[index]; }
+    [[nodiscard]] inline TypeId symbolType(SymbolIndex symbol) const noexcept { return symbolTypes[symbol]; }
+    [[nodiscard]] inline const TypeTable &getTypes() const noexcept { return types; }
+    /// Declared return types of @p function, empty when it declares none or is overloaded.
+    [[nodiscard]] std::span<const TypeId> returnTypes(SymbolIndex function) const noexcept;
+
+private:
+    struct Signature {
+        std::vector<TypeId> parameters;
+        std::vector<TypeId> returns;
+        bool overloaded;
+    };
+    struct Value {
+        TypeId type;
+        SymbolIndex function;
+        /// The vector or matrix type a name that only resolves to a builtin type builds when called.
+        TypeId constructs = TypeTable::unknownType;
+    };
+    static inline constexpr std::uint32_t noSignature = std::numeric_limits<std::uint32_t>::max();
+
+    const Ast &ast;
+    const NameResolver &names;
+    const ConstantFolder *folder = nullptr;
+    TypeTable types;
+    std::vector<TypeId> nodeTypes;
+    std::vector<TypeId> symbolTypes;
+    std::vector<std::uint32_t> signatureOf;
+    std::vector<Signature> signatures;
+    std::vector<Value> stack;
+    const Signature *currentFunction = nullptr;
+    std::vector<Diagnostic> diagnostics;
+
+    void declareFunctions();
+    void checkNode(NodeIndex index);
+    void checkDeclaration(NodeIndex index);
+    void checkAssignment(NodeIndex index);
+    /// Checks a condition and returns its type, unknownType when it is missing.
+    [[nodiscard]] TypeId checkCondition(NodeIndex index);
+    void checkParallelFor(NodeIndex index, TypeId bound, TypeId step);
+    void checkFunction(NodeIndex index);
+    void checkReturn(NodeIndex index);
+    void checkChildren(NodeIndex index);
+    [[nodiscard]] TypeId typeOfTypeNode(NodeIndex index);
+    [[nodiscard]] TypeId inferExpression(NodeIndex index);
+    [[nodiscard]] TypeId binary(std::uint32_t token, TypeId left, TypeId right);
+    [[nodiscard]] TypeId elementwise(std::uint32_t token, TypeId left, TypeId right);
+    [[nodiscard]] TypeId wideArithmetic(char symbol, TypeId left, TypeId right) const noexcept;
+    [[nodiscard]] TypeId unary(std::uint32_t token, TypeId operand);
+    [[nodiscard]] TypeId member(std::uint32_t token, TypeId base);
+    [[nodiscard]] TypeId indexType(std::uint32_t token, TypeId base, TypeId position);
+    [[nodiscard]] TypeId call(std::uint32_t token, std::span<const Value> values);
+    [[nodiscard]] TypeId construct(std::uint32_t token, TypeId type, std::span<const Value> arguments);
+    void typeAsValue(std::uint32_t token, TypeId type);
+    [[nodiscard]] TypeId arrayLiteral(std::span<const Value> values);
+    [[nodiscard]] bool isAssignable(TypeId target, TypeId value) const noexcept;
+    void expectAssignable(std::uint32_t token, TypeId target, TypeId value);
+    void mismatch(std::uint32_t token, std::string message);
+};
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "headers.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+enum class TypeKind : std::uint8_t { UNKNOWN, BOOL, CHAR, INT, DOUBLE, STRING, NAMED, ARRAY, VECTOR, MATRIX };
+
+template <> struct fmt::formatter<TypeKind> : fmt::formatter<std::string_view> {  // NOLINT(*-include-cleaner)
+    template <typename FormatContext> auto format(TypeKind kind, FormatContext &ctx) {
+        std::string_view name;
+        switch(kind) {
+            using enum TypeKind;
+        case UNKNOWN:
+            name = "UNKNOWN";
+            break;
+        case BOOL:
+            name = "BOOL";
+            break;
+        case CHAR:
+            name = "CHAR";
+            break;
+        case INT:
+            name = "INT";
+            break;
+        case DOUBLE:
+            name = "DOUBLE";
+            break;
+        case STRING:
+            name = "STRING";
+            break;
+        case NAMED:
+            name = "NAMED";
+            break;
+        case ARRAY:
+            name = "ARRAY";
+            break;
+        case VECTOR:
+            name = "VECTOR";
+            break;
+        case MATRIX:
+            name = "MATRIX";
+            break;
+        default:
+            name = "UNKNOWN";
+            break;
+        }
+        return fmt::formatter<std::string_view>::format(name, ctx);
+    }
+};
+
+using TypeId = std::uint32_t;
+
+/**
+ * @brief One interned type.
+ *
+ * NAMED types are user types nobody declares yet, so they are opaque. An ARRAY has an element type and a length,
+ * dynamicLength when the dimension is empty or not constant. The builtin VECTOR types vec2, vec3 and vec4 have their
+ * size as length and double as element, the type of one component; the square MATRIX types mat2, mat3 and mat4 have
+ * the vector of their size as element, the type of one column.
+ */
+struct TypeDescriptor {
+    TypeKind kind;
+    TypeId element;
+    std::uint32_t length;
+    std::string_view name;
+
+    [[nodiscard]] bool operator==(const TypeDescriptor &other) const noexcept = default;
+};
+
+/**
+ * @brief Hash-consing table of type descriptors.
+ *
+ * Structurally equal descriptors are stored once, so two types are equal exactly when their TypeId is. The builtin
+ * types are interned first and have fixed ids.
+ */
+class TypeTable {
+public:
+    static inline constexpr TypeId unknownType = 0;
+    static inline constexpr TypeId boolType = 1;
+    static inline constexpr TypeId charType = 2;
+    static inline constexpr TypeId intType = 3;
+    static inline constexpr TypeId doubleType = 4;
+    static inline constexpr TypeId stringType = 5;
+    static inline constexpr TypeId vec2Type = 6;
+    static inline constexpr TypeId vec4Type = 8;
+    static inline constexpr TypeId mat2Type = 9;
+    static inline constexpr TypeId mat4Type = 11;
+    static inline constexpr std::uint32_t dynamicLength = std::numeric_limits<std::uint32_t>::max();
+
+    TypeTable();
+
+    /// The builtin type called @p name, or the opaque NAMED type.
+    [[nodiscard]] TypeId named(std::string_view name);
+    [[nodiscard]] TypeId array(TypeId element, std::uint32_t length);
+    [[nodiscard]] inline const TypeDescriptor &get(TypeId type) const noexcept { return types[type]; }
+    [[nodiscard]] inline std::size_t size() const noexcept { return types.size(); }
+    [[nodiscard]] std::string to_string(TypeId type) const;
+
+    /// Types the checker cannot reason about: unknown, opaque and arrays of them accept everything.
+    [[nodiscard]] bool isOpaque(TypeId type) const noexcept;
+    [[nodiscard]] static inline bool isScalar(TypeId type) noexcept { return type >= boolType && type <= doubleType; }
+    /// Vectors and matrices.
+    [[nodiscard]] static inline bool isWide(TypeId type) noexcept { return type >= vec2Type && type <= mat4Type; }
+    /// The vector or matrix type called @p name, unknownType for any other name.
+    [[nodiscard]] static TypeId wideType(std::string_view name) noexcept;
+
+private:
+    struct DescriptorHash {
+        [[nodiscard]] std::size_t operator()(const TypeDescriptor &descriptor) const noexcept;
+    };
+
+    std::vector<TypeDescriptor> types;
+    std::unordered_map<TypeDescriptor, TypeId, DescriptorHash> ids;
+
+    [[nodiscard]] TypeId intern(const TypeDescriptor &descriptor);
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Instruction.hpp"
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Memoizes the Instruction state machine per line of tokens.
+ *
+ * The state machine only looks at token types, so two lines with the same type sequence always end in the same state
+ * and fail at the same offset. Entries are keyed by a hash of the type sequence and keep the sequence itself, so a hash
+ * collision is a miss and never a wrong answer.
+ *
+ * Most lines are whole statements: their entry keeps no Instruction, since the next line starts a fresh one. The cache
+ * holds at most maxEntries shapes and starts over when it is full, so varied input cannot grow it without bound.
+ */
+class ValidationCache {
+public:
+    static inline constexpr std::size_t noError = std::numeric_limits<std::size_t>::max();
+    static inline constexpr std::size_t maxEntries = 4096;
+
+    struct Entry {
+        std::vector<TokenType> types;
+        /// The Instruction after the last token of the line, or after the rejected token; empty when the line ends the
+        /// statement.
+        std::optional<Instruction> state;
+        /// The kind of the statement the line starts.
+        InstructionType statementType;
+        /// Offset of the rejected token from the start of the line, noError when the whole line was accepted.
+        std::size_t errorOffset;
+        /// Offset of the last token that is not a comment.
+        std::size_t lastOffset;
+    };
+
+    /// Returns the entry of @p line and counts a hit, or nullptr and counts a miss.
+    [[nodiscard]] const Entry *find(std::uint64_t key, std::span<const Token> line) noexcept;
+    const Entry &insert(std::uint64_t key, std::span<const Token> line, Instruction &&state, std::size_t errorOffset,
+                        std::size_t lastOffset);
+
+    [[nodiscard]] static std::uint64_t hash(std::span<const Token> line) noexcept;
+    [[nodiscard]] inline std::size_t getHits() const noexcept { return hits; }
+    [[nodiscard]] inline std::size_t getMisses() const noexcept { return misses; }
+    [[nodiscard]] inline std::size_t size() const noexcept { return entries.size(); }
+
+private:
+    std::unordered_map<std::uint64_t, Entry> entries;
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "AstBuilder.hpp"
+#include "BracketIndex.hpp"
+#include "Diagnostic.hpp"
+#include "Instruction.hpp"
+#include "Log.hpp"
+#include "ValidationCache.hpp"
+#include <array>
+#include <vector>
+
+/**
+ * @brief Drives the Instruction state machine over a whole token stream.
+ *
+ * Tokens are split into statements the same way the command line tool always did: a token on a new line starts a new
+ * Instruction when the previous one can terminate. When a token is rejected the validator records a Diagnostic, skips
+ * to the next statement boundary (panic mode) and starts again from a fresh Instruction, so a single run reports every
+ * error of the file instead of only the first one.
+ *
+ * When an AstBuilder is attached, every statement that validated is handed to it as soon as it is complete, so the
+ * tree is built in the same pass. Statement first lines are memoized in a ValidationCache, see checkLine().
+ */
+class Validator {
+public:
+    explicit Validator(const std::vector<Token> &tokenList);
+
+    [[nodiscard]] std::vector<Diagnostic> validate();
+    [[nodiscard]] inline std::size_t getInstructionCount() const noexcept { return instructionCount; }
+    /// Statements of every kind, indexed by InstructionType: the kind is the one after the first line of a statement.
+    [[nodiscard]] inline const std::array<std::size_t, instructionTypeCount> &getInstructionTypeCounts() const noexcept {
+        return instructionTypeCounts;
+    }
+    inline void setAstBuilder(AstBuilder *astBuilder) noexcept { builder = astBuilder; }
+    [[nodiscard]] inline const ValidationCache &getCache() const noexcept { return cache; }
+    [[nodiscard]] inline const BracketIndex &getBrackets() const noexcept { return brackets; }
+
+private:
+    const std::vector<Token> &tokens;
+    std::size_t instructionCount = 0;
+    std::array<std::size_t, instructionTypeCount> instructionTypeCounts{};
+    BracketIndex brackets;
+    AstBuilder *builder = nullptr;
+    ValidationCache cache;
+
+    [[nodiscard]] std::size_t findLineEnd(std::size_t first) const noexcept;
+    [[nodiscard]] const ValidationCache::Entry &checkLine(std::size_t first, std::size_t last);
+    [[nodiscard]] std::size_t recover(std::size_t statementStart, std::size_t errorIndex) const noexcept;
+    [[nodiscard]] static bool isStatementKeyword(TokenType type) noexcept;
+};
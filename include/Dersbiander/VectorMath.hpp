@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Bytecode.hpp"
+
+/**
+ * @brief Vector and matrix operations of the VirtualMachine, computed with glm's SIMD types.
+ *
+ * Operands are loaded from their Lanes as a 4 component vector or a 4x4 matrix of floats and the result is stored in
+ * the Lanes @p out of the destination register, with the lanes it does not use zeroed: a mat3 times a vec3 is the
+ * 4x4 product of the zero padded operands. Every operand is loaded before anything is stored, so @p out may hold one
+ * of them. A scalar operand is converted to float. Operands the TypeChecker rejects throw a RuntimeError.
+ */
+
+/**
+ * @brief ADD, SUB, MUL, DIV or NEG with a vector or a matrix operand.
+ *
+ * Vectors combine component by component, also with a scalar on either side. Matrices add and subtract element by
+ * element, multiply as matrices, with a vector on either side and with a scalar, and divide by a scalar.
+ */
+[[nodiscard]] Value wideArithmetic(OpCode op, const Value &left, const Value &right, Lanes &out);
+/// The value built by VECTOR with @p shape from the registers @p arguments.
+[[nodiscard]] Value buildWide(VectorShape shape, const Value *arguments, Lanes &out);
+/// The components of the vector @p source picked by the swizzlePattern() @p pattern, a double when it picks one.
+[[nodiscard]] Value swizzle(const Value &source, std::uint16_t pattern, Lanes &out);
+/// The value a parallel reduction of @p variable starts from: zero for ADD, the identity matrix for MUL.
+[[nodiscard]] Value wideIdentity(OpCode op, const Value &variable, Lanes &out);
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Bytecode.hpp"
+#include "Errors.hpp"
+#include <span>
+#include <vector>
+
+class NativeProgram;
+class ThreadPool;
+
+/// What registers point to, one entry per register: the Lanes of vectors and matrices and the elements of arrays.
+struct RegisterStorage {
+    Lanes *lanes = nullptr;
+    Array *arrays = nullptr;
+};
+
+/**
+ * @brief Interpreter of a Chunk.
+ *
+ * On GCC and Clang the dispatch is a computed goto: every handler jumps straight to the next one through a table of
+ * label addresses, which gives the branch predictor one indirect jump per opcode instead of one shared switch. Other
+ * compilers get the same handlers in a switch. Integer operations stay in 64 bit integers, mixing in a double
+ * promotes to double. Integer division by zero throws a RuntimeError. Vectors and matrices are computed by the
+ * functions of VectorMath.hpp into the Lanes of the destination register, arrays by the ones of ArrayMath.hpp into
+ * its Array; MOVE copies both. Indices out of bounds throw a RuntimeError.
+ *
+ * PARALLEL_FOR splits the iterations of its loop in contiguous ranges, a few per thread of the ThreadPool so
+ * that idle threads have something to steal, and runs each range on its own copy of the registers. Integer reductions
+ * give the same result as the sequential loop; double ones may differ in the last bits, since the partial results are
+ * grouped differently. Arrays are shared by every range, which only write distinct elements, while the arrays a range
+ * computes go to Arrays of its own.
+ */
+class VirtualMachine {
+public:
+    explicit VirtualMachine(const Chunk &program);
+
+    void run();
+    /// Runs machine code produced by the NativeCompiler for the same chunk on the register file.
+    void run(const NativeProgram &program);
+    /// The value of @p reg; a vector, matrix or array points to storage of the machine, valid until it runs again.
+    [[nodiscard]] inline const Value &get(std::uint16_t reg) const noexcept { return registers[reg]; }
+    [[nodiscard]] inline std::span<const Value> getRegisters() const noexcept { return registers; }
+    /// The pool running parallel loops, ThreadPool::shared() when none is set.
+    inline void setPool(ThreadPool *threadPool) noexcept { pool = threadPool; }
+    /// The `^` operator, also called by native code.
+    [[nodiscard]] static Value power(const Value &left, const Value &right) noexcept;
+    /**
+     * @brief The result of one arithmetic, logical or comparison instruction, exactly as run() computes it.
+     *
+     * NEG and NOT only read @p left. Throws a RuntimeError on integer division by zero, for opcodes that do not
+     * compute a value and for operations on vectors, matrices or arrays, whose result needs the storage of a register.
+     */
+    [[nodiscard]] static Value evaluate(OpCode op, const Value &left, const Value &right = Value{});
+
+private:
+    const Chunk &chunk;
+    std::vector<Value> registers;
+    /// The Lanes of every register, only for chunks with vectors.
+    std::vector<Lanes> lanes;
+    /// The Array of every register, only for chunks with arrays.
+    std::vector<Array> arrays;
+    ThreadPool *pool = nullptr;
+
+    void prepare();
+    /// Interprets the code from @p entry up to the next HALT on the register file @p reg and its @p storage.
+    void execute(Value *reg, RegisterStorage storage, std::size_t entry) const;
+    void parallelFor(const ParallelLoop &loop, Value *reg, RegisterStorage storage) const;
+};
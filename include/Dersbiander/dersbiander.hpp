@@ -6,6 +6,39 @@
 #include "Timer.hpp"
 #include "macros.hpp"
 #include "not_null.hpp"
+#include "AllocationTracker.hpp"
+#include "ArrayMath.hpp"
+#include "Ast.hpp"
+#include "AstBuilder.hpp"
+#include "Benchmark.hpp"
+#include "BinaryLog.hpp"
+#include "BracketIndex.hpp"
+#include "Bytecode.hpp"
+#include "BytecodeCompiler.hpp"
+#include "CBuildCache.hpp"
+#include "CTranspiler.hpp"
+#include "ConstantFolder.hpp"
+#include "Errors.hpp"
+#include "ExpressionParser.hpp"
+#include "Instrument.hpp"
 #include "Instruction.hpp"
+#include "Ir.hpp"
+#include "IrBuilder.hpp"
+#include "IrCompiler.hpp"
+#include "IrPasses.hpp"
+#include "NameResolver.hpp"
+#include "NativeCompiler.hpp"
+#include "ParallelChecker.hpp"
+#include "Profiler.hpp"
+#include "ProgramGenerator.hpp"
+#include "RunStats.hpp"
+#include "SymbolTable.hpp"
+#include "ThreadPool.hpp"
 #include "Tokenizer.hpp"
+#include "TypeChecker.hpp"
+#include "TypeTable.hpp"
+#include "ValidationCache.hpp"
+#include "Validator.hpp"
+#include "VectorMath.hpp"
+#include "VirtualMachine.hpp"
 // clang-format on
@@ -6,7 +6,6 @@
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #define GLM_FORCE_WIN32
 #define GLM_FORCE_SIZE_T_LENGTH
-#define GLM_FORCE_PURE
 #define GLM_FORCE_EXPLICIT_CTOR
 #define GLM_FORCE_CXX20
 #define GLM_FORCE_UNRESTRICTED_GENTYPE
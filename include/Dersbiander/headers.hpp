@@ -33,6 +33,7 @@ DISABLE_WARNINGS_PUSH(
 #include <cassert>
 #include <chrono>
 #include <cmath>
+#include <compare>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
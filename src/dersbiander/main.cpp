@@ -1,5 +1,6 @@
 ﻿#include "Dersbiander/dersbiander.hpp"
 #include "FileReadError.h"
+#include <functional>
 #include <string>
 namespace fs = std::filesystem;
 
@@ -17,15 +18,9 @@ DISABLE_WARNINGS_POP()
 #include <internal_use_only/config.hpp>
 
 DISABLE_WARNINGS_PUSH(26461 26821)
-// NOLINTNEXTLINE
-static void timeTokenizer(Tokenizer &tokenizer, std::vector<Token> &tokens) {
-    tokens.clear();
-    AutoTimer timer("tokenizer.tokenize()");
-    tokens = tokenizer.tokenize();
-}
-
 static std::string readFromFile(const std::string &filename) {
-    AutoTimer timer("readFromFile");
+    PROFILE_ZONE("readFromFile");
+    INSTRUMENT_TIMER(IO, "io.readFromFile");
     fs::path filePath = filename;
 
     if(!fs::exists(filePath)) { throw FileReadError(FORMAT("File not found: {}", filename)); }
@@ -49,9 +44,30 @@ static std::string readFromFile(const std::string &filename) {
     }
 
     // Extract the content as a string
-    return buffer.str();
+    std::string content = buffer.str();
+    INSTRUMENT_COUNT(IO, "io.bytes read", content.size());
+    return content;
 }
 
+/// Runs its action when the scope that owns it ends, whichever way it does.
+class OnExit {
+public:
+    explicit OnExit(std::function<void()> action) noexcept : action_(std::move(action)) {}
+    OnExit(const OnExit &other) = delete;
+    OnExit &operator=(const OnExit &other) = delete;
+    OnExit(OnExit &&other) = delete;
+    OnExit &operator=(OnExit &&other) = delete;
+    /// A destructor may not throw: a failing action is logged, and the other ones still run.
+    ~OnExit() {
+        try {
+            action_();
+        } catch(const std::exception &e) { LERROR("Exit action failed: {}", e.what()); }
+    }
+
+private:
+    std::function<void()> action_;
+};
+
 #ifdef _WIN32  // Windows
 constexpr std::string_view filename = "../../../input.txt";
 #elif defined __unix__  // Linux and Unix-like systems
@@ -60,34 +76,94 @@ constexpr std::string_view filename = "input.txt";  // Linux and Unix
 
 // NOLINTNEXTLINE(bugprone-exception-escape, readability-function-cognitive-complexity)
 int main(int argc, const char **argv) {
-    spdlog::set_pattern(R"(%^[%T] [%l] %v%$)");
-    const auto console = spdlog::stdout_color_mt(R"(console)");
-    spdlog::set_default_logger(console);
-
-    std::string lines = readFromFile(filename.data());
-    std::size_t line{};
     try {
         CLI::App app{FORMAT("{} version {}", Dersbiander::cmake::project_name, Dersbiander::cmake::project_version)};
 
         bool show_version = false;
         bool run_code_from_console = false;
+        bool dump_ast = false;
+        bool dump_bytecode = false;
+        bool dump_native = false;
+        bool interpret = false;
+        bool run_c = false;
+        bool dump_c = false;
+        bool ssa = false;
+        bool dump_ir = false;
+        bool dump_tokens = false;
+        bool print_stats = false;
+        std::size_t log_queue = 8192;
+        std::string binary_trace;
+        std::string read_trace;
+        std::string profile;
         //[[maybe_unused]] bool time_error = false;
-        std::optional<std::string> input;
-        app.add_option("-i,--input", input, "A message to print back out");
+        std::string input{filename};
+        app.add_option("-i,--input", input, "The program to run");
         app.add_flag("--version", show_version, "Show version information");
-        app.add_flag("--jit", run_code_from_console, "Run code from the console");
+        app.add_flag("--jit", run_code_from_console, "Compile the program to native code, or bytecode, and run it");
+        app.add_flag("--ast", dump_ast, "Print the syntax tree of the input");
+        app.add_flag("--bytecode", dump_bytecode, "Print the bytecode of the input, implies --jit");
+        app.add_flag("--native-dump", dump_native, "Print the x86-64 code generated for the input, implies --jit");
+        app.add_flag("--interpret", interpret, "Run the bytecode on the interpreter even when native code is available");
+        app.add_flag("--cc", run_c, "Transpile the program to C, compile it with cc -O2 and run it");
+        app.add_flag("--c-source", dump_c, "Print the C translation of the input");
+        app.add_flag("--ssa", ssa,
+                     "Optimize the program in SSA form before running it, implies --jit. Only covers scalar programs: arrays, "
+                     "strings, vectors, matrices and functions are rejected");
+        app.add_flag("--ir", dump_ir, "Print the optimized SSA form of the input, implies --ssa and its limits");
+        app.add_flag("--tokens", dump_tokens, "Print every token of the input");
+        app.add_flag("--stats", print_stats,
+                     "Print the counts and the timings of the run as one JSON object, alone on stdout: the log goes to stderr");
+        app.add_option("--log-queue", log_queue, "Messages the asynchronous logger can queue, 0 to log synchronously");
+        app.add_option("--binary-trace", binary_trace, "Record the trace, debug and info messages to this file unformatted");
+        app.add_option("--read-trace", read_trace, "Print the messages recorded by --binary-trace to this file and exit");
+        app.add_option("--profile", profile, "Time every phase and write the zones to this file as a Chrome trace");
 
         CLI11_PARSE(app, argc, argv)
+        initLogger(log_queue, print_stats);
+        if(!read_trace.empty()) {
+            std::ifstream in(read_trace, std::ios::in | std::ios::binary);
+            if(!in.is_open()) { throw FileReadError(FORMAT("Unable to open file: {}", read_trace)); }
+            for(const std::string &line : BinaryLog::read(in)) { fmt::print("{}\n", line); }
+            return EXIT_SUCCESS;
+        }
+        // The reports are made when main returns, whichever way it does, in the reverse order of these declarations.
+        BinaryLog::global().setEnabled(!binary_trace.empty());
+        const OnExit traceWriter([&binary_trace] {
+            if(binary_trace.empty()) { return; }
+            BinaryLog::global().setEnabled(false);
+            std::ofstream out(binary_trace, std::ios::out | std::ios::binary);
+            BinaryLog::global().write(out);
+            LINFO("{} log records written to {}", BinaryLog::global().size(), binary_trace);
+        });
+        Profiler::global().setEnabled(!profile.empty());
+        const OnExit profileWriter([&profile] {
+            if(profile.empty()) { return; }
+            Profiler::global().setEnabled(false);
+            std::ofstream out(profile, std::ios::out | std::ios::binary);
+            Profiler::global().writeChromeTrace(out);
+            LINFO("Profile written to {}:{}{}", profile, CNL, Profiler::global().report());
+        });
+        const OnExit allocationReport([] {
+            if constexpr(allocationTracking) { LINFO("Allocations:{}{}", CNL, AllocationTracker::global().report()); }
+        });
+        const OnExit instrumentationReport([] {
+            if constexpr(instrumentationEnabled) { LINFO("Instrumentation:{}{}", CNL, Instrumentation::global().report()); }
+        });
         if(show_version) {
             LINFO("{} version {}", Dersbiander::cmake::project_name, Dersbiander::cmake::project_version);
             return EXIT_SUCCESS;
         }
+        // The JSON line is the only output on stdout: with --stats the logger writes to stderr.
+        RunStats stats;
+        const OnExit statsWriter([&stats, print_stats] {
+            if(print_stats) { fmt::print("{}\n", stats.to_json()); }
+        });
 
-        if(run_code_from_console) [[unlikely]] {
-            // if(input.has_value()) {
-            // } else {
-            // }
-        } else [[likely]] {
+        auto phaseStart = std::chrono::steady_clock::now();
+        const std::string lines = readFromFile(input);
+        stats.record("read", phaseStart);
+        stats.inputBytes = lines.size();
+        {
             // for(const std::string &str : lines) {
             /* if(str.size() < 93) {
                     LINFO("code'{}',code length {}",str, str.length());
@@ -96,39 +172,168 @@ int main(int argc, const char **argv) {
                     LINFO("code length {}", str.length());
                 }*/
             Tokenizer tokenizer(lines);
-            std::vector<Token> tokens{};
-            timeTokenizer(tokenizer, tokens);
-            std::vector<Instruction> instructions{};
+            phaseStart = std::chrono::steady_clock::now();
+            const std::vector<Token> tokens = tokenizer.tokenize();
+            stats.record("tokenize", phaseStart);
+            stats.lines = tokenizer.getLineCount();
+            stats.tokens = tokenizer.getTypeCounts();
             // Instruction instruction(tokens);
             if(tokens.empty()) [[unlikely]] {
                 LINFO("Empty tokens");
                 return 0;
             }
-            for(const Token &token : tokens) {
+            if(dump_tokens) {
+                for(const Token &token : tokens) {
 #ifdef ONLY_TOKEN_TYPE
-                LINFO("Token {}", token.type);
+                    LINFO("Token {}", token.type);
 #else
-                LINFO("{}", token);
+                    LINFO("{}", token);
 #endif  // ONLY_TOKEN_TYPE
+                }
+            }
+            PROFILE_ZONE("front end");
+            Ast ast(tokens);
+            AstBuilder astBuilder(ast);
+            phaseStart = std::chrono::steady_clock::now();
+            Validator validator(tokens);
+            stats.record("brackets", phaseStart);
+            stats.maxDepth = validator.getBrackets().getMaxDepth();
+            validator.setAstBuilder(&astBuilder);
+            // Unbalanced brackets are known before the state machine runs: report them first.
+            const std::vector<Diagnostic> &bracketDiagnostics = validator.getBrackets().getDiagnostics();
+            for(const Diagnostic &diagnostic : bracketDiagnostics) { LERROR("{}", diagnostic); }
+            phaseStart = std::chrono::steady_clock::now();
+            const std::vector<Diagnostic> diagnostics = validator.validate();
+            stats.record("validate", phaseStart);
+            stats.instructions = validator.getInstructionTypeCounts();
+            LINFO("validation cache: {} hits, {} misses", validator.getCache().getHits(), validator.getCache().getMisses());
+            if(dump_ast) { LINFO("Syntax tree:{}{}", CNL, ast); }
+            for(const Diagnostic &diagnostic : diagnostics) { LERROR("{}", diagnostic); }
+            if(!diagnostics.empty() || !bracketDiagnostics.empty()) [[unlikely]] {
+                LERROR("{} errors in {} instructions", diagnostics.size() + bracketDiagnostics.size(),
+                       validator.getInstructionCount());
+                return EXIT_FAILURE;
             }
-            instructions.reserve(tokens.size());
-            AutoTimer tim("tokenizer total time");
-            line = tokens.at(0).getLine();
-            for(const Token &token : tokens) {
-                if(token.getType() == TokenType::COMMENT) [[unlikely]] { continue; }
-                if(token.getLine() >= line) [[likely]] {
-                    if(instructions.empty() || instructions.back().canTerminate()) [[likely]] {
-                        instructions.emplace_back();
-                    } else if(instructions.back().typeToString().back() != "EXPRESSION" && token.getType() != TokenType::STRING)
-                        [[unlikely]] {
-                        LINFO("Unexpected token: ENDL");
-                        break;
+            NameResolver resolver(ast);
+            phaseStart = std::chrono::steady_clock::now();
+            const std::vector<Diagnostic> nameDiagnostics = resolver.resolve();
+            stats.record("resolve", phaseStart);
+            for(const Diagnostic &diagnostic : nameDiagnostics) { LERROR("{}", diagnostic); }
+            if(!nameDiagnostics.empty()) [[unlikely]] {
+                LERROR("{} name errors in {} declarations", nameDiagnostics.size(), resolver.getSymbols().symbolCount());
+                return EXIT_FAILURE;
+            }
+            ConstantFolder folder(ast, resolver);
+            phaseStart = std::chrono::steady_clock::now();
+            const std::vector<Diagnostic> constantDiagnostics = folder.fold();
+            stats.record("fold", phaseStart);
+            for(const Diagnostic &diagnostic : constantDiagnostics) { LERROR("{}", diagnostic); }
+            if(!constantDiagnostics.empty()) [[unlikely]] {
+                LERROR("{} errors in constant expressions", constantDiagnostics.size());
+                return EXIT_FAILURE;
+            }
+            LINFO("{} operations folded at compile time", folder.getFoldedCount());
+            TypeChecker typeChecker(ast, resolver);
+            typeChecker.setFolder(&folder);
+            phaseStart = std::chrono::steady_clock::now();
+            const std::vector<Diagnostic> typeDiagnostics = typeChecker.check();
+            stats.record("typecheck", phaseStart);
+            for(const Diagnostic &diagnostic : typeDiagnostics) { LERROR("{}", diagnostic); }
+            if(!typeDiagnostics.empty()) [[unlikely]] {
+                LERROR("{} type errors", typeDiagnostics.size());
+                return EXIT_FAILURE;
+            }
+            ParallelChecker parallelChecker(ast, resolver);
+            const std::vector<Diagnostic> parallelDiagnostics = parallelChecker.check();
+            for(const Diagnostic &diagnostic : parallelDiagnostics) { LERROR("{}", diagnostic); }
+            if(!parallelDiagnostics.empty()) [[unlikely]] {
+                LERROR("{} dependencies between the iterations of parallel loops", parallelDiagnostics.size());
+                return EXIT_FAILURE;
+            }
+            const bool optimize = ssa || dump_ir;
+            if(run_code_from_console || dump_bytecode || dump_native || interpret || optimize) {
+                BytecodeCompiler compiler(ast, resolver, typeChecker);
+                compiler.setFolder(&folder);
+                compiler.setParallel(&parallelChecker);
+                IrBuilder irBuilder(ast, resolver, typeChecker);
+                irBuilder.setFolder(&folder);
+                IrCompiler irCompiler(ast, resolver, irBuilder.getFunction());
+                phaseStart = std::chrono::steady_clock::now();
+                const std::vector<Diagnostic> compileDiagnostics = optimize ? irBuilder.build() : compiler.compile();
+                for(const Diagnostic &diagnostic : compileDiagnostics) { LERROR("{}", diagnostic); }
+                if(!compileDiagnostics.empty()) [[unlikely]] {
+                    LERROR("{} constructs the {} does not support", compileDiagnostics.size(),
+                           optimize ? "SSA builder" : "bytecode compiler");
+                    if(optimize) { LERROR("--ssa only covers scalar programs, run without it to use the bytecode compiler"); }
+                    return EXIT_FAILURE;
+                }
+                if(optimize) {
+                    const std::size_t before = irBuilder.getFunction().instructionCount();
+                    IrPassManager passes = IrPassManager::standard();
+                    passes.run(irBuilder.getFunction());
+                    LINFO("SSA passes, {} instructions left of {}:{}{}", irBuilder.getFunction().instructionCount(), before, CNL,
+                          passes.report());
+                    if(dump_ir) { LINFO("SSA form:{}{}", CNL, irBuilder.getFunction().to_string(typeChecker.getTypes())); }
+                    const std::vector<Diagnostic> lowerDiagnostics = irCompiler.compile();
+                    for(const Diagnostic &diagnostic : lowerDiagnostics) { LERROR("{}", diagnostic); }
+                    if(!lowerDiagnostics.empty()) [[unlikely]] { return EXIT_FAILURE; }
+                }
+                const Chunk &chunk = optimize ? irCompiler.getChunk() : compiler.getChunk();
+                if(dump_bytecode) { LINFO("Bytecode:{}{}", CNL, chunk.disassemble()); }
+                VirtualMachine machine(chunk);
+                NativeCompiler nativeCompiler(chunk);
+                const bool native = !interpret && nativeCompiler.compile();
+                stats.record("compile", phaseStart);
+                if(native) [[likely]] {
+                    if(dump_native) { LINFO("Native code:{}{}", CNL, nativeCompiler.dump()); }
+                    const NativeProgram program = nativeCompiler.load();
+                    phaseStart = std::chrono::steady_clock::now();
+                    PROFILE_ZONE("run native code");
+                    machine.run(program);
+                    stats.record("run", phaseStart);
+                } else {
+                    if(!interpret) { LINFO("Running on the interpreter: {}", nativeCompiler.getFallbackReason()); }
+                    phaseStart = std::chrono::steady_clock::now();
+                    PROFILE_ZONE("run bytecode");
+                    machine.run();
+                    stats.record("run", phaseStart);
+                }
+                for(const auto &[name, reg] : chunk.variables) { LINFO("{} = {}", name, machine.get(reg)); }
+            }
+            if(run_c || dump_c) {
+                CTranspiler transpiler(ast, resolver, typeChecker);
+                phaseStart = std::chrono::steady_clock::now();
+                const std::vector<Diagnostic> transpileDiagnostics = transpiler.transpile();
+                stats.record("transpile", phaseStart);
+                for(const Diagnostic &diagnostic : transpileDiagnostics) { LERROR("{}", diagnostic); }
+                if(!transpileDiagnostics.empty()) [[unlikely]] {
+                    LERROR("{} constructs the C transpiler does not support", transpileDiagnostics.size());
+                    return EXIT_FAILURE;
+                }
+                if(dump_c) { LINFO("C source:{}{}", CNL, transpiler.getSource()); }
+                if(run_c) {
+                    CBuildCache cache;
+                    SharedLibrary library;
+                    phaseStart = std::chrono::steady_clock::now();
+                    {
+                        PROFILE_ZONE("load C object");
+                        library = cache.load(transpiler.getSource());
+                    }
+                    stats.record("compile C", phaseStart);
+                    LINFO("{} {}", cache.lastWasHit() ? "Loaded cached" : "Compiled", cache.objectPath(transpiler.getSource()));
+                    std::vector<Value> registers(transpiler.getRegisterCount());
+                    phaseStart = std::chrono::steady_clock::now();
+                    {
+                        PROFILE_ZONE("run C object");
+                        const int result = library(registers.data());
+                        if(result == CTranspiler::divisionByZero) [[unlikely]] { throw RuntimeError("Integer division by zero"); }
+                        if(result == CTranspiler::indexOutOfBounds) [[unlikely]] {
+                            throw RuntimeError("Array index out of bounds");
+                        }
                     }
-                    line = token.getLine() + 1;
+                    stats.record("run C", phaseStart);
+                    for(const auto &[name, reg] : transpiler.getVariables()) { LINFO("{} = {}", name, registers[reg]); }
                 }
-                const auto &[verify, token_s] = instructions.back().checkToken(token);
-                LINFO("{} {}", verify, token_s);
-                if(!verify) [[unlikely]] { break; }
             }
             //}
         }
@@ -0,0 +1,154 @@
+#include "Dersbiander/AllocationTracker.hpp"
+#include <cstdlib>
+#include <limits>
+#include <new>
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+namespace {
+    /// Keeps the block after the header aligned as malloc() aligns it.
+    constexpr std::size_t headerSize = alignof(std::max_align_t);
+    /// A larger request would wrap around once the header is added to it.
+    constexpr std::size_t maxSize = std::numeric_limits<std::size_t>::max() - headerSize;
+
+    struct Header {
+        std::uint64_t size;
+        std::uint32_t phase;
+    };
+    static_assert(sizeof(Header) <= headerSize);
+
+    thread_local std::uint32_t currentPhase = 0;
+
+    void raise(std::atomic_uint64_t &peak, std::uint64_t value) noexcept {
+        std::uint64_t seen = peak.load(std::memory_order_relaxed);
+        while(seen < value && !peak.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {}
+    }
+}  // namespace
+
+AllocationTracker::AllocationTracker() noexcept {
+    constexpr std::string_view none = "(none)";
+    std::ranges::copy(none, phases[0].name.begin());
+    phaseCount.store(1, std::memory_order_release);
+}
+
+AllocationTracker &AllocationTracker::global() noexcept {
+    static AllocationTracker tracker;
+    return tracker;
+}
+
+std::uint32_t AllocationTracker::find(std::string_view name) const noexcept {
+    const std::uint32_t count = phaseCount.load(std::memory_order_acquire);
+    for(std::uint32_t phase = 0; phase < count; ++phase) {
+        if(std::string_view{phases[phase].name.data()} == name) { return phase; }
+    }
+    return count;
+}
+
+/// A full table sends the new phases to the last one.
+std::uint32_t AllocationTracker::enter(std::string_view name) noexcept {
+    const std::uint32_t previous = currentPhase;
+    name = name.substr(0, maxNameLength);
+    std::uint32_t phase = find(name);
+    if(phase == phaseCount.load(std::memory_order_acquire)) [[unlikely]] {
+        const std::scoped_lock lock(mutex);
+        phase = find(name);
+        if(phase == maxPhases) {
+            phase = maxPhases - 1;
+        } else if(phase == phaseCount.load(std::memory_order_relaxed)) {
+            std::ranges::copy(name, phases[phase].name.begin());
+            phaseCount.store(phase + 1, std::memory_order_release);
+        }
+    }
+    currentPhase = phase;
+    return previous;
+}
+
+void AllocationTracker::leave(std::uint32_t previous) noexcept { currentPhase = previous; }
+
+void *AllocationTracker::allocate(std::size_t size) noexcept {
+    if(size > maxSize) [[unlikely]] { return nullptr; }
+    auto *base = static_cast<std::byte *>(std::malloc(size + headerSize));  // NOLINT(*-no-malloc, *-owning-memory)
+    if(base == nullptr) [[unlikely]] { return nullptr; }
+    const std::uint32_t phase = currentPhase;
+    *reinterpret_cast<Header *>(base) = Header{size, phase};  // NOLINT(*-reinterpret-cast)
+    Phase &counts = phases[phase];
+    counts.allocations.fetch_add(1, std::memory_order_relaxed);
+    counts.bytes.fetch_add(size, std::memory_order_relaxed);
+    raise(counts.peak, counts.live.fetch_add(size, std::memory_order_relaxed) + size);
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    raise(peak, live.fetch_add(size, std::memory_order_relaxed) + size);
+    return base + headerSize;  // NOLINT(*-pointer-arithmetic)
+}
+
+void AllocationTracker::deallocate(void *pointer) noexcept {
+    if(pointer == nullptr) { return; }
+    std::byte *base = static_cast<std::byte *>(pointer) - headerSize;  // NOLINT(*-pointer-arithmetic)
+    const Header header = *reinterpret_cast<const Header *>(base);     // NOLINT(*-reinterpret-cast)
+    Phase &counts = phases[header.phase];
+    counts.deallocations.fetch_add(1, std::memory_order_relaxed);
+    counts.live.fetch_sub(header.size, std::memory_order_relaxed);
+    live.fetch_sub(header.size, std::memory_order_relaxed);
+    std::free(base);  // NOLINT(*-no-malloc, *-owning-memory)
+}
+
+std::vector<AllocationTracker::PhaseStats> AllocationTracker::summary() const {
+    const std::uint32_t count = phaseCount.load(std::memory_order_acquire);
+    std::vector<PhaseStats> stats;
+    stats.reserve(count);
+    for(std::uint32_t phase = 0; phase < count; ++phase) {
+        const Phase &counts = phases[phase];
+        if(counts.allocations.load(std::memory_order_relaxed) == 0) { continue; }
+        stats.push_back(PhaseStats{std::string{counts.name.data()}, counts.allocations.load(std::memory_order_relaxed),
+                                   counts.deallocations.load(std::memory_order_relaxed),
+                                   counts.bytes.load(std::memory_order_relaxed), counts.live.load(std::memory_order_relaxed),
+                                   counts.peak.load(std::memory_order_relaxed)});
+    }
+    std::ranges::sort(stats, std::greater{}, &PhaseStats::allocations);
+    return stats;
+}
+
+std::string AllocationTracker::report() const {
+    std::string out = FORMAT("{:<32} {:>12} {:>12} {:>14} {:>12} {:>12}", "phase", "allocations", "frees", "bytes", "live",
+                             "peak");
+    for(const PhaseStats &phase : summary()) {
+        out.append(FORMAT("{}{:<32} {:>12} {:>12} {:>14} {:>12} {:>12}", CNL, phase.name, phase.allocations,
+                          phase.deallocations, phase.bytes, phase.live, phase.peak));
+    }
+    out.append(FORMAT("{}{} allocations, {} bytes live, {} bytes at the peak", CNL, allocations.load(std::memory_order_relaxed),
+                      live.load(std::memory_order_relaxed), peak.load(std::memory_order_relaxed)));
+    return out;
+}
+
+void AllocationTracker::clear() noexcept {
+    for(Phase &counts : phases) {
+        counts.allocations.store(0, std::memory_order_relaxed);
+        counts.deallocations.store(0, std::memory_order_relaxed);
+        counts.bytes.store(0, std::memory_order_relaxed);
+        counts.peak.store(counts.live.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    allocations.store(0, std::memory_order_relaxed);
+    peak.store(live.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+DISABLE_WARNINGS_POP()
+
+#ifdef DERSBIANDER_TRACK_ALLOCATIONS
+// The array and the nothrow forms of the standard library call these. The aligned forms keep their own allocator: they
+// are not counted.
+void *operator new(std::size_t size) {
+    // No handler can free enough memory for a size the header makes wrap around.
+    if(size > maxSize) [[unlikely]] { throw std::bad_alloc(); }
+    while(true) {
+        if(void *pointer = AllocationTracker::global().allocate(size); pointer != nullptr) [[likely]] { return pointer; }
+        const std::new_handler handler = std::get_new_handler();
+        if(handler == nullptr) { throw std::bad_alloc(); }
+        handler();
+    }
+}
+void *operator new(std::size_t size, const std::nothrow_t & /*tag*/) noexcept {
+    return AllocationTracker::global().allocate(size);
+}
+void operator delete(void *pointer) noexcept { AllocationTracker::global().deallocate(pointer); }
+void operator delete(void *pointer, std::size_t /*size*/) noexcept { AllocationTracker::global().deallocate(pointer); }
+void operator delete(void *pointer, const std::nothrow_t & /*tag*/) noexcept { AllocationTracker::global().deallocate(pointer); }
+#endif
@@ -0,0 +1,370 @@
+#include "Dersbiander/ArrayMath.hpp"
+#include "Dersbiander/VirtualMachine.hpp"
+#include <algorithm>
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+namespace {
+    // Integer arithmetic wraps around like the scalar instructions.
+    [[nodiscard]] inline std::int64_t wrap(std::uint64_t value) noexcept { return static_cast<std::int64_t>(value); }
+    [[nodiscard]] inline std::uint64_t bits(std::int64_t value) noexcept { return static_cast<std::uint64_t>(value); }
+
+    [[nodiscard]] std::string_view elementName(ValueKind kind) noexcept {
+        switch(kind) {
+        case ValueKind::BOOL:
+            return "bool";
+        case ValueKind::DOUBLE:
+            return "double";
+        default:
+            return "int";
+        }
+    }
+
+    [[noreturn]] void outOfBounds(std::int64_t position, std::size_t size) {
+        throw RuntimeError(FORMAT("index {} out of bounds of an array of {} elements", position, size));
+    }
+
+    [[nodiscard]] Array &arrayOf(const Value &value) {
+        if(value.kind != ValueKind::ARRAY) [[unlikely]] { throw RuntimeError(FORMAT("indexing {}", value)); }
+        return *value.array;
+    }
+
+    [[nodiscard]] std::size_t checkedPosition(const Array &array, const Value &position) {
+        if(position.kind > ValueKind::INT) [[unlikely]] { throw RuntimeError(FORMAT("index {} is not an integer", position)); }
+        const std::int64_t value = position.asInt();
+        if(value < 0 || bits(value) >= array.size()) [[unlikely]] { outOfBounds(value, array.size()); }
+        return C_ST(value);
+    }
+
+    /// The ARRAY value a tagged array keeps for its nested array @p position.
+    [[nodiscard]] Value nestedAt(std::size_t position) noexcept {
+        Value value;
+        value.kind = ValueKind::ARRAY;
+        value.integer = static_cast<std::int64_t>(position);
+        return value;
+    }
+
+    /// The element @p position of @p array, a nested array pointed to where it is instead of copied.
+    [[nodiscard]] Value view(Array &array, std::size_t position) {
+        if(!array.isTagged()) { return element(array, position, array); }
+        const Value value = array.values[position];
+        return value.kind == ValueKind::ARRAY ? Value::fromArray(array.nested[C_ST(value.integer)]) : value;
+    }
+
+    /// Sets the element kind of @p out and empties the buffers it does not use.
+    Value settle(Array &out, ValueKind element) noexcept {
+        out.element = element;
+        if(element == ValueKind::DOUBLE) {
+            out.integers.clear();
+        } else {
+            out.reals.clear();
+        }
+        out.values.clear();
+        out.nested.clear();
+        return Value::fromArray(out);
+    }
+
+    /// An unboxed operand: the elements of an array, or a scalar paired with every element.
+    template <typename T> struct Operand {
+        const T *data;
+        bool scalar;
+    };
+
+    /**
+     * @brief One pass of @p operation over @p count elements.
+     *
+     * A scalar operand is hoisted out of the loop, so every loop reads contiguous elements and nothing else: the
+     * compiler vectorizes it. @p out may be the elements of an operand, each one is read before it is written.
+     */
+    template <typename T, typename R, typename Operation>
+    void apply(Operand<T> left, Operand<T> right, R *out, std::size_t count, Operation operation) noexcept {
+        // NOLINTBEGIN(*-pro-bounds-pointer-arithmetic)
+        if(left.scalar) {
+            const T value = *left.data;
+            for(std::size_t i = 0; i < count; ++i) { out[i] = operation(value, right.data[i]); }
+        } else if(right.scalar) {
+            const T value = *right.data;
+            for(std::size_t i = 0; i < count; ++i) { out[i] = operation(left.data[i], value); }
+        } else {
+            for(std::size_t i = 0; i < count; ++i) { out[i] = operation(left.data[i], right.data[i]); }
+        }
+        // NOLINTEND(*-pro-bounds-pointer-arithmetic)
+    }
+
+    [[nodiscard]] constexpr bool isComparison(OpCode op) noexcept { return op >= OpCode::EQ && op <= OpCode::GE; }
+
+    /// The comparisons as one operation on two elements that gives 0 or 1, the element of a bool array.
+    template <typename T, typename R> void compareAll(OpCode op, Operand<T> left, Operand<T> right, R *out, std::size_t count) {
+        const auto flag = [](bool value) { return static_cast<R>(value); };
+        switch(op) {
+            using enum OpCode;
+        case EQ:
+            apply(left, right, out, count, [flag](T a, T b) { return flag(a == b); });
+            break;
+        case NE:
+            apply(left, right, out, count, [flag](T a, T b) { return flag(a != b); });
+            break;
+        case LT:
+            apply(left, right, out, count, [flag](T a, T b) { return flag(a < b); });
+            break;
+        case LE:
+            apply(left, right, out, count, [flag](T a, T b) { return flag(a <= b); });
+            break;
+        case GT:
+            apply(left, right, out, count, [flag](T a, T b) { return flag(a > b); });
+            break;
+        default:
+            apply(left, right, out, count, [flag](T a, T b) { return flag(a >= b); });
+            break;
+        }
+    }
+
+    Value integerKernel(OpCode op, Operand<std::int64_t> left, Operand<std::int64_t> right, std::size_t count, Array &out) {
+        std::int64_t *const result = out.integers.data();
+        switch(op) {
+            using enum OpCode;
+        case ADD:
+            apply(left, right, result, count, [](std::int64_t a, std::int64_t b) { return wrap(bits(a) + bits(b)); });
+            break;
+        case SUB:
+            apply(left, right, result, count, [](std::int64_t a, std::int64_t b) { return wrap(bits(a) - bits(b)); });
+            break;
+        case MUL:
+            apply(left, right, result, count, [](std::int64_t a, std::int64_t b) { return wrap(bits(a) * bits(b)); });
+            break;
+        case DIV: {
+            // NOLINTNEXTLINE(*-pro-bounds-pointer-arithmetic)
+            const std::int64_t *end = right.data + count;
+            const bool zero = right.scalar ? *right.data == 0 : std::find(right.data, end, 0) != end;
+            if(zero) [[unlikely]] { throw RuntimeError("Integer division by zero"); }
+            apply(left, right, result, count, [](std::int64_t a, std::int64_t b) { return b == -1 ? wrap(0 - bits(a)) : a / b; });
+            break;
+        }
+        case NEG:
+            apply(left, right, result, count, [](std::int64_t a, std::int64_t) { return wrap(0 - bits(a)); });
+            break;
+        default:
+            compareAll(op, left, right, result, count);
+            return settle(out, ValueKind::BOOL);
+        }
+        return settle(out, ValueKind::INT);
+    }
+
+    Value realKernel(OpCode op, Operand<double> left, Operand<double> right, std::size_t count, Array &out) {
+        if(isComparison(op)) {
+            compareAll(op, left, right, out.integers.data(), count);
+            return settle(out, ValueKind::BOOL);
+        }
+        double *const result = out.reals.data();
+        switch(op) {
+            using enum OpCode;
+        case ADD:
+            apply(left, right, result, count, [](double a, double b) { return a + b; });
+            break;
+        case SUB:
+            apply(left, right, result, count, [](double a, double b) { return a - b; });
+            break;
+        case MUL:
+            apply(left, right, result, count, [](double a, double b) { return a * b; });
+            break;
+        case DIV:
+            apply(left, right, result, count, [](double a, double b) { return a / b; });
+            break;
+        default:
+            apply(left, right, result, count, [](double a, double) { return -a; });
+            break;
+        }
+        return settle(out, ValueKind::DOUBLE);
+    }
+
+    /**
+     * @brief An operation between unboxed arrays and scalars.
+     *
+     * Integers and bools compute as integers, anything mixed with a double as doubles: an integer array is converted
+     * once, before the pass. The result buffer only grows when it is not the one of an operand.
+     */
+    Value unboxed(OpCode op, const Value &left, const Value &right, std::size_t count, Array &out) {
+        const ValueKind leftKind = left.kind == ValueKind::ARRAY ? left.array->element : left.kind;
+        const ValueKind rightKind = right.kind == ValueKind::ARRAY ? right.array->element : right.kind;
+        if(leftKind <= ValueKind::INT && rightKind <= ValueKind::INT) {
+            const std::int64_t leftScalar = left.asInt();
+            const std::int64_t rightScalar = right.asInt();
+            out.integers.resize(count);
+            const Operand<std::int64_t> first{left.kind == ValueKind::ARRAY ? left.array->integers.data() : &leftScalar,
+                                              left.kind != ValueKind::ARRAY};
+            const Operand<std::int64_t> second{right.kind == ValueKind::ARRAY ? right.array->integers.data() : &rightScalar,
+                                               right.kind != ValueKind::ARRAY};
+            return integerKernel(op, first, second, count, out);
+        }
+        const auto reals = [count](const Value &value, std::vector<double> &converted, double &scalar) {
+            if(value.kind != ValueKind::ARRAY) {
+                scalar = value.asDouble();
+                return Operand<double>{&scalar, true};
+            }
+            if(value.array->element == ValueKind::DOUBLE) { return Operand<double>{value.array->reals.data(), false}; }
+            converted.assign(value.array->integers.begin(), value.array->integers.begin() + C_PTRDIFT(count));
+            return Operand<double>{converted.data(), false};
+        };
+        std::vector<double> leftConverted;
+        std::vector<double> rightConverted;
+        double leftScalar = 0.0;
+        double rightScalar = 0.0;
+        const Operand<double> first = reals(left, leftConverted, leftScalar);
+        const Operand<double> second = reals(right, rightConverted, rightScalar);
+        if(isComparison(op)) {
+            out.integers.resize(count);
+        } else {
+            out.reals.resize(count);
+        }
+        return realKernel(op, first, second, count, out);
+    }
+
+    /// Tagged arrays and `^`, whose integer results may be doubles, compute element by element.
+    Value boxed(OpCode op, const Value &left, const Value &right, std::size_t count, Array &out) {
+        std::vector<Value> results(count);
+        std::vector<Array> parts;
+        parts.reserve(count);
+        for(std::size_t i = 0; i < count; ++i) {
+            const Value first = left.kind == ValueKind::ARRAY ? view(*left.array, i) : left;
+            const Value second = right.kind == ValueKind::ARRAY ? view(*right.array, i) : right;
+            if(first.kind == ValueKind::ARRAY || second.kind == ValueKind::ARRAY) {
+                results[i] = arrayArithmetic(op, first, second, parts.emplace_back());
+            } else {
+                results[i] = VirtualMachine::evaluate(op, first, second);
+            }
+        }
+        return buildArray(results.data(), count, out);
+    }
+}  // namespace
+
+Value buildArray(const Value *elements, std::size_t count, Array &out) {
+    const std::span<const Value> values(elements, count);
+    Array result;
+    if(std::ranges::all_of(values, [](const Value &value) { return value.isScalar(); })) {
+        result.element = values.empty() ? ValueKind::INT : std::ranges::max(values, {}, &Value::kind).kind;
+        if(result.element == ValueKind::DOUBLE) {
+            result.reals.reserve(count);
+            for(const Value &value : values) { result.reals.push_back(value.asDouble()); }
+        } else {
+            result.integers.reserve(count);
+            for(const Value &value : values) { result.integers.push_back(value.asInt()); }
+        }
+    } else {
+        result.element = ValueKind::ARRAY;
+        result.values.reserve(count);
+        for(const Value &value : values) {
+            if(value.isWide()) [[unlikely]] { throw RuntimeError(FORMAT("an array cannot hold {}", value)); }
+            if(value.kind == ValueKind::ARRAY) {
+                result.nested.push_back(*value.array);
+                result.values.push_back(nestedAt(result.nested.size() - 1));
+            } else {
+                result.values.push_back(value);
+            }
+        }
+    }
+    out = std::move(result);
+    return Value::fromArray(out);
+}
+
+Value fillArray(const Value &length, const Value &element, Array &out) {
+    if(length.kind > ValueKind::INT || length.asInt() < 0) [[unlikely]] {
+        throw RuntimeError(FORMAT("array of {} elements", length));
+    }
+    const auto count = C_ST(length.asInt());
+    Array result;
+    if(element.isScalar()) {
+        result.element = element.kind;
+        if(element.kind == ValueKind::DOUBLE) {
+            result.reals.assign(count, element.real);
+        } else {
+            result.integers.assign(count, element.asInt());
+        }
+    } else if(element.kind == ValueKind::ARRAY) {
+        result.element = ValueKind::ARRAY;
+        result.nested.assign(count, *element.array);
+        result.values.reserve(count);
+        for(std::size_t i = 0; i < count; ++i) { result.values.push_back(nestedAt(i)); }
+    } else [[unlikely]] {
+        throw RuntimeError(FORMAT("an array cannot hold {}", element));
+    }
+    out = std::move(result);
+    return Value::fromArray(out);
+}
+
+Value arrayArithmetic(OpCode op, const Value &left, const Value &right, Array &out) {
+    const bool arithmetic = op >= OpCode::ADD && op <= OpCode::NEG && op != OpCode::POW;
+    if((!arithmetic && op != OpCode::POW && !isComparison(op)) || left.isWide() || right.isWide()) [[unlikely]] {
+        throw RuntimeError(FORMAT("{} on {} and {}", op, left, right));
+    }
+    const bool leftArray = left.kind == ValueKind::ARRAY;
+    const bool rightArray = right.kind == ValueKind::ARRAY;
+    if(leftArray && rightArray && left.array->size() != right.array->size()) [[unlikely]] {
+        throw RuntimeError(FORMAT("{} on arrays of {} and {} elements", op, left.array->size(), right.array->size()));
+    }
+    const std::size_t count = leftArray ? left.array->size() : right.array->size();
+    const bool tagged = (leftArray && left.array->isTagged()) || (rightArray && right.array->isTagged());
+    if(tagged || op == OpCode::POW) { return boxed(op, left, right, count, out); }
+    return unboxed(op, left, right, count, out);
+}
+
+Value taggedElement(Array &array, std::size_t position, Array &out) {
+    const Value value = array.values[position];
+    if(value.kind != ValueKind::ARRAY) { return value; }
+    // Copied before it is assigned: @p out may be @p array itself.
+    Array copy = array.nested[C_ST(value.integer)];
+    out = std::move(copy);
+    return Value::fromArray(out);
+}
+
+Value indexArray(const Value &array, const Value &position, Array &out) {
+    Array &elements = arrayOf(array);
+    return element(elements, checkedPosition(elements, position), out);
+}
+
+void storeElement(const Value &array, const Value &position, const Value &value) {
+    Array &elements = arrayOf(array);
+    const std::size_t at = checkedPosition(elements, position);
+    if(!elements.isTagged()) {
+        if(!value.isScalar() || value.kind > elements.element) [[unlikely]] {
+            throw RuntimeError(FORMAT("cannot store {} in an array of {}", value, elementName(elements.element)));
+        }
+        if(elements.element == ValueKind::DOUBLE) {
+            elements.reals[at] = value.asDouble();
+        } else {
+            elements.integers[at] = value.asInt();
+        }
+        return;
+    }
+    Value &slot = elements.values[at];
+    if((slot.kind == ValueKind::ARRAY) != (value.kind == ValueKind::ARRAY) || value.isWide()) [[unlikely]] {
+        throw RuntimeError(FORMAT("cannot store {} in element {} of {}", value, at, elements.to_string()));
+    }
+    if(value.kind != ValueKind::ARRAY) {
+        slot = value;
+        return;
+    }
+    Array copy = *value.array;
+    elements.nested[C_ST(slot.integer)] = std::move(copy);
+}
+
+Value arrayLength(const Value &array) {
+    if(array.kind != ValueKind::ARRAY) [[unlikely]] { throw RuntimeError(FORMAT("{} has no length", array)); }
+    return Value::fromInt(static_cast<std::int64_t>(array.array->size()));
+}
+
+/// A loop of step 1 indexes every position from @p start up to @p bound: the first one out of bounds is either the
+/// start or the length of the array.
+void checkBound(const Value &array, const Value &bound, const Value &start) {
+    const bool runs = start.kind <= ValueKind::INT && bound.kind <= ValueKind::INT ? start.asInt() < bound.asInt()
+                                                                                   : start.asDouble() < bound.asDouble();
+    if(!runs) { return; }
+    const Array &elements = arrayOf(array);
+    if(start.kind > ValueKind::INT) [[unlikely]] { throw RuntimeError(FORMAT("index {} is not an integer", start)); }
+    const std::int64_t first = start.asInt();
+    if(first < 0 || bits(first) >= elements.size()) [[unlikely]] { outOfBounds(first, elements.size()); }
+    const auto length = static_cast<std::int64_t>(elements.size());
+    const bool beyond = bound.kind <= ValueKind::INT ? bound.asInt() > length : static_cast<double>(length) < bound.real;
+    if(beyond) [[unlikely]] { outOfBounds(length, elements.size()); }
+}
+
+DISABLE_WARNINGS_POP()
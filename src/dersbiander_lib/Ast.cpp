@@ -0,0 +1,47 @@
+#include "Dersbiander/Ast.hpp"
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+/**
+ * @brief Creates an empty tree over a token vector.
+ *
+ * Reserving the token count is an estimate, not a bound: statements, lists and EMPTY nodes have no token of their
+ * own, but they are outnumbered by the newlines, braces, commas and keywords that produce no node. For typical
+ * programs the arena is then allocated once, and a program that needs more only costs the vectors a reallocation.
+ */
+Ast::Ast(const std::vector<Token> &tokenList) : tokens(tokenList) {
+    nodes.reserve(tokens.size() + 1);
+    children_.reserve(tokens.size() + 1);
+    postfix.reserve(tokens.size() + 1);
+}
+
+NodeIndex Ast::allocate(AstKind kind, std::size_t tokenIndex, std::span<const NodeIndex> nodeChildren) {
+    const auto index = C_UI32T(nodes.size());
+    nodes.push_back(AstNode{kind, C_UI32T(tokenIndex), C_UI32T(children_.size()), C_UI32T(nodeChildren.size())});
+    children_.insert(children_.end(), nodeChildren.begin(), nodeChildren.end());
+    return index;
+}
+
+std::string Ast::to_string() const {
+    std::string out;
+    if(root != invalidNode) { dump(out, root, 0); }
+    return out;
+}
+
+void Ast::dump(std::string &out, NodeIndex index, std::size_t depth) const {
+    const AstNode &current = nodes[index];
+    out.append(depth * 2, ' ');
+    if(current.kind == AstKind::PROGRAM || current.kind == AstKind::BLOCK || current.kind == AstKind::LIST ||
+       current.kind == AstKind::EMPTY) {
+        out.append(FORMAT("{}", current.kind));
+    } else if(current.kind == AstKind::EXPRESSION) {
+        out.append(FORMAT("{} {}", current.kind, ExpressionParser::to_string(tokens, code(index))));
+    } else {
+        out.append(FORMAT("{} '{}'", current.kind, tokens[current.token].getValue()));
+    }
+    out.push_back(CNL);
+    if(current.kind == AstKind::EXPRESSION) { return; }
+    for(const NodeIndex child : children(index)) { dump(out, child, depth + 1); }
+}
+
+DISABLE_WARNINGS_POP()
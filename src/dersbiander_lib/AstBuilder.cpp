@@ -0,0 +1,265 @@
+#include "Dersbiander/AstBuilder.hpp"
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+AstBuilder::AstBuilder(Ast &tree) noexcept : ast(tree) {}
+
+void AstBuilder::statement(std::size_t first, std::size_t last) {
+    position = first;
+    end = last;
+    skipComments();
+    if(peek() == eofTokenType) { return; }
+    parseStatement();
+    while(peek() == TokenType::CLOSED_CURLY_BRACKETS) { closeBlock(); }
+}
+
+void AstBuilder::finish() {
+    // Only reachable when the input had errors: the blocks left open still end up in the tree.
+    while(!frames.empty()) {
+        position = end = ast.tokens.size();
+        closeBlock();
+    }
+    const std::size_t token = ast.tokens.empty() ? 0 : ast.tokens.size() - 1;
+    ast.root = commit(AstKind::PROGRAM, token, 0);
+}
+
+TokenType AstBuilder::peek() const noexcept { return position < end ? ast.tokens[position].getType() : eofTokenType; }
+
+std::size_t AstBuilder::advance() noexcept {
+    const std::size_t index = position;
+    if(position < end) { ++position; }
+    skipComments();
+    return index;
+}
+
+bool AstBuilder::match(TokenType type) noexcept {
+    if(peek() != type) { return false; }
+    advance();
+    return true;
+}
+
+void AstBuilder::skipComments() noexcept {
+    while(position < end && ast.tokens[position].getType() == TokenType::COMMENT) { ++position; }
+}
+
+/**
+ * @brief Creates a node whose children are the scratch entries pushed since @p mark and pops them.
+ */
+NodeIndex AstBuilder::commit(AstKind kind, std::size_t token, std::size_t mark) {
+    const auto begin = scratch.begin() + C_PTRDIFT(mark);
+    const NodeIndex index = ast.allocate(kind, token, {std::to_address(begin), scratch.size() - mark});
+    scratch.erase(begin, scratch.end());
+    return index;
+}
+
+void AstBuilder::parseStatement() {
+    switch(peek()) {
+        using enum TokenType;
+    case KEYWORD_MAIN:
+        openBlock(AstKind::MAIN, advance(), scratch.size());
+        break;
+    case OPEN_CURLY_BRACKETS:
+        openBlock(AstKind::BLOCK, position, scratch.size());
+        break;
+    case CLOSED_CURLY_BRACKETS:
+        break;
+    case KEYWORD_VAR:
+        parseDeclaration();
+        break;
+    case KEYWORD_FOR:
+        [[fallthrough]];
+    case KEYWORD_PARALLEL:
+        parseFor();
+        break;
+    case KEYWORD_STRUCTURE:
+        parseStructure();
+        break;
+    case KEYWORD_FUNC:
+        parseFunction();
+        break;
+    case KEYWORD_RETURN:
+        parseReturn();
+        break;
+    default:
+        parseAssignmentOrExpression();
+        break;
+    }
+}
+
+/// `var|const name, ...: type[...] = value, ...` becomes DECLARATION[LIST names, TYPE, LIST values].
+void AstBuilder::parseDeclaration() {
+    const std::size_t keyword = advance();
+    const std::size_t mark = scratch.size();
+    do {  // NOLINT(*-avoid-do-while)
+        scratch.push_back(ast.allocate(AstKind::IDENTIFIER, advance(), {}));
+    } while(match(TokenType::COMMA));
+    const NodeIndex names = commit(AstKind::LIST, keyword, mark);
+    scratch.push_back(names);
+    match(TokenType::COLON);
+    scratch.push_back(parseType());
+    if(peek() == TokenType::EQUAL_OPERATOR) {
+        const std::size_t equal = advance();
+        scratch.push_back(parseExpressionList(equal));
+    } else {
+        scratch.push_back(ast.allocate(AstKind::LIST, keyword, {}));
+    }
+    scratch.push_back(commit(AstKind::DECLARATION, keyword, mark));
+}
+
+/**
+ * @brief `for [var] i[: type] = start, condition, step {` becomes FOR[init, condition, step, BLOCK].
+ *
+ * The initialization is a DECLARATION or an ASSIGNMENT of a single expression, a missing condition or step is EMPTY.
+ * The token of its name, an IDENTIFIER or an EXPRESSION, is the loop variable.
+ * `parallel for` gives the same node, with the `parallel` keyword as its token.
+ */
+void AstBuilder::parseFor() {
+    using enum TokenType;
+    const std::size_t keyword = advance();
+    if(ast.tokens[keyword].getType() == KEYWORD_PARALLEL) { match(KEYWORD_FOR); }
+    const std::size_t headerMark = scratch.size();
+    const bool declaration = peek() == KEYWORD_VAR;
+    const std::size_t initToken = declaration ? advance() : position;
+    // Without `var` the name is an assignment target, an EXPRESSION like the ones of parseAssignmentOrExpression().
+    const std::array<NodeIndex, 1> name{declaration ? ast.allocate(AstKind::IDENTIFIER, advance(), {}) : parseExpression()};
+    scratch.push_back(ast.allocate(AstKind::LIST, initToken, name));
+    if(declaration) {
+        match(COLON);
+        scratch.push_back(parseType());
+    }
+    const std::size_t equal = advance();
+    const std::size_t valuesMark = scratch.size();
+    scratch.push_back(parseExpression());
+    scratch.push_back(commit(AstKind::LIST, equal, valuesMark));
+    scratch.push_back(commit(declaration ? AstKind::DECLARATION : AstKind::ASSIGNMENT, declaration ? initToken : equal, headerMark));
+    for(int part = 0; part < 2; ++part) {
+        if(match(COMMA)) {
+            scratch.push_back(parseExpression());
+        } else {
+            scratch.push_back(ast.allocate(AstKind::EMPTY, keyword, {}));
+        }
+    }
+    openBlock(AstKind::FOR, keyword, headerMark);
+}
+
+/// `if(condition) {` and `while(condition) {` become STRUCTURE[condition, BLOCK].
+void AstBuilder::parseStructure() {
+    const std::size_t keyword = advance();
+    const std::size_t headerMark = scratch.size();
+    scratch.push_back(parseExpression());
+    openBlock(AstKind::STRUCTURE, keyword, headerMark);
+}
+
+/// `func name(p: type, ...): type, ... {` becomes FUNCTION[LIST PARAMETER[TYPE], LIST TYPE, BLOCK].
+void AstBuilder::parseFunction() {
+    using enum TokenType;
+    advance();
+    const std::size_t name = advance();
+    const std::size_t headerMark = scratch.size();
+    const std::size_t parametersToken = advance();
+    const std::size_t parametersMark = scratch.size();
+    if(peek() != CLOSED_BRACKETS) {
+        do {  // NOLINT(*-avoid-do-while)
+            const std::size_t parameter = advance();
+            const std::size_t parameterMark = scratch.size();
+            match(COLON);
+            scratch.push_back(parseType());
+            scratch.push_back(commit(AstKind::PARAMETER, parameter, parameterMark));
+        } while(match(COMMA));
+    }
+    match(CLOSED_BRACKETS);
+    scratch.push_back(commit(AstKind::LIST, parametersToken, parametersMark));
+    const std::size_t returnsMark = scratch.size();
+    if(peek() == COLON) {
+        const std::size_t colon = advance();
+        do {  // NOLINT(*-avoid-do-while)
+            scratch.push_back(parseType());
+        } while(match(COMMA));
+        scratch.push_back(commit(AstKind::LIST, colon, returnsMark));
+    } else {
+        scratch.push_back(ast.allocate(AstKind::LIST, name, {}));
+    }
+    openBlock(AstKind::FUNCTION, name, headerMark);
+}
+
+void AstBuilder::parseReturn() {
+    const std::size_t keyword = advance();
+    const std::size_t mark = scratch.size();
+    if(peek() != eofTokenType && peek() != TokenType::CLOSED_CURLY_BRACKETS) {
+        do {  // NOLINT(*-avoid-do-while)
+            scratch.push_back(parseExpression());
+        } while(match(TokenType::COMMA));
+    }
+    scratch.push_back(commit(AstKind::RETURN, keyword, mark));
+}
+
+/// `a, b = x, y` and `a += x` become ASSIGNMENT[LIST targets, LIST values], anything else an EXPRESSION_STATEMENT.
+void AstBuilder::parseAssignmentOrExpression() {
+    const std::size_t first = position;
+    const std::size_t mark = scratch.size();
+    do {  // NOLINT(*-avoid-do-while)
+        scratch.push_back(parseExpression());
+    } while(match(TokenType::COMMA));
+    if(peek() != TokenType::EQUAL_OPERATOR && peek() != TokenType::OPERATION_EQUAL) {
+        scratch.push_back(commit(AstKind::EXPRESSION_STATEMENT, first, mark));
+        return;
+    }
+    const std::size_t oper = advance();
+    const NodeIndex targets = commit(AstKind::LIST, first, mark);
+    scratch.push_back(targets);
+    scratch.push_back(parseExpressionList(oper));
+    scratch.push_back(commit(AstKind::ASSIGNMENT, oper, mark));
+}
+
+void AstBuilder::openBlock(AstKind kind, std::size_t token, std::size_t headerMark) {
+    const std::size_t brace = position;
+    match(TokenType::OPEN_CURLY_BRACKETS);
+    frames.push_back(Frame{kind, token, headerMark, scratch.size(), brace});
+}
+
+void AstBuilder::closeBlock() {
+    match(TokenType::CLOSED_CURLY_BRACKETS);
+    if(frames.empty()) [[unlikely]] { return; }
+    const Frame frame = frames.back();
+    frames.pop_back();
+    scratch.push_back(commit(AstKind::BLOCK, frame.blockToken, frame.blockMark));
+    if(frame.kind != AstKind::BLOCK) { scratch.push_back(commit(frame.kind, frame.token, frame.headerMark)); }
+}
+
+/// `name[dimension]...[]` becomes TYPE[dimension, ...], an empty dimension is EMPTY.
+NodeIndex AstBuilder::parseType() {
+    using enum TokenType;
+    const std::size_t name = advance();
+    const std::size_t mark = scratch.size();
+    while(peek() == OPEN_SQUARE_BRACKETS) {
+        const std::size_t open = advance();
+        if(peek() == CLOSED_SQUARE_BRACKETS) {
+            scratch.push_back(ast.allocate(AstKind::EMPTY, open, {}));
+        } else {
+            scratch.push_back(parseExpression());
+        }
+        match(CLOSED_SQUARE_BRACKETS);
+    }
+    return commit(AstKind::TYPE, name, mark);
+}
+
+NodeIndex AstBuilder::parseExpressionList(std::size_t token) {
+    const std::size_t mark = scratch.size();
+    do {  // NOLINT(*-avoid-do-while)
+        scratch.push_back(parseExpression());
+    } while(match(TokenType::COMMA));
+    return commit(AstKind::LIST, token, mark);
+}
+
+/// Parses one expression with the ExpressionParser and wraps its postfix code in an EXPRESSION node.
+NodeIndex AstBuilder::parseExpression() {
+    const std::size_t token = position;
+    const std::size_t first = ast.postfix.size();
+    ExpressionParser parser(ast.tokens, position, end);
+    position = parser.parse(ast.postfix);
+    const auto index = C_UI32T(ast.nodes.size());
+    ast.nodes.push_back(AstNode{AstKind::EXPRESSION, C_UI32T(token), C_UI32T(first), C_UI32T(ast.postfix.size() - first)});
+    return index;
+}
+
+DISABLE_WARNINGS_POP()
@@ -0,0 +1,164 @@
+#include "Dersbiander/Benchmark.hpp"
+#include "Dersbiander/Timer.hpp"
+#include <cmath>
+#include <numeric>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+namespace {
+    /// The 97.5th percentile of Student's t distribution with 1 to 30 degrees of freedom, the normal one beyond.
+    [[nodiscard]] double studentT(std::size_t degrees) noexcept {
+        static constexpr std::array<double, 30> table{12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                                      2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                                      2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+        return degrees == 0 ? 0.0 : (degrees <= table.size() ? table[degrees - 1] : 1.960);
+    }
+
+    /// Linear interpolation between the closest ranks of the sorted @p values.
+    [[nodiscard]] double quantile(const std::vector<double> &values, double fraction) noexcept {
+        const double position = fraction * static_cast<double>(values.size() - 1);
+        const auto below = static_cast<std::size_t>(position);
+        const std::size_t above = std::min(below + 1, values.size() - 1);
+        return values[below] + (values[above] - values[below]) * (position - static_cast<double>(below));
+    }
+
+#ifdef __linux__
+    [[nodiscard]] int openEvent(std::uint64_t config, int group) noexcept {
+        perf_event_attr attributes{};
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.size = sizeof(attributes);
+        attributes.config = config;
+        attributes.disabled = group < 0 ? 1 : 0;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        attributes.read_format = PERF_FORMAT_GROUP;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, group, 0));
+    }
+#endif
+}  // namespace
+
+PerfCounters::PerfCounters() {
+#ifdef __linux__
+    static constexpr std::array<std::uint64_t, 4> events{PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                         PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES};
+    for(std::size_t i = 0; i < events.size(); ++i) {
+        descriptors[i] = openEvent(events[i], i == 0 ? -1 : descriptors[0]);
+        if(descriptors[i] < 0) [[unlikely]] { return; }
+    }
+    leader = descriptors[0];
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+    for(const int descriptor : descriptors) {
+        if(descriptor >= 0) { close(descriptor); }
+    }
+#endif
+}
+
+void PerfCounters::start() noexcept {
+#ifdef __linux__
+    if(!isAvailable()) { return; }
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+}
+
+void PerfCounters::stop() noexcept {
+#ifdef __linux__
+    if(!isAvailable()) { return; }
+    ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    // PERF_FORMAT_GROUP reads the number of events, then their values.
+    std::array<std::uint64_t, 5> values{};
+    if(read(leader, values.data(), sizeof(values)) != static_cast<ssize_t>(sizeof(values))) [[unlikely]] { return; }
+    for(std::size_t i = 0; i < totals.size(); ++i) { totals[i] += values[i + 1]; }
+#endif
+}
+
+HardwareCounters PerfCounters::perIteration(std::uint64_t iterations) const noexcept {
+    if(!isAvailable() || iterations == 0) { return {}; }
+    const auto per = [iterations](std::uint64_t total) { return static_cast<double>(total) / static_cast<double>(iterations); };
+    return HardwareCounters{true, per(totals[0]), per(totals[1]), per(totals[2]), per(totals[3])};
+}
+
+BenchmarkResult Benchmark::summarize(std::string name, std::uint64_t iterations, std::vector<double> times,
+                                     const HardwareCounters &counters) const {
+    BenchmarkResult result{.name = std::move(name), .iterations = iterations, .counters = counters};
+    if(times.empty()) [[unlikely]] { return result; }
+    std::ranges::sort(times);
+    const double first = quantile(times, 0.25);
+    const double third = quantile(times, 0.75);
+    const double fence = options.outlierFences * (third - first);
+    // The middle sample is never an outlier: with narrow fences and few samples every other one may be.
+    const double middle = times[(times.size() - 1) / 2];
+    const auto [begin, end] = std::ranges::remove_if(
+        times, [&](double time) { return time != middle && (time < first - fence || time > third + fence); });
+    result.outliers = static_cast<std::size_t>(end - begin);
+    times.erase(begin, end);
+    const auto count = static_cast<double>(times.size());
+    result.samples = times.size();
+    result.mean = std::accumulate(times.begin(), times.end(), 0.0) / count;
+    result.median = quantile(times, 0.5);
+    result.min = times.front();
+    result.max = times.back();
+    double squares = 0.0;
+    for(const double time : times) { squares += (time - result.mean) * (time - result.mean); }
+    result.stddev = times.size() > 1 ? std::sqrt(squares / (count - 1.0)) : 0.0;
+    const double margin = studentT(times.size() - 1) * result.stddev / std::sqrt(count);
+    result.low = result.mean - margin;
+    result.high = result.mean + margin;
+    return result;
+}
+
+std::string BenchmarkResult::to_string() const {
+    std::string out = FORMAT("{}: {} ± {:.2f}% per iteration (median {}, {} samples of {} iterations, {} outliers)", name,
+                             Timer::make_time_str(C_LD(mean)), resolution() * 100.0,
+                             Timer::make_time_str(C_LD(median)), samples, iterations, outliers);
+    if(bytes > 0) { out.append(FORMAT(", {:.1f} MB/s", static_cast<double>(bytes) * 1e3 / mean)); }
+    if(items > 0) { out.append(FORMAT(", {:.0f} items/s", static_cast<double>(items) * 1e9 / mean)); }
+    if(counters.available) {
+        out.append(FORMAT(", {:.0f} cycles, {:.2f} IPC, {:.1f} branch misses, {:.1f} cache misses", counters.cycles,
+                          counters.cycles > 0.0 ? counters.instructions / counters.cycles : 0.0, counters.branchMisses,
+                          counters.cacheMisses));
+    }
+    return out;
+}
+
+/// Throughputs and counters are null when they were not measured, so every result has the same keys.
+std::string BenchmarkResult::to_json() const {
+    const auto optional = [](bool present, double value) { return present ? FORMAT("{:.6g}", value) : std::string{"null"}; };
+    return FORMAT(R"({{"name":"{}","iterations":{},"samples":{},"outliers":{},"mean_ns":{:.6g},"median_ns":{:.6g},)"
+                  R"("stddev_ns":{:.6g},"min_ns":{:.6g},"max_ns":{:.6g},"ci95_low_ns":{:.6g},"ci95_high_ns":{:.6g},)"
+                  R"("mb_per_s":{},"items_per_s":{},"cycles":{},"instructions":{},"branch_misses":{},"cache_misses":{}}})",
+                  name, iterations, samples, outliers, mean, median, stddev, min, max, low, high,
+                  optional(bytes > 0, static_cast<double>(bytes) * 1e3 / mean),
+                  optional(items > 0, static_cast<double>(items) * 1e9 / mean), optional(counters.available, counters.cycles),
+                  optional(counters.available, counters.instructions), optional(counters.available, counters.branchMisses),
+                  optional(counters.available, counters.cacheMisses));
+}
+
+std::string Benchmark::toJson(std::span<const BenchmarkResult> results) {
+    std::string out = R"({"benchmarks":[)";
+    for(std::size_t i = 0; i < results.size(); ++i) {
+        out.append(FORMAT("{}{}{}", i == 0 ? "" : ",", CNL, results[i].to_json()));
+    }
+    out.append(FORMAT("{}]}}{}", CNL, CNL));
+    return out;
+}
+
+std::string Benchmark::compare(const BenchmarkResult &before, const BenchmarkResult &after) {
+    const double change = before.mean > 0.0 ? (after.mean - before.mean) / before.mean * 100.0 : 0.0;
+    const bool significant = after.low > before.high || after.high < before.low;
+    return FORMAT("{}: {:+.2f}% ({} -> {}){}", after.name, change, Timer::make_time_str(C_LD(before.mean)),
+                  Timer::make_time_str(C_LD(after.mean)), significant ? "" : ", within the noise");
+}
+
+DISABLE_WARNINGS_POP()
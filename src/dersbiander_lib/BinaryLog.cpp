@@ -0,0 +1,142 @@
+#include "Dersbiander/BinaryLog.hpp"
+#include "Dersbiander/Errors.hpp"
+#include "Dersbiander/disableWarn.hpp"
+#include <fmt/args.h>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <spdlog/common.h>
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+namespace {
+    inline constexpr std::string_view magic = "DBTRACE1";
+
+    /// Reads the values a BinaryLog put, in order, and reports a truncated trace.
+    class Reader {
+    public:
+        explicit Reader(std::string_view data) noexcept : data(data) {}
+
+        template <typename T> [[nodiscard]] T get() {
+            T value{};
+            std::memcpy(&value, getBytes(sizeof(T)).data(), sizeof(T));
+            return value;
+        }
+        [[nodiscard]] std::string_view getBytes(std::size_t size) {
+            if(size > data.size()) [[unlikely]] { throw RuntimeError("truncated binary trace"); }
+            const std::string_view taken = data.substr(0, size);
+            data.remove_prefix(size);
+            return taken;
+        }
+        [[nodiscard]] std::string_view getText() { return getBytes(get<std::uint32_t>()); }
+        /// Any byte but 0 is true: a bool holding another byte than 0 or 1 is undefined behaviour.
+        [[nodiscard]] bool getBool() { return get<std::uint8_t>() != 0; }
+        [[nodiscard]] inline std::size_t remaining() const noexcept { return data.size(); }
+        [[nodiscard]] inline bool empty() const noexcept { return data.empty(); }
+
+    private:
+        std::string_view data;
+    };
+}  // namespace
+
+BinaryLog &BinaryLog::global() noexcept {
+    static BinaryLog log;
+    return log;
+}
+
+std::uint32_t BinaryLog::intern(std::string_view format) {
+    if(const auto found = formatIds.find(format); found != formatIds.end()) [[likely]] { return found->second; }
+    const auto id = static_cast<std::uint32_t>(formats.size());
+    formats.emplace_back(format);
+    formatIds.emplace(format, id);
+    return id;
+}
+
+std::vector<std::string> BinaryLog::format() const {
+    const std::scoped_lock lock(mutex);
+    return decode(formats, {bytes.data(), bytes.size()});
+}
+
+void BinaryLog::write(std::ostream &out) const {
+    const std::scoped_lock lock(mutex);
+    const auto putValue = [&out](const auto &value) { out.write(reinterpret_cast<const char *>(&value), sizeof(value)); };
+    out << magic;
+    putValue(static_cast<std::uint32_t>(formats.size()));
+    for(const std::string &format : formats) {
+        putValue(static_cast<std::uint32_t>(format.size()));
+        out << format;
+    }
+    putValue(static_cast<std::uint64_t>(bytes.size()));
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+std::vector<std::string> BinaryLog::read(std::istream &in) {
+    const std::string data{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    if(!data.starts_with(magic)) [[unlikely]] { throw RuntimeError("not a binary trace"); }
+    Reader reader(std::string_view{data}.substr(magic.size()));
+    const auto formatCount = reader.get<std::uint32_t>();
+    // Every format takes at least its length: a larger count comes from a corrupt file, not from write().
+    if(formatCount > reader.remaining() / sizeof(std::uint32_t)) [[unlikely]] {
+        throw RuntimeError(FORMAT("{} formats in a binary trace of {} bytes", formatCount, data.size()));
+    }
+    std::vector<std::string> formats(formatCount);
+    for(std::string &format : formats) { format = reader.getText(); }
+    return decode(formats, reader.getBytes(reader.get<std::uint64_t>()));
+}
+
+void BinaryLog::clear() noexcept {
+    const std::scoped_lock lock(mutex);
+    formats.clear();
+    formatIds.clear();
+    bytes.clear();
+    records = 0;
+}
+
+/// Every record is formatted with the arguments it saved, as the logger would have formatted it when it was made.
+std::vector<std::string> BinaryLog::decode(const std::vector<std::string> &formats, std::string_view bytes) {
+    std::vector<std::string> lines;
+    Reader reader(bytes);
+    while(!reader.empty()) {
+        const auto id = reader.get<std::uint32_t>();
+        const auto levelByte = reader.get<std::uint8_t>();
+        const auto count = reader.get<std::uint8_t>();
+        if(id >= formats.size()) [[unlikely]] {
+            throw RuntimeError(FORMAT("format {} of a binary trace of {}", id, formats.size()));
+        }
+        if(levelByte >= spdlog::level::n_levels) [[unlikely]] {
+            throw RuntimeError(FORMAT("level {} in a binary trace", levelByte));
+        }
+        const auto level = static_cast<spdlog::level::level_enum>(levelByte);
+        fmt::dynamic_format_arg_store<fmt::format_context> arguments;
+        for(std::uint8_t i = 0; i < count; ++i) {
+            const auto tag = reader.get<std::uint8_t>();
+            switch(static_cast<Argument>(tag)) {
+                using enum Argument;
+            case INT:
+                arguments.push_back(reader.get<std::int64_t>());
+                break;
+            case UINT:
+                arguments.push_back(reader.get<std::uint64_t>());
+                break;
+            case DOUBLE:
+                arguments.push_back(reader.get<double>());
+                break;
+            case BOOL:
+                arguments.push_back(reader.getBool());
+                break;
+            case CHAR:
+                arguments.push_back(reader.get<char>());
+                break;
+            case STRING:
+                arguments.push_back(std::string{reader.getText()});
+                break;
+            default:
+                throw RuntimeError(FORMAT("argument tag {} in a binary trace", tag));
+            }
+        }
+        lines.push_back(FORMAT("[{}] {}", spdlog::level::to_string_view(level), fmt::vformat(formats[id], arguments)));
+    }
+    return lines;
+}
+
+DISABLE_WARNINGS_POP()
@@ -0,0 +1,78 @@
+#include "Dersbiander/BracketIndex.hpp"
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+namespace {
+    /// 0 for anything else, 1..3 for ( [ { and 4..6 for ) ] }.
+    enum BracketClass : std::uint8_t { NONE, OPEN_ROUND, OPEN_SQUARE, OPEN_CURLY, CLOSED_ROUND, CLOSED_SQUARE, CLOSED_CURLY };
+
+    constexpr std::array<std::uint8_t, tokenTypeCount> bracketClasses = [] {
+        std::array<std::uint8_t, tokenTypeCount> table{};
+        table[static_cast<std::size_t>(TokenType::OPEN_BRACKETS)] = OPEN_ROUND;
+        table[static_cast<std::size_t>(TokenType::OPEN_SQUARE_BRACKETS)] = OPEN_SQUARE;
+        table[static_cast<std::size_t>(TokenType::OPEN_CURLY_BRACKETS)] = OPEN_CURLY;
+        table[static_cast<std::size_t>(TokenType::CLOSED_BRACKETS)] = CLOSED_ROUND;
+        table[static_cast<std::size_t>(TokenType::CLOSED_SQUARE_BRACKETS)] = CLOSED_SQUARE;
+        table[static_cast<std::size_t>(TokenType::CLOSED_CURLY_BRACKETS)] = CLOSED_CURLY;
+        return table;
+    }();
+
+    /// Depth change of every class: curly brackets delimit statements and are not counted.
+    inline constexpr std::array<std::int8_t, 7> depthDeltas{0, 1, 1, 0, -1, -1, 0};
+
+    inline constexpr std::array<TokenType, 3> closingTypes{TokenType::CLOSED_BRACKETS, TokenType::CLOSED_SQUARE_BRACKETS,
+                                                           TokenType::CLOSED_CURLY_BRACKETS};
+}  // namespace
+
+BracketIndex::BracketIndex(const std::vector<Token> &tokens) : partners(tokens.size(), noPartner), depths(tokens.size() + 1, 0) {
+    const std::size_t size = tokens.size();
+    std::vector<std::uint8_t> classes(size);
+    for(std::size_t i = 0; i < size; ++i) { classes[i] = bracketClasses[static_cast<std::size_t>(tokens[i].getType())]; }
+    // Branch-free passes over the byte array: the compiler is free to vectorize them.
+    std::size_t bracketCount = 0;
+    for(std::size_t i = 0; i < size; ++i) {
+        depths[i + 1] = depths[i] + depthDeltas[classes[i]];
+        bracketCount += C_ST(classes[i] != NONE);
+    }
+    if(bracketCount == 0) { return; }
+
+    std::vector<std::uint32_t> open;
+    std::vector<std::uint32_t> unbalanced;
+    // Brackets of every opening class on the stack: a stray closing bracket is found without searching the stack.
+    std::array<std::size_t, OPEN_CURLY + 1> openCounts{};
+    for(std::size_t i = 0; i < size; ++i) {
+        const std::uint8_t current = classes[i];
+        if(current == NONE) [[likely]] { continue; }
+        if(current < CLOSED_ROUND) {
+            open.push_back(C_UI32T(i));
+            ++openCounts[current];
+            maxDepth = std::max(maxDepth, open.size());
+            continue;
+        }
+        const auto opener = C_UI8T(current - 3);
+        // A closing bracket that matches something deeper closes the brackets in between as unbalanced, otherwise it
+        // is a stray bracket and the open ones are left alone. The search only runs when there is a match, and every
+        // bracket it passes leaves the stack, so the pass stays linear.
+        if(openCounts[opener] == 0) {
+            unbalanced.push_back(C_UI32T(i));
+            continue;
+        }
+        std::size_t match = open.size() - 1;
+        while(classes[open[match]] != opener) { --match; }
+        for(std::size_t closed = match; closed < open.size(); ++closed) { --openCounts[classes[open[closed]]]; }
+        unbalanced.insert(unbalanced.end(), open.begin() + C_PTRDIFT(match) + 1, open.end());
+        partners[open[match]] = C_UI32T(i);
+        partners[i] = open[match];
+        open.resize(match);
+    }
+    unbalanced.insert(unbalanced.end(), open.begin(), open.end());
+    std::ranges::sort(unbalanced);
+    diagnostics.reserve(unbalanced.size());
+    for(const std::uint32_t i : unbalanced) {
+        std::vector<TokenType> expected;
+        if(classes[i] < CLOSED_ROUND) { expected.push_back(closingTypes[classes[i] - 1U]); }
+        diagnostics.emplace_back(DiagnosticKind::UNBALANCED_BRACKET, tokens[i], std::move(expected));
+    }
+}
+
+DISABLE_WARNINGS_POP()
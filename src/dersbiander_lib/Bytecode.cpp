@@ -0,0 +1,261 @@
+#include "Dersbiander/Bytecode.hpp"
+#include <charconv>
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+namespace {
+    [[nodiscard]] std::int64_t charCode(std::string_view value) noexcept {
+        // The tokenizer strips the apostrophes: a, \n or the empty string of ''.
+        if(value.empty()) { return 0; }
+        if(value.front() != '\\' || value.size() < 2) { return value.front(); }
+        switch(value[1]) {
+        case 'n':
+            return '\n';
+        case 't':
+            return '\t';
+        case 'r':
+            return '\r';
+        case '0':
+            return '\0';
+        default:
+            return value[1];
+        }
+    }
+
+    /// Lane of the component @p letter in @p set, -1 when it is not one of them.
+    [[nodiscard]] int component(std::string_view set, char letter) noexcept {
+        const std::size_t found = set.find(letter);
+        return found == std::string_view::npos ? -1 : static_cast<int>(found);
+    }
+
+    /// `vec3(1, 2, 3)` for a vector, the columns of a matrix as vectors: the syntax that builds the value again.
+    [[nodiscard]] std::string wideString(const Value &value) {
+        const auto column = [&value](std::size_t first) {
+            std::vector<float> components(value.lanes->values.begin() + static_cast<std::ptrdiff_t>(first),
+                                          value.lanes->values.begin() + static_cast<std::ptrdiff_t>(first + value.size));
+            return FORMAT("vec{}({})", value.size, FMT_JOIN(components, ", "));
+        };
+        if(value.kind == ValueKind::VECTOR) { return column(0); }
+        std::vector<std::string> columns;
+        for(std::size_t i = 0; i < value.size; ++i) { columns.push_back(column(i * 4)); }
+        return FORMAT("mat{}({})", value.size, FMT_JOIN(columns, ", "));
+    }
+
+    /// The scalar element @p position of @p array; a nested array gives its ARRAY value, which is only a position.
+    [[nodiscard]] Value stored(const Array &array, std::size_t position) noexcept {
+        switch(array.element) {
+        case ValueKind::BOOL:
+            return Value::fromBool(array.integers[position] != 0);
+        case ValueKind::INT:
+            return Value::fromInt(array.integers[position]);
+        case ValueKind::DOUBLE:
+            return Value::fromDouble(array.reals[position]);
+        default:
+            return array.values[position];
+        }
+    }
+}  // namespace
+
+bool Array::operator==(const Array &other) const noexcept {
+    if(size() != other.size()) { return false; }
+    for(std::size_t i = 0; i < size(); ++i) {
+        const Value left = stored(*this, i);
+        const Value right = stored(other, i);
+        if(left.kind != right.kind) { return false; }
+        const bool equal = left.kind == ValueKind::ARRAY ? nested[C_ST(left.integer)] == other.nested[C_ST(right.integer)]
+                                                         : left == right;
+        if(!equal) { return false; }
+    }
+    return true;
+}
+
+/// `[1, 2]`, nested arrays included: the literal that builds the array again.
+std::string Array::to_string() const {
+    std::vector<std::string> elements;
+    elements.reserve(size());
+    for(std::size_t i = 0; i < size(); ++i) {
+        const Value value = stored(*this, i);
+        elements.push_back(value.kind == ValueKind::ARRAY ? nested[C_ST(value.integer)].to_string() : value.to_string());
+    }
+    return FORMAT("[{}]", FMT_JOIN(elements, ", "));
+}
+
+bool Value::operator==(const Value &other) const noexcept {
+    if(kind != other.kind) { return false; }
+    switch(kind) {
+    case ValueKind::BOOL:
+        return boolean == other.boolean;
+    case ValueKind::DOUBLE:
+        return real == other.real;
+    case ValueKind::VECTOR:
+        [[fallthrough]];
+    case ValueKind::MATRIX: {
+        if(size != other.size) { return false; }
+        const std::size_t columns = kind == ValueKind::MATRIX ? size : 1;
+        for(std::size_t i = 0; i < columns * 4; ++i) {
+            if(lanes->values[i] != other.lanes->values[i]) { return false; }
+        }
+        return true;
+    }
+    case ValueKind::ARRAY:
+        return *array == *other.array;
+    default:
+        return integer == other.integer;
+    }
+}
+
+std::string Value::to_string() const {
+    switch(kind) {
+    case ValueKind::BOOL:
+        return boolean ? "true" : "false";
+    case ValueKind::DOUBLE:
+        return FORMAT("{}", real);
+    case ValueKind::VECTOR:
+        [[fallthrough]];
+    case ValueKind::MATRIX:
+        return wideString(*this);
+    case ValueKind::ARRAY:
+        return array->to_string();
+    default:
+        return FORMAT("{}", integer);
+    }
+}
+
+std::optional<OpCode> binaryOpCode(std::string_view value) noexcept {
+    using enum OpCode;
+    if(value == "+") { return ADD; }
+    if(value == "-") { return SUB; }
+    if(value == "*") { return MUL; }
+    if(value == "/") { return DIV; }
+    if(value == "^") { return POW; }
+    if(value == "&&") { return AND; }
+    if(value == "||") { return OR; }
+    if(value == "==") { return EQ; }
+    if(value == "!=") { return NE; }
+    if(value == "<") { return LT; }
+    if(value == "<=") { return LE; }
+    if(value == ">") { return GT; }
+    if(value == ">=") { return GE; }
+    return std::nullopt;
+}
+
+std::optional<std::uint16_t> swizzlePattern(std::string_view letters, std::uint8_t size) noexcept {
+    if(letters.empty() || letters.size() > 4) { return std::nullopt; }
+    for(const std::string_view set : {"xyzw", "rgba", "stpq"}) {
+        if(component(set, letters.front()) < 0) { continue; }
+        unsigned pattern = C_UI32T(letters.size()) << 8U;
+        for(std::size_t i = 0; i < letters.size(); ++i) {
+            const int lane = component(set, letters[i]);
+            if(lane < 0 || lane >= size) { return std::nullopt; }
+            pattern |= static_cast<unsigned>(lane) << (2 * i);
+        }
+        return static_cast<std::uint16_t>(pattern);
+    }
+    return std::nullopt;
+}
+
+Value literalValue(const Token &token) {
+    const std::string &value = token.getValue();
+    switch(token.getType()) {
+        using enum TokenType;
+    case BOOLEAN:
+        return Value::fromBool(value == "true");
+    case CHAR:
+        return Value::fromInt(charCode(value));
+    case INTEGER: {
+        std::int64_t result = 0;
+        if(const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), result); error == std::errc{}) {
+            return Value::fromInt(result);
+        }
+        return Value::fromDouble(std::strtod(value.c_str(), nullptr));
+    }
+    default:
+        return Value::fromDouble(std::strtod(value.c_str(), nullptr));
+    }
+}
+
+/// One instruction per line; jumps show their target and constant registers their value.
+std::string Chunk::disassemble() const {
+    std::string out;
+    const auto operand = [this](std::uint16_t reg) {
+        if(reg >= constantBase && reg < constantBase + constants.size()) { return FORMAT("k{}", constants[reg - constantBase]); }
+        return FORMAT("r{}", reg);
+    };
+    for(std::size_t i = 0; i < code.size(); ++i) {
+        const Bytecode &instruction = code[i];
+        out.append(FORMAT("{:>4} {:<10}", i, instruction.op));
+        switch(instruction.op) {
+            using enum OpCode;
+        case JUMP:
+            out.append(FORMAT(" -> {}", instruction.target()));
+            break;
+        case JUMP_FALSE:
+            out.append(FORMAT(" {} -> {}", operand(instruction.a), instruction.target()));
+            break;
+        case FOR_TEST:
+            out.append(FORMAT(" {} r{}", operand(instruction.a), instruction.b));
+            break;
+        case VECTOR: {
+            const VectorShape shape = VectorShape::decode(instruction.c);
+            out.append(FORMAT(" r{} {}{}", instruction.a, shape.matrix ? "mat" : "vec", shape.size));
+            if(shape.arguments > 0) { out.append(FORMAT(" r{}..r{}", instruction.b, instruction.b + shape.arguments - 1)); }
+            break;
+        }
+        case SWIZZLE: {
+            std::string letters;
+            for(unsigned i = 0; i < (instruction.c >> 8U); ++i) { letters.push_back("xyzw"[(instruction.c >> (2 * i)) & 3U]); }
+            out.append(FORMAT(" r{} r{}.{}", instruction.a, instruction.b, letters));
+            break;
+        }
+        case ARRAY:
+            if(instruction.c == 0) {
+                out.append(FORMAT(" r{} []", instruction.a));
+            } else {
+                out.append(FORMAT(" r{} [r{}..r{}]", instruction.a, instruction.b, instruction.b + instruction.c - 1));
+            }
+            break;
+        case FILL:
+            out.append(FORMAT(" r{} {} of {}", instruction.a, operand(instruction.b), operand(instruction.c)));
+            break;
+        case INDEX:
+            [[fallthrough]];
+        case ELEMENT:
+            out.append(FORMAT(" r{} r{}[{}]", instruction.a, instruction.b, operand(instruction.c)));
+            break;
+        case STORE:
+            out.append(FORMAT(" r{}[{}] {}", instruction.a, operand(instruction.b), operand(instruction.c)));
+            break;
+        case BOUND:
+            out.append(FORMAT(" r{}[r{}..{}]", instruction.a, instruction.c, operand(instruction.b)));
+            break;
+        case PARALLEL_FOR: {
+            const ParallelLoop &loop = loops[instruction.a];
+            out.append(FORMAT(" r{} < {} by {}, body {}", loop.variable, operand(loop.bound), operand(loop.step), loop.body));
+            for(const auto &[reg, op] : loop.reductions) { out.append(FORMAT(", {} r{}", op, reg)); }
+            break;
+        }
+        case HALT:
+            break;
+        case MOVE:
+            [[fallthrough]];
+        case NEG:
+            [[fallthrough]];
+        case NOT:
+            [[fallthrough]];
+        case POSTINC:
+            [[fallthrough]];
+        case POSTDEC:
+            [[fallthrough]];
+        case LENGTH:
+            out.append(FORMAT(" r{} {}", instruction.a, operand(instruction.b)));
+            break;
+        default:
+            out.append(FORMAT(" r{} {} {}", instruction.a, operand(instruction.b), operand(instruction.c)));
+            break;
+        }
+        out.push_back(CNL);
+    }
+    return out;
+}
+
+DISABLE_WARNINGS_POP()
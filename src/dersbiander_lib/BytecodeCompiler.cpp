@@ -0,0 +1,653 @@
+#include "Dersbiander/BytecodeCompiler.hpp"
+#include "Dersbiander/Profiler.hpp"
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+namespace {
+    inline constexpr std::size_t maxRegisters = std::numeric_limits<std::uint16_t>::max();
+
+    /// Position of the first op of the subtree of the code ending at @p last.
+    [[nodiscard]] std::size_t subtreeStart(std::span<const PostfixOp> code, std::size_t last) noexcept {
+        std::size_t position = last + 1;
+        std::uint32_t needed = 1;
+        while(needed > 0 && position > 0) {
+            --position;
+            needed = needed - 1 + code[position].arity;
+        }
+        return position;
+    }
+
+    /// Position of the first op of the callee of the CALL at @p call: every argument is one subtree of the code.
+    [[nodiscard]] std::size_t calleePosition(std::span<const PostfixOp> code, std::size_t call) noexcept {
+        std::size_t position = call;
+        for(std::uint32_t operand = 0; operand < code[call].arity && position > 0; ++operand) {
+            position = subtreeStart(code, position - 1);
+        }
+        return position;
+    }
+
+    /// `a[e]` with a variable `a`, where the index `e` is the whole code but the first and the last op.
+    [[nodiscard]] bool isElementTarget(std::span<const PostfixOp> code) noexcept {
+        return code.size() >= 3 && code.front().kind == PostfixKind::IDENTIFIER && code.back().kind == PostfixKind::INDEX &&
+               subtreeStart(code, code.size() - 2) == 1;
+    }
+
+    /// `.len()`: the MEMBER at @p position followed by a CALL without arguments.
+    [[nodiscard]] bool isLength(std::span<const PostfixOp> code, std::size_t position, const Token &member) noexcept {
+        return member.getValue() == "len" && position + 1 < code.size() && code[position + 1].kind == PostfixKind::CALL &&
+               code[position + 1].arity == 1;
+    }
+}  // namespace
+
+BytecodeCompiler::BytecodeCompiler(const Ast &tree, const NameResolver &resolver, const TypeChecker &checker)
+  : ast(tree), names(resolver), types(checker) {}
+
+std::vector<Diagnostic> BytecodeCompiler::compile() {
+    PROFILE_ZONE("compile bytecode");
+    diagnostics.clear();
+    chunk = Chunk{};
+    constantRegisters.clear();
+    const std::size_t symbolCount = names.getSymbols().symbolCount();
+    if(symbolCount >= maxRegisters) [[unlikely]] {
+        unsupported(0, "more than 65535 variables");
+        return std::move(diagnostics);
+    }
+    chunk.constantBase = C_UI16T(symbolCount);
+    collectConstants();
+    tempBase = nextTemp = maxTemp = C_UI16T(chunk.constantBase + chunk.constants.size());
+    for(SymbolIndex symbol = 0; symbol < symbolCount; ++symbol) {
+        const Symbol &declared = names.getSymbols().symbol(symbol);
+        if(declared.kind != SymbolKind::FUNCTION) { chunk.variables.emplace_back(ast.getTokens()[declared.token].getValue(), C_UI16T(symbol)); }
+    }
+    if(ast.getRoot() != invalidNode) { compileNode(ast.getRoot()); }
+    emit(OpCode::HALT, 0);
+    chunk.registerCount = maxTemp;
+    return std::move(diagnostics);
+}
+
+/// Gives every literal of the program its register up front, so temporaries can start right after them.
+void BytecodeCompiler::collectConstants() {
+    for(const Value value : {Value::fromInt(0), Value::fromInt(1), Value::fromDouble(0.0), Value::fromBool(false)}) {
+        [[maybe_unused]] const std::uint16_t reg = constant(value);
+    }
+    for(NodeIndex index = 0; index < ast.size(); ++index) {
+        if(ast.node(index).kind != AstKind::EXPRESSION) { continue; }
+        const auto code = ast.code(index);
+        for(std::size_t position = 0; position < code.size(); ++position) {
+            const PostfixOp &oper = code[position];
+            if(const ConstantFolder::Folded *subtree = folded(index, position); subtree != nullptr) {
+                [[maybe_unused]] const std::uint16_t reg = constant(subtree->value);
+                position = subtree->last;
+            } else if(oper.kind == PostfixKind::LITERAL && ast.getTokens()[oper.token].getType() != TokenType::STRING) {
+                [[maybe_unused]] const std::uint16_t reg = constant(literalValue(ast.getTokens()[oper.token]));
+            }
+        }
+    }
+}
+
+std::uint16_t BytecodeCompiler::constant(Value value) {
+    const std::int64_t bits = value.kind == ValueKind::DOUBLE ? std::bit_cast<std::int64_t>(value.real) : value.asInt();
+    const auto [found, inserted] = constantRegisters.try_emplace({value.kind, bits}, C_UI16T(chunk.constantBase + chunk.constants.size()));
+    if(inserted) {
+        if(chunk.constantBase + chunk.constants.size() >= maxRegisters) [[unlikely]] { return 0; }
+        chunk.constants.push_back(value);
+    }
+    return found->second;
+}
+
+const ConstantFolder::Folded *BytecodeCompiler::folded(NodeIndex index, std::size_t position) const noexcept {
+    return folder == nullptr ? nullptr : folder->folded(index, position);
+}
+
+void BytecodeCompiler::compileNode(NodeIndex index) {
+    nextTemp = tempBase;
+    switch(ast.node(index).kind) {
+        using enum AstKind;
+    case DECLARATION:
+        compileDeclaration(index);
+        break;
+    case ASSIGNMENT:
+        compileAssignment(index);
+        break;
+    case FOR:
+        compileFor(index);
+        break;
+    case STRUCTURE:
+        compileStructure(index);
+        break;
+    case FUNCTION:
+        break;
+    case RETURN:
+        unsupported(ast.node(index).token, "return");
+        break;
+    case EXPRESSION:
+        compileExpression(index);
+        break;
+    default:
+        compileChildren(index);
+        break;
+    }
+}
+
+/// A declaration without values starts from the zero of its type, an array from as many zeros as its dimensions say.
+void BytecodeCompiler::compileDeclaration(NodeIndex index) {
+    const auto children = ast.children(index);
+    const auto declared = ast.children(children[0]);
+    const auto values = ast.children(children[2]);
+    const bool array = !ast.children(children[1]).empty();
+    for(std::size_t i = 0; i < declared.size(); ++i) {
+        const std::uint32_t token = ast.node(declared[i]).token;
+        const std::uint16_t reg = variableRegister(token);
+        if(values.empty()) {
+            TypeId type = names.binding(token) == noSymbol ? TypeTable::unknownType : types.symbolType(names.binding(token));
+            while(types.getTypes().get(type).kind == TypeKind::ARRAY) { type = types.getTypes().get(type).element; }
+            const Value zero = type == TypeTable::doubleType ? Value::fromDouble(0.0)
+                                                             : (type == TypeTable::boolType ? Value::fromBool(false) : Value::fromInt(0));
+            if(array && (TypeTable::isWide(type) || type == TypeTable::stringType)) {
+                unsupported(ast.node(children[1]).token, "arrays of strings, vectors or matrices");
+            } else if(array) {
+                compileZeroArray(children[1], reg, zero);
+            } else if(TypeTable::isWide(type)) {
+                emitVector(reg, type, 0, 0);
+            } else {
+                emit(OpCode::MOVE, reg, constant(zero));
+            }
+        } else if(values.size() == 1 && i > 0) {
+            emit(OpCode::MOVE, reg, variableRegister(ast.node(declared[0]).token));
+        } else {
+            compileExpression(values[std::min(i, values.size() - 1)], reg);
+        }
+        nextTemp = tempBase;
+    }
+}
+
+/// Multiple targets are assigned in parallel: every value is evaluated before the first target changes.
+void BytecodeCompiler::compileAssignment(NodeIndex index) {
+    const auto children = ast.children(index);
+    const auto targets = ast.children(children[0]);
+    const auto values = ast.children(children[1]);
+    const std::uint32_t oper = ast.node(index).token;
+    std::vector<std::uint16_t> targetRegisters;
+    targetRegisters.reserve(targets.size());
+    // `+=` is the operator followed by '='.
+    const bool compound = ast.getTokens()[oper].getType() == TokenType::OPERATION_EQUAL;
+    const auto code = compound ? binaryOpCode(std::string_view{ast.getTokens()[oper].getValue()}.substr(0, 1)) : std::nullopt;
+    for(const NodeIndex target : targets) {
+        const auto targetCode = ast.code(target);
+        if(targets.size() == 1 && values.size() == 1 && isElementTarget(targetCode)) {
+            compileElementAssignment(target, values.front(), compound ? std::optional{code.value_or(OpCode::ADD)} : std::nullopt);
+            return;
+        }
+        if(targetCode.size() != 1 || targetCode.front().kind != PostfixKind::IDENTIFIER) {
+            unsupported(ast.node(target).token, "assignment to a member or to several or nested elements");
+            return;
+        }
+        targetRegisters.push_back(variableRegister(targetCode.front().token));
+    }
+    if(compound) {
+        for(const std::uint16_t target : targetRegisters) {
+            const std::uint16_t value = compileExpression(values.front());
+            emit(code.value_or(OpCode::ADD), target, target, value);
+            nextTemp = tempBase;
+        }
+        return;
+    }
+    if(targetRegisters.size() == 1 && values.size() == 1) {
+        compileExpression(values.front(), targetRegisters.front());
+        return;
+    }
+    std::vector<std::uint16_t> valueRegisters;
+    valueRegisters.reserve(values.size());
+    for(const NodeIndex value : values) {
+        std::uint16_t reg = compileExpression(value);
+        if(reg < tempBase) {
+            const std::uint16_t copy = allocateTemp();
+            emit(OpCode::MOVE, copy, reg);
+            reg = copy;
+        }
+        valueRegisters.push_back(reg);
+    }
+    for(std::size_t i = 0; i < targetRegisters.size(); ++i) {
+        emit(OpCode::MOVE, targetRegisters[i], valueRegisters[std::min(i, valueRegisters.size() - 1)]);
+    }
+}
+
+void BytecodeCompiler::compileFor(NodeIndex index) {
+    const auto children = ast.children(index);
+    compileNode(children[0]);
+    const NodeIndex variable = ast.children(ast.children(children[0])[0])[0];
+    const std::uint32_t variableToken = ast.node(variable).token;
+    const std::uint16_t loopVariable = variableRegister(variableToken);
+    const std::size_t outerProven = proven.size();
+    hoistBounds(index, variableToken, loopVariable);
+    if(const auto *reductions = parallel == nullptr ? nullptr : parallel->reductions(index); reductions != nullptr) {
+        compileParallelFor(index, loopVariable, *reductions);
+        proven.resize(outerProven);
+        return;
+    }
+    const std::size_t start = chunk.code.size();
+    std::optional<std::size_t> exit;
+    if(ast.node(children[1]).kind != AstKind::EMPTY) {
+        nextTemp = tempBase;
+        emit(OpCode::FOR_TEST, compileExpression(children[1]), loopVariable);
+        exit = emitJump(OpCode::JUMP);
+    }
+    compileNode(children[3]);
+    proven.resize(outerProven);
+    nextTemp = tempBase;
+    const std::uint16_t step = ast.node(children[2]).kind == AstKind::EMPTY ? constant(Value::fromInt(1))
+                                                                             : compileExpression(children[2]);
+    emit(OpCode::ADD, loopVariable, loopVariable, step);
+    patchJump(emitJump(OpCode::JUMP), start);
+    if(exit) { patchJump(*exit, chunk.code.size()); }
+}
+
+/// The bound and the step are computed once, before PARALLEL_FOR; the body follows the jump over it and ends with HALT.
+void BytecodeCompiler::compileParallelFor(NodeIndex index, std::uint16_t loopVariable,
+                                          std::span<const ParallelChecker::Reduction> reductions) {
+    const auto children = ast.children(index);
+    if(chunk.loops.size() >= maxRegisters) [[unlikely]] {
+        unsupported(ast.node(index).token, "more than 65535 parallel loops");
+        return;
+    }
+    nextTemp = tempBase;
+    ParallelLoop loop{loopVariable, compileExpression(children[1]), 0, 0, {}};
+    loop.step = ast.node(children[2]).kind == AstKind::EMPTY ? constant(Value::fromInt(1)) : compileExpression(children[2]);
+    for(const auto &[symbol, op] : reductions) {
+        if(types.getTypes().get(types.symbolType(symbol)).kind == TypeKind::ARRAY) [[unlikely]] {
+            unsupported(ast.node(index).token, "array reductions in a parallel for");
+        }
+        loop.reductions.emplace_back(C_UI16T(symbol), op);
+    }
+    emit(OpCode::PARALLEL_FOR, C_UI16T(chunk.loops.size()));
+    const std::size_t skip = emitJump(OpCode::JUMP);
+    loop.body = C_UI32T(chunk.code.size());
+    chunk.loops.push_back(std::move(loop));
+    compileNode(children[3]);
+    emit(OpCode::HALT, 0);
+    patchJump(skip, chunk.code.size());
+}
+
+/**
+ * @brief Checks the indices of the body of the `for` @p index once, before it, when they cannot fail halfway.
+ *
+ * The loop variable must go up by 1 to a bound that stays the same: a constant, or a variable or the `len()` of one
+ * the body does not assign. Then the body indices `a[i]` of an array variable `a` it does not assign either, in a
+ * statement of its own or the condition of an `if` or `while` of its own, run on every iteration: one BOUND checks
+ * them all, and the first index out of bounds fails before the loop instead of during it.
+ */
+void BytecodeCompiler::hoistBounds(NodeIndex index, std::uint32_t variableToken, std::uint16_t loopVariable) {
+    const auto children = ast.children(index);
+    const SymbolIndex variable = names.binding(variableToken);
+    const NodeIndex body = children[3];
+    if(variable == noSymbol || ast.node(children[1]).kind != AstKind::EXPRESSION || assigns(body, variable)) { return; }
+    const auto isConstant = [this](NodeIndex expression, std::optional<Value> expected) {
+        const auto code = ast.code(expression);
+        std::optional<Value> value;
+        const ConstantFolder::Folded *subtree = folded(expression, 0);
+        if(subtree != nullptr && subtree->last + 1 == code.size()) {
+            value = subtree->value;
+        } else if(code.size() == 1 && code.front().kind == PostfixKind::LITERAL) {
+            value = literalValue(ast.getTokens()[code.front().token]);
+        }
+        return value && value->kind == ValueKind::INT && (!expected || *value == *expected);
+    };
+    const auto isStable = [this, body](std::uint32_t token, bool number) {
+        const SymbolIndex symbol = names.binding(token);
+        if(symbol == noSymbol || names.getSymbols().symbol(symbol).kind == SymbolKind::FUNCTION || assigns(body, symbol)) {
+            return false;
+        }
+        const TypeId type = types.symbolType(symbol);
+        return number ? type == TypeTable::charType || type == TypeTable::intType || type == TypeTable::doubleType
+                      : types.getTypes().get(type).kind == TypeKind::ARRAY;
+    };
+    const auto bound = ast.code(children[1]);
+    const bool variableBound = bound.size() == 1 && bound[0].kind == PostfixKind::IDENTIFIER && isStable(bound[0].token, true);
+    const bool lengthBound = bound.size() == 3 && bound[0].kind == PostfixKind::IDENTIFIER && bound[1].kind == PostfixKind::MEMBER &&
+                             isLength(bound, 1, ast.getTokens()[bound[1].token]) && isStable(bound[0].token, false);
+    const bool stableBound = isConstant(children[1], std::nullopt) || variableBound || lengthBound;
+    const bool unitStep = ast.node(children[2]).kind == AstKind::EMPTY || isConstant(children[2], Value::fromInt(1));
+    if(!stableBound || !unitStep) { return; }
+    std::vector<NodeIndex> expressions;
+    for(const NodeIndex statement : ast.children(body)) {
+        const auto parts = ast.children(statement);
+        switch(ast.node(statement).kind) {
+            using enum AstKind;
+        case DECLARATION:
+            expressions.insert(expressions.end(), ast.children(parts[2]).begin(), ast.children(parts[2]).end());
+            break;
+        case ASSIGNMENT:
+            for(const NodeIndex list : parts) {
+                expressions.insert(expressions.end(), ast.children(list).begin(), ast.children(list).end());
+            }
+            break;
+        case EXPRESSION_STATEMENT:
+            expressions.insert(expressions.end(), parts.begin(), parts.end());
+            break;
+        case STRUCTURE:
+            expressions.push_back(parts[0]);
+            break;
+        default:
+            break;
+        }
+    }
+    std::optional<std::uint16_t> boundRegister;
+    for(const NodeIndex expression : expressions) {
+        const auto code = ast.code(expression);
+        for(std::size_t position = 2; position < code.size(); ++position) {
+            if(code[position].kind != PostfixKind::INDEX || code[position - 1].kind != PostfixKind::IDENTIFIER ||
+               code[position - 2].kind != PostfixKind::IDENTIFIER || names.binding(code[position - 1].token) != variable ||
+               !isStable(code[position - 2].token, false)) {
+                continue;
+            }
+            const SymbolIndex array = names.binding(code[position - 2].token);
+            if(std::ranges::find(proven, std::pair{array, variable}) != proven.end()) { continue; }
+            if(!boundRegister) {
+                nextTemp = tempBase;
+                boundRegister = compileExpression(children[1]);
+            }
+            emit(OpCode::BOUND, C_UI16T(array), *boundRegister, loopVariable);
+            chunk.arrays = true;
+            proven.emplace_back(array, variable);
+        }
+    }
+    nextTemp = tempBase;
+}
+
+bool BytecodeCompiler::assigns(NodeIndex index, SymbolIndex symbol) const {
+    const auto children = ast.children(index);
+    const auto lists = [this, symbol](NodeIndex list) {
+        return std::ranges::any_of(ast.children(list), [this, symbol](NodeIndex target) {
+            const auto code = ast.node(target).kind == AstKind::EXPRESSION ? ast.code(target) : std::span<const PostfixOp>{};
+            const std::uint32_t token = code.empty() ? ast.node(target).token : code.front().token;
+            return (code.empty() || code.size() == 1) && names.binding(token) == symbol;
+        });
+    };
+    switch(ast.node(index).kind) {
+        using enum AstKind;
+    case DECLARATION:
+    case ASSIGNMENT:
+        if(lists(children[0])) { return true; }
+        break;
+    case EXPRESSION: {
+        const auto code = ast.code(index);
+        for(std::size_t position = 1; position < code.size(); ++position) {
+            if(code[position].kind == PostfixKind::POSTFIX && code[position - 1].kind == PostfixKind::IDENTIFIER &&
+               names.binding(code[position - 1].token) == symbol) {
+                return true;
+            }
+        }
+        return false;
+    }
+    case FUNCTION:
+        return false;
+    default:
+        break;
+    }
+    return std::ranges::any_of(children, [this, symbol](NodeIndex child) { return assigns(child, symbol); });
+}
+
+bool BytecodeCompiler::isProven(std::span<const PostfixOp> code, std::size_t position) const {
+    if(position < 2 || code[position - 1].kind != PostfixKind::IDENTIFIER || code[position - 2].kind != PostfixKind::IDENTIFIER) {
+        return false;
+    }
+    const std::pair element{names.binding(code[position - 2].token), names.binding(code[position - 1].token)};
+    return std::ranges::find(proven, element) != proven.end();
+}
+
+/// `if` jumps over its block when the condition is false, `while` also jumps back to the condition after it.
+void BytecodeCompiler::compileStructure(NodeIndex index) {
+    const auto children = ast.children(index);
+    const bool loop = ast.token(index).getValue() == "while";
+    const std::size_t start = chunk.code.size();
+    const std::size_t exit = emitJump(OpCode::JUMP_FALSE, compileExpression(children[0]));
+    compileNode(children[1]);
+    if(loop) { patchJump(emitJump(OpCode::JUMP), start); }
+    patchJump(exit, chunk.code.size());
+}
+
+void BytecodeCompiler::compileChildren(NodeIndex index) {
+    for(const NodeIndex child : ast.children(index)) { compileNode(child); }
+}
+
+std::uint16_t BytecodeCompiler::compileExpression(NodeIndex index, std::optional<std::uint16_t> destination) {
+    operands.clear();
+    const std::size_t start = chunk.code.size();
+    compileCode(index, 0, ast.code(index).size());
+    const std::uint16_t result = operands.empty() ? constant(Value::fromInt(0)) : operands.back();
+    if(!destination) { return result; }
+    // The value was just computed into a temporary: write it to the destination directly instead of moving it.
+    if(result >= tempBase && chunk.code.size() > start && chunk.code.back().a == result) {
+        chunk.code.back().a = *destination;
+    } else {
+        emit(OpCode::MOVE, *destination, result);
+    }
+    release(result);
+    return *destination;
+}
+
+void BytecodeCompiler::compileCode(NodeIndex index, std::size_t first, std::size_t last) {
+    const auto pop = [this] {
+        const std::uint16_t reg = operands.empty() ? 0 : operands.back();
+        if(!operands.empty()) { operands.pop_back(); }
+        return reg;
+    };
+    const auto skip = [this, &pop](const PostfixOp &oper) {
+        unsupported(oper.token, FORMAT("{}", oper.kind));
+        for(std::uint32_t i = 0; i < oper.arity; ++i) { release(pop()); }
+        operands.push_back(allocateTemp());
+    };
+    const auto code = ast.code(index);
+    for(std::size_t position = first; position < last; ++position) {
+        if(const ConstantFolder::Folded *subtree = folded(index, position); subtree != nullptr) {
+            operands.push_back(constant(subtree->value));
+            position = subtree->last;
+            continue;
+        }
+        const PostfixOp &oper = code[position];
+        const Token &token = ast.getTokens()[oper.token];
+        switch(oper.kind) {
+            using enum PostfixKind;
+        case IDENTIFIER:
+            // The callee of a constructor has no register: the CALL that follows its arguments builds the value.
+            if(names.binding(oper.token) == noSymbol && TypeTable::isWide(TypeTable::wideType(token.getValue()))) {
+                operands.push_back(0);
+                break;
+            }
+            operands.push_back(variableRegister(oper.token));
+            break;
+        case LITERAL:
+            if(token.getType() == TokenType::STRING) { unsupported(oper.token, "strings"); }
+            operands.push_back(constant(literalValue(token)));
+            break;
+        case UNARY: {
+            const std::uint16_t operand = pop();
+            release(operand);
+            const std::uint16_t result = allocateTemp();
+            emit(token.getType() == TokenType::NOT_OPERATOR ? OpCode::NOT : OpCode::NEG, result, operand);
+            operands.push_back(result);
+            break;
+        }
+        case POSTFIX: {
+            const std::uint16_t operand = pop();
+            if(operand >= chunk.constantBase) { unsupported(oper.token, "++ and -- on a value that is not a variable"); }
+            const std::uint16_t result = allocateTemp();
+            emit(token.getValue() == "++" ? OpCode::POSTINC : OpCode::POSTDEC, result, operand);
+            operands.push_back(result);
+            break;
+        }
+        case BINARY: {
+            const std::uint16_t right = pop();
+            const std::uint16_t left = pop();
+            release(right);
+            release(left);
+            const std::uint16_t result = allocateTemp();
+            emit(binaryOpCode(token.getValue()).value_or(OpCode::ADD), result, left, right);
+            operands.push_back(result);
+            break;
+        }
+        case CALL: {
+            const PostfixOp &callee = code[calleePosition(code, position)];
+            const bool constructor = callee.kind == IDENTIFIER && names.binding(callee.token) == noSymbol && oper.arity <= 5;
+            const TypeId type = constructor ? TypeTable::wideType(ast.getTokens()[callee.token].getValue())
+                                            : TypeTable::unknownType;
+            if(TypeTable::isWide(type)) {
+                compileConstructor(type, oper.arity - 1);
+            } else {
+                skip(oper);
+            }
+            break;
+        }
+        case INDEX: {
+            const std::uint16_t element = pop();
+            const std::uint16_t array = pop();
+            release(element);
+            release(array);
+            const std::uint16_t result = allocateTemp();
+            emit(isProven(code, position) ? OpCode::ELEMENT : OpCode::INDEX, result, array, element);
+            chunk.arrays = true;
+            operands.push_back(result);
+            break;
+        }
+        case ARRAY: {
+            if(oper.arity > maxRegisters) [[unlikely]] {
+                skip(oper);
+                break;
+            }
+            const std::uint16_t elements = gather(oper.arity);
+            const std::uint16_t result = allocateTemp();
+            emit(OpCode::ARRAY, result, elements, C_UI16T(oper.arity));
+            chunk.arrays = true;
+            operands.push_back(result);
+            break;
+        }
+        case MEMBER:
+            if(isLength(code, position, token)) {
+                const std::uint16_t source = pop();
+                release(source);
+                const std::uint16_t result = allocateTemp();
+                emit(OpCode::LENGTH, result, source);
+                operands.push_back(result);
+                ++position;
+            } else if(const std::optional<std::uint16_t> pattern = swizzlePattern(token.getValue()); pattern) {
+                const std::uint16_t source = pop();
+                release(source);
+                const std::uint16_t result = allocateTemp();
+                emit(OpCode::SWIZZLE, result, source, *pattern);
+                chunk.vectors = true;
+                operands.push_back(result);
+            } else {
+                skip(oper);
+            }
+            break;
+        default:
+            skip(oper);
+            break;
+        }
+    }
+}
+
+void BytecodeCompiler::compileConstructor(TypeId type, std::uint32_t arguments) {
+    if(operands.size() <= arguments) [[unlikely]] { return; }
+    const std::uint16_t first = gather(arguments);
+    operands.pop_back();
+    const std::uint16_t result = allocateTemp();
+    emitVector(result, type, first, C_UI8T(arguments));
+    operands.push_back(result);
+}
+
+/// VECTOR and ARRAY read their operands from consecutive temporaries: each one is moved to its place, the last first,
+/// since an operand computed in a temporary never sits above its own place. The temporaries are released.
+std::uint16_t BytecodeCompiler::gather(std::uint32_t count) {
+    count = std::min(count, C_UI32T(operands.size()));
+    const std::vector<std::uint16_t> values(operands.end() - count, operands.end());
+    operands.resize(operands.size() - count);
+    for(const std::uint16_t value : values) { release(value); }
+    const std::uint16_t first = nextTemp;
+    for(std::uint32_t i = 0; i < count; ++i) { [[maybe_unused]] const std::uint16_t reg = allocateTemp(); }
+    for(std::uint32_t i = count; i-- > 0;) {
+        if(values[i] != first + i) { emit(OpCode::MOVE, C_UI16T(first + i), values[i]); }
+    }
+    release(first);
+    return first;
+}
+
+void BytecodeCompiler::compileElementAssignment(NodeIndex target, NodeIndex value, std::optional<OpCode> op) {
+    const auto code = ast.code(target);
+    const std::uint16_t array = variableRegister(code.front().token);
+    operands.clear();
+    compileCode(target, 1, code.size() - 1);
+    const std::uint16_t element = operands.empty() ? constant(Value::fromInt(0)) : operands.back();
+    std::uint16_t result = compileExpression(value);
+    if(op) {
+        const std::uint16_t current = allocateTemp();
+        emit(isProven(code, code.size() - 1) ? OpCode::ELEMENT : OpCode::INDEX, current, array, element);
+        emit(*op, current, current, result);
+        result = current;
+    }
+    emit(OpCode::STORE, array, element, result);
+    chunk.arrays = true;
+}
+
+/// An EMPTY dimension, as in `int[]`, has no elements.
+void BytecodeCompiler::compileZeroArray(NodeIndex type, std::uint16_t target, Value zero) {
+    const auto dimensions = ast.children(type);
+    std::uint16_t element = constant(zero);
+    for(std::size_t i = dimensions.size(); i-- > 0;) {
+        const std::uint16_t length = ast.node(dimensions[i]).kind == AstKind::EXPRESSION ? compileExpression(dimensions[i])
+                                                                                         : constant(Value::fromInt(0));
+        const std::uint16_t result = i == 0 ? target : allocateTemp();
+        emit(OpCode::FILL, result, length, element);
+        element = result;
+    }
+    chunk.arrays = true;
+}
+
+std::uint16_t BytecodeCompiler::variableRegister(std::uint32_t token) {
+    const SymbolIndex symbol = names.binding(token);
+    if(symbol == noSymbol || names.getSymbols().symbol(symbol).kind == SymbolKind::FUNCTION) [[unlikely]] {
+        unsupported(token, "functions");
+        return 0;
+    }
+    return C_UI16T(symbol);
+}
+
+std::uint16_t BytecodeCompiler::allocateTemp() {
+    if(nextTemp == maxRegisters) [[unlikely]] {
+        unsupported(0, "expressions needing more than 65535 registers");
+        return 0;
+    }
+    const std::uint16_t reg = nextTemp++;
+    maxTemp = std::max(maxTemp, nextTemp);
+    return reg;
+}
+
+/// Temporaries are freed in stack order, so releasing one frees everything above it.
+void BytecodeCompiler::release(std::uint16_t reg) noexcept {
+    if(reg >= tempBase && reg < nextTemp) { nextTemp = reg; }
+}
+
+void BytecodeCompiler::emit(OpCode op, std::uint16_t a, std::uint16_t b, std::uint16_t c) { chunk.code.push_back(Bytecode{op, a, b, c}); }
+
+void BytecodeCompiler::emitVector(std::uint16_t target, TypeId type, std::uint16_t first, std::uint8_t arguments) {
+    const TypeDescriptor &descriptor = types.getTypes().get(type);
+    const VectorShape shape{descriptor.kind == TypeKind::MATRIX, C_UI8T(descriptor.length), arguments};
+    emit(OpCode::VECTOR, target, first, shape.encode());
+    chunk.vectors = true;
+}
+
+std::size_t BytecodeCompiler::emitJump(OpCode op, std::uint16_t condition) {
+    emit(op, condition);
+    return chunk.code.size() - 1;
+}
+
+void BytecodeCompiler::patchJump(std::size_t jump, std::size_t target) noexcept {
+    chunk.code[jump].b = C_UI16T(target & 0xFFFFU);
+    chunk.code[jump].c = C_UI16T(target >> 16U);
+}
+
+void BytecodeCompiler::unsupported(std::uint32_t token, std::string_view what) {
+    diagnostics.emplace_back(DiagnosticKind::UNSUPPORTED, ast.getTokens()[token], FORMAT("{} in the bytecode compiler", what));
+}
+
+DISABLE_WARNINGS_POP()
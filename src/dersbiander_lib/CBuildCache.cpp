@@ -0,0 +1,211 @@
+#include "Dersbiander/CBuildCache.hpp"
+#include "Dersbiander/CTranspiler.hpp"
+#include <bit>
+#include <cstddef>
+
+#ifdef DERSBIANDER_C_BACKEND
+#include <cerrno>
+#include <cstdio>
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482 26490)
+
+namespace {
+    static_assert(sizeof(Value) == 16 && offsetof(Value, integer) == 8, "dsb_value relies on the Value layout");
+
+    inline constexpr std::uint64_t fnvOffset = 14695981039346656037ULL;
+    inline constexpr std::uint64_t fnvPrime = 1099511628211ULL;
+
+    [[nodiscard]] std::string readAll(const std::filesystem::path &path) {
+        std::ifstream stream(path, std::ios::in | std::ios::binary);
+        std::stringstream buffer;
+        buffer << stream.rdbuf();
+        return buffer.str();
+    }
+
+#ifdef DERSBIANDER_C_BACKEND
+    /**
+     * @brief Throws unless @p path is a @p kind owned by the current user that no one else can write.
+     *
+     * lstat() does not follow symbolic links, so a link planted in place of the directory or an object is refused too.
+     */
+    void requireOwned(const std::filesystem::path &path, mode_t kind) {
+        struct stat status {};
+        if(::lstat(path.c_str(), &status) != 0) [[unlikely]] {
+            throw RuntimeError(FORMAT("Unable to inspect {}: {}", path.string(), std::strerror(errno)));  // NOLINT(*-mt-unsafe)
+        }
+        if((status.st_mode & S_IFMT) != kind || status.st_uid != ::geteuid() || (status.st_mode & (S_IWGRP | S_IWOTH)) != 0)
+            [[unlikely]] {
+            throw RuntimeError(FORMAT("Refusing {}: it is not owned by the current user or others can write it", path.string()));
+        }
+    }
+
+    /// @p path as one single-quoted shell word: the cache directory comes from $XDG_CACHE_HOME or $HOME.
+    [[nodiscard]] std::string shellQuoted(const std::filesystem::path &path) {
+        std::string quoted = "'";
+        for(const char character : path.string()) {
+            if(character == '\'') {
+                quoted += "'\\''";
+            } else {
+                quoted.push_back(character);
+            }
+        }
+        quoted.push_back('\'');
+        return quoted;
+    }
+
+    /// The first line printed by `@p compiler --version`, empty when it prints nothing.
+    [[nodiscard]] std::string compilerVersion(const std::string &compiler) {
+        const std::string command = FORMAT("{} --version 2>/dev/null", compiler);
+        FILE *pipe = ::popen(command.c_str(), "r");  // NOLINT(*-owning-memory)
+        if(pipe == nullptr) [[unlikely]] { return {}; }
+        std::string version;
+        for(int character = std::fgetc(pipe); character != EOF && character != '\n'; character = std::fgetc(pipe)) {
+            version.push_back(static_cast<char>(character));
+        }
+        ::pclose(pipe);
+        return version;
+    }
+#endif
+}  // namespace
+
+SharedLibrary::SharedLibrary(const std::filesystem::path &path) {
+#ifdef DERSBIANDER_C_BACKEND
+    handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if(handle == nullptr) [[unlikely]] { throw RuntimeError(FORMAT("Unable to load {}: {}", path.string(), dlerror())); }
+    entry = std::bit_cast<Entry>(dlsym(handle, CTranspiler::entryPoint));
+    if(entry == nullptr) [[unlikely]] {
+        release();
+        throw RuntimeError(FORMAT("{} has no {} function", path.string(), CTranspiler::entryPoint));
+    }
+#else
+    (void)path;
+    throw RuntimeError("The C backend needs dlopen");
+#endif
+}
+
+SharedLibrary::SharedLibrary(SharedLibrary &&other) noexcept
+  : handle(std::exchange(other.handle, nullptr)), entry(std::exchange(other.entry, nullptr)) {}
+
+SharedLibrary &SharedLibrary::operator=(SharedLibrary &&other) noexcept {
+    if(this != &other) {
+        release();
+        handle = std::exchange(other.handle, nullptr);
+        entry = std::exchange(other.entry, nullptr);
+    }
+    return *this;
+}
+
+SharedLibrary::~SharedLibrary() { release(); }
+
+void SharedLibrary::release() noexcept {
+#ifdef DERSBIANDER_C_BACKEND
+    if(handle != nullptr) { dlclose(handle); }
+#endif
+    handle = nullptr;
+    entry = nullptr;
+}
+
+int SharedLibrary::operator()(Value *registers) const {
+    if(entry == nullptr) [[unlikely]] { throw RuntimeError("Running an empty shared library"); }
+    return entry(registers);
+}
+
+CBuildCache::CBuildCache(std::filesystem::path cacheDirectory, std::string compilerCommand)
+  : directory(std::move(cacheDirectory)), compiler(std::move(compilerCommand)) {
+#ifdef DERSBIANDER_C_BACKEND
+    version = compilerVersion(compiler);
+#endif
+}
+
+/// `$XDG_CACHE_HOME/dersbiander`, or `~/.cache/dersbiander`: a directory of the user, never one shared in /tmp.
+std::filesystem::path CBuildCache::defaultDirectory() {
+    // NOLINTBEGIN(concurrency-mt-unsafe)
+    if(const char *cacheHome = std::getenv("XDG_CACHE_HOME"); cacheHome != nullptr && std::filesystem::path(cacheHome).is_absolute()) {
+        return std::filesystem::path(cacheHome) / "dersbiander";
+    }
+    const char *home = std::getenv("HOME");
+    // NOLINTEND(concurrency-mt-unsafe)
+    if(home == nullptr || *home == '\0') [[unlikely]] { throw RuntimeError("Neither XDG_CACHE_HOME nor HOME is set"); }
+    return std::filesystem::path(home) / ".cache" / "dersbiander";
+}
+
+/// Only objects the user owns are loaded: anything else in the directory is refused rather than run.
+SharedLibrary CBuildCache::load(std::string_view source) {
+    prepareDirectory();
+    const std::filesystem::path object = objectPath(source);
+    hit = std::filesystem::exists(std::filesystem::symlink_status(object));
+    if(hit) {
+#ifdef DERSBIANDER_C_BACKEND
+        requireOwned(object, S_IFREG);
+#endif
+    } else {
+        build(source, object);
+    }
+    return SharedLibrary(object);
+}
+
+/// Creates the cache directory readable by its owner only, and refuses an existing one that someone else controls.
+void CBuildCache::prepareDirectory() const {
+#ifdef DERSBIANDER_C_BACKEND
+    if(directory.has_parent_path()) { std::filesystem::create_directories(directory.parent_path()); }
+    if(::mkdir(directory.c_str(), S_IRWXU) != 0 && errno != EEXIST) [[unlikely]] {
+        throw RuntimeError(FORMAT("Unable to create {}: {}", directory.string(), std::strerror(errno)));  // NOLINT(*-mt-unsafe)
+    }
+    requireOwned(directory, S_IFDIR);
+#endif
+}
+
+std::filesystem::path CBuildCache::objectPath(std::string_view source) const {
+    return directory / FORMAT("{:016x}.so", hash(source));
+}
+
+/// FNV-1a over the compiler command, its version and the source: changing any of them gives another object.
+std::uint64_t CBuildCache::hash(std::string_view source) const noexcept {
+    std::uint64_t result = fnvOffset;
+    for(const std::string_view part : {std::string_view{compiler}, std::string_view{"\n"}, std::string_view{version},
+                                       std::string_view{"\n"}, source}) {
+        for(const char character : part) {
+            result ^= static_cast<unsigned char>(character);
+            result *= fnvPrime;
+        }
+    }
+    return result;
+}
+
+void CBuildCache::build(std::string_view source, const std::filesystem::path &object) const {
+#ifdef DERSBIANDER_C_BACKEND
+    // Every process writes its own files: only the final rename publishes the object.
+    const std::string unique = FORMAT("{}.{}", object.stem().string(), getpid());
+    const std::filesystem::path sourcePath = directory / FORMAT("{}.c", unique);
+    const std::filesystem::path temporary = directory / FORMAT("{}.so.tmp", unique);
+    const std::filesystem::path log = directory / FORMAT("{}.log", unique);
+    {
+        std::ofstream stream(sourcePath, std::ios::out | std::ios::binary | std::ios::trunc);
+        stream << source;
+        if(!stream) [[unlikely]] { throw RuntimeError(FORMAT("Unable to write {}", sourcePath.string())); }
+    }
+    const std::string command = FORMAT("{} -fwrapv -shared -fPIC -o {} {} -lm > {} 2>&1", compiler, shellQuoted(temporary),
+                                       shellQuoted(sourcePath), shellQuoted(log));
+    const int status = std::system(command.c_str());  // NOLINT(*-env33-c, concurrency-mt-unsafe)
+    std::error_code ignored;
+    if(status != 0) [[unlikely]] {
+        const std::string output = readAll(log);
+        std::filesystem::remove(temporary, ignored);
+        std::filesystem::remove(log, ignored);
+        throw RuntimeError(FORMAT("{} failed on {}:{}{}", compiler, sourcePath.string(), CNL, output));
+    }
+    std::filesystem::rename(temporary, object);
+    std::filesystem::remove(sourcePath, ignored);
+    std::filesystem::remove(log, ignored);
+#else
+    (void)source;
+    (void)object;
+    throw RuntimeError("The C backend needs a Unix system compiler");
+#endif
+}
+
+DISABLE_WARNINGS_POP()
@@ -0,0 +1,548 @@
+#include "Dersbiander/CTranspiler.hpp"
+#include "Dersbiander/Bytecode.hpp"
+#include "Dersbiander/Profiler.hpp"
+#include <charconv>
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+namespace {
+    // The helpers every program shares. dsb_value has the layout of Value, -fwrapv makes integers wrap around like in
+    // the interpreter and a division by zero or an index out of bounds leaves the entry point through dsb_abort, with
+    // the CTranspiler::divisionByZero or CTranspiler::indexOutOfBounds result.
+    constexpr std::string_view prelude = R"(#include <math.h>
+#include <setjmp.h>
+#include <stdbool.h>
+#include <string.h>
+
+typedef struct {
+    unsigned char kind;
+    union {
+        bool boolean;
+        long long integer;
+        double real;
+    } as;
+} dsb_value;
+
+static jmp_buf dsb_abort;
+
+static long long dsb_div(long long left, long long right) {
+    if(right == 0) { longjmp(dsb_abort, 1); }
+    return right == -1 ? -left : left / right;
+}
+
+static long long dsb_index(long long index, long long length) {
+    if(index < 0 || index >= length) { longjmp(dsb_abort, 2); }
+    return index;
+}
+
+static long long dsb_ipow(long long base, long long exponent) {
+    unsigned long long factor = (unsigned long long)base;
+    unsigned long long result = 1;
+    for(; exponent > 0; exponent >>= 1) {
+        if((exponent & 1) != 0) { result *= factor; }
+        factor *= factor;
+    }
+    return (long long)result;
+}
+
+)";
+
+    [[nodiscard]] std::string_view scalarType(TypeId type) noexcept {
+        switch(type) {
+        case TypeTable::boolType:
+            return "bool";
+        case TypeTable::charType:
+            return "char";
+        case TypeTable::intType:
+            return "long long";
+        case TypeTable::doubleType:
+            return "double";
+        default:
+            return {};
+        }
+    }
+
+    [[nodiscard]] bool isComparison(std::string_view oper) noexcept {
+        return oper == "==" || oper == "!=" || oper == "<" || oper == "<=" || oper == ">" || oper == ">=";
+    }
+}  // namespace
+
+CTranspiler::CTranspiler(const Ast &tree, const NameResolver &resolver, const TypeChecker &checker)
+  : ast(tree), names(resolver), types(checker) {}
+
+std::vector<Diagnostic> CTranspiler::transpile() {
+    PROFILE_ZONE("transpile to C");
+    diagnostics.clear();
+    variables.clear();
+    contexts.clear();
+    const std::size_t symbolCount = names.getSymbols().symbolCount();
+    owners.assign(symbolCount, noContext);
+    contexts.push_back(Context{invalidNode, {}});
+    if(ast.getRoot() != invalidNode) { collect(ast.getRoot(), 0); }
+
+    std::string prototypes;
+    std::string definitions;
+    std::vector<bool> defined(symbolCount, false);
+    for(std::uint32_t context = 1; context < contexts.size(); ++context) {
+        const std::uint32_t token = ast.node(contexts[context].function).token;
+        const SymbolIndex symbol = names.binding(token);
+        if(symbol == noSymbol) { continue; }
+        if(defined[symbol]) {
+            unsupported(token, "overloaded functions");
+            continue;
+        }
+        defined[symbol] = true;
+        const std::string header = signature(contexts[context]);
+        prototypes.append(FORMAT("{};{}", header, CNL));
+        definitions.append(FORMAT("{}{} {{{}{}}}{}", CNL, header, CNL, body(context), CNL));
+    }
+    source = FORMAT("{}{}{}int {}(dsb_value *registers) {{{}{}}}{}", prelude, prototypes, definitions, entryPoint, CNL, body(0), CNL);
+    return std::move(diagnostics);
+}
+
+/// Records which function owns every parameter and declared name: nested functions start a context of their own.
+void CTranspiler::collect(NodeIndex index, std::uint32_t context) {
+    const auto children = ast.children(index);
+    switch(ast.node(index).kind) {
+        using enum AstKind;
+    case FUNCTION: {
+        const auto function = C_UI32T(contexts.size());
+        contexts.push_back(Context{index, {}});
+        for(const NodeIndex parameter : ast.children(children[0])) {
+            const SymbolIndex symbol = names.binding(ast.node(parameter).token);
+            if(symbol != noSymbol) { owners[symbol] = function; }
+        }
+        collect(children[2], function);
+        break;
+    }
+    case DECLARATION:
+        for(const NodeIndex name : ast.children(children[0])) {
+            const SymbolIndex symbol = names.binding(ast.node(name).token);
+            if(symbol == noSymbol) { continue; }
+            owners[symbol] = context;
+            contexts[context].locals.push_back(symbol);
+        }
+        break;
+    case EXPRESSION:
+        break;
+    default:
+        for(const NodeIndex child : children) { collect(child, context); }
+        break;
+    }
+}
+
+std::string CTranspiler::signature(const Context &context) {
+    const std::uint32_t token = ast.node(context.function).token;
+    const SymbolIndex symbol = names.binding(token);
+    const auto returns = types.returnTypes(symbol);
+    std::string_view result = "void";
+    if(returns.size() > 1) {
+        unsupported(token, "multiple return values");
+    } else if(returns.size() == 1) {
+        result = scalarType(returns.front());
+        if(result.empty()) { unsupported(token, FORMAT("returning {}", types.getTypes().to_string(returns.front()))); }
+    }
+    std::vector<std::string> parameters;
+    for(const NodeIndex parameter : ast.children(ast.children(context.function)[0])) {
+        const SymbolIndex parameterSymbol = names.binding(ast.node(parameter).token);
+        if(parameterSymbol == noSymbol) { continue; }
+        const TypeId type = types.symbolType(parameterSymbol);
+        std::string declaration = declarator(type, symbolName(parameterSymbol));
+        if(declaration.empty()) { unsupported(ast.node(parameter).token, FORMAT("parameters of type {}", types.getTypes().to_string(type))); }
+        parameters.push_back(std::move(declaration));
+    }
+    if(parameters.empty()) { parameters.emplace_back("void"); }
+    return FORMAT("static {} {}({})", result, symbolName(symbol), FMT_JOIN(parameters, ", "));
+}
+
+std::string CTranspiler::body(std::uint32_t context) {
+    current = context;
+    depth = 1;
+    code.clear();
+    for(const SymbolIndex symbol : contexts[context].locals) {
+        const TypeId type = types.symbolType(symbol);
+        const std::string declaration = declarator(type, symbolName(symbol));
+        if(declaration.empty()) {
+            unsupported(names.getSymbols().symbol(symbol).token, FORMAT("variables of type {}", types.getTypes().to_string(type)));
+            continue;
+        }
+        line(FORMAT("{} = {};", declaration, TypeTable::isScalar(type) ? "0" : "{0}"));
+    }
+    if(context == 0) {
+        // setjmp() may only be the whole controlling expression of a switch, not a value to store.
+        line(FORMAT("switch(setjmp(dsb_abort)) {{ case 0: break; case {0}: return {0}; default: return {1}; }}", divisionByZero,
+                    indexOutOfBounds));
+        if(ast.getRoot() != invalidNode) { emitNode(ast.getRoot()); }
+        emitExports();
+        line("return 0;");
+    } else {
+        const NodeIndex function = contexts[context].function;
+        const auto statements = ast.children(ast.children(function)[2]);
+        for(const NodeIndex statement : statements) { emitNode(statement); }
+        const bool returns = !statements.empty() && ast.node(statements.back()).kind == AstKind::RETURN;
+        if(!returns && types.returnTypes(names.binding(ast.node(function).token)).size() == 1) { line("return 0;"); }
+    }
+    return std::exchange(code, {});
+}
+
+/// The scalar variables of the entry point are written back with their kind, like the registers of the interpreter.
+void CTranspiler::emitExports() {
+    for(const SymbolIndex symbol : contexts.front().locals) {
+        const TypeId type = types.symbolType(symbol);
+        if(!TypeTable::isScalar(type)) { continue; }
+        const ValueKind kind = type == TypeTable::doubleType ? ValueKind::DOUBLE : (type == TypeTable::boolType ? ValueKind::BOOL : ValueKind::INT);
+        const std::string_view field = kind == ValueKind::DOUBLE ? "real" : (kind == ValueKind::BOOL ? "boolean" : "integer");
+        line(FORMAT("registers[{}].kind = {};", symbol, static_cast<int>(kind)));
+        line(FORMAT("registers[{}].as.{} = {};", symbol, field, symbolName(symbol)));
+        variables.emplace_back(ast.getTokens()[names.getSymbols().symbol(symbol).token].getValue(), symbol);
+    }
+}
+
+void CTranspiler::emitNode(NodeIndex index) {
+    switch(ast.node(index).kind) {
+        using enum AstKind;
+    case DECLARATION:
+        emitDeclaration(index);
+        break;
+    case ASSIGNMENT:
+        emitAssignment(index);
+        break;
+    case FOR:
+        emitFor(index);
+        break;
+    case STRUCTURE:
+        emitStructure(index);
+        break;
+    case FUNCTION:
+        break;
+    case RETURN:
+        emitReturn(index);
+        break;
+    case BLOCK:
+        emitBlock(index);
+        break;
+    case EXPRESSION:
+        line(FORMAT("{};", expression(index).text));
+        break;
+    default:
+        for(const NodeIndex child : ast.children(index)) { emitNode(child); }
+        break;
+    }
+}
+
+void CTranspiler::emitBlock(NodeIndex index) {
+    line("{");
+    ++depth;
+    for(const NodeIndex child : ast.children(index)) { emitNode(child); }
+    --depth;
+    line("}");
+}
+
+/// Declared names live for the whole function, so a declaration is an assignment: without values, of the zero value.
+void CTranspiler::emitDeclaration(NodeIndex index) {
+    const auto children = ast.children(index);
+    const auto declared = ast.children(children[0]);
+    const auto values = ast.children(children[2]);
+    for(std::size_t i = 0; i < declared.size(); ++i) {
+        const std::uint32_t token = ast.node(declared[i]).token;
+        const Operand target = variable(token);
+        if(values.empty()) {
+            line(TypeTable::isScalar(target.type) ? FORMAT("{} = 0;", target.text) : FORMAT("memset({0}, 0, sizeof({0}));", target.text));
+        } else if(values.size() == 1 && i > 0) {
+            emitStore(target, variable(ast.node(declared[0]).token), token);
+        } else {
+            emitStore(target, expression(values[std::min(i, values.size() - 1)]), token);
+        }
+    }
+}
+
+/// Multiple targets are assigned in parallel: every value is evaluated into a temporary before the first target changes.
+void CTranspiler::emitAssignment(NodeIndex index) {
+    const auto children = ast.children(index);
+    const auto targets = ast.children(children[0]);
+    const auto values = ast.children(children[1]);
+    const std::uint32_t oper = ast.node(index).token;
+    std::vector<Operand> targetOperands;
+    targetOperands.reserve(targets.size());
+    for(const NodeIndex target : targets) { targetOperands.push_back(expression(target)); }
+    if(ast.getTokens()[oper].getType() == TokenType::OPERATION_EQUAL) {
+        // `+=` is the operator followed by '='.
+        const std::string_view symbol = std::string_view{ast.getTokens()[oper].getValue()}.substr(0, 1);
+        for(const Operand &target : targetOperands) {
+            line(FORMAT("{} = {};", target.text, binary(oper, symbol, target, expression(values.front())).text));
+        }
+        return;
+    }
+    if(targetOperands.size() == 1 && values.size() == 1) {
+        emitStore(targetOperands.front(), expression(values.front()), oper);
+        return;
+    }
+    line("{");
+    ++depth;
+    std::vector<Operand> temporaries;
+    temporaries.reserve(values.size());
+    for(const NodeIndex value : values) {
+        const Operand computed = expression(value);
+        if(!TypeTable::isScalar(computed.type)) { unsupported(ast.node(value).token, "arrays in a parallel assignment"); }
+        temporaries.push_back(Operand{FORMAT("t{}", temporaries.size()), computed.type});
+        line(FORMAT("{} = {};", declarator(computed.type, temporaries.back().text), computed.text));
+    }
+    for(std::size_t i = 0; i < targetOperands.size(); ++i) {
+        emitStore(targetOperands[i], temporaries[std::min(i, temporaries.size() - 1)], oper);
+    }
+    --depth;
+    line("}");
+}
+
+/// `for i = start, condition, step` runs while a bool condition holds, or while `i` is below a numeric one.
+void CTranspiler::emitFor(NodeIndex index) {
+    const auto children = ast.children(index);
+    emitNode(children[0]);
+    const NodeIndex name = ast.children(ast.children(children[0])[0])[0];
+    const std::uint32_t nameToken = ast.node(name).token;
+    const Operand loopVariable = variable(nameToken);
+    std::string condition;
+    if(ast.node(children[1]).kind != AstKind::EMPTY) {
+        const Operand bound = expression(children[1]);
+        condition = bound.type == TypeTable::boolType ? bound.text : FORMAT("{} < {}", loopVariable.text, bound.text);
+    }
+    const std::string step = ast.node(children[2]).kind == AstKind::EMPTY ? "1" : expression(children[2]).text;
+    line(FORMAT("for(; {}; {} += {}) {{", condition, loopVariable.text, step));
+    ++depth;
+    for(const NodeIndex statement : ast.children(children[3])) { emitNode(statement); }
+    --depth;
+    line("}");
+}
+
+/// `if` and `while` have the same meaning in C.
+void CTranspiler::emitStructure(NodeIndex index) {
+    const auto children = ast.children(index);
+    line(FORMAT("{}({}) {{", ast.token(index).getValue(), expression(children[0]).text));
+    ++depth;
+    for(const NodeIndex statement : ast.children(children[1])) { emitNode(statement); }
+    --depth;
+    line("}");
+}
+
+void CTranspiler::emitReturn(NodeIndex index) {
+    const std::uint32_t token = ast.node(index).token;
+    const auto values = ast.children(index);
+    if(current == 0) {
+        unsupported(token, "return outside a function");
+    } else if(values.empty()) {
+        line("return;");
+    } else if(values.size() > 1) {
+        unsupported(token, "multiple return values");
+    } else if(types.returnTypes(names.binding(ast.node(contexts[current].function).token)).empty()) {
+        unsupported(token, "returning a value from a function without return types");
+    } else {
+        line(FORMAT("return {};", expression(values.front()).text));
+    }
+}
+
+/// Arrays are copied with memcpy, array literals through a compound literal of the target type.
+void CTranspiler::emitStore(const Operand &target, const Operand &value, std::uint32_t token) {
+    if(target.function != noSymbol) {
+        unsupported(token, "assignment to a function");
+    } else if(TypeTable::isScalar(target.type)) {
+        if(value.initializer) { unsupported(token, "array literal assigned to a scalar"); }
+        line(FORMAT("{} = {};", target.text, value.text));
+    } else if(types.getTypes().get(target.type).kind != TypeKind::ARRAY) {
+        unsupported(token, FORMAT("assignment to {}", types.getTypes().to_string(target.type)));
+    } else if(value.initializer) {
+        line(FORMAT("memcpy({0}, ({1}){2}, sizeof({0}));", target.text, declarator(target.type, ""), value.text));
+    } else {
+        line(FORMAT("memcpy({0}, {1}, sizeof({0}));", target.text, value.text));
+    }
+}
+
+/// Rebuilds an infix C expression from the postfix code, fully parenthesized so C precedences never matter.
+CTranspiler::Operand CTranspiler::expression(NodeIndex index) {
+    operands.clear();
+    for(const PostfixOp &oper : ast.code(index)) {
+        const Token &token = ast.getTokens()[oper.token];
+        const std::size_t base = operands.size() - std::min<std::size_t>(oper.arity, operands.size());
+        const std::span<const Operand> values{operands.data() + base, operands.size() - base};
+        Operand result{"0", TypeTable::unknownType};
+        switch(oper.kind) {
+            using enum PostfixKind;
+        case IDENTIFIER:
+            result = variable(oper.token);
+            break;
+        case LITERAL:
+            result = literal(oper.token);
+            break;
+        case UNARY:
+            [[fallthrough]];
+        case POSTFIX:
+            if(values.size() != 1 || !TypeTable::isScalar(values[0].type)) {
+                unsupported(oper.token, FORMAT("operator {} on {}", token.getValue(), types.getTypes().to_string(values.empty() ? 0 : values[0].type)));
+            } else if(oper.kind == POSTFIX) {
+                result = Operand{FORMAT("({}{})", values[0].text, token.getValue()), values[0].type};
+            } else if(token.getType() == TokenType::NOT_OPERATOR) {
+                result = Operand{FORMAT("(!{})", values[0].text), TypeTable::boolType};
+            } else {
+                const bool widen = values[0].type < TypeTable::intType;
+                result = Operand{FORMAT("(-{}{})", widen ? "(long long)" : "", values[0].text), std::max(values[0].type, TypeTable::intType)};
+            }
+            break;
+        case BINARY:
+            if(values.size() == 2) { result = binary(oper.token, token.getValue(), values[0], values[1]); }
+            break;
+        case INDEX: {
+            const TypeId array = values.size() == 2 ? values[0].type : TypeTable::unknownType;
+            if(types.getTypes().get(array).kind != TypeKind::ARRAY) {
+                unsupported(oper.token, FORMAT("indexing {}", types.getTypes().to_string(array)));
+            } else {
+                // The arrays the transpiler declares have a known length: only literals below it go unchecked.
+                const TypeDescriptor &descriptor = types.getTypes().get(array);
+                const auto length = static_cast<std::int64_t>(descriptor.length);
+                const std::string position = values[1].integer >= 0 && values[1].integer < length
+                                                 ? values[1].text
+                                                 : FORMAT("dsb_index({}, {}LL)", values[1].text, length);
+                result = Operand{FORMAT("{}[{}]", values[0].text, position), descriptor.element};
+            }
+            break;
+        }
+        case CALL:
+            result = call(oper.token, values);
+            break;
+        case ARRAY: {
+            std::vector<std::string_view> elements;
+            for(const Operand &element : values) {
+                if(!element.initializer && !TypeTable::isScalar(element.type)) { unsupported(oper.token, "arrays inside an array literal"); }
+                elements.push_back(element.text);
+            }
+            result = Operand{FORMAT("{{{}}}", FMT_JOIN(elements, ", ")), TypeTable::unknownType, noSymbol, true};
+            break;
+        }
+        default:
+            unsupported(oper.token, FORMAT("{}", oper.kind));
+            break;
+        }
+        operands.resize(base);
+        operands.push_back(std::move(result));
+    }
+    if(operands.empty()) { return Operand{"0", TypeTable::intType}; }
+    if(operands.size() == 1 && operands.back().initializer) { return operands.back(); }
+    for(const Operand &operand : operands) {
+        if(operand.initializer) { unsupported(ast.node(index).token, "array literal outside a declaration or an assignment"); }
+    }
+    return operands.back();
+}
+
+/// Functions become an operand with no text, everything else is a variable the current function owns.
+CTranspiler::Operand CTranspiler::variable(std::uint32_t token) {
+    const SymbolIndex symbol = names.binding(token);
+    if(symbol == noSymbol) [[unlikely]] {
+        unsupported(token, "unresolved names");
+        return Operand{"0", TypeTable::unknownType};
+    }
+    if(names.getSymbols().symbol(symbol).kind == SymbolKind::FUNCTION) { return Operand{"", TypeTable::unknownType, symbol}; }
+    if(owners[symbol] != current) { unsupported(token, "variables of an enclosing block"); }
+    return Operand{symbolName(symbol), types.symbolType(symbol)};
+}
+
+CTranspiler::Operand CTranspiler::literal(std::uint32_t token) {
+    const Token &lexeme = ast.getTokens()[token];
+    const std::string &value = lexeme.getValue();
+    switch(lexeme.getType()) {
+        using enum TokenType;
+    case BOOLEAN:
+        return Operand{value == "true" ? "true" : "false", TypeTable::boolType};
+    case CHAR:
+        // The tokenizer strips the apostrophes, the escapes are those of C. The empty '' is the character 0.
+        return Operand{value.empty() ? "0" : FORMAT("'{}'", value), TypeTable::charType};
+    case INTEGER:
+        if(std::int64_t result = 0; std::from_chars(value.data(), value.data() + value.size(), result).ec == std::errc{}) {
+            Operand operand{FORMAT("{}LL", result), TypeTable::intType};
+            operand.integer = result;
+            return operand;
+        }
+        [[fallthrough]];
+    case DOUBLE: {
+        const double result = std::strtod(value.c_str(), nullptr);
+        if(std::isinf(result)) { return Operand{"HUGE_VAL", TypeTable::doubleType}; }
+        std::string text = FORMAT("{:.17g}", result);
+        if(text.find_first_of(".e") == std::string::npos) { text.append(".0"); }
+        return Operand{text, TypeTable::doubleType};
+    }
+    default:
+        unsupported(token, "strings");
+        return Operand{"0", TypeTable::stringType};
+    }
+}
+
+/// Arithmetic promotes like the TypeChecker: integral operands are widened to 64 bits before C can promote them to int.
+CTranspiler::Operand CTranspiler::binary(std::uint32_t token, std::string_view oper, const Operand &left, const Operand &right) {
+    if(!TypeTable::isScalar(left.type) || !TypeTable::isScalar(right.type)) {
+        unsupported(token, FORMAT("operator {} on {} and {}", oper, types.getTypes().to_string(left.type), types.getTypes().to_string(right.type)));
+        return Operand{"0", TypeTable::unknownType};
+    }
+    // The interpreter evaluates both sides of && and ||: & and | keep a division by zero on the right from being skipped.
+    if(oper == "&&" || oper == "||") {
+        return Operand{FORMAT("((bool)({}) {} (bool)({}))", left.text, oper.front(), right.text), TypeTable::boolType};
+    }
+    if(isComparison(oper)) { return Operand{FORMAT("({} {} {})", left.text, oper, right.text), TypeTable::boolType}; }
+    const TypeId type = std::max({left.type, right.type, TypeTable::intType});
+    const auto widen = [](const Operand &operand) {
+        return operand.type < TypeTable::intType ? FORMAT("(long long){}", operand.text) : operand.text;
+    };
+    if(oper == "/" && type == TypeTable::intType) { return Operand{FORMAT("dsb_div({}, {})", left.text, right.text), type}; }
+    if(oper == "^" && type == TypeTable::intType) {
+        // As in the NativeCompiler: the interpreter gives a double for a negative exponent, only literals stay integers.
+        if(right.integer < 0) {
+            unsupported(token, "integer power with a variable exponent");
+            return Operand{"0", TypeTable::unknownType};
+        }
+        return Operand{FORMAT("dsb_ipow({}, {})", left.text, right.text), type};
+    }
+    if(oper == "^") { return Operand{FORMAT("pow({}, {})", left.text, right.text), type}; }
+    return Operand{FORMAT("({} {} {})", widen(left), oper, widen(right)), type};
+}
+
+CTranspiler::Operand CTranspiler::call(std::uint32_t token, std::span<const Operand> values) {
+    if(values.empty() || values.front().function == noSymbol) {
+        unsupported(token, "calling a value that is not a function");
+        return Operand{"0", TypeTable::unknownType};
+    }
+    std::vector<std::string_view> arguments;
+    for(const Operand &argument : values.subspan(1)) {
+        if(argument.initializer) { unsupported(token, "array literal as an argument"); }
+        arguments.push_back(argument.text);
+    }
+    const SymbolIndex function = values.front().function;
+    const auto returns = types.returnTypes(function);
+    return Operand{FORMAT("{}({})", symbolName(function), FMT_JOIN(arguments, ", ")),
+                   returns.size() == 1 ? returns.front() : TypeTable::unknownType};
+}
+
+std::string CTranspiler::declarator(TypeId type, std::string_view name) const {
+    std::string dimensions;
+    while(types.getTypes().get(type).kind == TypeKind::ARRAY) {
+        const TypeDescriptor &array = types.getTypes().get(type);
+        if(array.length == TypeTable::dynamicLength) { return {}; }
+        dimensions.append(FORMAT("[{}]", array.length));
+        type = array.element;
+    }
+    const std::string_view base = scalarType(type);
+    if(base.empty()) { return {}; }
+    return FORMAT("{}{}{}{}", base, name.empty() ? "" : " ", name, dimensions);
+}
+
+std::string CTranspiler::symbolName(SymbolIndex symbol) const {
+    const Symbol &declared = names.getSymbols().symbol(symbol);
+    return FORMAT("{}{}_{}", declared.kind == SymbolKind::FUNCTION ? 'f' : 'v', symbol, ast.getTokens()[declared.token].getValue());
+}
+
+void CTranspiler::line(std::string_view text) {
+    code.append(depth * 4, ' ');
+    code.append(text);
+    code.push_back(CNL);
+}
+
+void CTranspiler::unsupported(std::uint32_t token, std::string_view what) {
+    diagnostics.emplace_back(DiagnosticKind::UNSUPPORTED, ast.getTokens()[token], FORMAT("{} in the C transpiler", what));
+}
+
+DISABLE_WARNINGS_POP()
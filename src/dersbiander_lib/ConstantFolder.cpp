@@ -0,0 +1,199 @@
+#include "Dersbiander/ConstantFolder.hpp"
+#include "Dersbiander/Profiler.hpp"
+#include "Dersbiander/VirtualMachine.hpp"
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+namespace {
+    /// Characters of a string literal: the quotes do not count and an escape sequence is one character.
+    [[nodiscard]] std::uint32_t stringLength(std::string_view value) noexcept {
+        if(value.size() >= 2) { value = value.substr(1, value.size() - 2); }
+        std::uint32_t length = 0;
+        for(std::size_t i = 0; i < value.size(); ++i, ++length) {
+            if(value[i] == '\\') { ++i; }
+        }
+        return length;
+    }
+}  // namespace
+
+ConstantFolder::ConstantFolder(const Ast &tree, const NameResolver &resolver) : ast(tree), names(resolver) {}
+
+std::vector<Diagnostic> ConstantFolder::fold() {
+    PROFILE_ZONE("fold constants");
+    diagnostics.clear();
+    foldedCount = 0;
+    std::size_t postfixSize = 0;
+    for(NodeIndex index = 0; index < ast.size(); ++index) {
+        const AstNode &node = ast.node(index);
+        if(node.kind == AstKind::EXPRESSION) { postfixSize = std::max<std::size_t>(postfixSize, node.firstChild + node.childCount); }
+    }
+    foldAt.assign(postfixSize, std::nullopt);
+    constants.assign(names.getSymbols().symbolCount(), std::nullopt);
+    lengths.assign(names.getSymbols().symbolCount(), unknownLength);
+    if(ast.getRoot() != invalidNode) { foldNode(ast.getRoot()); }
+    return std::move(diagnostics);
+}
+
+const ConstantFolder::Folded *ConstantFolder::folded(NodeIndex expression, std::size_t position) const noexcept {
+    const std::size_t index = ast.node(expression).firstChild + position;
+    if(index >= foldAt.size() || !foldAt[index]) { return nullptr; }
+    return &*foldAt[index];
+}
+
+std::optional<Value> ConstantFolder::value(NodeIndex expression) const noexcept {
+    const AstNode &node = ast.node(expression);
+    if(node.kind != AstKind::EXPRESSION || node.childCount == 0) { return std::nullopt; }
+    const Folded *whole = folded(expression, 0);
+    if(whole == nullptr || whole->last + 1 != node.childCount) { return std::nullopt; }
+    return whole->value;
+}
+
+/// Children are folded in source order, so a constant is known before the statements after its declaration.
+void ConstantFolder::foldNode(NodeIndex index) {
+    switch(ast.node(index).kind) {
+        using enum AstKind;
+    case EXPRESSION:
+        foldExpression(index);
+        break;
+    case DECLARATION:
+        foldDeclaration(index);
+        break;
+    default:
+        for(const NodeIndex child : ast.children(index)) { foldNode(child); }
+        break;
+    }
+}
+
+/// Fixed dimensions give their variables a length, `const` names with a constant value become that value.
+void ConstantFolder::foldDeclaration(NodeIndex index) {
+    const auto children = ast.children(index);
+    for(const NodeIndex child : children) { foldNode(child); }
+    const auto declared = ast.children(children[0]);
+    const auto dimensions = ast.children(children[1]);
+    const auto values = ast.children(children[2]);
+    const bool constant = ast.token(index).getValue() == "const";
+    std::uint32_t length = unknownLength;
+    if(!dimensions.empty()) {
+        const std::optional<Value> dimension = value(dimensions.front());
+        if(dimension && dimension->kind == ValueKind::INT && dimension->integer >= 0 && dimension->integer < unknownLength) {
+            length = C_UI32T(dimension->integer);
+        }
+    }
+    for(std::size_t i = 0; i < declared.size(); ++i) {
+        const SymbolIndex symbol = names.binding(ast.node(declared[i]).token);
+        if(symbol == noSymbol) { continue; }
+        lengths[symbol] = length;
+        if(!constant || values.empty()) { continue; }
+        const NodeIndex initializer = values[std::min(i, values.size() - 1)];
+        constants[symbol] = value(initializer);
+        if(dimensions.empty()) { lengths[symbol] = lengthOf(initializer); }
+    }
+}
+
+void ConstantFolder::foldExpression(NodeIndex index) {
+    const std::uint32_t first = ast.node(index).firstChild;
+    const auto code = ast.code(index);
+    stack.clear();
+    for(std::uint32_t position = 0; position < code.size(); ++position) {
+        const PostfixOp &oper = code[position];
+        const std::size_t base = stack.size() - std::min<std::size_t>(oper.arity, stack.size());
+        Operand result = apply(oper, position, std::span<const Operand>{stack.data() + base, stack.size() - base});
+        stack.resize(base);
+        // A larger constant subtree starting at the same operation replaces the smaller one recorded before it.
+        if(result.value) { foldAt[first + result.start] = Folded{position, *result.value}; }
+        stack.push_back(result);
+    }
+}
+
+ConstantFolder::Operand ConstantFolder::apply(const PostfixOp &oper, std::uint32_t position, std::span<const Operand> operands) {
+    Operand result{std::nullopt, operands.empty() ? position : operands.front().start};
+    const Token &token = ast.getTokens()[oper.token];
+    switch(oper.kind) {
+        using enum PostfixKind;
+    case LITERAL:
+        if(token.getType() == TokenType::STRING) {
+            result.length = stringLength(token.getValue());
+        } else {
+            result.value = literalValue(token);
+        }
+        break;
+    case IDENTIFIER:
+        if(const SymbolIndex symbol = names.binding(oper.token); symbol != noSymbol) {
+            result.value = constants[symbol];
+            result.length = lengths[symbol];
+            if(result.value) { ++foldedCount; }
+        }
+        break;
+    case UNARY:
+        if(operands.size() == 1 && operands[0].value) {
+            const OpCode op = token.getType() == TokenType::NOT_OPERATOR ? OpCode::NOT : OpCode::NEG;
+            result.value = evaluate(oper.token, op, *operands[0].value, Value{});
+        }
+        break;
+    case BINARY:
+        if(const auto op = binaryOpCode(token.getValue()); op && operands.size() == 2 && operands[0].value && operands[1].value) {
+            result.value = evaluate(oper.token, *op, *operands[0].value, *operands[1].value);
+        }
+        break;
+    case INDEX:
+        if(operands.size() == 2 && operands[1].value) { checkIndex(oper.token, operands[0], *operands[1].value); }
+        break;
+    case MEMBER:
+        if(operands.size() == 1 && operands[0].length != unknownLength && token.getValue() == "len") {
+            result.length = operands[0].length;
+            result.lengthMember = true;
+        }
+        break;
+    case CALL:
+        if(operands.size() == 1 && operands[0].lengthMember) {
+            result.value = Value::fromInt(operands[0].length);
+            ++foldedCount;
+        }
+        break;
+    case ARRAY:
+        result.length = oper.arity;
+        break;
+    default:
+        break;
+    }
+    return result;
+}
+
+std::optional<Value> ConstantFolder::evaluate(std::uint32_t token, OpCode op, const Value &left, const Value &right) {
+    try {
+        const Value result = VirtualMachine::evaluate(op, left, right);
+        ++foldedCount;
+        return result;
+    } catch(const RuntimeError &error) {
+        diagnostics.emplace_back(DiagnosticKind::CONSTANT_ERROR, ast.getTokens()[token], error.what());
+        return std::nullopt;
+    }
+}
+
+void ConstantFolder::checkIndex(std::uint32_t token, const Operand &base, const Value &position) {
+    if(position.kind == ValueKind::DOUBLE) { return; }
+    const std::int64_t index = position.asInt();
+    if(index < 0) {
+        diagnostics.emplace_back(DiagnosticKind::CONSTANT_ERROR, ast.getTokens()[token], FORMAT("negative index {}", index));
+    } else if(base.length != unknownLength && index >= base.length) {
+        diagnostics.emplace_back(DiagnosticKind::CONSTANT_ERROR, ast.getTokens()[token],
+                                 FORMAT("index {} out of range for length {}", index, base.length));
+    }
+}
+
+std::uint32_t ConstantFolder::lengthOf(NodeIndex index) const noexcept {
+    if(ast.node(index).kind != AstKind::EXPRESSION) { return unknownLength; }
+    const auto code = ast.code(index);
+    if(code.empty()) { return unknownLength; }
+    // The operation emitted last is the root of the expression.
+    const PostfixOp &root = code.back();
+    if(root.kind == PostfixKind::ARRAY) { return root.arity; }
+    if(code.size() != 1) { return unknownLength; }
+    if(root.kind == PostfixKind::LITERAL && ast.getTokens()[root.token].getType() == TokenType::STRING) {
+        return stringLength(ast.getTokens()[root.token].getValue());
+    }
+    if(root.kind == PostfixKind::IDENTIFIER && names.binding(root.token) != noSymbol) { return lengths[names.binding(root.token)]; }
+    return unknownLength;
+}
+
+DISABLE_WARNINGS_POP()
@@ -0,0 +1,35 @@
+#include "Dersbiander/Diagnostic.hpp"
+
+std::string Diagnostic::to_string() const {
+    switch(_kind) {
+        using enum DiagnosticKind;
+    case UNEXPECTED_ENDL:
+        return FORMAT("Unexpected token: ENDL line {} column {}", _line, _column);
+    case UNDECLARED_IDENTIFIER:
+        return FORMAT("Undeclared identifier: {} line {} column {}", _value, _line, _column);
+    case DUPLICATE_DECLARATION:
+        return FORMAT("Duplicate declaration: {} line {} column {}", _value, _line, _column);
+    case CONST_REASSIGNMENT:
+        return FORMAT("Assignment to constant: {} line {} column {}", _value, _line, _column);
+    case TYPE_MISMATCH:
+        return FORMAT("Type mismatch: {} line {} column {}", _message, _line, _column);
+    case CONSTANT_ERROR:
+        return FORMAT("Constant evaluation: {} line {} column {}", _message, _line, _column);
+    case LOOP_DEPENDENCY:
+        return FORMAT("Loop-carried dependency: {} line {} column {}", _message, _line, _column);
+    case UNSUPPORTED:
+        return FORMAT("Unsupported: {} line {} column {}", _message, _line, _column);
+    default:
+        break;
+    }
+    std::string expected;
+    for(const TokenType &type : _expected) {
+        if(!expected.empty()) { expected.append(", "); }
+        expected.append(FORMAT("{}", type));
+    }
+    if(_kind == DiagnosticKind::UNBALANCED_BRACKET) {
+        if(expected.empty()) { return FORMAT("Unbalanced bracket: {} line {} column {}", _value, _line, _column); }
+        return FORMAT("Unbalanced bracket: {} line {} column {}, never closed by {}", _value, _line, _column, expected);
+    }
+    return FORMAT("Unexpected token: {} line {} column {}, expected one of: {}", _value, _line, _column, expected);
+}
@@ -0,0 +1,206 @@
+#include "Dersbiander/ExpressionParser.hpp"
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+namespace {
+    /// Above `*` and below the left power of `^`, so a prefix operator applies to the whole power.
+    inline constexpr int prefixBindingPower = 13;
+}  // namespace
+
+ExpressionParser::ExpressionParser(const std::vector<Token> &tokenList, std::size_t first, std::size_t last) noexcept
+  : tokens(tokenList), position(first), end(std::min(last, tokenList.size())) {
+    skipComments();
+}
+
+std::size_t ExpressionParser::parse(std::vector<PostfixOp> &out) {
+    output = &out;
+    parseExpression(0);
+    output = nullptr;
+    return position;
+}
+
+/**
+ * @brief Renders a postfix array on one line, mostly for debugging and for the --ast dump.
+ *
+ * Operators are prefixed so that the arity is readable: `u-` is the unary minus, `p++` a postfix increment, `.name` a
+ * member access, `call/N` and `array/N` pop N values, `[]` indexes and `()` is an empty group.
+ */
+std::string ExpressionParser::to_string(const std::vector<Token> &tokens, std::span<const PostfixOp> code) {
+    std::string out;
+    for(const PostfixOp &oper : code) {
+        if(!out.empty()) { out.push_back(' '); }
+        const std::string &value = tokens[oper.token].getValue();
+        switch(oper.kind) {
+            using enum PostfixKind;
+        case UNARY:
+            out.append("u").append(value);
+            break;
+        case POSTFIX:
+            out.append("p").append(value);
+            break;
+        case MEMBER:
+            out.append(".").append(value);
+            break;
+        case CALL:
+            out.append(FORMAT("call/{}", oper.arity));
+            break;
+        case ARRAY:
+            out.append(FORMAT("array/{}", oper.arity));
+            break;
+        case INDEX:
+            out.append("[]");
+            break;
+        case EMPTY:
+            out.append("()");
+            break;
+        default:
+            out.append(value);
+            break;
+        }
+    }
+    return out;
+}
+
+void ExpressionParser::parseExpression(int minBindingPower) {
+    parsePrefix();
+    for(;;) {
+        if(parsePostfix()) { continue; }
+        const auto [left, right] = infixBindingPower();
+        if(left == 0 || left < minBindingPower) { return; }
+        const std::size_t oper = advance();
+        parseExpression(right);
+        emit(PostfixKind::BINARY, oper, 2);
+    }
+}
+
+void ExpressionParser::parsePrefix() {
+    using enum TokenType;
+    switch(peek()) {
+    case IDENTIFIER:
+        emit(PostfixKind::IDENTIFIER, advance(), 0);
+        return;
+    case INTEGER:
+    case DOUBLE:
+    case CHAR:
+    case STRING:
+        [[fallthrough]];
+    case BOOLEAN:
+        emit(PostfixKind::LITERAL, advance(), 0);
+        return;
+    case MINUS_OPERATOR:
+        [[fallthrough]];
+    case NOT_OPERATOR: {
+        const std::size_t oper = advance();
+        parseExpression(prefixBindingPower);
+        emit(PostfixKind::UNARY, oper, 1);
+        return;
+    }
+    case OPEN_BRACKETS: {
+        const std::size_t open = advance();
+        if(match(CLOSED_BRACKETS)) {
+            emit(PostfixKind::EMPTY, open, 0);
+            return;
+        }
+        parseExpression(0);
+        match(CLOSED_BRACKETS);
+        return;
+    }
+    case OPEN_SQUARE_BRACKETS: {
+        const std::size_t open = advance();
+        emit(PostfixKind::ARRAY, open, parseList(CLOSED_SQUARE_BRACKETS));
+        return;
+    }
+    default:
+        // Never produced by validated input: keep the stack balanced without consuming anything.
+        emit(PostfixKind::EMPTY, position < end ? position : (end == 0 ? 0 : end - 1), 0);
+        return;
+    }
+}
+
+/// Calls, indexing, member access and `++`/`--` bind tighter than everything, so they never look at the binding power.
+bool ExpressionParser::parsePostfix() {
+    using enum TokenType;
+    switch(peek()) {
+    case OPEN_BRACKETS: {
+        const std::size_t open = advance();
+        emit(PostfixKind::CALL, open, parseList(CLOSED_BRACKETS) + 1);
+        return true;
+    }
+    case OPEN_SQUARE_BRACKETS: {
+        const std::size_t open = advance();
+        parseExpression(0);
+        match(CLOSED_SQUARE_BRACKETS);
+        emit(PostfixKind::INDEX, open, 2);
+        return true;
+    }
+    case DOT_OPERATOR:
+        advance();
+        emit(PostfixKind::MEMBER, advance(), 1);
+        return true;
+    case UNARY_OPERATOR:
+        emit(PostfixKind::POSTFIX, advance(), 1);
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// Parses comma separated expressions up to @p close, consumes it and returns how many there were.
+std::uint32_t ExpressionParser::parseList(TokenType close) {
+    std::uint32_t count = 0;
+    if(!match(close)) {
+        do {  // NOLINT(*-avoid-do-while)
+            parseExpression(0);
+            ++count;
+        } while(match(TokenType::COMMA));
+        match(close);
+    }
+    return count;
+}
+
+TokenType ExpressionParser::peek() const noexcept { return position < end ? tokens[position].getType() : eofTokenType; }
+
+std::size_t ExpressionParser::advance() noexcept {
+    const std::size_t index = position;
+    if(position < end) { ++position; }
+    skipComments();
+    return index;
+}
+
+bool ExpressionParser::match(TokenType type) noexcept {
+    if(peek() != type) { return false; }
+    advance();
+    return true;
+}
+
+void ExpressionParser::skipComments() noexcept {
+    while(position < end && tokens[position].getType() == TokenType::COMMENT) { ++position; }
+}
+
+void ExpressionParser::emit(PostfixKind kind, std::size_t token, std::uint32_t arity) {
+    output->push_back(PostfixOp{kind, C_UI32T(token), arity});
+}
+
+/// Left and right binding power of the current token, {0, 0} when it is not an infix operator.
+std::pair<int, int> ExpressionParser::infixBindingPower() const noexcept {
+    using enum TokenType;
+    if(position >= end) { return {0, 0}; }
+    const Token &token = tokens[position];
+    const char first = token.getValue().empty() ? '\0' : token.getValue().front();
+    switch(token.getType()) {
+    case LOGICAL_OPERATOR:
+        return first == '|' ? std::pair{1, 2} : std::pair{3, 4};
+    case BOOLEAN_OPERATOR:
+        return first == '=' || first == '!' ? std::pair{5, 6} : std::pair{7, 8};
+    case MINUS_OPERATOR:
+        return {9, 10};
+    case OPERATOR:
+        if(first == '+') { return {9, 10}; }
+        if(first == '^') { return {14, 13}; }
+        return {11, 12};
+    default:
+        return {0, 0};
+    }
+}
+
+DISABLE_WARNINGS_POP()
@@ -5,12 +5,11 @@
 DISABLE_WARNINGS_PUSH(26461 26821)
 
 Instruction::Instruction() noexcept
-  : tokens({}), instructionTypes({InstructionType::BLANK}),
+  : instructionTypes({InstructionType::BLANK}),
     allowedTokens({TokenType::KEYWORD_MAIN, TokenType::KEYWORD_VAR, TokenType::KEYWORD_STRUCTURE, TokenType::KEYWORD_FOR,
-                   TokenType::KEYWORD_FUNC, TokenType::KEYWORD_RETURN, TokenType::IDENTIFIER, TokenType::OPEN_CURLY_BRACKETS,
-                   TokenType::CLOSED_CURLY_BRACKETS, eofTokenType}), booleanOperatorPresent({false}) {
-    previousTokens.reserve(tokens.size());
-}
+                   TokenType::KEYWORD_PARALLEL, TokenType::KEYWORD_FUNC, TokenType::KEYWORD_RETURN, TokenType::IDENTIFIER,
+                   TokenType::OPEN_CURLY_BRACKETS, TokenType::CLOSED_CURLY_BRACKETS, eofTokenType}),
+    booleanOperatorPresent({false}) {}
 
 [[nodiscard]] std::string Instruction::unexpected(const Token &token) const {
     std::string value;
@@ -109,6 +108,9 @@ Instruction::Instruction() noexcept
     case KEYWORD_FOR:
         this->checkKeywordFor();
         break;
+    case KEYWORD_PARALLEL:
+        this->checkKeywordParallel();
+        break;
     case KEYWORD_FUNC:
         this->checkKeywordFunc();
         break;
@@ -122,7 +124,8 @@ Instruction::Instruction() noexcept
     case COMMENT:
         break;
     }
-    this->previousTokens.emplace_back(token);
+    this->previousType = token.getType();
+    this->previousEmpty = false;
     return {true, msg};
 }
 
@@ -178,7 +181,7 @@ void Instruction::checkIdentifier(const TokenType &type) noexcept {
     case OPERATION:
         this->setLastInstructionType(OPERATION);
         this->allowedTokens = {EQUAL_OPERATOR, OPERATION_EQUAL, DOT_OPERATOR, COMMA, OPEN_BRACKETS, OPEN_SQUARE_BRACKETS, eofTokenType};
-        if(previousTokens.empty()) { this->allowedTokens.emplace_back(OPEN_BRACKETS); }
+        if(this->isPreviousEmpty()) { this->allowedTokens.emplace_back(OPEN_BRACKETS); }
         this->emplaceUnaryOperator(type);
         break;
     case DECLARATION:
@@ -256,7 +259,7 @@ void Instruction::checkMinusOperator() {
 void Instruction::checkEqualOperator() {
     using enum TokenType;
     using enum InstructionType;
-    this->allowedTokens = this->expressionStart;
+    this->allowedTokens.assign(expressionStart.begin(), expressionStart.end());
     if(lastInstructionTypeIs(OPERATION) || lastInstructionTypeIs(DECLARATION)) {
         if(lastInstructionTypeIs(OPERATION)) {
             this->setLastInstructionType(ASSIGNATION);
@@ -276,7 +279,7 @@ void Instruction::checkBooleanAndLogicalOperator(const TokenType &type) {
     using enum TokenType;
     using enum InstructionType;
     if(this->isExpression()) {
-        this->allowedTokens = this->expressionStart;
+        this->allowedTokens.assign(expressionStart.begin(), expressionStart.end());
         if(type != NOT_OPERATOR) {
             this->allowedTokens.emplace_back(NOT_OPERATOR);
             this->setLastBooleanOperatorPresent(type == BOOLEAN_OPERATOR);
@@ -300,7 +303,7 @@ void Instruction::checkComma() {
         this->setLastInstructionType(FOR_STEP);
     }
     this->setLastBooleanOperatorPresent(false);
-    this->allowedTokens = this->expressionStart;
+    this->allowedTokens.assign(expressionStart.begin(), expressionStart.end());
 }
 
 void Instruction::checkColon() {
@@ -447,6 +450,21 @@ void Instruction::checkKeywordFor() {
         this->allowedTokens = {KEYWORD_VAR, IDENTIFIER};
         return;
     }
+    if(lastInstructionTypeIs(FOR_STRUCTURE) && !this->isPreviousEmpty() && this->previousTokensLast() == KEYWORD_PARALLEL) {
+        this->allowedTokens = {KEYWORD_VAR, IDENTIFIER};
+        return;
+    }
+    this->allowedTokens = {};
+}
+
+void Instruction::checkKeywordParallel() {
+    using enum TokenType;
+    using enum InstructionType;
+    if(lastInstructionTypeIs(BLANK)) {
+        this->setLastInstructionType(FOR_STRUCTURE);
+        this->allowedTokens = {KEYWORD_FOR};
+        return;
+    }
     this->allowedTokens = {};
 }
 
@@ -466,7 +484,7 @@ void Instruction::checkKeywordReturn() {
     using enum InstructionType;
     if(lastInstructionTypeIs(BLANK)) {
         this->setLastInstructionType(RETURN_EXPRESSION);
-        this->allowedTokens = this->expressionStart;
+        this->allowedTokens.assign(expressionStart.begin(), expressionStart.end());
         this->allowedTokens.emplace_back(eofTokenType);
         return;
     }
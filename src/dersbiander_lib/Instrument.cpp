@@ -0,0 +1,74 @@
+#include "Dersbiander/Instrument.hpp"
+#include "Dersbiander/Timer.hpp"
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+Instrumentation &Instrumentation::global() noexcept {
+    static Instrumentation instrumentation;
+    return instrumentation;
+}
+
+std::uint32_t Instrumentation::counter(std::string_view name) { return reserve(name, false); }
+
+std::uint32_t Instrumentation::timer(std::string_view name) { return reserve(name, true); }
+
+/**
+ * @brief Registers @p name, or finds the slots it already has.
+ *
+ * Two points of the same kind with the same name share their slots. A counter and a timer are told apart by their kind
+ * as well as their name, so a counter never gets a slot that a timer adds nanoseconds to. Once the table is full a new
+ * name is still registered, on the overflow slots of its kind, so that report() lists it.
+ */
+std::uint32_t Instrumentation::reserve(std::string_view name, bool timer) {
+    const std::scoped_lock lock(mutex);
+    const auto same = [name, timer](const Entry &entry) { return entry.timer == timer && entry.name == name; };
+    if(const auto found = std::ranges::find_if(entries, same); found != entries.end()) { return found->slot; }
+    const std::uint32_t width = timer ? 2 : 1;
+    if(used + width > maxSlots) [[unlikely]] {
+        LWARN("Instrumentation slots exhausted: {} shares the overflow slots", name);
+        entries.push_back(Entry{std::string{name}, timer ? overflowTimer : overflowCounter, timer});
+        return entries.back().slot;
+    }
+    entries.push_back(Entry{std::string{name}, used, timer});
+    used += width;
+    return entries.back().slot;
+}
+
+Instrumentation::Slots &Instrumentation::registerThread() {
+    const std::scoped_lock lock(mutex);
+    threads.push_back(std::make_unique<Slots>());
+    return *threads.back();
+}
+
+std::vector<Instrumentation::Stats> Instrumentation::summary() const {
+    const std::scoped_lock lock(mutex);
+    std::vector<Stats> stats;
+    stats.reserve(entries.size());
+    const auto sum = [this](std::uint32_t slot) {
+        std::uint64_t total = 0;
+        for(const auto &thread : threads) { total += (*thread)[slot].load(std::memory_order_relaxed); }
+        return total;
+    };
+    for(const Entry &entry : entries) {
+        // The overflow slots add up every point sent to them: their names say so.
+        std::string name = entry.slot < firstSlot ? FORMAT("{} (overflow)", entry.name) : entry.name;
+        stats.push_back(Stats{std::move(name), sum(entry.slot), entry.timer ? sum(entry.slot + 1) : 0, entry.timer});
+    }
+    return stats;
+}
+
+std::string Instrumentation::report() const {
+    std::string out = FORMAT("{:<32} {:>14} {:>14} {:>14}", "point", "count", "total", "mean");
+    for(const Stats &point : summary()) {
+        if(!point.timer) {
+            out.append(FORMAT("{}{:<32} {:>14}", CNL, point.name, point.count));
+            continue;
+        }
+        const long double mean = point.count == 0 ? 0.0L : C_LD(point.nanoseconds) / C_LD(point.count);
+        out.append(FORMAT("{}{:<32} {:>14} {:>14} {:>14}", CNL, point.name, point.count,
+                          Timer::make_time_str(C_LD(point.nanoseconds)), Timer::make_time_str(mean)));
+    }
+    return out;
+}
+
+DISABLE_WARNINGS_POP()
@@ -0,0 +1,254 @@
+#include "Dersbiander/Ir.hpp"
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+namespace {
+    [[nodiscard]] IrValue resolve(const std::vector<IrValue> &forward, IrValue value) noexcept {
+        while(value < forward.size() && forward[value] != noValue) { value = forward[value]; }
+        return value;
+    }
+
+    [[nodiscard]] TypeId constantType(const Value &value) noexcept {
+        switch(value.kind) {
+        case ValueKind::BOOL:
+            return TypeTable::boolType;
+        case ValueKind::DOUBLE:
+            return TypeTable::doubleType;
+        default:
+            return TypeTable::intType;
+        }
+    }
+}  // namespace
+
+std::vector<BlockIndex> IrBlock::successors() const {
+    switch(terminator) {
+        using enum IrTerminator;
+    case JUMP:
+        return {target};
+    case BRANCH:
+        [[fallthrough]];
+    case FOR_BRANCH:
+        return {target, otherwise};
+    default:
+        return {};
+    }
+}
+
+BlockIndex IrFunction::addBlock() {
+    blocks.emplace_back();
+    return C_UI32T(blocks.size() - 1);
+}
+
+IrValue IrFunction::add(BlockIndex block, IrKind kind, OpCode op, TypeId type, std::vector<IrValue> operands) {
+    if(kind == IrKind::CONSTANT) { block = entry; }
+    const auto value = C_UI32T(values.size());
+    values.push_back(IrInstruction{kind, op, type, block, Value{}, std::move(operands)});
+    blocks[block].instructions.push_back(value);
+    return value;
+}
+
+IrValue IrFunction::constant(Value value) {
+    const IrValue result = add(entry, IrKind::CONSTANT, OpCode::MOVE, constantType(value));
+    values[result].constant = value;
+    return result;
+}
+
+void IrFunction::link(BlockIndex from, BlockIndex to) { blocks[to].predecessors.push_back(from); }
+
+void IrFunction::unlink(BlockIndex from, BlockIndex to) {
+    auto &predecessors = blocks[to].predecessors;
+    const auto found = std::ranges::find(predecessors, from);
+    if(found == predecessors.end()) { return; }
+    const auto position = found - predecessors.begin();
+    predecessors.erase(found);
+    for(const IrValue value : blocks[to].instructions) {
+        IrInstruction &instruction = values[value];
+        if(instruction.kind == IrKind::PHI && position < std::ssize(instruction.operands)) {
+            instruction.operands.erase(instruction.operands.begin() + position);
+        }
+    }
+}
+
+void IrFunction::replaceUses(const std::vector<IrValue> &forward) {
+    for(IrInstruction &instruction : values) {
+        if(instruction.kind == IrKind::REMOVED) { continue; }
+        for(IrValue &operand : instruction.operands) { operand = resolve(forward, operand); }
+    }
+    for(IrBlock &block : blocks) {
+        if(block.condition != noValue) { block.condition = resolve(forward, block.condition); }
+        if(block.loopVariable != noValue) { block.loopVariable = resolve(forward, block.loopVariable); }
+    }
+    for(auto &[symbol, value] : outputs) { value = resolve(forward, value); }
+}
+
+std::size_t IrFunction::removeTrivialPhis() {
+    std::vector<IrValue> forward(values.size(), noValue);
+    std::size_t removed = 0;
+    bool changed = true;
+    while(changed) {
+        changed = false;
+        for(IrValue phi = 0; phi < values.size(); ++phi) {
+            if(values[phi].kind != IrKind::PHI) { continue; }
+            IrValue same = noValue;
+            bool trivial = true;
+            for(const IrValue operand : values[phi].operands) {
+                const IrValue current = resolve(forward, operand);
+                if(current == phi || current == same) { continue; }
+                if(same != noValue) {
+                    trivial = false;
+                    break;
+                }
+                same = current;
+            }
+            if(!trivial) { continue; }
+            // A phi that only merges itself reads a variable nobody wrote: the register still holds its initial 0.
+            if(same == noValue) { same = constant(Value{}); }
+            forward.resize(values.size(), noValue);
+            forward[phi] = same;
+            values[phi].kind = IrKind::REMOVED;
+            std::erase(blocks[values[phi].block].instructions, phi);
+            ++removed;
+            changed = true;
+        }
+    }
+    if(removed != 0) { replaceUses(forward); }
+    return removed;
+}
+
+/// Phi copies are placed at the end of the predecessor, which must then have a single successor.
+void IrFunction::splitCriticalEdges() {
+    const std::size_t count = blocks.size();
+    for(BlockIndex block = 0; block < count; ++block) {
+        if(blocks[block].removed || blocks[block].terminator == IrTerminator::JUMP || blocks[block].terminator == IrTerminator::HALT) {
+            continue;
+        }
+        for(BlockIndex IrBlock::*edge : {&IrBlock::target, &IrBlock::otherwise}) {
+            const BlockIndex successor = blocks[block].*edge;
+            const IrBlock &next = blocks[successor];
+            if(next.predecessors.size() < 2 || next.instructions.empty() || values[next.instructions.front()].kind != IrKind::PHI) {
+                continue;
+            }
+            const BlockIndex split = addBlock();
+            blocks[split].terminator = IrTerminator::JUMP;
+            blocks[split].target = successor;
+            blocks[split].predecessors.push_back(block);
+            *std::ranges::find(blocks[successor].predecessors, block) = split;
+            blocks[block].*edge = split;
+        }
+    }
+}
+
+std::vector<BlockIndex> IrFunction::reversePostorder() const {
+    std::vector<BlockIndex> order;
+    if(blocks.empty()) { return order; }
+    std::vector<bool> visited(blocks.size(), false);
+    // Explicit stack of (block, next successor to visit), so deep loop nests never overflow the native stack.
+    std::vector<std::pair<BlockIndex, std::size_t>> stack{{entry, 0}};
+    visited[entry] = true;
+    while(!stack.empty()) {
+        auto &[block, next] = stack.back();
+        const std::vector<BlockIndex> successors = blocks[block].successors();
+        if(next < successors.size()) {
+            const BlockIndex successor = successors[next++];
+            if(!visited[successor]) {
+                visited[successor] = true;
+                stack.emplace_back(successor, 0);
+            }
+            continue;
+        }
+        order.push_back(block);
+        stack.pop_back();
+    }
+    std::ranges::reverse(order);
+    return order;
+}
+
+/// Cooper, Harvey and Kennedy: iterate over the reverse postorder, intersecting the dominators of the predecessors.
+std::vector<BlockIndex> IrFunction::dominators() const {
+    std::vector<BlockIndex> idom(blocks.size(), noBlock);
+    const std::vector<BlockIndex> order = reversePostorder();
+    if(order.empty()) { return idom; }
+    std::vector<std::size_t> position(blocks.size(), 0);
+    for(std::size_t i = 0; i < order.size(); ++i) { position[order[i]] = i; }
+    const auto intersect = [&](BlockIndex left, BlockIndex right) {
+        while(left != right) {
+            while(position[left] > position[right]) { left = idom[left]; }
+            while(position[right] > position[left]) { right = idom[right]; }
+        }
+        return left;
+    };
+    idom[entry] = entry;
+    bool changed = true;
+    while(changed) {
+        changed = false;
+        for(std::size_t i = 1; i < order.size(); ++i) {
+            const BlockIndex block = order[i];
+            BlockIndex dominator = noBlock;
+            for(const BlockIndex predecessor : blocks[block].predecessors) {
+                if(idom[predecessor] == noBlock) { continue; }
+                dominator = dominator == noBlock ? predecessor : intersect(predecessor, dominator);
+            }
+            if(dominator != idom[block]) {
+                idom[block] = dominator;
+                changed = true;
+            }
+        }
+    }
+    idom[entry] = noBlock;
+    return idom;
+}
+
+bool IrFunction::dominates(const std::vector<BlockIndex> &idom, BlockIndex dominator, BlockIndex block) noexcept {
+    for(; block != noBlock; block = idom[block]) {
+        if(block == dominator) { return true; }
+    }
+    return false;
+}
+
+std::size_t IrFunction::instructionCount() const noexcept {
+    return static_cast<std::size_t>(std::ranges::count_if(values, [](const IrInstruction &instruction) {
+        return instruction.kind == IrKind::PHI || instruction.kind == IrKind::OPERATION;
+    }));
+}
+
+std::string IrFunction::to_string(const TypeTable &types) const {
+    std::string out;
+    for(BlockIndex index = 0; index < blocks.size(); ++index) {
+        const IrBlock &block = blocks[index];
+        if(block.removed) { continue; }
+        out.append(FORMAT("b{}:", index));
+        if(!block.predecessors.empty()) { out.append(FORMAT(" <- b{}", FMT_JOIN(block.predecessors, ", b"))); }
+        out.push_back(CNL);
+        for(const IrValue value : block.instructions) {
+            const IrInstruction &instruction = values[value];
+            out.append(FORMAT("  v{} {} = ", value, types.to_string(instruction.type)));
+            if(instruction.kind == IrKind::CONSTANT) {
+                out.append(instruction.constant.to_string());
+            } else {
+                out.append(instruction.kind == IrKind::PHI ? "PHI" : FORMAT("{}", instruction.op));
+                for(const IrValue operand : instruction.operands) { out.append(FORMAT(" v{}", operand)); }
+            }
+            out.push_back(CNL);
+        }
+        switch(block.terminator) {
+            using enum IrTerminator;
+        case JUMP:
+            out.append(FORMAT("  JUMP b{}", block.target));
+            break;
+        case BRANCH:
+            out.append(FORMAT("  BRANCH v{} b{} b{}", block.condition, block.target, block.otherwise));
+            break;
+        case FOR_BRANCH:
+            out.append(FORMAT("  FOR_BRANCH v{} v{} b{} b{}", block.condition, block.loopVariable, block.target, block.otherwise));
+            break;
+        default:
+            out.append("  HALT");
+            for(const auto &[symbol, value] : outputs) { out.append(FORMAT(" s{}=v{}", symbol, value)); }
+            break;
+        }
+        out.push_back(CNL);
+    }
+    return out;
+}
+
+DISABLE_WARNINGS_POP()
@@ -0,0 +1,365 @@
+#include "Dersbiander/IrBuilder.hpp"
+#include "Dersbiander/Profiler.hpp"
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+IrBuilder::IrBuilder(const Ast &tree, const NameResolver &resolver, const TypeChecker &checker)
+  : ast(tree), names(resolver), types(checker) {}
+
+std::vector<Diagnostic> IrBuilder::build() {
+    PROFILE_ZONE("build SSA");
+    diagnostics.clear();
+    function = IrFunction{};
+    definitions.clear();
+    incompletePhis.clear();
+    sealed.clear();
+    current = newBlock();
+    seal(current);
+    if(ast.getRoot() != invalidNode) { buildNode(ast.getRoot()); }
+    function.blocks[current].terminator = IrTerminator::HALT;
+    const SymbolTable &symbols = names.getSymbols();
+    for(SymbolIndex symbol = 0; symbol < symbols.symbolCount(); ++symbol) {
+        if(symbols.symbol(symbol).kind != SymbolKind::FUNCTION) { function.outputs.emplace_back(symbol, read(symbol, current)); }
+    }
+    function.removeTrivialPhis();
+    return std::move(diagnostics);
+}
+
+BlockIndex IrBuilder::newBlock() {
+    definitions.emplace_back();
+    incompletePhis.emplace_back();
+    sealed.push_back(false);
+    return function.addBlock();
+}
+
+/// All the predecessors of @p block are known: the placeholder phis created while it was open get their operands.
+void IrBuilder::seal(BlockIndex block) {
+    const std::vector<std::pair<SymbolIndex, IrValue>> pending = std::exchange(incompletePhis[block], {});
+    for(const auto &[symbol, phi] : pending) { addPhiOperands(symbol, phi); }
+    sealed[block] = true;
+}
+
+void IrBuilder::jump(BlockIndex from, BlockIndex to) {
+    function.blocks[from].terminator = IrTerminator::JUMP;
+    function.blocks[from].target = to;
+    function.link(from, to);
+}
+
+void IrBuilder::write(SymbolIndex symbol, BlockIndex block, IrValue value) { definitions[block][symbol] = value; }
+
+IrValue IrBuilder::read(SymbolIndex symbol, BlockIndex block) {
+    if(const auto found = definitions[block].find(symbol); found != definitions[block].end()) { return found->second; }
+    return readRecursive(symbol, block);
+}
+
+IrValue IrBuilder::readRecursive(SymbolIndex symbol, BlockIndex block) {
+    const auto newPhi = [this, symbol, block] {
+        const IrValue phi = function.add(block, IrKind::PHI, OpCode::MOVE, types.symbolType(symbol));
+        auto &instructions = function.blocks[block].instructions;
+        instructions.pop_back();
+        instructions.insert(instructions.begin(), phi);
+        return phi;
+    };
+    const std::vector<BlockIndex> &predecessors = function.blocks[block].predecessors;
+    IrValue value = noValue;
+    if(!sealed[block]) {
+        value = newPhi();
+        incompletePhis[block].emplace_back(symbol, value);
+    } else if(predecessors.empty()) {
+        // Never written on this path: the register still holds the 0 every register starts with.
+        value = function.constant(Value{});
+    } else if(predecessors.size() == 1) {
+        value = read(symbol, predecessors.front());
+    } else {
+        // Written before the operands are read, so a loop reaching this block again finds the phi and stops.
+        value = newPhi();
+        write(symbol, block, value);
+        addPhiOperands(symbol, value);
+    }
+    write(symbol, block, value);
+    return value;
+}
+
+void IrBuilder::addPhiOperands(SymbolIndex symbol, IrValue phi) {
+    const std::vector<BlockIndex> predecessors = function.blocks[function.values[phi].block].predecessors;
+    for(const BlockIndex predecessor : predecessors) {
+        const IrValue operand = read(symbol, predecessor);
+        function.values[phi].operands.push_back(operand);
+    }
+}
+
+void IrBuilder::buildNode(NodeIndex index) {
+    switch(ast.node(index).kind) {
+        using enum AstKind;
+    case DECLARATION:
+        buildDeclaration(index);
+        break;
+    case ASSIGNMENT:
+        buildAssignment(index);
+        break;
+    case FOR:
+        buildFor(index);
+        break;
+    case STRUCTURE:
+        buildStructure(index);
+        break;
+    case FUNCTION:
+        break;
+    case RETURN:
+        unsupported(ast.node(index).token, "return");
+        break;
+    case EXPRESSION: {
+        [[maybe_unused]] const IrValue value = buildExpression(index);
+        break;
+    }
+    default:
+        for(const NodeIndex child : ast.children(index)) { buildNode(child); }
+        break;
+    }
+}
+
+/// A declaration without values starts from the zero of its type, like in the BytecodeCompiler.
+void IrBuilder::buildDeclaration(NodeIndex index) {
+    const auto children = ast.children(index);
+    const auto declared = ast.children(children[0]);
+    const auto values = ast.children(children[2]);
+    if(!ast.children(children[1]).empty()) { unsupported(ast.node(children[1]).token, "array types"); }
+    for(std::size_t i = 0; i < declared.size(); ++i) {
+        const SymbolIndex symbol = variable(ast.node(declared[i]).token);
+        if(symbol == noSymbol) { continue; }
+        IrValue value = noValue;
+        if(values.empty()) {
+            const TypeId type = types.symbolType(symbol);
+            if(TypeTable::isWide(type)) [[unlikely]] { unsupported(ast.node(declared[i]).token, "vectors and matrices"); }
+            const Value zero = type == TypeTable::doubleType ? Value::fromDouble(0.0)
+                                                             : (type == TypeTable::boolType ? Value::fromBool(false) : Value::fromInt(0));
+            value = function.constant(zero);
+        } else if(values.size() == 1 && i > 0) {
+            const SymbolIndex first = names.binding(ast.node(declared[0]).token);
+            value = first == noSymbol ? buildExpression(values.front()) : read(first, current);
+        } else {
+            value = buildExpression(values[std::min(i, values.size() - 1)]);
+        }
+        write(symbol, current, value);
+    }
+}
+
+/// Every value is built before the first target is written, which gives `a, b = b, a` its parallel meaning for free.
+void IrBuilder::buildAssignment(NodeIndex index) {
+    const auto children = ast.children(index);
+    const auto targets = ast.children(children[0]);
+    const auto values = ast.children(children[1]);
+    const std::uint32_t oper = ast.node(index).token;
+    std::vector<SymbolIndex> targetSymbols;
+    targetSymbols.reserve(targets.size());
+    for(const NodeIndex target : targets) {
+        const auto code = ast.code(target);
+        if(code.size() != 1 || code.front().kind != PostfixKind::IDENTIFIER) {
+            unsupported(ast.node(target).token, "assignment to an element or a member");
+            return;
+        }
+        const SymbolIndex symbol = variable(code.front().token);
+        if(symbol == noSymbol) { return; }
+        targetSymbols.push_back(symbol);
+    }
+    if(ast.getTokens()[oper].getType() == TokenType::OPERATION_EQUAL) {
+        // `+=` is the operator followed by '='.
+        const OpCode op = binaryOpCode(std::string_view{ast.getTokens()[oper].getValue()}.substr(0, 1)).value_or(OpCode::ADD);
+        for(const SymbolIndex symbol : targetSymbols) {
+            const IrValue value = buildExpression(values.front());
+            write(symbol, current, operation(op, read(symbol, current), value));
+        }
+        return;
+    }
+    std::vector<IrValue> results;
+    results.reserve(values.size());
+    for(const NodeIndex value : values) { results.push_back(buildExpression(value)); }
+    for(std::size_t i = 0; i < targetSymbols.size(); ++i) { write(targetSymbols[i], current, results[std::min(i, results.size() - 1)]); }
+}
+
+/// init; header: FOR_BRANCH condition; body ...; step; JUMP header; exit.
+void IrBuilder::buildFor(NodeIndex index) {
+    const auto children = ast.children(index);
+    buildNode(children[0]);
+    const NodeIndex declared = ast.children(ast.children(children[0])[0])[0];
+    const std::uint32_t variableToken = ast.node(declared).token;
+    const SymbolIndex loopVariable = variable(variableToken);
+    if(loopVariable == noSymbol) { return; }
+    const BlockIndex header = newBlock();
+    jump(current, header);
+    current = header;
+    const BlockIndex body = newBlock();
+    BlockIndex exit = noBlock;
+    if(ast.node(children[1]).kind != AstKind::EMPTY) {
+        const IrValue condition = buildExpression(children[1]);
+        const IrValue value = read(loopVariable, current);
+        exit = newBlock();
+        IrBlock &test = function.blocks[current];
+        test.terminator = IrTerminator::FOR_BRANCH;
+        test.condition = condition;
+        test.loopVariable = value;
+        test.target = body;
+        test.otherwise = exit;
+        function.link(current, body);
+        function.link(current, exit);
+    } else {
+        jump(current, body);
+    }
+    seal(body);
+    current = body;
+    buildNode(children[3]);
+    const IrValue step = ast.node(children[2]).kind == AstKind::EMPTY ? function.constant(Value::fromInt(1))
+                                                                        : buildExpression(children[2]);
+    write(loopVariable, current, operation(OpCode::ADD, read(loopVariable, current), step));
+    jump(current, header);
+    seal(header);
+    // Without a condition the loop never ends: the code after it is unreachable.
+    if(exit == noBlock) { exit = newBlock(); }
+    seal(exit);
+    current = exit;
+}
+
+/// `if` branches over its block, `while` also jumps back to the block testing the condition.
+void IrBuilder::buildStructure(NodeIndex index) {
+    const auto children = ast.children(index);
+    const bool loop = ast.token(index).getValue() == "while";
+    BlockIndex header = noBlock;
+    if(loop) {
+        header = newBlock();
+        jump(current, header);
+        current = header;
+    }
+    const IrValue condition = buildExpression(children[0]);
+    const BlockIndex test = current;
+    const BlockIndex body = newBlock();
+    const BlockIndex exit = newBlock();
+    IrBlock &branch = function.blocks[test];
+    branch.terminator = IrTerminator::BRANCH;
+    branch.condition = condition;
+    branch.target = body;
+    branch.otherwise = exit;
+    function.link(test, body);
+    function.link(test, exit);
+    seal(body);
+    current = body;
+    buildNode(children[1]);
+    jump(current, loop ? header : exit);
+    if(loop) { seal(header); }
+    seal(exit);
+    current = exit;
+}
+
+/// Variables are read when an operator consumes them, like registers in the VirtualMachine: `x + x++` sees the new x.
+IrValue IrBuilder::buildExpression(NodeIndex index) {
+    operands.clear();
+    const auto pop = [this] {
+        const Operand operand = operands.empty() ? Operand{function.constant(Value{}), noSymbol} : operands.back();
+        if(!operands.empty()) { operands.pop_back(); }
+        return operand;
+    };
+    const auto code = ast.code(index);
+    for(std::size_t position = 0; position < code.size(); ++position) {
+        if(const ConstantFolder::Folded *subtree = folder == nullptr ? nullptr : folder->folded(index, position); subtree != nullptr) {
+            operands.push_back({function.constant(subtree->value), noSymbol});
+            position = subtree->last;
+            continue;
+        }
+        const PostfixOp &oper = code[position];
+        const Token &token = ast.getTokens()[oper.token];
+        switch(oper.kind) {
+            using enum PostfixKind;
+        case IDENTIFIER: {
+            const SymbolIndex symbol = variable(oper.token);
+            operands.push_back({symbol == noSymbol ? function.constant(Value{}) : read(symbol, current), symbol});
+            break;
+        }
+        case LITERAL:
+            if(token.getType() == TokenType::STRING) { unsupported(oper.token, "strings"); }
+            operands.push_back({function.constant(literalValue(token)), noSymbol});
+            break;
+        case UNARY: {
+            const Operand operand = pop();
+            const OpCode op = token.getType() == TokenType::NOT_OPERATOR ? OpCode::NOT : OpCode::NEG;
+            operands.push_back({operation(op, operand.value), noSymbol});
+            break;
+        }
+        case POSTFIX: {
+            const Operand operand = pop();
+            if(operand.symbol == noSymbol) {
+                unsupported(oper.token, "++ and -- on a value that is not a variable");
+            } else {
+                const OpCode op = token.getValue() == "++" ? OpCode::ADD : OpCode::SUB;
+                const IrValue updated = operation(op, operand.value, function.constant(Value::fromInt(1)));
+                write(operand.symbol, current, updated);
+                for(Operand &pending : operands) {
+                    if(pending.symbol == operand.symbol) { pending.value = updated; }
+                }
+            }
+            operands.push_back({operand.value, noSymbol});
+            break;
+        }
+        case BINARY: {
+            const Operand right = pop();
+            const Operand left = pop();
+            operands.push_back({operation(binaryOpCode(token.getValue()).value_or(OpCode::ADD), left.value, right.value), noSymbol});
+            break;
+        }
+        default:
+            unsupported(oper.token, FORMAT("{}", oper.kind));
+            for(std::uint32_t i = 0; i < oper.arity; ++i) { [[maybe_unused]] const Operand discarded = pop(); }
+            operands.push_back({function.constant(Value{}), noSymbol});
+            break;
+        }
+    }
+    return operands.empty() ? function.constant(Value::fromInt(0)) : operands.back().value;
+}
+
+/// Arithmetic promotes scalars to at least int, logic and comparisons give bool, anything else stays unknown.
+IrValue IrBuilder::operation(OpCode op, IrValue left, IrValue right) {
+    const TypeId leftType = function.values[left].type;
+    const TypeId rightType = right == noValue ? leftType : function.values[right].type;
+    TypeId type = TypeTable::unknownType;
+    switch(op) {
+        using enum OpCode;
+    case NOT:
+        [[fallthrough]];
+    case AND:
+        [[fallthrough]];
+    case OR:
+        [[fallthrough]];
+    case EQ:
+        [[fallthrough]];
+    case NE:
+        [[fallthrough]];
+    case LT:
+        [[fallthrough]];
+    case LE:
+        [[fallthrough]];
+    case GT:
+        [[fallthrough]];
+    case GE:
+        type = TypeTable::boolType;
+        break;
+    default:
+        if(TypeTable::isScalar(leftType) && TypeTable::isScalar(rightType)) { type = std::max({leftType, rightType, TypeTable::intType}); }
+        break;
+    }
+    std::vector<IrValue> arguments{left};
+    if(right != noValue) { arguments.push_back(right); }
+    return function.add(current, IrKind::OPERATION, op, type, std::move(arguments));
+}
+
+SymbolIndex IrBuilder::variable(std::uint32_t token) {
+    const SymbolIndex symbol = names.binding(token);
+    if(symbol == noSymbol || names.getSymbols().symbol(symbol).kind == SymbolKind::FUNCTION) [[unlikely]] {
+        unsupported(token, "functions");
+        return noSymbol;
+    }
+    return symbol;
+}
+
+void IrBuilder::unsupported(std::uint32_t token, std::string_view what) {
+    diagnostics.emplace_back(DiagnosticKind::UNSUPPORTED, ast.getTokens()[token], FORMAT("{} in the SSA builder", what));
+}
+
+DISABLE_WARNINGS_POP()
@@ -0,0 +1,158 @@
+#include "Dersbiander/IrCompiler.hpp"
+#include "Dersbiander/Profiler.hpp"
+#include <bit>
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+namespace {
+    inline constexpr std::size_t maxRegisters = std::numeric_limits<std::uint16_t>::max();
+}  // namespace
+
+IrCompiler::IrCompiler(const Ast &tree, const NameResolver &resolver, IrFunction &ir) : ast(tree), names(resolver), function(ir) {}
+
+std::vector<Diagnostic> IrCompiler::compile() {
+    PROFILE_ZONE("lower SSA");
+    diagnostics.clear();
+    chunk = Chunk{};
+    constantRegisters.clear();
+    jumps.clear();
+    const std::size_t symbolCount = names.getSymbols().symbolCount();
+    if(symbolCount >= maxRegisters) [[unlikely]] {
+        unsupported("more than 65535 variables");
+        return std::move(diagnostics);
+    }
+    chunk.constantBase = C_UI16T(symbolCount);
+    for(SymbolIndex symbol = 0; symbol < symbolCount; ++symbol) {
+        const Symbol &declared = names.getSymbols().symbol(symbol);
+        if(declared.kind != SymbolKind::FUNCTION) {
+            chunk.variables.emplace_back(ast.getTokens()[declared.token].getValue(), C_UI16T(symbol));
+        }
+    }
+    function.splitCriticalEdges();
+    const std::vector<BlockIndex> order = function.reversePostorder();
+    if(!allocate(order)) { return std::move(diagnostics); }
+    std::vector<std::size_t> addresses(function.blocks.size(), 0);
+    for(std::size_t i = 0; i < order.size(); ++i) {
+        const BlockIndex index = order[i];
+        const BlockIndex next = i + 1 < order.size() ? order[i + 1] : noBlock;
+        addresses[index] = chunk.code.size();
+        const IrBlock &block = function.blocks[index];
+        for(const IrValue value : block.instructions) {
+            const IrInstruction &instruction = function.values[value];
+            if(instruction.kind != IrKind::OPERATION) { continue; }
+            const std::uint16_t right = instruction.operands.size() > 1 ? registers[instruction.operands[1]] : 0;
+            emit(instruction.op, registers[value], registers[instruction.operands[0]], right);
+        }
+        switch(block.terminator) {
+            using enum IrTerminator;
+        case JUMP:
+            emitCopies(index, block.target);
+            if(block.target != next) { emitJump(OpCode::JUMP, block.target); }
+            break;
+        case BRANCH:
+            emitJump(OpCode::JUMP_FALSE, block.otherwise, registers[block.condition]);
+            if(block.target != next) { emitJump(OpCode::JUMP, block.target); }
+            break;
+        case FOR_BRANCH:
+            // FOR_TEST skips the jump to the exit while the loop goes on.
+            emit(OpCode::FOR_TEST, registers[block.condition], registers[block.loopVariable]);
+            emitJump(OpCode::JUMP, block.otherwise);
+            if(block.target != next) { emitJump(OpCode::JUMP, block.target); }
+            break;
+        default:
+            for(const auto &[symbol, value] : function.outputs) {
+                // Registers start at 0: a variable that ends as the integer 0 needs no store.
+                const IrInstruction &output = function.values[value];
+                if(output.kind == IrKind::CONSTANT && output.constant == Value{}) { continue; }
+                emit(OpCode::MOVE, C_UI16T(symbol), registers[value]);
+            }
+            emit(OpCode::HALT, 0);
+            break;
+        }
+    }
+    for(const auto &[jump, target] : jumps) {
+        chunk.code[jump].b = C_UI16T(addresses[target] & 0xFFFFU);
+        chunk.code[jump].c = C_UI16T(addresses[target] >> 16U);
+    }
+    return std::move(diagnostics);
+}
+
+/// Constants first, like in the BytecodeCompiler, then one register per value in layout order and the scratch one.
+bool IrCompiler::allocate(const std::vector<BlockIndex> &order) {
+    registers.assign(function.values.size(), 0);
+    for(IrValue value = 0; value < function.values.size(); ++value) {
+        const IrInstruction &instruction = function.values[value];
+        if(instruction.kind == IrKind::CONSTANT) { registers[value] = constant(instruction.constant); }
+    }
+    std::size_t next = chunk.constantBase + chunk.constants.size();
+    for(const BlockIndex block : order) {
+        for(const IrValue value : function.blocks[block].instructions) {
+            if(function.values[value].kind == IrKind::CONSTANT) { continue; }
+            if(next >= maxRegisters) [[unlikely]] {
+                unsupported("programs needing more than 65535 registers");
+                return false;
+            }
+            registers[value] = C_UI16T(next++);
+        }
+    }
+    if(next >= maxRegisters) [[unlikely]] {
+        unsupported("programs needing more than 65535 registers");
+        return false;
+    }
+    scratch = C_UI16T(next++);
+    chunk.registerCount = C_UI16T(next);
+    return true;
+}
+
+std::uint16_t IrCompiler::constant(Value value) {
+    const std::int64_t bits = value.kind == ValueKind::DOUBLE ? std::bit_cast<std::int64_t>(value.real) : value.asInt();
+    const auto [found, inserted] = constantRegisters.try_emplace({value.kind, bits}, C_UI16T(chunk.constantBase + chunk.constants.size()));
+    if(inserted) {
+        if(chunk.constantBase + chunk.constants.size() >= maxRegisters) [[unlikely]] { return 0; }
+        chunk.constants.push_back(value);
+    }
+    return found->second;
+}
+
+/// The phis of @p to read their operand for @p from all at once: a copy whose destination another copy still has to
+/// read waits, and a cycle of such copies is broken by saving one source in the scratch register.
+void IrCompiler::emitCopies(BlockIndex from, BlockIndex to) {
+    const IrBlock &successor = function.blocks[to];
+    const auto edge = static_cast<std::size_t>(std::ranges::find(successor.predecessors, from) - successor.predecessors.begin());
+    std::vector<std::pair<std::uint16_t, std::uint16_t>> pending;
+    for(const IrValue value : successor.instructions) {
+        const IrInstruction &phi = function.values[value];
+        if(phi.kind != IrKind::PHI) { break; }
+        if(edge >= phi.operands.size()) { continue; }
+        const std::uint16_t source = registers[phi.operands[edge]];
+        if(source != registers[value]) { pending.emplace_back(registers[value], source); }
+    }
+    while(!pending.empty()) {
+        const auto ready = std::ranges::find_if(pending, [&pending](const auto &copy) {
+            return std::ranges::none_of(pending, [&copy](const auto &other) { return other.second == copy.first; });
+        });
+        if(ready != pending.end()) {
+            emit(OpCode::MOVE, ready->first, ready->second);
+            pending.erase(ready);
+            continue;
+        }
+        const std::uint16_t saved = pending.front().second;
+        emit(OpCode::MOVE, scratch, saved);
+        for(auto &copy : pending) {
+            if(copy.second == saved) { copy.second = scratch; }
+        }
+    }
+}
+
+void IrCompiler::emitJump(OpCode op, BlockIndex target, std::uint16_t condition) {
+    jumps.emplace_back(chunk.code.size(), target);
+    emit(op, condition);
+}
+
+void IrCompiler::emit(OpCode op, std::uint16_t a, std::uint16_t b, std::uint16_t c) { chunk.code.push_back(Bytecode{op, a, b, c}); }
+
+void IrCompiler::unsupported(std::string_view what) {
+    diagnostics.emplace_back(DiagnosticKind::UNSUPPORTED, ast.getTokens()[0], FORMAT("{} in the SSA lowering", what));
+}
+
+DISABLE_WARNINGS_POP()
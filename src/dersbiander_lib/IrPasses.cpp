@@ -0,0 +1,288 @@
+#include "Dersbiander/IrPasses.hpp"
+#include "Dersbiander/Profiler.hpp"
+#include "Dersbiander/Timer.hpp"
+#include <bit>
+#include <map>
+#include <unordered_map>
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+namespace {
+    /// Integer division by zero throws: a division is only free to move or vanish when its divisor is a known nonzero.
+    [[nodiscard]] bool mayTrap(const IrFunction &function, const IrInstruction &instruction) noexcept {
+        if(instruction.kind != IrKind::OPERATION || instruction.op != OpCode::DIV) { return false; }
+        const IrInstruction &divisor = function.values[instruction.operands[1]];
+        if(divisor.kind != IrKind::CONSTANT) { return true; }
+        return divisor.constant.kind != ValueKind::DOUBLE && divisor.constant.asInt() == 0;
+    }
+
+    [[nodiscard]] bool isCommutative(OpCode op) noexcept {
+        switch(op) {
+            using enum OpCode;
+        case ADD:
+            [[fallthrough]];
+        case MUL:
+            [[fallthrough]];
+        case AND:
+            [[fallthrough]];
+        case OR:
+            [[fallthrough]];
+        case EQ:
+            [[fallthrough]];
+        case NE:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    struct ExpressionKey {
+        OpCode op;
+        IrValue left;
+        IrValue right;
+
+        [[nodiscard]] bool operator==(const ExpressionKey &other) const noexcept = default;
+    };
+
+    struct ExpressionHash {
+        [[nodiscard]] std::size_t operator()(const ExpressionKey &key) const noexcept {
+            std::uint64_t hash = (static_cast<std::uint64_t>(key.left) << 32U) | key.right;
+            hash ^= static_cast<std::uint64_t>(key.op) * 0x9E3779B97F4A7C15ULL;
+            hash ^= hash >> 29U;
+            return static_cast<std::size_t>(hash * 0xBF58476D1CE4E5B9ULL);
+        }
+    };
+
+    [[nodiscard]] IrValue resolve(const std::vector<IrValue> &forward, IrValue value) noexcept {
+        while(forward[value] != noValue) { value = forward[value]; }
+        return value;
+    }
+
+    void removeValue(IrFunction &function, IrValue value) {
+        IrInstruction &instruction = function.values[value];
+        std::erase(function.blocks[instruction.block].instructions, value);
+        instruction.kind = IrKind::REMOVED;
+        instruction.operands.clear();
+    }
+}  // namespace
+
+std::size_t eliminateDeadCode(IrFunction &function) {
+    std::size_t changes = 0;
+    for(BlockIndex index = 0; index < function.blocks.size(); ++index) {
+        IrBlock &block = function.blocks[index];
+        if(block.removed || (block.terminator != IrTerminator::BRANCH && block.terminator != IrTerminator::FOR_BRANCH)) { continue; }
+        const IrInstruction &condition = function.values[block.condition];
+        // A numeric for condition is compared with the loop variable, only a bool one is known in advance.
+        if(condition.kind != IrKind::CONSTANT) { continue; }
+        if(block.terminator == IrTerminator::FOR_BRANCH && condition.constant.kind != ValueKind::BOOL) { continue; }
+        const bool taken = condition.constant.isTruthy();
+        const BlockIndex kept = taken ? block.target : block.otherwise;
+        const BlockIndex dropped = taken ? block.otherwise : block.target;
+        block.terminator = IrTerminator::JUMP;
+        block.target = kept;
+        block.otherwise = noBlock;
+        block.condition = noValue;
+        block.loopVariable = noValue;
+        if(kept != dropped) { function.unlink(index, dropped); }
+        ++changes;
+    }
+    std::vector<bool> reachable(function.blocks.size(), false);
+    for(const BlockIndex block : function.reversePostorder()) { reachable[block] = true; }
+    for(BlockIndex index = 0; index < function.blocks.size(); ++index) {
+        if(reachable[index] || function.blocks[index].removed) { continue; }
+        for(const BlockIndex successor : function.blocks[index].successors()) { function.unlink(index, successor); }
+        for(const IrValue value : std::vector<IrValue>(function.blocks[index].instructions)) { removeValue(function, value); }
+        IrBlock &block = function.blocks[index];
+        block.removed = true;
+        block.terminator = IrTerminator::HALT;
+        block.predecessors.clear();
+        ++changes;
+    }
+    changes += function.removeTrivialPhis();
+
+    std::vector<bool> live(function.values.size(), false);
+    std::vector<IrValue> worklist;
+    const auto mark = [&](IrValue value) {
+        if(value != noValue && !live[value]) {
+            live[value] = true;
+            worklist.push_back(value);
+        }
+    };
+    for(const auto &[symbol, value] : function.outputs) { mark(value); }
+    for(const IrBlock &block : function.blocks) {
+        if(block.removed) { continue; }
+        mark(block.condition);
+        mark(block.loopVariable);
+        for(const IrValue value : block.instructions) {
+            if(mayTrap(function, function.values[value])) { mark(value); }
+        }
+    }
+    while(!worklist.empty()) {
+        const IrValue value = worklist.back();
+        worklist.pop_back();
+        for(const IrValue operand : function.values[value].operands) { mark(operand); }
+    }
+    for(IrValue value = 0; value < function.values.size(); ++value) {
+        if(!live[value] && function.values[value].kind != IrKind::REMOVED) {
+            removeValue(function, value);
+            ++changes;
+        }
+    }
+    return changes;
+}
+
+std::size_t eliminateCommonSubexpressions(IrFunction &function) {
+    std::size_t changes = 0;
+    std::vector<IrValue> forward(function.values.size(), noValue);
+    std::map<std::pair<ValueKind, std::int64_t>, IrValue> constants;
+    for(IrValue value = 0; value < function.values.size(); ++value) {
+        const IrInstruction &instruction = function.values[value];
+        if(instruction.kind != IrKind::CONSTANT) { continue; }
+        const Value &constant = instruction.constant;
+        const std::int64_t bits = constant.kind == ValueKind::DOUBLE ? std::bit_cast<std::int64_t>(constant.real) : constant.asInt();
+        const auto [found, inserted] = constants.try_emplace({constant.kind, bits}, value);
+        if(!inserted) {
+            forward[value] = found->second;
+            removeValue(function, value);
+            ++changes;
+        }
+    }
+
+    const std::vector<BlockIndex> idom = function.dominators();
+    std::vector<std::vector<BlockIndex>> dominated(function.blocks.size());
+    for(const BlockIndex block : function.reversePostorder()) {
+        if(idom[block] != noBlock) { dominated[idom[block]].push_back(block); }
+    }
+    std::unordered_map<ExpressionKey, IrValue, ExpressionHash> available;
+    std::vector<ExpressionKey> added;
+    const auto number = [&](BlockIndex block) {
+        for(const IrValue value : std::vector<IrValue>(function.blocks[block].instructions)) {
+            IrInstruction &instruction = function.values[value];
+            if(instruction.kind != IrKind::OPERATION) { continue; }
+            for(IrValue &operand : instruction.operands) { operand = resolve(forward, operand); }
+            const IrValue right = instruction.operands.size() > 1 ? instruction.operands[1] : noValue;
+            ExpressionKey key{instruction.op, instruction.operands[0], right};
+            if(isCommutative(key.op) && key.right < key.left) { std::swap(key.left, key.right); }
+            const auto [found, inserted] = available.try_emplace(key, value);
+            if(inserted) {
+                added.push_back(key);
+                continue;
+            }
+            forward[value] = found->second;
+            removeValue(function, value);
+            ++changes;
+        }
+    };
+    // Walks the dominator tree with an explicit stack: what a block computes is available in the blocks it dominates
+    // and forgotten when the walk leaves them.
+    struct Frame {
+        BlockIndex block;
+        std::size_t mark;
+        std::size_t next;
+    };
+    std::vector<Frame> stack{{IrFunction::entry, 0, 0}};
+    number(IrFunction::entry);
+    while(!stack.empty()) {
+        Frame &frame = stack.back();
+        if(frame.next < dominated[frame.block].size()) {
+            const BlockIndex child = dominated[frame.block][frame.next++];
+            const std::size_t mark = added.size();
+            number(child);
+            stack.push_back({child, mark, 0});
+            continue;
+        }
+        for(std::size_t i = frame.mark; i < added.size(); ++i) { available.erase(added[i]); }
+        added.resize(frame.mark);
+        stack.pop_back();
+    }
+    if(changes != 0) { function.replaceUses(forward); }
+    return changes;
+}
+
+std::size_t hoistLoopInvariants(IrFunction &function) {
+    const std::vector<BlockIndex> idom = function.dominators();
+    const std::vector<BlockIndex> order = function.reversePostorder();
+    // A back edge goes to a block dominating its source: that block heads a loop made of everything reaching the
+    // source without passing through it.
+    std::map<BlockIndex, std::vector<bool>> loops;
+    for(const BlockIndex block : order) {
+        for(const BlockIndex header : function.blocks[block].successors()) {
+            if(!IrFunction::dominates(idom, header, block)) { continue; }
+            std::vector<bool> &body = loops.try_emplace(header, function.blocks.size(), false).first->second;
+            body[header] = true;
+            std::vector<BlockIndex> worklist{block};
+            while(!worklist.empty()) {
+                const BlockIndex current = worklist.back();
+                worklist.pop_back();
+                if(body[current]) { continue; }
+                body[current] = true;
+                for(const BlockIndex predecessor : function.blocks[current].predecessors) { worklist.push_back(predecessor); }
+            }
+        }
+    }
+    std::vector<std::pair<std::size_t, BlockIndex>> bySize;
+    bySize.reserve(loops.size());
+    for(const auto &[header, body] : loops) { bySize.emplace_back(static_cast<std::size_t>(std::ranges::count(body, true)), header); }
+    std::ranges::sort(bySize);
+
+    std::size_t changes = 0;
+    for(const auto &[size, header] : bySize) {
+        const std::vector<bool> &body = loops[header];
+        BlockIndex preheader = noBlock;
+        std::size_t outside = 0;
+        for(const BlockIndex predecessor : function.blocks[header].predecessors) {
+            if(!body[predecessor]) {
+                preheader = predecessor;
+                ++outside;
+            }
+        }
+        if(outside != 1 || function.blocks[preheader].terminator != IrTerminator::JUMP) { continue; }
+        for(const BlockIndex block : order) {
+            if(!body[block]) { continue; }
+            for(const IrValue value : std::vector<IrValue>(function.blocks[block].instructions)) {
+                IrInstruction &instruction = function.values[value];
+                if(instruction.kind != IrKind::OPERATION || mayTrap(function, instruction)) { continue; }
+                const bool invariant = std::ranges::none_of(instruction.operands, [&](IrValue operand) {
+                    return body[function.values[operand].block];
+                });
+                if(!invariant) { continue; }
+                std::erase(function.blocks[block].instructions, value);
+                function.blocks[preheader].instructions.push_back(value);
+                instruction.block = preheader;
+                ++changes;
+            }
+        }
+    }
+    return changes;
+}
+
+void IrPassManager::add(std::string name, Pass pass) { passes.emplace_back(std::move(name), std::move(pass)); }
+
+void IrPassManager::run(IrFunction &function) {
+    for(const auto &[name, pass] : passes) {
+        PROFILE_ZONE(name);
+        const Timer timer(name);
+        const std::size_t changes = pass(function);
+        runs.push_back(PassRun{name, changes, timer.make_time()});
+    }
+}
+
+std::string IrPassManager::report() const {
+    std::string out;
+    for(const PassRun &run : runs) {
+        if(!out.empty()) { out.push_back(CNL); }
+        out.append(FORMAT("{}: {} changes in {}", run.name, run.changes, Timer::make_time_str(run.nanoseconds)));
+    }
+    return out;
+}
+
+IrPassManager IrPassManager::standard() {
+    IrPassManager manager;
+    manager.add("dce", eliminateDeadCode);
+    manager.add("cse", eliminateCommonSubexpressions);
+    manager.add("licm", hoistLoopInvariants);
+    manager.add("dce", eliminateDeadCode);
+    return manager;
+}
+
+DISABLE_WARNINGS_POP()
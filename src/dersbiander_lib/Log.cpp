@@ -0,0 +1,15 @@
+#include "Dersbiander/Log.hpp"
+#include <cstdlib>
+#include <spdlog/async.h>
+
+void initLogger(std::size_t queueSize, bool toStderr) {
+    spdlog::set_pattern(R"(%^[%T] [%l] %v%$)");
+    if(queueSize == 0) {
+        spdlog::set_default_logger(toStderr ? spdlog::stderr_color_mt(R"(console)") : spdlog::stdout_color_mt(R"(console)"));
+        return;
+    }
+    spdlog::init_thread_pool(queueSize, 1);
+    spdlog::set_default_logger(toStderr ? spdlog::stderr_color_mt<spdlog::async_factory>(R"(console)")
+                                        : spdlog::stdout_color_mt<spdlog::async_factory>(R"(console)"));
+    std::atexit([] { spdlog::shutdown(); });
+}
@@ -0,0 +1,138 @@
+#include "Dersbiander/NameResolver.hpp"
+#include "Dersbiander/Profiler.hpp"
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+// Sized so that typical programs never rehash: the table still grows if there are more names.
+NameResolver::NameResolver(const Ast &tree)
+  : ast(tree), symbols(tree.getTokens().size() / 4), bindings(tree.getTokens().size(), noSymbol) {}
+
+std::vector<Diagnostic> NameResolver::resolve() {
+    PROFILE_ZONE("resolve names");
+    diagnostics.clear();
+    if(ast.getRoot() != invalidNode) { resolveBlock(ast.getRoot()); }
+    // Hoisting can report a function before the statements above it.
+    std::ranges::stable_sort(diagnostics, [](const Diagnostic &left, const Diagnostic &right) {
+        return std::pair{left.getLine(), left.getColumn()} < std::pair{right.getLine(), right.getColumn()};
+    });
+    return std::move(diagnostics);
+}
+
+void NameResolver::resolveNode(NodeIndex index) {
+    switch(ast.node(index).kind) {
+        using enum AstKind;
+    case PROGRAM:
+        [[fallthrough]];
+    case BLOCK:
+        resolveBlock(index);
+        break;
+    case DECLARATION:
+        resolveDeclaration(index);
+        break;
+    case ASSIGNMENT:
+        resolveAssignment(index);
+        break;
+    case FOR:
+        resolveFor(index);
+        break;
+    case FUNCTION:
+        resolveFunction(index);
+        break;
+    case EXPRESSION:
+        resolveExpression(index);
+        break;
+    case IDENTIFIER:
+        break;
+    default:
+        resolveChildren(index);
+        break;
+    }
+}
+
+/// Opens a scope, hoists the functions declared directly in it and resolves the statements in order.
+void NameResolver::resolveBlock(NodeIndex index) {
+    symbols.openScope();
+    for(const NodeIndex child : ast.children(index)) {
+        if(ast.node(child).kind == AstKind::FUNCTION) { declare(ast.node(child).token, SymbolKind::FUNCTION); }
+    }
+    resolveChildren(index);
+    symbols.closeScope();
+}
+
+/// The values are resolved before the names are declared, so `var x: t = x` refers to an outer `x`.
+void NameResolver::resolveDeclaration(NodeIndex index) {
+    const auto children = ast.children(index);
+    resolveNode(children[1]);
+    resolveNode(children[2]);
+    const SymbolKind kind = ast.token(index).getValue() == "const" ? SymbolKind::CONSTANT : SymbolKind::VARIABLE;
+    for(const NodeIndex name : ast.children(children[0])) { declare(ast.node(name).token, kind); }
+}
+
+void NameResolver::resolveAssignment(NodeIndex index) {
+    const auto children = ast.children(index);
+    resolveNode(children[1]);
+    for(const NodeIndex target : ast.children(children[0])) {
+        resolveExpression(target);
+        // Only a bare name is a reassignment: `constant[0] = x` changes an element, not the constant.
+        const auto code = ast.code(target);
+        if(code.size() == 1 && code.front().kind == PostfixKind::IDENTIFIER) { checkAssignable(code.front().token); }
+    }
+}
+
+/// The loop variable lives in a scope of its own around the condition, the step and the body.
+void NameResolver::resolveFor(NodeIndex index) {
+    symbols.openScope();
+    resolveChildren(index);
+    symbols.closeScope();
+}
+
+void NameResolver::resolveFunction(NodeIndex index) {
+    const auto children = ast.children(index);
+    symbols.openScope();
+    for(const NodeIndex parameter : ast.children(children[0])) {
+        resolveChildren(parameter);
+        declare(ast.node(parameter).token, SymbolKind::PARAMETER);
+    }
+    resolveNode(children[1]);
+    resolveNode(children[2]);
+    symbols.closeScope();
+}
+
+void NameResolver::resolveExpression(NodeIndex index) {
+    const auto code = ast.code(index);
+    for(std::size_t i = 0; i < code.size(); ++i) {
+        const PostfixOp &oper = code[i];
+        if(oper.kind == PostfixKind::IDENTIFIER) {
+            const Token &token = ast.getTokens()[oper.token];
+            bindings[oper.token] = symbols.lookup(token.getValue());
+            // `vec3(...)` builds a value of the builtin type: the name stays unbound unless a declaration hides it.
+            if(bindings[oper.token] == noSymbol && TypeTable::wideType(token.getValue()) == TypeTable::unknownType) [[unlikely]] {
+                diagnostics.emplace_back(DiagnosticKind::UNDECLARED_IDENTIFIER, token, std::vector<TokenType>{});
+            }
+        } else if(oper.kind == PostfixKind::POSTFIX && i > 0 && code[i - 1].kind == PostfixKind::IDENTIFIER) {
+            checkAssignable(code[i - 1].token);
+        }
+    }
+}
+
+void NameResolver::resolveChildren(NodeIndex index) {
+    for(const NodeIndex child : ast.children(index)) { resolveNode(child); }
+}
+
+void NameResolver::declare(std::uint32_t token, SymbolKind kind) {
+    const SymbolIndex previous = symbols.declare(ast.getTokens()[token].getValue(), kind, token);
+    bindings[token] = previous == noSymbol ? C_UI32T(symbols.symbolCount() - 1) : previous;
+    if(previous == noSymbol) [[likely]] { return; }
+    // Functions are hoisted and may be overloaded: only a clash with a variable is a duplicate.
+    if(kind == SymbolKind::FUNCTION && symbols.symbol(previous).kind == SymbolKind::FUNCTION) { return; }
+    diagnostics.emplace_back(DiagnosticKind::DUPLICATE_DECLARATION, ast.getTokens()[token], std::vector<TokenType>{});
+}
+
+void NameResolver::checkAssignable(std::uint32_t token) {
+    const SymbolIndex symbol = symbols.lookup(ast.getTokens()[token].getValue());
+    if(symbol != noSymbol && symbols.symbol(symbol).kind == SymbolKind::CONSTANT) [[unlikely]] {
+        diagnostics.emplace_back(DiagnosticKind::CONST_REASSIGNMENT, ast.getTokens()[token], std::vector<TokenType>{});
+    }
+}
+
+DISABLE_WARNINGS_POP()
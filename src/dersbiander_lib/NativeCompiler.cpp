@@ -0,0 +1,467 @@
+#include "Dersbiander/NativeCompiler.hpp"
+#include "Dersbiander/Profiler.hpp"
+#include <bit>
+#include <cstddef>
+
+#ifdef DERSBIANDER_NATIVE_X86_64
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482 26490)
+
+namespace {
+    static_assert(sizeof(Value) == 16 && offsetof(Value, integer) == 8, "native code relies on the Value layout");
+
+    inline constexpr std::uint8_t rax = 0;
+    inline constexpr std::uint8_t rcx = 1;
+    inline constexpr std::uint8_t rsi = 6;
+    inline constexpr std::uint8_t rdi = 7;
+    inline constexpr std::uint8_t xmm0 = 0;
+    inline constexpr std::uint8_t xmm1 = 1;
+
+    // Condition codes, as the second byte of the 0F 9x setcc and 0F 8x jcc encodings.
+    inline constexpr std::uint8_t conditionAbove = 0x7;
+    inline constexpr std::uint8_t conditionAboveEqual = 0x3;
+    inline constexpr std::uint8_t conditionEqual = 0x4;
+    inline constexpr std::uint8_t conditionNotEqual = 0x5;
+    inline constexpr std::uint8_t conditionParity = 0xA;
+    inline constexpr std::uint8_t conditionNotParity = 0xB;
+    inline constexpr std::uint8_t conditionLess = 0xC;
+    inline constexpr std::uint8_t conditionLessEqual = 0xE;
+    inline constexpr std::uint8_t conditionGreater = 0xF;
+    inline constexpr std::uint8_t conditionGreaterEqual = 0xD;
+    inline constexpr std::uint8_t unconditional = 0xFF;
+
+    inline constexpr std::uint64_t signBit = 0x8000000000000000ULL;
+
+    std::int64_t integerPower(std::int64_t base, std::int64_t exponent) noexcept {
+        return VirtualMachine::power(Value::fromInt(base), Value::fromInt(exponent)).integer;
+    }
+    double doublePower(double base, double exponent) noexcept { return std::pow(base, exponent); }
+
+    [[nodiscard]] inline bool bothIntegral(ValueKind left, ValueKind right) noexcept {
+        return left != ValueKind::DOUBLE && right != ValueKind::DOUBLE;
+    }
+    [[nodiscard]] inline std::string_view kindName(ValueKind kind) noexcept {
+        switch(kind) {
+        case ValueKind::BOOL:
+            return "bool";
+        case ValueKind::DOUBLE:
+            return "double";
+        default:
+            return "int";
+        }
+    }
+}  // namespace
+
+NativeProgram::NativeProgram(std::span<const std::uint8_t> machineCode) {
+#ifdef DERSBIANDER_NATIVE_X86_64
+    const auto page = C_ST(sysconf(_SC_PAGESIZE));
+    mappedSize = (machineCode.size() + page - 1) / page * page;
+    void *mapped = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(mapped == MAP_FAILED) [[unlikely]] { throw RuntimeError("Unable to map memory for native code"); }
+    std::memcpy(mapped, machineCode.data(), machineCode.size());
+    if(mprotect(mapped, mappedSize, PROT_READ | PROT_EXEC) != 0) [[unlikely]] {
+        munmap(mapped, mappedSize);
+        throw RuntimeError("Unable to make native code executable");
+    }
+    memory = mapped;
+#else
+    (void)machineCode;
+    throw RuntimeError("Native code is only generated for x86-64");
+#endif
+}
+
+NativeProgram::NativeProgram(NativeProgram &&other) noexcept
+  : memory(std::exchange(other.memory, nullptr)), mappedSize(std::exchange(other.mappedSize, 0)) {}
+
+NativeProgram &NativeProgram::operator=(NativeProgram &&other) noexcept {
+    if(this != &other) {
+        release();
+        memory = std::exchange(other.memory, nullptr);
+        mappedSize = std::exchange(other.mappedSize, 0);
+    }
+    return *this;
+}
+
+NativeProgram::~NativeProgram() { release(); }
+
+void NativeProgram::release() noexcept {
+#ifdef DERSBIANDER_NATIVE_X86_64
+    if(memory != nullptr) { munmap(memory, mappedSize); }
+#endif
+    memory = nullptr;
+    mappedSize = 0;
+}
+
+int NativeProgram::operator()(Value *registers) const {
+    if(memory == nullptr) [[unlikely]] { throw RuntimeError("Running an empty native program"); }
+    using Entry = int (*)(Value *);
+    return std::bit_cast<Entry>(memory)(registers);
+}
+
+NativeCompiler::NativeCompiler(const Chunk &program) noexcept : chunk(program) {}
+
+bool NativeCompiler::compile() {
+    PROFILE_ZONE("compile native code");
+#ifndef DERSBIANDER_NATIVE_X86_64
+    fallbackReason = "native code is only generated for x86-64";
+    return false;
+#else
+    const std::size_t count = chunk.code.size();
+    code.clear();
+    fixups.clear();
+    fallbackReason.clear();
+    offsets.assign(count + 2, 0);
+    kinds.assign(chunk.registerCount, ValueKind::INT);
+    assigned.assign(chunk.constantBase, false);
+    for(std::size_t i = 0; i < chunk.constants.size(); ++i) { kinds[chunk.constantBase + i] = chunk.constants[i].kind; }
+
+    bytes({0x53, 0x48, 0x89, 0xFB});  // push rbx; mov rbx, rdi
+    for(std::size_t i = 0; i < count; ++i) {
+        offsets[i] = C_UI32T(code.size());
+        if(!translate(i)) { return false; }
+    }
+    // Epilogue: the variables get their tags back, then return 0.
+    offsets[count] = C_UI32T(code.size());
+    for(std::uint16_t reg = 0; reg < chunk.constantBase; ++reg) {
+        if(!assigned[reg]) { continue; }
+        bytes({0xC6, 0x83});  // mov byte [rbx + tag], kind
+        imm32(C_UI32T(reg) * 16U);
+        bytes({static_cast<std::uint8_t>(kinds[reg])});
+    }
+    bytes({0x31, 0xC0, 0x5B, 0xC3});  // xor eax, eax; pop rbx; ret
+    offsets[count + 1] = C_UI32T(code.size());
+    bytes({0xB8, 0x01, 0x00, 0x00, 0x00, 0x5B, 0xC3});  // mov eax, 1; pop rbx; ret
+
+    for(const Fixup &fixup : fixups) {
+        const std::uint32_t relative = offsets[fixup.target] - C_UI32T(fixup.position + 4);
+        for(std::size_t i = 0; i < 4; ++i) { code[fixup.position + i] = C_UI8T(relative >> (8 * i)); }
+    }
+    return true;
+#endif
+}
+
+std::string NativeCompiler::dump() const {
+    std::string out;
+    const auto hex = [this](std::size_t first, std::size_t last) {
+        std::string text;
+        for(std::size_t i = first; i < last; ++i) { text.append(FORMAT("{:02x} ", code[i])); }
+        return text;
+    };
+    if(offsets.empty()) { return out; }
+    out.append(FORMAT("{:06x} {:<15} {}{}", 0, "prologue", hex(0, offsets[0]), CNL));
+    for(std::size_t i = 0; i < chunk.code.size(); ++i) {
+        out.append(FORMAT("{:06x} {:>4} {:<10} {}{}", offsets[i], i, chunk.code[i].op, hex(offsets[i], offsets[i + 1]), CNL));
+    }
+    const std::size_t epilogue = chunk.code.size();
+    out.append(FORMAT("{:06x} {:<15} {}{}", offsets[epilogue], "epilogue", hex(offsets[epilogue], offsets[epilogue + 1]), CNL));
+    out.append(FORMAT("{:06x} {:<15} {}", offsets[epilogue + 1], "division error", hex(offsets[epilogue + 1], code.size())));
+    return out;
+}
+
+NativeProgram NativeCompiler::load() const { return NativeProgram(code); }
+
+// NOLINTBEGIN(*-magic-numbers)
+bool NativeCompiler::translate(std::size_t index) {
+    const Bytecode &instruction = chunk.code[index];
+    const std::uint16_t a = instruction.a;
+    const std::uint16_t b = instruction.b;
+    const std::uint16_t c = instruction.c;
+    const auto compareOperands = [&](std::uint8_t integerCondition, std::uint8_t doubleCondition, bool swapped) {
+        if(bothIntegral(kinds[b], kinds[c])) {
+            loadInt(rax, b);
+            loadInt(rcx, c);
+            bytes({0x48, 0x39, 0xC8});  // cmp rax, rcx
+            storeFlag(integerCondition, a);
+        } else {
+            loadDouble(xmm0, b);
+            loadDouble(xmm1, c);
+            bytes({0x66, 0x0F, 0x2E, C_UI8T(swapped ? 0xC8 : 0xC1)});  // ucomisd
+            storeFlag(doubleCondition, a);
+        }
+        return define(a, ValueKind::BOOL);
+    };
+    // ucomisd sets ZF for a NaN too, and PF for it alone: == also needs PF clear, != is also true with PF set.
+    const auto equality = [&](bool equal) {
+        if(bothIntegral(kinds[b], kinds[c])) { return compareOperands(equal ? conditionEqual : conditionNotEqual, 0, false); }
+        loadDouble(xmm0, b);
+        loadDouble(xmm1, c);
+        bytes({0x66, 0x0F, 0x2E, 0xC1});  // ucomisd xmm0, xmm1
+        // setcc al; setcc cl; and/or al, cl; movzx eax, al
+        bytes({0x0F, C_UI8T(0x90U | (equal ? conditionEqual : conditionNotEqual)), 0xC0, 0x0F,
+               C_UI8T(0x90U | (equal ? conditionNotParity : conditionParity)), 0xC1, C_UI8T(equal ? 0x20 : 0x08), 0xC8, 0x0F,
+               0xB6, 0xC0});
+        storeInt(a);
+        return define(a, ValueKind::BOOL);
+    };
+    const auto arithmetic = [&](std::initializer_list<std::uint8_t> integerOp, std::uint8_t doubleOp) {
+        if(bothIntegral(kinds[b], kinds[c])) {
+            loadInt(rax, b);
+            loadInt(rcx, c);
+            bytes(integerOp);
+            storeInt(a);
+            return define(a, ValueKind::INT);
+        }
+        loadDouble(xmm0, b);
+        loadDouble(xmm1, c);
+        bytes({0xF2, 0x0F, doubleOp, 0xC1});
+        storeDouble(a);
+        return define(a, ValueKind::DOUBLE);
+    };
+
+    switch(instruction.op) {
+        using enum OpCode;
+    case MOVE:
+        bytes({0x48, 0x8B});
+        memory(rax, b);
+        storeInt(a);
+        return define(a, kinds[b]);
+    case ADD:
+        return arithmetic({0x48, 0x01, 0xC8}, 0x58);
+    case SUB:
+        return arithmetic({0x48, 0x29, 0xC8}, 0x5C);
+    case MUL:
+        return arithmetic({0x48, 0x0F, 0xAF, 0xC1}, 0x59);
+    case DIV:
+        if(bothIntegral(kinds[b], kinds[c])) {
+            loadInt(rax, b);
+            loadInt(rcx, c);
+            bytes({0x48, 0x85, 0xC9});  // test rcx, rcx
+            jump(conditionEqual, chunk.code.size() + 1);
+            // cmp rcx, -1; jne idiv; neg rax; jmp done; idiv: cqo; idiv rcx; done:
+            bytes({0x48, 0x83, 0xF9, 0xFF, 0x75, 0x05, 0x48, 0xF7, 0xD8, 0xEB, 0x05, 0x48, 0x99, 0x48, 0xF7, 0xF9});
+            storeInt(a);
+            return define(a, ValueKind::INT);
+        }
+        return arithmetic({}, 0x5E);
+    case POW:
+        if(bothIntegral(kinds[b], kinds[c])) {
+            // The kind of 2 ^ n depends on the sign of n: only constant exponents are known to stay integers.
+            if(!isConstant(c) || chunk.constants[c - chunk.constantBase].asInt() < 0) {
+                return fallback(index, "integer power with a variable exponent");
+            }
+            loadInt(rdi, b);
+            loadInt(rsi, c);
+            call(std::bit_cast<std::uintptr_t>(&integerPower));
+            storeInt(a);
+            return define(a, ValueKind::INT);
+        }
+        loadDouble(xmm0, b);
+        loadDouble(xmm1, c);
+        call(std::bit_cast<std::uintptr_t>(&doublePower));
+        storeDouble(a);
+        return define(a, ValueKind::DOUBLE);
+    case NEG:
+        if(kinds[b] != ValueKind::DOUBLE) {
+            loadInt(rax, b);
+            bytes({0x48, 0xF7, 0xD8});  // neg rax
+            storeInt(a);
+            return define(a, ValueKind::INT);
+        }
+        loadDouble(xmm0, b);
+        bytes({0x48, 0xB8});  // mov rax, sign bit; movq xmm1, rax; xorpd xmm0, xmm1
+        imm64(signBit);
+        bytes({0x66, 0x48, 0x0F, 0x6E, 0xC8, 0x66, 0x0F, 0x57, 0xC1});
+        storeDouble(a);
+        return define(a, ValueKind::DOUBLE);
+    case NOT:
+        truth(b);
+        bytes({0x34, 0x01, 0x0F, 0xB6, 0xC0});  // xor al, 1; movzx eax, al
+        storeInt(a);
+        return define(a, ValueKind::BOOL);
+    case AND:
+        [[fallthrough]];
+    case OR:
+        truth(b);
+        bytes({0x0F, 0xB6, 0xD0});  // movzx edx, al
+        truth(c);
+        bytes({C_UI8T(instruction.op == AND ? 0x20 : 0x08), 0xD0, 0x0F, 0xB6, 0xC0});  // and/or al, dl; movzx eax, al
+        storeInt(a);
+        return define(a, ValueKind::BOOL);
+    case EQ:
+        return equality(true);
+    case NE:
+        return equality(false);
+    // The double conditions need CF clear, which an unordered ucomisd never leaves: a NaN fails them all.
+    case LT:
+        return compareOperands(conditionLess, conditionAbove, true);
+    case LE:
+        return compareOperands(conditionLessEqual, conditionAboveEqual, true);
+    case GT:
+        return compareOperands(conditionGreater, conditionAbove, false);
+    case GE:
+        return compareOperands(conditionGreaterEqual, conditionAboveEqual, false);
+    case POSTINC:
+        [[fallthrough]];
+    case POSTDEC: {
+        const bool increment = instruction.op == POSTINC;
+        if(kinds[b] == ValueKind::BOOL) { return fallback(index, "increment of a bool"); }
+        if(kinds[b] == ValueKind::INT) {
+            loadInt(rax, b);
+            storeInt(a);
+            bytes({0x48, 0x83, C_UI8T(increment ? 0xC0 : 0xE8), 0x01});  // add/sub rax, 1
+            storeInt(b);
+        } else {
+            loadDouble(xmm0, b);
+            storeDouble(a);
+            bytes({0x48, 0xB8});  // mov rax, 1.0; movq xmm1, rax; addsd/subsd xmm0, xmm1
+            imm64(std::bit_cast<std::uint64_t>(1.0));
+            bytes({0x66, 0x48, 0x0F, 0x6E, 0xC8, 0xF2, 0x0F, C_UI8T(increment ? 0x58 : 0x5C), 0xC1});
+            storeDouble(b);
+        }
+        return define(a, kinds[b]) && define(b, kinds[b]);
+    }
+    case JUMP:
+        jump(unconditional, instruction.target());
+        return true;
+    case JUMP_FALSE:
+        truth(a);
+        bytes({0x84, 0xC0});  // test al, al
+        jump(conditionEqual, instruction.target());
+        return true;
+    case FOR_TEST:
+        // Proceeding skips the JUMP to the loop exit that follows.
+        if(kinds[a] == ValueKind::BOOL) {
+            truth(a);
+            bytes({0x84, 0xC0});
+            jump(conditionNotEqual, index + 2);
+        } else if(bothIntegral(kinds[a], kinds[b])) {
+            loadInt(rax, b);
+            loadInt(rcx, a);
+            bytes({0x48, 0x39, 0xC8});
+            jump(conditionLess, index + 2);
+        } else {
+            loadDouble(xmm0, b);
+            loadDouble(xmm1, a);
+            bytes({0x66, 0x0F, 0x2E, 0xC8});  // ucomisd xmm1, xmm0
+            jump(conditionAbove, index + 2);
+        }
+        return true;
+    case HALT:
+        jump(unconditional, chunk.code.size());
+        return true;
+    default:
+        return fallback(index, FORMAT("opcode {}", instruction.op));
+    }
+}
+
+bool NativeCompiler::define(std::uint16_t reg, ValueKind kind) {
+    if(reg < chunk.constantBase) {
+        if(assigned[reg] && kinds[reg] != kind) {
+            fallbackReason = FORMAT("variable r{} changes kind from {} to {}", reg, kindName(kinds[reg]), kindName(kind));
+            return false;
+        }
+        assigned[reg] = true;
+    }
+    kinds[reg] = kind;
+    return true;
+}
+
+bool NativeCompiler::isConstant(std::uint16_t reg) const noexcept {
+    return reg >= chunk.constantBase && reg < chunk.constantBase + chunk.constants.size();
+}
+
+bool NativeCompiler::fallback(std::size_t index, std::string_view reason) {
+    fallbackReason = FORMAT("{} at instruction {}", reason, index);
+    return false;
+}
+
+void NativeCompiler::bytes(std::initializer_list<std::uint8_t> values) { code.insert(code.end(), values); }
+
+void NativeCompiler::imm32(std::uint32_t value) {
+    for(std::size_t i = 0; i < 4; ++i) { code.push_back(C_UI8T(value >> (8 * i))); }
+}
+
+void NativeCompiler::imm64(std::uint64_t value) {
+    for(std::size_t i = 0; i < 8; ++i) { code.push_back(C_UI8T(value >> (8 * i))); }
+}
+
+/// ModRM for [rbx + disp32] addressing the payload of @p valueRegister.
+void NativeCompiler::memory(std::uint8_t reg, std::uint16_t valueRegister) {
+    code.push_back(C_UI8T(0x83U | (C_UI32T(reg) << 3U)));
+    imm32(C_UI32T(valueRegister) * 16U + 8U);
+}
+
+void NativeCompiler::loadInt(std::uint8_t gpr, std::uint16_t reg) {
+    if(kinds[reg] == ValueKind::BOOL) {
+        bytes({0x0F, 0xB6});  // movzx r32, byte
+    } else {
+        bytes({0x48, 0x8B});  // mov r64, qword
+    }
+    memory(gpr, reg);
+}
+
+void NativeCompiler::loadDouble(std::uint8_t xmm, std::uint16_t reg) {
+    switch(kinds[reg]) {
+    case ValueKind::DOUBLE:
+        bytes({0xF2, 0x0F, 0x10});  // movsd
+        memory(xmm, reg);
+        break;
+    case ValueKind::INT:
+        bytes({0xF2, 0x48, 0x0F, 0x2A});  // cvtsi2sd xmm, qword
+        memory(xmm, reg);
+        break;
+    default:
+        bytes({0x0F, 0xB6});  // movzx, then cvtsi2sd xmm, r64 of the same number
+        memory(xmm, reg);
+        bytes({0xF2, 0x48, 0x0F, 0x2A, C_UI8T(0xC0U | (C_UI32T(xmm) << 3U) | xmm)});
+        break;
+    }
+}
+
+void NativeCompiler::storeInt(std::uint16_t reg) {
+    bytes({0x48, 0x89});
+    memory(rax, reg);
+}
+
+void NativeCompiler::storeDouble(std::uint16_t reg) {
+    bytes({0xF2, 0x0F, 0x11});
+    memory(xmm0, reg);
+}
+
+/// al = 1 when @p reg is truthy, with the same rules as Value::isTruthy.
+void NativeCompiler::truth(std::uint16_t reg) {
+    switch(kinds[reg]) {
+    case ValueKind::BOOL:
+        bytes({0x80});  // cmp byte [payload], 0
+        memory(7, reg);
+        bytes({0x00, 0x0F, 0x95, 0xC0});  // setne al
+        break;
+    case ValueKind::INT:
+        bytes({0x48, 0x83});  // cmp qword [payload], 0
+        memory(7, reg);
+        bytes({0x00, 0x0F, 0x95, 0xC0});
+        break;
+    default:
+        // NaN is truthy: unordered sets the parity flag.
+        loadDouble(xmm0, reg);
+        bytes({0x66, 0x0F, 0x57, 0xC9, 0x66, 0x0F, 0x2E, 0xC1, 0x0F, 0x95, 0xC0, 0x0F, 0x9A, 0xC1, 0x08, 0xC8});
+        break;
+    }
+}
+
+void NativeCompiler::storeFlag(std::uint8_t setcc, std::uint16_t reg) {
+    bytes({0x0F, C_UI8T(0x90U | setcc), 0xC0, 0x0F, 0xB6, 0xC0});  // setcc al; movzx eax, al
+    storeInt(reg);
+}
+
+void NativeCompiler::jump(std::uint8_t condition, std::size_t target) {
+    if(condition == unconditional) {
+        bytes({0xE9});
+    } else {
+        bytes({0x0F, C_UI8T(0x80U | condition)});
+    }
+    fixups.push_back(Fixup{code.size(), target});
+    imm32(0);
+}
+
+void NativeCompiler::call(std::uintptr_t function) {
+    bytes({0x48, 0xB8});  // mov rax, function; call rax
+    imm64(function);
+    bytes({0xFF, 0xD0});
+}
+// NOLINTEND(*-magic-numbers)
+
+DISABLE_WARNINGS_POP()
@@ -0,0 +1,238 @@
+#include "Dersbiander/ParallelChecker.hpp"
+#include "Dersbiander/Profiler.hpp"
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+ParallelChecker::ParallelChecker(const Ast &tree, const NameResolver &resolver) : ast(tree), names(resolver) {}
+
+std::vector<Diagnostic> ParallelChecker::check() {
+    PROFILE_ZONE("check parallel loops");
+    diagnostics.clear();
+    loops.clear();
+    for(NodeIndex index = 0; index < ast.size(); ++index) {
+        const bool loop = ast.node(index).kind == AstKind::FOR;
+        if(loop && ast.token(index).getType() == TokenType::KEYWORD_PARALLEL) { checkLoop(index); }
+    }
+    // Nested loops are committed to the Ast before the loops around them.
+    std::ranges::stable_sort(diagnostics, [](const Diagnostic &left, const Diagnostic &right) {
+        return std::pair{left.getLine(), left.getColumn()} < std::pair{right.getLine(), right.getColumn()};
+    });
+    return std::move(diagnostics);
+}
+
+const std::vector<ParallelChecker::Reduction> *ParallelChecker::reductions(NodeIndex loop) const noexcept {
+    const auto found = loops.find(loop);
+    return found == loops.end() ? nullptr : &found->second;
+}
+
+void ParallelChecker::checkLoop(NodeIndex index) {
+    const auto children = ast.children(index);
+    const std::size_t before = diagnostics.size();
+    accesses.clear();
+    local.assign(names.getSymbols().symbolCount(), false);
+    const NodeIndex name = ast.children(ast.children(children[0])[0])[0];
+    variable = variableSymbol(ast.node(name).token);
+    collect(children[3]);
+    for(const auto &[symbol, use] : accesses) {
+        const std::string &label = ast.getTokens()[use.token].getValue();
+        const bool reduced = use.additive || use.multiplicative;
+        if(symbol == variable) {
+            if(use.written || reduced || use.indexedWrite) [[unlikely]] {
+                dependency(use.token, FORMAT("the loop variable {} changes in the body of a parallel for", label));
+            }
+        } else if(use.written) [[unlikely]] {
+            dependency(use.token, FORMAT("{} is written by more than one iteration", label));
+        } else if(use.additive && use.multiplicative) [[unlikely]] {
+            dependency(use.token, FORMAT("{} is reduced with both + and *", label));
+        } else if(reduced && (use.read || use.indexedRead || use.indexedWrite)) [[unlikely]] {
+            dependency(use.token, FORMAT("{} is read while the iterations reduce it", label));
+        } else if(use.indexedWrite && use.read) [[unlikely]] {
+            dependency(use.token, FORMAT("{} is written at the loop variable and read elsewhere", label));
+        }
+    }
+    if(ast.node(children[1]).kind != AstKind::EXPRESSION) [[unlikely]] {
+        dependency(ast.node(index).token, "a parallel for needs a bound, its iterations are counted before it starts");
+    }
+    // The bound and the step are read once: nothing they depend on may change while the loop runs.
+    for(const NodeIndex part : {children[1], children[2]}) {
+        if(ast.node(part).kind != AstKind::EXPRESSION) { continue; }
+        for(const PostfixOp &oper : ast.code(part)) {
+            if(oper.kind != PostfixKind::IDENTIFIER) { continue; }
+            const SymbolIndex symbol = variableSymbol(oper.token);
+            const auto found = accesses.find(symbol);
+            if(symbol == noSymbol || (symbol != variable && found == accesses.end())) { continue; }
+            if(symbol == variable || found->second.additive || found->second.multiplicative) [[unlikely]] {
+                const std::string &label = ast.getTokens()[oper.token].getValue();
+                dependency(oper.token, FORMAT("the bound or step of a parallel for depends on {}", label));
+            }
+        }
+    }
+    if(diagnostics.size() != before) { return; }
+    std::vector<Reduction> &found = loops[index];
+    for(const auto &[symbol, use] : accesses) {
+        if(use.additive) { found.push_back({symbol, OpCode::ADD}); }
+        if(use.multiplicative) { found.push_back({symbol, OpCode::MUL}); }
+    }
+}
+
+/// Names declared in the body are private to an iteration; nested loops are walked like any other block.
+void ParallelChecker::collect(NodeIndex index) {
+    switch(ast.node(index).kind) {
+        using enum AstKind;
+    case DECLARATION: {
+        const auto children = ast.children(index);
+        collect(children[1]);
+        collect(children[2]);
+        for(const NodeIndex name : ast.children(children[0])) {
+            if(const SymbolIndex symbol = variableSymbol(ast.node(name).token); symbol != noSymbol) { local[symbol] = true; }
+        }
+        break;
+    }
+    case ASSIGNMENT:
+        collectAssignment(index);
+        break;
+    case EXPRESSION_STATEMENT:
+        for(const NodeIndex expression : ast.children(index)) {
+            const auto code = ast.code(expression);
+            // `count++` on its own is `count += 1`.
+            if(code.size() == 2 && code[0].kind == PostfixKind::IDENTIFIER && code[1].kind == PostfixKind::POSTFIX) {
+                const SymbolIndex symbol = variableSymbol(code[0].token);
+                if(symbol != noSymbol && !local[symbol]) {
+                    access({PlaceKind::NAME, symbol, code[0].token}).additive = true;
+                    continue;
+                }
+            }
+            consume(walk(expression));
+        }
+        break;
+    case EXPRESSION:
+        consume(walk(index));
+        break;
+    case FUNCTION:
+        break;
+    default:
+        for(const NodeIndex child : ast.children(index)) { collect(child); }
+        break;
+    }
+}
+
+/// `+=` and `-=` are additive and `*=` multiplicative, the other compound operators read what they write.
+void ParallelChecker::collectAssignment(NodeIndex index) {
+    const auto children = ast.children(index);
+    const Token &oper = ast.token(index);
+    const char op = oper.getType() == TokenType::OPERATION_EQUAL ? oper.getValue().front() : '=';
+    for(const NodeIndex value : ast.children(children[1])) { consume(walk(value)); }
+    for(const NodeIndex target : ast.children(children[0])) {
+        const Place place = walk(target);
+        if(place.kind == PlaceKind::VALUE) { continue; }
+        Access &use = access(place);
+        switch(place.kind) {
+        case PlaceKind::NAME:
+            use.additive |= op == '+' || op == '-';
+            use.multiplicative |= op == '*';
+            use.written |= op != '+' && op != '-' && op != '*';
+            break;
+        case PlaceKind::ELEMENT:
+            use.indexedWrite = true;
+            use.indexedRead |= op != '=';
+            break;
+        default:
+            use.written = true;
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Replays the postfix code of @p index on a stack of places.
+ *
+ * A name stays a NAME until an operation uses it; indexing a name with the loop variable gives an ELEMENT, which
+ * stays one through further indices, and any other index or member access a DERIVED place of the same name. Operands
+ * of the other operations are read, operands of `++` and `--` also written.
+ */
+ParallelChecker::Place ParallelChecker::walk(NodeIndex index) {
+    places.clear();
+    const auto pop = [this] {
+        if(places.empty()) { return Place{PlaceKind::VALUE, noSymbol, 0}; }
+        const Place place = places.back();
+        places.pop_back();
+        return place;
+    };
+    for(const PostfixOp &oper : ast.code(index)) {
+        switch(oper.kind) {
+            using enum PostfixKind;
+        case IDENTIFIER: {
+            const SymbolIndex symbol = variableSymbol(oper.token);
+            const bool shared = symbol != noSymbol && !local[symbol];
+            places.push_back({shared ? PlaceKind::NAME : PlaceKind::VALUE, symbol, oper.token});
+            break;
+        }
+        case INDEX: {
+            const Place position = pop();
+            const Place base = pop();
+            const bool atVariable = position.kind == PlaceKind::NAME && position.symbol == variable;
+            consume(position);
+            if(base.kind == PlaceKind::ELEMENT || (base.kind == PlaceKind::NAME && atVariable)) {
+                places.push_back({PlaceKind::ELEMENT, base.symbol, base.token});
+            } else {
+                consume(base);
+                const PlaceKind kind = base.kind == PlaceKind::VALUE ? PlaceKind::VALUE : PlaceKind::DERIVED;
+                places.push_back({kind, base.symbol, base.token});
+            }
+            break;
+        }
+        case MEMBER: {
+            const Place base = pop();
+            consume(base);
+            places.push_back({base.kind == PlaceKind::VALUE ? PlaceKind::VALUE : PlaceKind::DERIVED, base.symbol, base.token});
+            break;
+        }
+        case POSTFIX: {
+            const Place operand = pop();
+            if(operand.kind != PlaceKind::VALUE) {
+                Access &use = access(operand);
+                if(operand.kind == PlaceKind::ELEMENT) {
+                    use.indexedRead = use.indexedWrite = true;
+                } else {
+                    use.read = use.written = true;
+                }
+            }
+            places.push_back({PlaceKind::VALUE, noSymbol, oper.token});
+            break;
+        }
+        default:
+            for(std::uint32_t i = 0; i < oper.arity; ++i) { consume(pop()); }
+            places.push_back({PlaceKind::VALUE, noSymbol, oper.token});
+            break;
+        }
+    }
+    const Place result = pop();
+    while(!places.empty()) { consume(pop()); }
+    return result;
+}
+
+void ParallelChecker::consume(const Place &place) {
+    if(place.kind == PlaceKind::NAME) {
+        access(place).read = true;
+    } else if(place.kind == PlaceKind::ELEMENT) {
+        access(place).indexedRead = true;
+    }
+}
+
+SymbolIndex ParallelChecker::variableSymbol(std::uint32_t token) const noexcept {
+    const SymbolIndex symbol = names.binding(token);
+    if(symbol == noSymbol || names.getSymbols().symbol(symbol).kind == SymbolKind::FUNCTION) { return noSymbol; }
+    return symbol;
+}
+
+ParallelChecker::Access &ParallelChecker::access(const Place &place) {
+    const auto [found, inserted] = accesses.try_emplace(place.symbol);
+    if(inserted) { found->second.token = place.token; }
+    return found->second;
+}
+
+void ParallelChecker::dependency(std::uint32_t token, std::string message) {
+    diagnostics.emplace_back(DiagnosticKind::LOOP_DEPENDENCY, ast.getTokens()[token], std::move(message));
+}
+
+DISABLE_WARNINGS_POP()
@@ -0,0 +1,118 @@
+#include "Dersbiander/Profiler.hpp"
+#include "Dersbiander/Timer.hpp"
+#include <ostream>
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+namespace {
+    thread_local Profiler::ThreadBuffer *current = nullptr;
+
+    [[nodiscard]] std::string escape(std::string_view text) {
+        std::string out;
+        out.reserve(text.size());
+        for(const char cha : text) {
+            if(cha == '"' || cha == '\\') { out.push_back('\\'); }
+            out.push_back(static_cast<unsigned char>(cha) < ' ' ? ' ' : cha);
+        }
+        return out;
+    }
+
+    [[nodiscard]] std::string microseconds(std::uint64_t nanoseconds) {
+        return FORMAT("{}.{:03}", nanoseconds / 1000, nanoseconds % 1000);
+    }
+}  // namespace
+
+/// The cache is keyed by address, and the name behind an address is compared before it is trusted. On a miss the
+/// name is looked up by content: a name built again at a new address, as a temporary, keeps its first id.
+std::uint32_t Profiler::ThreadBuffer::intern(std::string_view name) {
+    if(const auto found = nameIds.find(name.data()); found != nameIds.end() && names[found->second] == name) [[likely]] {
+        return found->second;
+    }
+    if(const auto found = nameContents.find(name); found != nameContents.end()) {
+        nameIds[name.data()] = found->second;
+        return found->second;
+    }
+    const auto id = static_cast<std::uint32_t>(names.size());
+    names.emplace_back(name);
+    nameContents.emplace(name, id);
+    nameIds[name.data()] = id;
+    return id;
+}
+
+Profiler &Profiler::global() noexcept {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::ThreadBuffer &Profiler::buffer() {
+    if(current == nullptr) [[unlikely]] {
+        const std::scoped_lock lock(mutex);
+        threads.push_back(std::make_unique<ThreadBuffer>());
+        threads.back()->thread = static_cast<std::uint32_t>(threads.size());
+        current = threads.back().get();
+    }
+    return *current;
+}
+
+std::vector<Profiler::ZoneStats> Profiler::summary() const {
+    const std::scoped_lock lock(mutex);
+    std::map<std::string_view, std::vector<std::uint64_t>> durations;
+    for(const auto &thread : threads) {
+        for(const Event &event : thread->events) { durations[thread->names[event.name]].push_back(event.end - event.start); }
+    }
+    std::vector<ZoneStats> stats;
+    stats.reserve(durations.size());
+    for(auto &[name, times] : durations) {
+        std::ranges::sort(times);
+        const auto percentile = [&times](std::size_t percent) { return times[(times.size() - 1) * percent / 100]; };
+        std::uint64_t total = 0;
+        for(const std::uint64_t time : times) { total += time; }
+        stats.push_back(
+            ZoneStats{std::string{name}, times.size(), total, times.front(), times.back(), percentile(50), percentile(99)});
+    }
+    std::ranges::sort(stats, std::greater{}, &ZoneStats::total);
+    return stats;
+}
+
+std::string Profiler::report() const {
+    std::string out = FORMAT("{:<32} {:>8} {:>14} {:>12} {:>12} {:>12} {:>12}", "zone", "count", "total", "min", "p50", "p99",
+                             "max");
+    for(const ZoneStats &zone : summary()) {
+        out.append(FORMAT("{}{:<32} {:>8} {:>14} {:>12} {:>12} {:>12} {:>12}", CNL, zone.name, zone.count,
+                          Timer::make_time_str(C_LD(zone.total)), Timer::make_time_str(C_LD(zone.min)),
+                          Timer::make_time_str(C_LD(zone.p50)), Timer::make_time_str(C_LD(zone.p99)),
+                          Timer::make_time_str(C_LD(zone.max))));
+    }
+    return out;
+}
+
+/// Timestamps are in microseconds, with the nanoseconds as decimals.
+void Profiler::writeChromeTrace(std::ostream &out) const {
+    const std::scoped_lock lock(mutex);
+    out << R"({"displayTimeUnit":"ns","traceEvents":[)";
+    bool first = true;
+    const auto separate = [&out, &first] {
+        if(!first) { out << ",\n"; }
+        first = false;
+    };
+    for(const auto &thread : threads) {
+        separate();
+        out << FORMAT(R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":"thread {}"}}}})", thread->thread,
+                      thread->thread);
+        for(const Event &event : thread->events) {
+            separate();
+            out << FORMAT(R"({{"name":"{}","cat":"dersbiander","ph":"X","ts":{},"dur":{},"pid":1,"tid":{},)"
+                          R"("args":{{"depth":{}}}}})",
+                          escape(thread->names[event.name]), microseconds(event.start), microseconds(event.end - event.start),
+                          thread->thread, event.depth);
+        }
+    }
+    out << "]}\n";
+}
+
+void Profiler::clear() {
+    const std::scoped_lock lock(mutex);
+    for(const auto &thread : threads) { thread->events.clear(); }
+}
+
+DISABLE_WARNINGS_POP()
@@ -0,0 +1,538 @@
+#include "Dersbiander/ProgramGenerator.hpp"
+#include <ostream>
+#include <sstream>
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+namespace {
+    inline constexpr std::size_t chunkSize = 1U << 16U;
+    /// Declarations a scope takes before the following ones turn into assignments, which bounds the names remembered.
+    inline constexpr std::size_t maxVariables = 24;
+    inline constexpr std::size_t maxFunctions = 16;
+
+    inline constexpr std::array<std::string_view, 16> nameWords{"count", "total", "index", "value",  "weight", "offset",
+                                                                "delta", "limit", "scale", "result", "sum",    "width",
+                                                                "height", "ratio", "step", "flag"};
+    inline constexpr std::array<std::string_view, 16> textWords{"the",   "loop",   "adds",  "every", "value", "of",
+                                                                "array", "before", "which", "keeps", "a",     "running",
+                                                                "total", "and",    "then",  "checks"};
+}  // namespace
+
+void ProgramGenerator::generate(std::ostream &stream) {
+    out = &stream;
+    state = seedState();
+    bytes = lines = errors = names = 0;
+    functions.clear();
+    const GeneratorMix &mix = options.mix;
+    const std::uint64_t weights = std::uint64_t{mix.declarations} + mix.assignments + mix.loops + mix.conditions + mix.arrays +
+                                  mix.functions + mix.strings + mix.comments;
+    // Functions take their share of the size, main the rest.
+    const std::uint64_t functionBytes = mix.functions == 0 ? 0 : options.size * mix.functions / weights;
+    while(mix.functions > 0 && (functions.empty() || bytes + buffer.size() < functionBytes)) { function(); }
+    line(0, "main {");
+    scopes.assign(1, {});
+    while(!full()) { statement(1); }
+    scopes.clear();
+    line(0, "}");
+    flush();
+}
+
+std::string ProgramGenerator::generate() {
+    std::ostringstream stream;
+    generate(stream);
+    return stream.str();
+}
+
+/// One round of SplitMix64, so that nearby seeds, 0 included, start from unrelated non-zero states.
+std::uint64_t ProgramGenerator::seedState() const noexcept {
+    std::uint64_t mixed = options.seed + 0x9E3779B97F4A7C15ULL;
+    mixed = (mixed ^ (mixed >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+    mixed = (mixed ^ (mixed >> 27U)) * 0x94D049BB133111EBULL;
+    return (mixed ^ (mixed >> 31U)) | 1U;
+}
+
+/// xorshift64*.
+std::uint64_t ProgramGenerator::next() noexcept {
+    state ^= state >> 12U;
+    state ^= state << 25U;
+    state ^= state >> 27U;
+    return state * 0x2545F4914F6CDD1DULL;
+}
+
+std::size_t ProgramGenerator::below(std::size_t bound) noexcept { return static_cast<std::size_t>(next() % bound); }
+
+bool ProgramGenerator::chance(double probability) noexcept {
+    return static_cast<double>(next() >> 11U) * 0x1.0p-53 < probability;
+}
+
+void ProgramGenerator::write(std::string_view text) {
+    buffer.append(text);
+    if(buffer.size() >= chunkSize) [[unlikely]] { flush(); }
+}
+
+void ProgramGenerator::line(std::size_t depth, std::string_view text) {
+    buffer.append(depth, '\t');
+    buffer.append(text);
+    write("\n");
+    ++lines;
+}
+
+void ProgramGenerator::flush() {
+    out->write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    bytes += buffer.size();
+    buffer.clear();
+}
+
+std::string ProgramGenerator::newName() { return FORMAT("{}{}", nameWords[below(nameWords.size())], names++); }
+
+/**
+ * @brief A random variable of @p type in scope, or nullptr when there is none.
+ *
+ * Inside a `parallel for` only the variables of its own scopes can be assigned, and the array it fills is never
+ * picked, so its iterations stay independent.
+ */
+const ProgramGenerator::Variable *ProgramGenerator::pick(Type type, bool assignable) noexcept {
+    const std::size_t first = assignable ? parallelScope : 0;
+    const auto matches = [&](const Variable &variable) {
+        return variable.type == type && (!assignable || variable.assignable) && variable.name != filled;
+    };
+    std::size_t count = 0;
+    for(std::size_t scope = first; scope < scopes.size(); ++scope) {
+        count += C_ST(std::ranges::count_if(scopes[scope], matches));
+    }
+    if(count == 0) { return nullptr; }
+    std::size_t chosen = below(count);
+    for(std::size_t scope = first; scope < scopes.size(); ++scope) {
+        for(const Variable &variable : scopes[scope]) {
+            if(matches(variable) && chosen-- == 0) { return &variable; }
+        }
+    }
+    return nullptr;
+}
+
+bool ProgramGenerator::hasRoom() const noexcept { return scopes.back().size() < maxVariables; }
+
+void ProgramGenerator::declare(Variable variable) { scopes.back().push_back(std::move(variable)); }
+
+void ProgramGenerator::function() {
+    Function callee{FORMAT("compute{}", names++), {}, below(2) == 0 ? Type::INT : Type::DOUBLE};
+    std::vector<Variable> parameters;
+    std::string signature;
+    for(std::size_t count = 1 + below(3); parameters.size() < count;) {
+        const Type type = below(2) == 0 ? Type::INT : Type::DOUBLE;
+        parameters.push_back(Variable{newName(), type, 0, false});
+        callee.parameters.push_back(type);
+        signature.append(FORMAT("{}{}: {}", signature.empty() ? "" : ", ", parameters.back().name, typeName(type)));
+    }
+    line(0, FORMAT("func {}({}): {} {{", callee.name, signature, typeName(callee.result)));
+    scopes.assign(1, std::move(parameters));
+    for(std::size_t count = 1 + below(4); count > 0; --count) { statement(1); }
+    line(1, FORMAT("return {}", expression(callee.result, options.expressionDepth)));
+    scopes.clear();
+    line(0, "}");
+    if(functions.size() == maxFunctions) { functions.erase(functions.begin()); }
+    functions.push_back(std::move(callee));
+}
+
+/// Writes `header {`, one to four statements in a new scope holding @p locals, then `}`.
+void ProgramGenerator::block(std::size_t depth, std::string_view header, std::vector<Variable> locals) {
+    line(depth, FORMAT("{} {{", header));
+    scopes.push_back(std::move(locals));
+    for(std::size_t count = 1 + below(4); count > 0; --count) { statement(depth + 1); }
+    scopes.pop_back();
+    line(depth, "}");
+}
+
+void ProgramGenerator::statement(std::size_t depth) {
+    if(options.errorRate > 0.0 && chance(options.errorRate)) [[unlikely]] {
+        error(depth);
+        return;
+    }
+    const GeneratorMix &mix = options.mix;
+    const bool nest = depth <= options.depth;
+    const std::array<unsigned, 8> weights{mix.declarations,
+                                          mix.assignments,
+                                          nest ? mix.loops : 0U,
+                                          nest ? mix.conditions : 0U,
+                                          mix.arrays,
+                                          functions.empty() ? 0U : mix.functions,
+                                          mix.strings,
+                                          mix.comments};
+    std::size_t total = 0;
+    for(const unsigned weight : weights) { total += weight; }
+    if(total == 0) [[unlikely]] {
+        declaration(depth);
+        return;
+    }
+    std::size_t chosen = below(total);
+    std::size_t kind = 0;
+    while(chosen >= weights[kind]) { chosen -= weights[kind++]; }
+    switch(kind) {
+    case 0:
+        declaration(depth);
+        break;
+    case 1:
+        assignment(depth);
+        break;
+    case 2:
+        loop(depth);
+        break;
+    case 3:
+        condition(depth);
+        break;
+    case 4:
+        arrayStatement(depth);
+        break;
+    case 5:
+        callStatement(depth);
+        break;
+    case 6:
+        stringStatement(depth);
+        break;
+    default:
+        comment(depth);
+        break;
+    }
+}
+
+/// A constant, one variable or two of the same type: a full scope gets an assignment instead.
+void ProgramGenerator::declaration(std::size_t depth) {
+    if(!hasRoom()) {
+        assignment(depth);
+        return;
+    }
+    static constexpr std::array<Type, 4> types{Type::INT, Type::INT, Type::DOUBLE, Type::BOOL};
+    const Type type = types[below(types.size())];
+    const std::size_t form = below(6);
+    if(form == 0 && type == Type::INT) {
+        const std::string name = newName();
+        line(depth, FORMAT("const {}: int = {} * {}", name, 1 + below(50), 1 + below(20)));
+        declare(Variable{name, type, 0, false});
+    } else if(form == 1) {
+        const std::string first = newName();
+        const std::string second = newName();
+        line(depth, FORMAT("var {}, {}: {} = {}, {}", first, second, typeName(type), expression(type, options.expressionDepth),
+                           expression(type, options.expressionDepth)));
+        declare(Variable{first, type});
+        declare(Variable{second, type});
+    } else {
+        const std::string name = newName();
+        line(depth, FORMAT("var {}: {} = {}", name, typeName(type), expression(type, options.expressionDepth)));
+        declare(Variable{name, type});
+    }
+}
+
+void ProgramGenerator::assignment(std::size_t depth) {
+    static constexpr std::array<Type, 4> types{Type::INT, Type::INT, Type::DOUBLE, Type::BOOL};
+    const Type type = types[below(types.size())];
+    const Variable *target = pick(type, true);
+    if(target == nullptr) {
+        if(hasRoom()) {
+            declaration(depth);
+        } else {
+            comment(depth);
+        }
+        return;
+    }
+    const std::string name = target->name;
+    if(type == Type::INT) {
+        switch(below(6)) {
+        case 0:
+            line(depth, FORMAT("{}++", name));
+            return;
+        case 1:
+            line(depth, FORMAT("{} {}= {}", name, below(2) == 0 ? '+' : '-', intExpression(options.expressionDepth)));
+            return;
+        case 2:
+            if(const Variable *other = pick(Type::INT, true); other != nullptr && other->name != name) {
+                const std::string otherName = other->name;
+                line(depth, FORMAT("{}, {} = {}, {}", name, otherName, intExpression(options.expressionDepth),
+                                   intExpression(options.expressionDepth)));
+                return;
+            }
+            break;
+        default:
+            break;
+        }
+    } else if(type == Type::DOUBLE && below(3) == 0) {
+        line(depth, FORMAT("{} *= {}", name, doubleExpression(options.expressionDepth)));
+        return;
+    }
+    line(depth, FORMAT("{} = {}", name, expression(type, options.expressionDepth)));
+}
+
+/// Declares an array, assigns one of its elements, or fills it in a `for` or a `parallel for` over its `.len()`.
+void ProgramGenerator::arrayStatement(std::size_t depth) {
+    const Variable *array = pick(Type::ARRAY, true);
+    const std::size_t form = below(4);
+    if(array == nullptr || (form == 0 && hasRoom())) {
+        if(!hasRoom()) {
+            assignment(depth);
+            return;
+        }
+        const std::string name = newName();
+        const auto length = static_cast<std::uint32_t>(2 + below(5));
+        if(below(3) == 0) {
+            line(depth, FORMAT("var {}: int[{}]", name, length));
+        } else {
+            std::string elements;
+            for(std::uint32_t i = 0; i < length; ++i) {
+                elements.append(FORMAT("{}{}", i == 0 ? "" : ", ", intExpression(innerDepth())));
+            }
+            line(depth, FORMAT("var {}: int[{}] = [{}]", name, length, elements));
+        }
+        declare(Variable{name, Type::ARRAY, length});
+        return;
+    }
+    const std::string name = array->name;
+    const std::uint32_t length = array->length;
+    if(form == 1 || depth > options.depth) {
+        line(depth, FORMAT("{}[{}] = {}", name, below(length), intExpression(options.expressionDepth)));
+        return;
+    }
+    const std::string counter = newName();
+    const bool parallel = form == 3 && parallelScope == 0 && options.mix.loops > 0;
+    line(depth, FORMAT("{}for var {}: int = 0, {}.len() {{", parallel ? "parallel " : "", counter, name));
+    scopes.push_back({Variable{counter, Type::INT, 0, false}});
+    if(parallel) {
+        parallelScope = scopes.size() - 1;
+        filled = name;
+        for(std::size_t count = below(3); count > 0; --count) { statement(depth + 1); }
+        line(depth + 1, FORMAT("{}[{}] = {} + {}", name, counter, intExpression(innerDepth()), counter));
+        parallelScope = 0;
+        filled.clear();
+    } else {
+        line(depth + 1, FORMAT("{}[{}] = {}[{}] * 2 + {}", name, counter, name, counter, intExpression(innerDepth())));
+    }
+    scopes.pop_back();
+    line(depth, "}");
+}
+
+/// A `for` with a constant bound, and sometimes a step, over a counter of its own.
+void ProgramGenerator::loop(std::size_t depth) {
+    const std::string counter = newName();
+    const std::size_t bound = 1 + below(4);
+    const std::string header = below(3) == 0 ? FORMAT("for var {}: int = 0, {}, 2", counter, bound * 2)
+                                             : FORMAT("for var {}: int = 0, {}", counter, bound);
+    block(depth, header, {Variable{counter, Type::INT, 0, false}});
+}
+
+/// An `if`, or a `while` over a counter declared before it and incremented first thing in its body.
+void ProgramGenerator::condition(std::size_t depth) {
+    if(below(2) == 0 || !hasRoom()) {
+        block(depth, FORMAT("if({})", boolExpression(options.expressionDepth)));
+        return;
+    }
+    const std::string counter = newName();
+    line(depth, FORMAT("var {}: int = 0", counter));
+    declare(Variable{counter, Type::INT, 0, false});
+    line(depth, FORMAT("while({} < {}) {{", counter, 1 + below(4)));
+    scopes.emplace_back();
+    line(depth + 1, FORMAT("{}++", counter));
+    for(std::size_t count = 1 + below(3); count > 0; --count) { statement(depth + 1); }
+    scopes.pop_back();
+    line(depth, "}");
+}
+
+void ProgramGenerator::callStatement(std::size_t depth) {
+    const Type type = functions[below(functions.size())].result;
+    if(!hasRoom()) {
+        if(const Variable *target = pick(type, true); target != nullptr) {
+            const std::string name = target->name;
+            line(depth, FORMAT("{} = {}", name, call(type, options.expressionDepth)));
+        } else {
+            comment(depth);
+        }
+        return;
+    }
+    const std::string name = newName();
+    line(depth, FORMAT("var {}: {} = {}", name, typeName(type), call(type, options.expressionDepth)));
+    declare(Variable{name, type});
+}
+
+void ProgramGenerator::stringStatement(std::size_t depth) {
+    const Variable *source = pick(Type::STRING, false);
+    std::string value = FORMAT("\"{}\"", words(1 + below(6)));
+    if(source != nullptr && below(2) == 0) { value = FORMAT("{} + {}", source->name, value); }
+    if(!hasRoom()) {
+        if(const Variable *target = pick(Type::STRING, true); target != nullptr) {
+            const std::string name = target->name;
+            line(depth, FORMAT("{} = {}", name, value));
+        } else {
+            comment(depth);
+        }
+        return;
+    }
+    const std::string name = newName();
+    line(depth, FORMAT("var {}: string = {}", name, value));
+    declare(Variable{name, Type::STRING});
+}
+
+void ProgramGenerator::comment(std::size_t depth) {
+    switch(below(4)) {
+    case 0:
+        line(depth, FORMAT("/* {} */", words(2 + below(6))));
+        break;
+    case 1:
+        line(depth, "/*");
+        line(depth, FORMAT(" * {}", words(4 + below(8))));
+        line(depth, " */");
+        break;
+    default:
+        line(depth, FORMAT("// {}", words(3 + below(10))));
+        break;
+    }
+}
+
+/// A statement the Validator rejects, in one of the ways it reports with a single diagnostic.
+void ProgramGenerator::error(std::size_t depth) {
+    ++errors;
+    const std::string name = newName();
+    switch(below(4)) {
+    case 0:
+        line(depth, FORMAT("{} = {} +", name, intExpression(innerDepth())));
+        break;
+    case 1:
+        line(depth, FORMAT("{} = ) {}", name, intExpression(innerDepth())));
+        break;
+    case 2:
+        line(depth, FORMAT("{} = {} * / {}", name, 1 + below(9), intExpression(innerDepth())));
+        break;
+    default:
+        line(depth, FORMAT("var : int = {}", intExpression(innerDepth())));
+        break;
+    }
+}
+
+std::string ProgramGenerator::expression(Type type, std::size_t depth) {
+    switch(type) {
+        using enum Type;
+    case DOUBLE:
+        return doubleExpression(depth);
+    case BOOL:
+        return boolExpression(depth);
+    default:
+        return intExpression(depth);
+    }
+}
+
+/// Divisors are non-zero literals, so constant folding never divides by zero, and indices are below the length.
+std::string ProgramGenerator::intExpression(std::size_t depth) {
+    if(depth == 0 || below(3) == 0) {
+        switch(below(6)) {
+        case 0:
+        case 1:
+            if(const Variable *variable = pick(Type::INT, false); variable != nullptr) { return variable->name; }
+            break;
+        case 2:
+            if(const Variable *array = pick(Type::ARRAY, false); array != nullptr) {
+                return below(2) == 0 ? FORMAT("{}[{}]", array->name, below(array->length)) : FORMAT("{}.len()", array->name);
+            }
+            break;
+        case 3:
+            if(options.mix.functions > 0 && depth > 0) { return call(Type::INT, depth - 1); }
+            break;
+        default:
+            break;
+        }
+        return FORMAT("{}", below(1000));
+    }
+    switch(below(6)) {
+    case 0:
+        return FORMAT("({})", intExpression(depth - 1));
+    case 1:
+        return FORMAT("{} / {}", intExpression(depth - 1), 1 + below(9));
+    case 2:
+        return FORMAT("(-{})", intExpression(depth - 1));
+    default: {
+        static constexpr std::array<std::string_view, 3> operators{"+", "-", "*"};
+        return FORMAT("{} {} {}", intExpression(depth - 1), operators[below(operators.size())], intExpression(depth - 1));
+    }
+    }
+}
+
+/// Always has a double operand, so it never types as an int.
+std::string ProgramGenerator::doubleExpression(std::size_t depth) {
+    if(depth == 0 || below(3) == 0) {
+        switch(below(4)) {
+        case 0:
+            if(const Variable *variable = pick(Type::DOUBLE, false); variable != nullptr) { return variable->name; }
+            break;
+        case 1:
+            if(options.mix.functions > 0 && depth > 0) { return call(Type::DOUBLE, depth - 1); }
+            break;
+        default:
+            break;
+        }
+        return FORMAT("{}.{}", below(100), below(100));
+    }
+    switch(below(4)) {
+    case 0:
+        return FORMAT("({})", doubleExpression(depth - 1));
+    case 1:
+        return FORMAT("{} / {}.5", doubleExpression(depth - 1), below(9));
+    default: {
+        static constexpr std::array<std::string_view, 3> operators{"+", "-", "*"};
+        const std::string_view oper = operators[below(operators.size())];
+        return below(2) == 0 ? FORMAT("{} {} {}", doubleExpression(depth - 1), oper, intExpression(depth - 1))
+                             : FORMAT("{} {} {}", intExpression(depth - 1), oper, doubleExpression(depth - 1));
+    }
+    }
+}
+
+std::string ProgramGenerator::boolExpression(std::size_t depth) {
+    if(depth == 0 || below(3) == 0) {
+        if(below(2) == 0) {
+            if(const Variable *variable = pick(Type::BOOL, false); variable != nullptr) { return variable->name; }
+        }
+        return below(2) == 0 ? "true" : "false";
+    }
+    switch(below(5)) {
+    case 0:
+        return FORMAT("!({})", boolExpression(depth - 1));
+    case 1:
+        return FORMAT("{} {} {}", boolExpression(depth - 1), below(2) == 0 ? "&&" : "||", boolExpression(depth - 1));
+    default: {
+        static constexpr std::array<std::string_view, 6> comparisons{"<", ">", "<=", ">=", "==", "!="};
+        return FORMAT("{} {} {}", intExpression(depth - 1), comparisons[below(comparisons.size())], intExpression(depth - 1));
+    }
+    }
+}
+
+/// A call of one of the last functions returning @p result, or a literal when none does.
+std::string ProgramGenerator::call(Type result, std::size_t depth) {
+    std::size_t count = 0;
+    for(const Function &function : functions) { count += function.result == result ? 1 : 0; }
+    if(count == 0) { return result == Type::INT ? FORMAT("{}", below(1000)) : FORMAT("{}.{}", below(100), below(100)); }
+    std::size_t chosen = below(count);
+    const auto callee = std::ranges::find_if(functions, [&](const Function &function) {
+        return function.result == result && chosen-- == 0;
+    });
+    std::string arguments;
+    for(const Type parameter : callee->parameters) {
+        arguments.append(FORMAT("{}{}", arguments.empty() ? "" : ", ", expression(parameter, depth)));
+    }
+    return FORMAT("{}({})", callee->name, arguments);
+}
+
+std::string ProgramGenerator::words(std::size_t count) {
+    std::string text;
+    for(std::size_t i = 0; i < count; ++i) { text.append(FORMAT("{}{}", i == 0 ? "" : " ", textWords[below(textWords.size())])); }
+    return text;
+}
+
+std::string_view ProgramGenerator::typeName(Type type) noexcept {
+    switch(type) {
+        using enum Type;
+    case DOUBLE:
+        return "double";
+    case BOOL:
+        return "bool";
+    case STRING:
+        return "string";
+    default:
+        return "int";
+    }
+}
+
+DISABLE_WARNINGS_POP()
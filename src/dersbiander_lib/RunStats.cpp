@@ -0,0 +1,35 @@
+#include "Dersbiander/RunStats.hpp"
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+namespace {
+    /// Writes `"NAME":count` for every entry of @p counts, named as fmt formats the enum.
+    template <typename Enum, std::size_t Size> void appendCounts(std::string &out, const std::array<std::size_t, Size> &counts) {
+        out.push_back('{');
+        for(std::size_t i = 0; i < Size; ++i) {
+            if(i > 0) { out.push_back(','); }
+            out.append(FORMAT(R"("{}":{})", static_cast<Enum>(i), counts[i]));
+        }
+        out.push_back('}');
+    }
+}  // namespace
+
+/// Phase names are written as they are: they are literals of the caller, without quotes or backslashes.
+std::string RunStats::to_json() const {
+    std::string out = FORMAT(R"({{"input_bytes":{},"lines":{},"tokens":)", inputBytes, lines);
+    appendCounts<TokenType>(out, tokens);
+    out.append(R"(,"instructions":)");
+    appendCounts<InstructionType>(out, instructions);
+    out.append(FORMAT(R"(,"max_depth":{},"phases":{{)", maxDepth));
+    for(std::size_t i = 0; i < phases.size(); ++i) {
+        const Phase &phase = phases[i];
+        const double seconds = static_cast<double>(phase.nanoseconds) / 1e9;
+        const double mbPerSecond = seconds > 0.0 ? static_cast<double>(inputBytes) / 1e6 / seconds : 0.0;
+        out.append(FORMAT(R"({}"{}":{{"ns":{},"mb_per_s":{:.2f}}})", i > 0 ? "," : "", phase.name, phase.nanoseconds,
+                          mbPerSecond));
+    }
+    out.append("}}");
+    return out;
+}
+
+DISABLE_WARNINGS_POP()
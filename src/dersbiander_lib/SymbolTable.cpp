@@ -0,0 +1,65 @@
+#include "Dersbiander/SymbolTable.hpp"
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+namespace {
+    [[nodiscard]] constexpr std::size_t nextPowerOfTwo(std::size_t value) noexcept {
+        std::size_t result = 16;
+        while(result < value) { result <<= 1U; }
+        return result;
+    }
+}  // namespace
+
+SymbolTable::SymbolTable(std::size_t expectedNames) : slots(nextPowerOfTwo(expectedNames * 2)) {
+    symbols.reserve(expectedNames);
+}
+
+void SymbolTable::openScope() { scopes.push_back(undo.size()); }
+
+void SymbolTable::closeScope() noexcept {
+    if(scopes.empty()) [[unlikely]] { return; }
+    const std::size_t mark = scopes.back();
+    scopes.pop_back();
+    while(undo.size() > mark) {
+        const Undo &entry = undo.back();
+        slots[findSlot(entry.name)].symbol = entry.previous;
+        undo.pop_back();
+    }
+}
+
+SymbolIndex SymbolTable::declare(std::string_view name, SymbolKind kind, std::uint32_t token) {
+    // Keep the load factor under one half so probe sequences stay short.
+    if((used + 1) * 2 > slots.size()) [[unlikely]] { grow(); }
+    Slot &slot = slots[findSlot(name)];
+    const auto currentDepth = C_UI32T(depth());
+    if(slot.symbol != noSymbol && symbols[slot.symbol].depth == currentDepth) { return slot.symbol; }
+    if(slot.name.empty()) {
+        slot.name = name;
+        ++used;
+    }
+    undo.push_back(Undo{name, slot.symbol});
+    slot.symbol = C_UI32T(symbols.size());
+    symbols.push_back(Symbol{kind, token, currentDepth});
+    return noSymbol;
+}
+
+SymbolIndex SymbolTable::lookup(std::string_view name) const noexcept { return slots[findSlot(name)].symbol; }
+
+/// Linear probing: the slot holding @p name, or the empty slot where it would be inserted.
+std::size_t SymbolTable::findSlot(std::string_view name) const noexcept {
+    const std::size_t mask = slots.size() - 1;
+    std::size_t index = std::hash<std::string_view>{}(name) & mask;
+    while(!slots[index].name.empty() && slots[index].name != name) { index = (index + 1) & mask; }
+    return index;
+}
+
+/// Doubles the table. Names are never removed, so there are no tombstones to carry over.
+void SymbolTable::grow() {
+    std::vector<Slot> previous(slots.size() * 2);
+    previous.swap(slots);
+    for(const Slot &slot : previous) {
+        if(!slot.name.empty()) { slots[findSlot(slot.name)] = slot; }
+    }
+}
+
+DISABLE_WARNINGS_POP()
@@ -0,0 +1,122 @@
+#include "Dersbiander/ThreadPool.hpp"
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+namespace {
+    /// Set while a thread runs a task, so a nested run() does not wait for the workers it is occupying.
+    thread_local bool insideTask = false;
+}  // namespace
+
+ThreadPool::ThreadPool(std::size_t threads) {
+    queues.reserve(threads + 1);
+    for(std::size_t i = 0; i <= threads; ++i) { queues.push_back(std::make_unique<Queue>()); }
+    workers.reserve(threads);
+    for(std::size_t i = 0; i < threads; ++i) {
+        workers.emplace_back([this, i] { work(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        const std::scoped_lock lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for(std::thread &worker : workers) { worker.join(); }
+}
+
+ThreadPool &ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+std::size_t ThreadPool::defaultThreads() noexcept {
+    const unsigned hardware = std::thread::hardware_concurrency();
+    return hardware > 1 ? hardware - 1 : 0;
+}
+
+void ThreadPool::run(std::size_t tasks, const std::function<void(std::size_t)> &task) {
+    if(tasks == 0) { return; }
+    if(insideTask || workers.empty() || tasks == 1) {
+        for(std::size_t i = 0; i < tasks; ++i) { task(i); }
+        return;
+    }
+    const std::scoped_lock batch(batchMutex);
+    {
+        // A worker still draining the previous batch may find the new tasks before it is woken: the job comes first.
+        const std::scoped_lock lock(mutex);
+        job = &task;
+        remaining = tasks;
+        error = nullptr;
+    }
+    // Queue q gets the contiguous range [q * tasks / n, (q + 1) * tasks / n).
+    for(std::size_t q = 0; q < queues.size(); ++q) {
+        const std::scoped_lock lock(queues[q]->mutex);
+        const std::size_t last = (q + 1) * tasks / queues.size();
+        for(std::size_t i = q * tasks / queues.size(); i < last; ++i) { queues[q]->tasks.push_back(i); }
+    }
+    {
+        const std::scoped_lock lock(mutex);
+        ++generation;
+    }
+    wake.notify_all();
+    drain(workers.size());
+    std::unique_lock lock(mutex);
+    finished.wait(lock, [this] { return remaining == 0; });
+    job = nullptr;
+    if(error) { std::rethrow_exception(std::exchange(error, nullptr)); }
+}
+
+void ThreadPool::work(std::size_t self) {
+    std::size_t seen = 0;
+    for(;;) {
+        {
+            std::unique_lock lock(mutex);
+            wake.wait(lock, [this, seen] { return stopping || generation != seen; });
+            if(stopping) { return; }
+            seen = generation;
+        }
+        drain(self);
+    }
+}
+
+void ThreadPool::drain(std::size_t self) {
+    std::size_t task = 0;
+    while(take(self, task)) {
+        insideTask = true;
+        try {
+            (*job)(task);
+        } catch(...) {
+            const std::scoped_lock lock(mutex);
+            if(!error) { error = std::current_exception(); }
+        }
+        insideTask = false;
+        const std::scoped_lock lock(mutex);
+        if(--remaining == 0) { finished.notify_all(); }
+    }
+}
+
+/// The newest task of the own queue, which is still warm in its cache, or the oldest of another one.
+bool ThreadPool::take(std::size_t self, std::size_t &task) {
+    {
+        Queue &own = *queues[self];
+        const std::scoped_lock lock(own.mutex);
+        if(!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for(std::size_t offset = 1; offset < queues.size(); ++offset) {
+        Queue &victim = *queues[(self + offset) % queues.size()];
+        const std::scoped_lock lock(victim.mutex);
+        if(!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+DISABLE_WARNINGS_POP()
@@ -1,4 +1,5 @@
 #include "Dersbiander/Tokenizer.hpp"
+#include "Dersbiander/Instrument.hpp"
 
 DISABLE_WARNINGS_PUSH(
     4005 4201 4459 4514 4625 4626 4820 6244 6285 6385 6386 26409 26415 26418 26429 26432 26437 26438 26440 26446 26447 26450 26451 26455 26457 26459 26460 26461 26467 26472 26473 26474 26475 26481 26482 26485 26490 26491 26493 26494 26495 26496 26497 26498 26800 26814 26818 26826)
@@ -28,7 +29,11 @@ bool Tokenizer::isPositionInText() const noexcept { return position < _inputSize
  * @sa Tokenizer::setDelimiters()
  */
 std::vector<Token> Tokenizer::tokenize() {
+    PROFILE_ZONE("tokenize");
+    INSTRUMENT_TIMER(LEXER, "lexer.tokenize");
     std::vector<Token> tokens;
+    typeCounts.fill(0);
+    std::size_t counted = 0;
     while(isPositionInText()) {
         const char currentChar = _input[position];
         if(std::isalpha(currentChar)) [[likely]] {
@@ -57,11 +62,18 @@ std::vector<Token> Tokenizer::tokenize() {
             continue;  // Continue the loop to get the next token
         } else [[unlikely]] {
             handleError(std::string(1, currentChar), "Unknown Character");
-            std::exit(-1);  // Terminate the program with an error code
+            if(exitOnError) { std::exit(-1); }  // Terminate the program with an error code
+            tokens.emplace_back(TokenType::UNKNOWN, std::string(1, currentChar), line, column);
+            incPosAndCol();
         }
+        // The tokens just made are still in cache: counting them here saves a pass over the whole vector.
+        for(; counted < tokens.size(); ++counted) { ++typeCounts[static_cast<std::size_t>(tokens[counted].getType())]; }
     }
 
     tokens.emplace_back(eofTokenType, "", line, column - 1);
+    ++typeCounts[static_cast<std::size_t>(eofTokenType)];
+    INSTRUMENT_COUNT(LEXER, "lexer.bytes", _inputSize);
+    INSTRUMENT_COUNT(LEXER, "lexer.tokens", tokens.size());
 
     return tokens;
 }
@@ -77,7 +89,8 @@ std::vector<Token> Tokenizer::tokenize() {
  * @param errorMsg The error message describing the nature of the error.
  */
 void Tokenizer::handleError(const std::string &values, const std::string &errorMsg) {
-    Timer timer(errorMsg);
+    INSTRUMENT_COUNT(LEXER, "lexer.errors", 1);
+    if(!exitOnError) { return; }
 
     const auto &lineStart = findLineStart();
     const auto &lineEnd = findLineEnd();
@@ -86,7 +99,7 @@ void Tokenizer::handleError(const std::string &values, const std::string &errorM
     std::string highlighting = getHighlighting(lineStart, values.length());
     std::string errorMessage = getErrorMessage(values, errorMsg, contextLine, highlighting);
 
-    LERROR("{}{}", errorMessage, timer.to_string());
+    LERROR("{}", errorMessage);
 }
 
 /**
@@ -224,6 +237,7 @@ void Tokenizer::kewordType(const std::string &value, TokenType &type) const {
     if(value == "var" || value == "const") { type = KEYWORD_VAR; }
     if(value == "if" || value == "while") { type = KEYWORD_STRUCTURE; }
     if(value == "for") { type = KEYWORD_FOR; }
+    if(value == "parallel") { type = KEYWORD_PARALLEL; }
     if(value == "func") { type = KEYWORD_FUNC; }
     if(value == "return") { type = KEYWORD_RETURN; }
     if(value == "true" || value == "false") { type = BOOLEAN; }
@@ -362,14 +376,19 @@ void Tokenizer::extractOperator(std::vector<Token> &tokens) {
     std::string value;
 
     extractVarLenOperator(value);
-    while(!value.empty()) {
-        Token token;
-        if(value.size() > 1) { token = {typeByValue(value.substr(0, 2)), value.substr(0, 2), line, column - 2}; }
-        if(token.getType() == TokenType::UNKNOWN || value.size() == 1) {
-            token = Token{typeBySingleCharacter(value[0]), std::string(1, value[0]), line, column - 1};
+    // Walks the run once: erasing the front of the run for every token made long runs quadratic.
+    for(std::size_t start = 0; start < value.size();) {
+        const std::size_t offset = value.size() - start;
+        if(offset > 1) {
+            const std::string pair = value.substr(start, 2);
+            if(const TokenType type = typeByValue(pair); type != TokenType::UNKNOWN) {
+                tokens.emplace_back(type, pair, line, column - offset);
+                start += 2;
+                continue;
+            }
         }
-        tokens.emplace_back(token);
-        value.erase(0, token.getValue().size());
+        tokens.emplace_back(typeBySingleCharacter(value[start]), std::string(1, value[start]), line, column - offset);
+        ++start;
     }
 }
 
@@ -425,8 +444,8 @@ Token Tokenizer::extractChar() {
     std::size_t startcol = column;
     incPosAndCol();
     std::string value;
-    while(!TokenizerUtils::isApostrophe(_input[position])) {
-        if(position + 1 == _inputSize || TokenizerUtils::inCNL(_input[position])) {
+    while(!isPositionInText() || !TokenizerUtils::isApostrophe(_input[position])) {
+        if(position + 1 >= _inputSize || TokenizerUtils::inCNL(_input[position])) {
             return {UNKNOWN, "'" + value + "'", line, column - startcol};
         }
         appendCharToValue(value);
@@ -440,8 +459,8 @@ Token Tokenizer::extractString() {
     using enum TokenType;
     incPosAndCol();
     std::string value;
-    while(!TokenizerUtils::isQuotation(_input[position])) {
-        if(position + 1 == _inputSize) { return {UNKNOWN, "\"" + value + "\"", line, column}; }
+    while(!isPositionInText() || !TokenizerUtils::isQuotation(_input[position])) {
+        if(position + 1 >= _inputSize) { return {UNKNOWN, "\"" + value + "\"", line, column}; }
         if(TokenizerUtils::inCNL(_input[position])) {
             ++line;
             column = 1;
@@ -491,7 +510,7 @@ Token Tokenizer::extractComment() {
 std::string Tokenizer::handleWithSingleLineComment() {
     std::string value;
 
-    while(_input[position] != CNL) { appendCharToValue(value); }
+    while(isPositionInText() && _input[position] != CNL) { appendCharToValue(value); }
     return value;
 }
 
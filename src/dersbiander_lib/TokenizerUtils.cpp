@@ -8,7 +8,7 @@ DISABLE_WARNINGS_PUSH(
 bool TokenizerUtils::isPlusORMinus(char cha) noexcept { return cha == '+' || cha == '-'; }
 
 bool TokenizerUtils::isComment(const std::string_view &inputSpan, size_t position) noexcept {
-    return position != inputSpan.size() && inputSpan[position] == '/' &&
+    return position + 1 < inputSpan.size() && inputSpan[position] == '/' &&
            (inputSpan[position + 1] == '/' || inputSpan[position + 1] == '*');
 }
 // NOLINTNEXTLINE
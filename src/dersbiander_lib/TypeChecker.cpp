@@ -0,0 +1,513 @@
+#include "Dersbiander/TypeChecker.hpp"
+#include "Dersbiander/Profiler.hpp"
+#include <charconv>
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+namespace {
+    [[nodiscard]] constexpr bool isIntegral(TypeId type) noexcept { return type >= TypeTable::boolType && type <= TypeTable::intType; }
+    /// Scalars that can be a component of a vector.
+    [[nodiscard]] constexpr bool isNumber(TypeId type) noexcept {
+        return type >= TypeTable::charType && type <= TypeTable::doubleType;
+    }
+
+    /// Literal integer dimensions, or constant ones when a folder ran, have a fixed length; the others are dynamic.
+    [[nodiscard]] std::uint32_t dimensionLength(const Ast &ast, const ConstantFolder *folder, NodeIndex dimension) {
+        if(ast.node(dimension).kind != AstKind::EXPRESSION) { return TypeTable::dynamicLength; }
+        if(folder != nullptr) {
+            const std::optional<Value> length = folder->value(dimension);
+            if(!length || length->kind != ValueKind::INT || length->integer < 0 || length->integer >= TypeTable::dynamicLength) {
+                return TypeTable::dynamicLength;
+            }
+            return C_UI32T(length->integer);
+        }
+        const auto code = ast.code(dimension);
+        if(code.size() != 1 || ast.getTokens()[code.front().token].getType() != TokenType::INTEGER) {
+            return TypeTable::dynamicLength;
+        }
+        std::uint32_t length = 0;
+        const std::string &value = ast.getTokens()[code.front().token].getValue();
+        const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), length);
+        return error == std::errc{} ? length : TypeTable::dynamicLength;
+    }
+}  // namespace
+
+TypeChecker::TypeChecker(const Ast &tree, const NameResolver &resolver)
+  : ast(tree), names(resolver), nodeTypes(tree.size(), TypeTable::unknownType),
+    symbolTypes(resolver.getSymbols().symbolCount(), TypeTable::unknownType),
+    signatureOf(resolver.getSymbols().symbolCount(), noSignature) {}
+
+std::vector<Diagnostic> TypeChecker::check() {
+    PROFILE_ZONE("check types");
+    diagnostics.clear();
+    if(ast.getRoot() == invalidNode) { return {}; }
+    declareFunctions();
+    checkNode(ast.getRoot());
+    return std::move(diagnostics);
+}
+
+std::span<const TypeId> TypeChecker::returnTypes(SymbolIndex function) const noexcept {
+    if(function >= signatureOf.size() || signatureOf[function] == noSignature) { return {}; }
+    const Signature &signature = signatures[signatureOf[function]];
+    if(signature.overloaded) { return {}; }
+    return signature.returns;
+}
+
+/// Functions are hoisted, so their signatures and parameter types are known before any call is checked.
+void TypeChecker::declareFunctions() {
+    for(NodeIndex function = 0; function < ast.size(); ++function) {
+        if(ast.node(function).kind != AstKind::FUNCTION) { continue; }
+        const auto children = ast.children(function);
+        Signature signature{{}, {}, false};
+        for(const NodeIndex parameter : ast.children(children[0])) {
+            const TypeId type = typeOfTypeNode(ast.children(parameter)[0]);
+            signature.parameters.push_back(type);
+            const SymbolIndex symbol = names.binding(ast.node(parameter).token);
+            if(symbol != noSymbol) { symbolTypes[symbol] = type; }
+        }
+        for(const NodeIndex type : ast.children(children[1])) { signature.returns.push_back(typeOfTypeNode(type)); }
+        const SymbolIndex symbol = names.binding(ast.node(function).token);
+        if(symbol == noSymbol) { continue; }
+        if(signatureOf[symbol] != noSignature) {
+            signatures[signatureOf[symbol]].overloaded = true;
+            continue;
+        }
+        signatureOf[symbol] = C_UI32T(signatures.size());
+        signatures.push_back(std::move(signature));
+    }
+}
+
+void TypeChecker::checkNode(NodeIndex index) {
+    switch(ast.node(index).kind) {
+        using enum AstKind;
+    case DECLARATION:
+        checkDeclaration(index);
+        break;
+    case ASSIGNMENT:
+        checkAssignment(index);
+        break;
+    case FOR: {
+        const auto children = ast.children(index);
+        checkNode(children[0]);
+        const TypeId bound = checkCondition(children[1]);
+        const TypeId step = ast.node(children[2]).kind == AstKind::EXPRESSION ? inferExpression(children[2]) : TypeTable::intType;
+        if(ast.token(index).getType() == TokenType::KEYWORD_PARALLEL) { checkParallelFor(index, bound, step); }
+        checkNode(children[3]);
+        break;
+    }
+    case STRUCTURE: {
+        [[maybe_unused]] const TypeId condition = checkCondition(ast.children(index)[0]);
+        checkNode(ast.children(index)[1]);
+        break;
+    }
+    case FUNCTION:
+        checkFunction(index);
+        break;
+    case RETURN:
+        checkReturn(index);
+        break;
+    case TYPE:
+        // Types are built in declareFunctions() and checkDeclaration(): here only the dimensions are checked.
+        for(const NodeIndex dimension : ast.children(index)) { checkNode(dimension); }
+        break;
+    case EXPRESSION: {
+        [[maybe_unused]] const TypeId type = inferExpression(index);
+        break;
+    }
+    default:
+        checkChildren(index);
+        break;
+    }
+}
+
+/// One value per name, or a single value given to every name.
+void TypeChecker::checkDeclaration(NodeIndex index) {
+    const auto children = ast.children(index);
+    const auto declared = ast.children(children[0]);
+    const auto values = ast.children(children[2]);
+    checkNode(children[1]);
+    const TypeId type = typeOfTypeNode(children[1]);
+    for(const NodeIndex name : declared) {
+        const SymbolIndex symbol = names.binding(ast.node(name).token);
+        if(symbol != noSymbol) { symbolTypes[symbol] = type; }
+    }
+    if(values.empty()) { return; }
+    if(values.size() != 1 && values.size() != declared.size()) {
+        mismatch(ast.node(index).token, FORMAT("{} names declared with {} values", declared.size(), values.size()));
+    }
+    for(const NodeIndex value : values) {
+        const TypeId valueType = inferExpression(value);
+        expectAssignable(ast.node(value).token, type, valueType);
+    }
+}
+
+/// `a, b = x, y` assigns pairwise, `a += x` checks the operator first.
+void TypeChecker::checkAssignment(NodeIndex index) {
+    const auto children = ast.children(index);
+    const auto targets = ast.children(children[0]);
+    const auto values = ast.children(children[1]);
+    const std::uint32_t oper = ast.node(index).token;
+    const bool compound = ast.getTokens()[oper].getType() == TokenType::OPERATION_EQUAL;
+    if(values.size() != 1 && values.size() != targets.size()) {
+        mismatch(oper, FORMAT("{} targets assigned {} values", targets.size(), values.size()));
+    }
+    std::vector<TypeId> valueTypes;
+    valueTypes.reserve(values.size());
+    for(const NodeIndex value : values) { valueTypes.push_back(inferExpression(value)); }
+    for(std::size_t i = 0; i < targets.size(); ++i) {
+        const TypeId target = inferExpression(targets[i]);
+        const TypeId value = valueTypes[std::min(i, valueTypes.size() - 1)];
+        expectAssignable(oper, target, compound ? binary(oper, target, value) : value);
+    }
+}
+
+/// Conditions of if, while and for are scalars: booleans, or numbers for the bound of a for loop.
+TypeId TypeChecker::checkCondition(NodeIndex index) {
+    if(ast.node(index).kind != AstKind::EXPRESSION) { return TypeTable::unknownType; }
+    const TypeId type = inferExpression(index);
+    if(!TypeTable::isScalar(type) && !types.isOpaque(type)) [[unlikely]] {
+        mismatch(ast.node(index).token, FORMAT("condition of type {}", types.to_string(type)));
+    }
+    return type;
+}
+
+/// The iterations of a parallel for are counted before it starts: the variable, the bound and the step are integers.
+void TypeChecker::checkParallelFor(NodeIndex index, TypeId bound, TypeId step) {
+    const auto children = ast.children(index);
+    const NodeIndex variable = ast.children(ast.children(children[0])[0])[0];
+    const std::uint32_t token = ast.node(variable).kind == AstKind::EXPRESSION ? ast.code(variable).front().token
+                                                                                 : ast.node(variable).token;
+    const SymbolIndex symbol = names.binding(token);
+    const auto integral = [this](TypeId type) {
+        return type == TypeTable::charType || type == TypeTable::intType || types.isOpaque(type);
+    };
+    if(symbol != noSymbol && !integral(symbolTypes[symbol])) [[unlikely]] {
+        mismatch(token, FORMAT("parallel for over a variable of type {}", types.to_string(symbolTypes[symbol])));
+    }
+    if(ast.node(children[1]).kind == AstKind::EXPRESSION && !integral(bound)) [[unlikely]] {
+        mismatch(ast.node(children[1]).token, FORMAT("parallel for bound of type {}", types.to_string(bound)));
+    }
+    if(!integral(step)) [[unlikely]] {
+        mismatch(ast.node(children[2]).token, FORMAT("parallel for step of type {}", types.to_string(step)));
+    }
+}
+
+void TypeChecker::checkFunction(NodeIndex index) {
+    const SymbolIndex symbol = names.binding(ast.node(index).token);
+    const Signature *previous = currentFunction;
+    currentFunction = symbol != noSymbol && signatureOf[symbol] != noSignature ? &signatures[signatureOf[symbol]] : nullptr;
+    // Overloads share one symbol: only the first signature is known, so the others are not checked against it.
+    if(currentFunction != nullptr && currentFunction->overloaded) { currentFunction = nullptr; }
+    checkNode(ast.children(index)[2]);
+    currentFunction = previous;
+}
+
+/// A function without return types may return anything, otherwise the values must match them one by one.
+void TypeChecker::checkReturn(NodeIndex index) {
+    const auto values = ast.children(index);
+    std::vector<TypeId> valueTypes;
+    valueTypes.reserve(values.size());
+    for(const NodeIndex value : values) { valueTypes.push_back(inferExpression(value)); }
+    if(currentFunction == nullptr || currentFunction->returns.empty()) { return; }
+    if(valueTypes.size() != currentFunction->returns.size()) {
+        mismatch(ast.node(index).token, FORMAT("{} values returned, {} expected", valueTypes.size(), currentFunction->returns.size()));
+        return;
+    }
+    for(std::size_t i = 0; i < valueTypes.size(); ++i) {
+        expectAssignable(ast.node(values[i]).token, currentFunction->returns[i], valueTypes[i]);
+    }
+}
+
+void TypeChecker::checkChildren(NodeIndex index) {
+    for(const NodeIndex child : ast.children(index)) { checkNode(child); }
+}
+
+/// `name[a][b]` is an array of `a` arrays of `b` elements of `name`.
+TypeId TypeChecker::typeOfTypeNode(NodeIndex index) {
+    TypeId type = types.named(ast.token(index).getValue());
+    const auto dimensions = ast.children(index);
+    for(auto dimension = dimensions.rbegin(); dimension != dimensions.rend(); ++dimension) {
+        type = types.array(type, dimensionLength(ast, folder, *dimension));
+    }
+    return type;
+}
+
+TypeId TypeChecker::inferExpression(NodeIndex index) {
+    stack.clear();
+    const auto code = ast.code(index);
+    for(const PostfixOp &oper : code) {
+        const std::size_t base = stack.size() - std::min<std::size_t>(oper.arity, stack.size());
+        const std::span<const Value> operands{stack.data() + base, stack.size() - base};
+        Value result{TypeTable::unknownType, noSymbol};
+        // Only the callee of a call may be a vector or matrix type.
+        for(const Value &operand : operands.subspan(oper.kind == PostfixKind::CALL && !operands.empty() ? 1 : 0)) {
+            if(operand.constructs != TypeTable::unknownType) [[unlikely]] { typeAsValue(oper.token, operand.constructs); }
+        }
+        switch(oper.kind) {
+            using enum PostfixKind;
+        case IDENTIFIER: {
+            const SymbolIndex symbol = names.binding(oper.token);
+            if(symbol != noSymbol) {
+                result = names.getSymbols().symbol(symbol).kind == SymbolKind::FUNCTION ? Value{TypeTable::unknownType, symbol}
+                                                                                         : Value{symbolTypes[symbol], noSymbol};
+            } else {
+                result.constructs = TypeTable::wideType(ast.getTokens()[oper.token].getValue());
+            }
+            break;
+        }
+        case LITERAL:
+            switch(ast.getTokens()[oper.token].getType()) {
+                using enum TokenType;
+            case BOOLEAN:
+                result.type = TypeTable::boolType;
+                break;
+            case CHAR:
+                result.type = TypeTable::charType;
+                break;
+            case INTEGER:
+                result.type = TypeTable::intType;
+                break;
+            case DOUBLE:
+                result.type = TypeTable::doubleType;
+                break;
+            default:
+                result.type = TypeTable::stringType;
+                break;
+            }
+            break;
+        case UNARY:
+            [[fallthrough]];
+        case POSTFIX:
+            result.type = operands.empty() ? TypeTable::unknownType : unary(oper.token, operands[0].type);
+            break;
+        case BINARY:
+            result.type = operands.size() == 2 ? binary(oper.token, operands[0].type, operands[1].type) : TypeTable::unknownType;
+            break;
+        case INDEX:
+            result.type = operands.size() == 2 ? indexType(oper.token, operands[0].type, operands[1].type) : TypeTable::unknownType;
+            break;
+        case CALL:
+            result.type = call(oper.token, operands);
+            break;
+        case ARRAY:
+            result.type = arrayLiteral(operands);
+            break;
+        case MEMBER:
+            result.type = operands.size() == 1 ? member(oper.token, operands[0].type) : TypeTable::unknownType;
+            break;
+        default:
+            // `()` is opaque.
+            break;
+        }
+        stack.resize(base);
+        stack.push_back(result);
+    }
+    if(!stack.empty() && stack.back().constructs != TypeTable::unknownType) [[unlikely]] {
+        typeAsValue(code.back().token, stack.back().constructs);
+    }
+    const TypeId type = stack.empty() ? TypeTable::unknownType : stack.back().type;
+    nodeTypes[index] = type;
+    return type;
+}
+
+TypeId TypeChecker::binary(std::uint32_t token, TypeId left, TypeId right) {
+    const Token &oper = ast.getTokens()[token];
+    const char symbol = oper.getValue().empty() ? '\0' : oper.getValue().front();
+    const bool opaque = types.isOpaque(left) || types.isOpaque(right);
+    const bool scalars = TypeTable::isScalar(left) && TypeTable::isScalar(right);
+    const bool arrays = types.get(left).kind == TypeKind::ARRAY || types.get(right).kind == TypeKind::ARRAY;
+    if(arrays && !opaque && oper.getType() != TokenType::LOGICAL_OPERATOR) { return elementwise(token, left, right); }
+    switch(oper.getType()) {
+        using enum TokenType;
+    case LOGICAL_OPERATOR:
+        if(!opaque && !scalars) { break; }
+        return TypeTable::boolType;
+    case BOOLEAN_OPERATOR:
+        // Vectors and matrices are equal or not, they have no order.
+        if(opaque || scalars || (left == right && (!TypeTable::isWide(left) || symbol == '=' || symbol == '!'))) {
+            return TypeTable::boolType;
+        }
+        break;
+    default:
+        if(symbol == '+' && (left == TypeTable::stringType || right == TypeTable::stringType) &&
+           (TypeTable::isScalar(left) || TypeTable::isScalar(right) || left == right)) {
+            return TypeTable::stringType;
+        }
+        if(opaque) { return TypeTable::unknownType; }
+        if(scalars) { return std::max({left, right, TypeTable::intType}); }
+        if(const TypeId type = wideArithmetic(symbol, left, right); type != TypeTable::unknownType) { return type; }
+        break;
+    }
+    mismatch(token, FORMAT("operator {} on {} and {}", oper.getValue(), types.to_string(left), types.to_string(right)));
+    return TypeTable::unknownType;
+}
+
+/// `-x` and `x++` promote like arithmetic, `!x` yields bool.
+TypeId TypeChecker::unary(std::uint32_t token, TypeId operand) {
+    const Token &oper = ast.getTokens()[token];
+    const bool negation = oper.getType() == TokenType::NOT_OPERATOR;
+    if(types.isOpaque(operand)) { return negation ? TypeTable::boolType : TypeTable::unknownType; }
+    if(TypeTable::isScalar(operand)) {
+        if(negation) { return TypeTable::boolType; }
+        return oper.getType() == TokenType::UNARY_OPERATOR ? operand : std::max(operand, TypeTable::intType);
+    }
+    if(TypeTable::isWide(operand) && oper.getType() == TokenType::MINUS_OPERATOR) { return operand; }
+    const TypeDescriptor descriptor = types.get(operand);
+    if(descriptor.kind == TypeKind::ARRAY && oper.getType() == TokenType::MINUS_OPERATOR) {
+        const TypeId element = unary(token, descriptor.element);
+        return element == TypeTable::unknownType ? element : types.array(element, descriptor.length);
+    }
+    mismatch(token, FORMAT("operator {} on {}", oper.getValue(), types.to_string(operand)));
+    return TypeTable::unknownType;
+}
+
+/// Two arrays pair their elements and need the same length, a scalar pairs with every element of an array.
+TypeId TypeChecker::elementwise(std::uint32_t token, TypeId left, TypeId right) {
+    const TypeDescriptor leftDescriptor = types.get(left);
+    const TypeDescriptor rightDescriptor = types.get(right);
+    const bool leftArray = leftDescriptor.kind == TypeKind::ARRAY;
+    const bool rightArray = rightDescriptor.kind == TypeKind::ARRAY;
+    const std::uint32_t leftLength = leftArray ? leftDescriptor.length : TypeTable::dynamicLength;
+    const std::uint32_t rightLength = rightArray ? rightDescriptor.length : TypeTable::dynamicLength;
+    const bool fixed = leftLength != TypeTable::dynamicLength && rightLength != TypeTable::dynamicLength;
+    if(fixed && leftLength != rightLength) [[unlikely]] {
+        const std::string &symbol = ast.getTokens()[token].getValue();
+        mismatch(token, FORMAT("operator {} on {} and {}", symbol, types.to_string(left), types.to_string(right)));
+        return TypeTable::unknownType;
+    }
+    const TypeId element = binary(token, leftArray ? leftDescriptor.element : left, rightArray ? rightDescriptor.element : right);
+    if(element == TypeTable::unknownType) { return element; }
+    return types.array(element, leftLength != TypeTable::dynamicLength ? leftLength : rightLength);
+}
+
+TypeId TypeChecker::indexType(std::uint32_t token, TypeId base, TypeId position) {
+    if(!isIntegral(position) && !types.isOpaque(position)) [[unlikely]] {
+        mismatch(token, FORMAT("index of type {}", types.to_string(position)));
+    }
+    const TypeDescriptor &descriptor = types.get(base);
+    if(descriptor.kind == TypeKind::ARRAY) { return descriptor.element; }
+    if(base == TypeTable::stringType) { return TypeTable::charType; }
+    if(!types.isOpaque(base)) [[unlikely]] { mismatch(token, FORMAT("indexing a value of type {}", types.to_string(base))); }
+    return TypeTable::unknownType;
+}
+
+/**
+ * @brief The type of @p left @p symbol @p right when one of them is a vector or a matrix, unknownType when invalid.
+ *
+ * Vectors combine with a vector of the same type or a number component by component. Matrices add and subtract
+ * matrices of the same type, multiply them, vectors of their size on either side and numbers, and divide by numbers.
+ */
+TypeId TypeChecker::wideArithmetic(char symbol, TypeId left, TypeId right) const noexcept {
+    const bool leftMatrix = types.get(left).kind == TypeKind::MATRIX;
+    const bool rightMatrix = types.get(right).kind == TypeKind::MATRIX;
+    if(!TypeTable::isWide(left) && !TypeTable::isWide(right)) { return TypeTable::unknownType; }
+    switch(symbol) {
+    case '+':
+        [[fallthrough]];
+    case '-':
+        return left == right ? left : TypeTable::unknownType;
+    case '*':
+        if(left == right || isNumber(left)) { return right; }
+        if(isNumber(right)) { return left; }
+        if(leftMatrix && types.get(left).element == right) { return right; }
+        if(rightMatrix && types.get(right).element == left) { return left; }
+        return TypeTable::unknownType;
+    case '/':
+        if(isNumber(right) || (left == right && !leftMatrix)) { return left; }
+        return isNumber(left) && !rightMatrix ? right : TypeTable::unknownType;
+    default:
+        return TypeTable::unknownType;
+    }
+}
+
+TypeId TypeChecker::member(std::uint32_t token, TypeId base) {
+    const TypeDescriptor &descriptor = types.get(base);
+    if(!TypeTable::isWide(base)) { return TypeTable::unknownType; }
+    const std::string &letters = ast.getTokens()[token].getValue();
+    const std::optional<std::uint16_t> pattern = swizzlePattern(letters, C_UI8T(descriptor.length));
+    if(descriptor.kind == TypeKind::MATRIX || !pattern) [[unlikely]] {
+        mismatch(token, FORMAT("member {} of {}", letters, types.to_string(base)));
+        return TypeTable::unknownType;
+    }
+    const std::size_t count = letters.size();
+    return count == 1 ? TypeTable::doubleType : TypeTable::vec2Type + C_UI32T(count) - 2;
+}
+
+/// Only calls of a known, not overloaded function or of a vector or matrix type are checked: everything else is opaque.
+TypeId TypeChecker::call(std::uint32_t token, std::span<const Value> values) {
+    if(values.empty()) { return TypeTable::unknownType; }
+    const Value &callee = values.front();
+    if(callee.constructs != TypeTable::unknownType) { return construct(token, callee.constructs, values.subspan(1)); }
+    if(callee.function == noSymbol) {
+        if(!types.isOpaque(callee.type)) [[unlikely]] { mismatch(token, FORMAT("calling a value of type {}", types.to_string(callee.type))); }
+        return TypeTable::unknownType;
+    }
+    const std::uint32_t signatureIndex = signatureOf[callee.function];
+    if(signatureIndex == noSignature || signatures[signatureIndex].overloaded) { return TypeTable::unknownType; }
+    const Signature &signature = signatures[signatureIndex];
+    const auto arguments = values.subspan(1);
+    if(arguments.size() != signature.parameters.size()) {
+        mismatch(token, FORMAT("{} arguments given, {} expected", arguments.size(), signature.parameters.size()));
+    } else {
+        for(std::size_t i = 0; i < arguments.size(); ++i) { expectAssignable(token, signature.parameters[i], arguments[i].type); }
+    }
+    return signature.returns.size() == 1 ? signature.returns.front() : TypeTable::unknownType;
+}
+
+/// `vec3()` is zero, `vec3(x)` repeats `x` on every component and `mat3(x)` on the diagonal, otherwise every component
+/// of a vector is a number and every column of a matrix a vector.
+TypeId TypeChecker::construct(std::uint32_t token, TypeId type, std::span<const Value> arguments) {
+    const TypeDescriptor &descriptor = types.get(type);
+    if(arguments.size() > 1 && arguments.size() != descriptor.length) [[unlikely]] {
+        mismatch(token, FORMAT("{} arguments given to {}, 0, 1 or {} expected", arguments.size(), types.to_string(type),
+                               descriptor.length));
+        return type;
+    }
+    const bool columns = arguments.size() > 1 && descriptor.kind == TypeKind::MATRIX;
+    const TypeId expected = columns ? descriptor.element : TypeTable::doubleType;
+    for(const Value &argument : arguments) {
+        const bool valid = expected == TypeTable::doubleType ? isNumber(argument.type) : argument.type == expected;
+        if(!valid && !types.isOpaque(argument.type)) [[unlikely]] {
+            mismatch(token, FORMAT("{} argument of {}", types.to_string(argument.type), types.to_string(type)));
+        }
+    }
+    return type;
+}
+
+void TypeChecker::typeAsValue(std::uint32_t token, TypeId type) {
+    mismatch(token, FORMAT("{} is a type, it can only be called", types.to_string(type)));
+}
+
+/// The element type is the common type of the elements, unknown when they do not agree.
+TypeId TypeChecker::arrayLiteral(std::span<const Value> values) {
+    TypeId element = values.empty() ? TypeTable::unknownType : values.front().type;
+    for(const Value &value : values) {
+        if(value.type == element) { continue; }
+        element = TypeTable::isScalar(value.type) && TypeTable::isScalar(element) ? std::max(value.type, element)
+                                                                                  : TypeTable::unknownType;
+    }
+    return types.array(element, C_UI32T(values.size()));
+}
+
+bool TypeChecker::isAssignable(TypeId target, TypeId value) const noexcept {
+    if(target == value || types.isOpaque(target) || types.isOpaque(value)) { return true; }
+    if(TypeTable::isScalar(target) && TypeTable::isScalar(value)) { return value <= target && (target != TypeTable::charType || value == target); }
+    if(target == TypeTable::stringType) { return value == TypeTable::charType; }
+    const TypeDescriptor &targetDescriptor = types.get(target);
+    const TypeDescriptor &valueDescriptor = types.get(value);
+    if(targetDescriptor.kind != TypeKind::ARRAY || valueDescriptor.kind != TypeKind::ARRAY) { return false; }
+    return (targetDescriptor.length == TypeTable::dynamicLength || targetDescriptor.length == valueDescriptor.length) &&
+           isAssignable(targetDescriptor.element, valueDescriptor.element);
+}
+
+void TypeChecker::expectAssignable(std::uint32_t token, TypeId target, TypeId value) {
+    if(!isAssignable(target, value)) [[unlikely]] {
+        mismatch(token, FORMAT("cannot assign {} to {}", types.to_string(value), types.to_string(target)));
+    }
+}
+
+void TypeChecker::mismatch(std::uint32_t token, std::string message) {
+    diagnostics.emplace_back(DiagnosticKind::TYPE_MISMATCH, ast.getTokens()[token], std::move(message));
+}
+
+DISABLE_WARNINGS_POP()
@@ -0,0 +1,83 @@
+#include "Dersbiander/TypeTable.hpp"
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+TypeTable::TypeTable() {
+    using enum TypeKind;
+    for(const TypeKind kind : {UNKNOWN, BOOL, CHAR, INT, DOUBLE, STRING}) {
+        [[maybe_unused]] const TypeId type = intern(TypeDescriptor{kind, unknownType, 0, {}});
+    }
+    for(const TypeKind kind : {VECTOR, MATRIX}) {
+        for(std::uint32_t size = 2; size <= 4; ++size) {
+            const TypeId element = kind == VECTOR ? doubleType : vec2Type + size - 2;
+            [[maybe_unused]] const TypeId type = intern(TypeDescriptor{kind, element, size, {}});
+        }
+    }
+}
+
+TypeId TypeTable::named(std::string_view name) {
+    if(name == "bool") { return boolType; }
+    if(name == "char") { return charType; }
+    if(name == "int") { return intType; }
+    if(name == "double") { return doubleType; }
+    if(name == "string") { return stringType; }
+    if(const TypeId type = wideType(name); type != unknownType) { return type; }
+    return intern(TypeDescriptor{TypeKind::NAMED, unknownType, 0, name});
+}
+
+TypeId TypeTable::wideType(std::string_view name) noexcept {
+    if(name.size() != 4 || name[3] < '2' || name[3] > '4') { return unknownType; }
+    const TypeId offset = C_UI32T(name[3] - '2');
+    if(name.starts_with("vec")) { return vec2Type + offset; }
+    return name.starts_with("mat") ? mat2Type + offset : unknownType;
+}
+
+TypeId TypeTable::array(TypeId element, std::uint32_t length) { return intern(TypeDescriptor{TypeKind::ARRAY, element, length, {}}); }
+
+std::string TypeTable::to_string(TypeId type) const {
+    const TypeDescriptor &descriptor = types[type];
+    switch(descriptor.kind) {
+        using enum TypeKind;
+    case BOOL:
+        return "bool";
+    case CHAR:
+        return "char";
+    case INT:
+        return "int";
+    case DOUBLE:
+        return "double";
+    case STRING:
+        return "string";
+    case NAMED:
+        return std::string{descriptor.name};
+    case VECTOR:
+        return FORMAT("vec{}", descriptor.length);
+    case MATRIX:
+        return FORMAT("mat{}", descriptor.length);
+    case ARRAY:
+        if(descriptor.length == dynamicLength) { return FORMAT("{}[]", to_string(descriptor.element)); }
+        return FORMAT("{}[{}]", to_string(descriptor.element), descriptor.length);
+    default:
+        return "unknown";
+    }
+}
+
+bool TypeTable::isOpaque(TypeId type) const noexcept {
+    while(types[type].kind == TypeKind::ARRAY) { type = types[type].element; }
+    return types[type].kind == TypeKind::UNKNOWN || types[type].kind == TypeKind::NAMED;
+}
+
+std::size_t TypeTable::DescriptorHash::operator()(const TypeDescriptor &descriptor) const noexcept {
+    std::size_t result = std::hash<std::string_view>{}(descriptor.name);
+    result ^= (static_cast<std::size_t>(descriptor.kind) << 56U) ^ (static_cast<std::size_t>(descriptor.element) << 24U) ^
+              descriptor.length;
+    return result * 0x9E3779B97F4A7C15ULL;
+}
+
+TypeId TypeTable::intern(const TypeDescriptor &descriptor) {
+    const auto [found, inserted] = ids.try_emplace(descriptor, C_UI32T(types.size()));
+    if(inserted) { types.push_back(descriptor); }
+    return found->second;
+}
+
+DISABLE_WARNINGS_POP()
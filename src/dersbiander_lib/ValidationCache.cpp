@@ -0,0 +1,39 @@
+#include "Dersbiander/ValidationCache.hpp"
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+const ValidationCache::Entry *ValidationCache::find(std::uint64_t key, std::span<const Token> line) noexcept {
+    const auto found = entries.find(key);
+    if(found != entries.end() && std::ranges::equal(found->second.types, line, {}, {}, &Token::getType)) [[likely]] {
+        ++hits;
+        return &found->second;
+    }
+    ++misses;
+    return nullptr;
+}
+
+const ValidationCache::Entry &ValidationCache::insert(std::uint64_t key, std::span<const Token> line, Instruction &&state,
+                                                      std::size_t errorOffset, std::size_t lastOffset) {
+    if(entries.size() >= maxEntries && !entries.contains(key)) [[unlikely]] { entries.clear(); }
+    std::vector<TokenType> types;
+    types.reserve(line.size());
+    for(const Token &token : line) { types.emplace_back(token.getType()); }
+    const InstructionType statementType = state.getFirstInstructionType();
+    std::optional<Instruction> kept;
+    if(errorOffset != noError || !state.canTerminate()) { kept.emplace(std::move(state)); }
+    // A colliding key simply takes the slot over: the most recent shape is the most likely to repeat.
+    Entry entry{std::move(types), std::move(kept), statementType, errorOffset, lastOffset};
+    return entries.insert_or_assign(key, std::move(entry)).first->second;
+}
+
+/// FNV-1a over the token types.
+std::uint64_t ValidationCache::hash(std::span<const Token> line) noexcept {
+    std::uint64_t result = 14695981039346656037ULL;
+    for(const Token &token : line) {
+        result ^= static_cast<std::uint64_t>(token.getType());
+        result *= 1099511628211ULL;
+    }
+    return result;
+}
+
+DISABLE_WARNINGS_POP()
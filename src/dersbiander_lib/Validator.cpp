@@ -0,0 +1,160 @@
+#include "Dersbiander/Validator.hpp"
+#include "Dersbiander/Instrument.hpp"
+
+DISABLE_WARNINGS_PUSH(26461 26821)
+
+Validator::Validator(const std::vector<Token> &tokenList) : tokens(tokenList), brackets(tokenList) {}
+
+/**
+ * @brief Validates every statement of the token stream.
+ *
+ * A failing token does not stop the validation: the error is recorded, the validator skips to the next statement
+ * boundary and resumes with a fresh Instruction. The first line of every statement is looked up in the cache and the
+ * state machine only runs on a miss.
+ *
+ * @return The diagnostics found, in source order. An empty vector means the whole stream is valid.
+ */
+std::vector<Diagnostic> Validator::validate() {
+    PROFILE_ZONE("validate");
+    INSTRUMENT_TIMER(VALIDATOR, "validator.validate");
+    std::vector<Diagnostic> diagnostics;
+    if(tokens.empty()) [[unlikely]] { return diagnostics; }
+    Instruction instruction;
+    // Whether the statement goes on past its first line: only then does instruction hold its state.
+    bool continued = false;
+    bool startNew = true;
+    bool statementValid = false;
+    std::size_t statementStart = 0;
+    std::size_t previous = 0;
+    std::size_t line = tokens.front().getLine();
+    std::size_t index = 0;
+    while(index < tokens.size()) {
+        const Token &token = tokens[index];
+        if(token.getType() == TokenType::COMMENT) [[unlikely]] {
+            ++index;
+            continue;
+        }
+        if(startNew || token.getLine() >= line) [[likely]] {
+            const bool unterminated = !startNew && continued && !instruction.canTerminate();
+            if(unterminated && instruction.getLastInstructionType() != InstructionType::EXPRESSION &&
+               token.getType() != TokenType::STRING) [[unlikely]] {
+                diagnostics.emplace_back(DiagnosticKind::UNEXPECTED_ENDL, tokens[previous], instruction.getAllowedTokens());
+                statementValid = false;
+                startNew = true;
+            }
+            line = token.getLine() + 1;
+            if(startNew || !continued || instruction.canTerminate()) [[likely]] {
+                if(statementValid && builder != nullptr) { builder->statement(statementStart, index); }
+                statementStart = index;
+                statementValid = true;
+                ++instructionCount;
+                startNew = false;
+                const std::size_t lineEnd = findLineEnd(index);
+                const ValidationCache::Entry &entry = checkLine(index, lineEnd);
+                ++instructionTypeCounts[static_cast<std::size_t>(entry.statementType)];
+                if(entry.errorOffset != ValidationCache::noError) [[unlikely]] {
+                    const std::size_t errorIndex = index + entry.errorOffset;
+                    const std::vector<TokenType> &allowed = entry.state->getAllowedTokens();
+                    diagnostics.emplace_back(DiagnosticKind::UNEXPECTED_TOKEN, tokens[errorIndex], allowed);
+                    statementValid = false;
+                    index = recover(statementStart, errorIndex);
+                    startNew = true;
+                    continue;
+                }
+                continued = entry.state.has_value();
+                if(continued) { instruction = *entry.state; }
+                previous = index + entry.lastOffset;
+                index = lineEnd;
+                continue;
+            }
+        }
+        const auto &[verify, token_s] = instruction.checkToken(token);
+        INSTRUMENT_COUNT(VALIDATOR, "validator.tokens checked", 1);
+        LTRACE("{} {}", verify, token_s);
+        if(!verify) [[unlikely]] {
+            diagnostics.emplace_back(DiagnosticKind::UNEXPECTED_TOKEN, token, instruction.getAllowedTokens());
+            statementValid = false;
+            index = recover(statementStart, index);
+            startNew = true;
+            continue;
+        }
+        previous = index;
+        ++index;
+    }
+    if(builder != nullptr) {
+        if(statementValid) { builder->statement(statementStart, tokens.size()); }
+        builder->finish();
+    }
+    INSTRUMENT_COUNT(VALIDATOR, "validator.statements", instructionCount);
+    INSTRUMENT_COUNT(VALIDATOR, "validator.errors", diagnostics.size());
+    return diagnostics;
+}
+
+/// Index one past the last token on the line of @p first, comments included.
+std::size_t Validator::findLineEnd(std::size_t first) const noexcept {
+    const std::size_t currentLine = tokens[first].getLine();
+    std::size_t index = first + 1;
+    while(index < tokens.size() && tokens[index].getLine() <= currentLine) { ++index; }
+    return index;
+}
+
+/**
+ * @brief Runs a fresh Instruction over the tokens in [first, last), or takes the outcome from the cache.
+ *
+ * Only the first line of a statement goes through here: it always starts from the initial state, so its outcome
+ * depends on the type sequence alone. The following lines of a multi-line statement continue from the returned state.
+ */
+const ValidationCache::Entry &Validator::checkLine(std::size_t first, std::size_t last) {
+    const std::span<const Token> line{tokens.data() + first, last - first};
+    const std::uint64_t key = ValidationCache::hash(line);
+    if(const ValidationCache::Entry *entry = cache.find(key, line); entry != nullptr) [[likely]] { return *entry; }
+    Instruction instruction;
+    std::size_t errorOffset = ValidationCache::noError;
+    std::size_t lastOffset = 0;
+    for(std::size_t offset = 0; offset < line.size(); ++offset) {
+        if(line[offset].getType() == TokenType::COMMENT) [[unlikely]] { continue; }
+        const auto &[verify, token_s] = instruction.checkToken(line[offset]);
+        INSTRUMENT_COUNT(VALIDATOR, "validator.tokens checked", 1);
+        LTRACE("{} {}", verify, token_s);
+        if(!verify) [[unlikely]] {
+            errorOffset = offset;
+            break;
+        }
+        lastOffset = offset;
+    }
+    return cache.insert(key, line, std::move(instruction), errorOffset, lastOffset);
+}
+
+/**
+ * @brief Finds where validation can resume after an error.
+ *
+ * The scan stops at the first token that can start a new statement: a curly bracket or the end of the file, or a token
+ * on a later line once every round and square bracket opened by the failed statement has been closed (an O(1) depth
+ * lookup in the BracketIndex). A statement
+ * keyword at the beginning of a line also ends the scan, so an unclosed bracket cannot swallow the rest of the file.
+ *
+ * @param statementStart Index of the first token of the failed statement.
+ * @param errorIndex Index of the rejected token.
+ * @return The index of the token that starts the next statement.
+ */
+std::size_t Validator::recover(std::size_t statementStart, std::size_t errorIndex) const noexcept {
+    using enum TokenType;
+    const long depth = brackets.depth(statementStart);
+    const std::size_t errorLine = tokens[errorIndex].getLine();
+    // A rejected first token is never a valid restart point: it would be rejected again.
+    std::size_t index = errorIndex == statementStart ? errorIndex + 1 : errorIndex;
+    for(; index < tokens.size(); ++index) {
+        const TokenType type = tokens[index].getType();
+        if(type == eofTokenType || type == OPEN_CURLY_BRACKETS || type == CLOSED_CURLY_BRACKETS) { return index; }
+        if(tokens[index].getLine() > errorLine && (brackets.depth(index) <= depth || isStatementKeyword(type))) { return index; }
+    }
+    return index;
+}
+
+bool Validator::isStatementKeyword(TokenType type) noexcept {
+    using enum TokenType;
+    return type == KEYWORD_MAIN || type == KEYWORD_VAR || type == KEYWORD_STRUCTURE || type == KEYWORD_FOR ||
+           type == KEYWORD_PARALLEL || type == KEYWORD_FUNC || type == KEYWORD_RETURN;
+}
+
+DISABLE_WARNINGS_POP()
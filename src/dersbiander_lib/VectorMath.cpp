@@ -0,0 +1,158 @@
+#include "Dersbiander/VectorMath.hpp"
+#include "Dersbiander/VirtualMachine.hpp"
+#include "Dersbiander/glm_matld.hpp"
+#include <cstring>
+#include <type_traits>
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+namespace {
+    // The aligned types are the ones glm computes with SSE or NEON when its configuration allows it.
+#if defined(GLM_CONFIG_ALIGNED_GENTYPES) && GLM_CONFIG_ALIGNED_GENTYPES == GLM_ENABLE
+    using Vec4 = glm::vec<4, float, glm::aligned_highp>;
+    using Mat4 = glm::mat<4, 4, float, glm::aligned_highp>;
+#else
+    using Vec4 = glm::vec4;
+    using Mat4 = glm::mat4;
+#endif
+    static_assert(sizeof(Mat4) == sizeof(Lanes) && std::is_trivially_copyable_v<Mat4> && std::is_trivially_copyable_v<Vec4>);
+
+    [[nodiscard]] inline Vec4 loadVector(const Value &value) noexcept {
+        Vec4 result;
+        std::memcpy(&result, value.lanes->values.data(), sizeof(result));
+        return result;
+    }
+    [[nodiscard]] inline Mat4 loadMatrix(const Value &value) noexcept {
+        Mat4 result;
+        std::memcpy(&result, value.lanes->values.data(), sizeof(result));
+        return result;
+    }
+    /// A vector operand, or a scalar one on every component.
+    [[nodiscard]] inline Vec4 broadcast(const Value &value) noexcept {
+        return value.kind == ValueKind::VECTOR ? loadVector(value) : Vec4(static_cast<float>(value.asDouble()));
+    }
+
+    Value store(const Vec4 &vector, std::uint8_t size, Lanes &out) noexcept {
+        std::memcpy(out.values.data(), &vector, sizeof(vector));
+        for(std::size_t lane = size; lane < 4; ++lane) { out.values[lane] = 0.0F; }
+        return Value::fromLanes(ValueKind::VECTOR, size, out);
+    }
+    Value store(const Mat4 &matrix, std::uint8_t size, Lanes &out) noexcept {
+        std::memcpy(out.values.data(), &matrix, sizeof(matrix));
+        for(std::size_t column = 0; column < 4; ++column) {
+            for(std::size_t row = column < size ? size : 0; row < 4; ++row) { out.values[column * 4 + row] = 0.0F; }
+        }
+        return Value::fromLanes(ValueKind::MATRIX, size, out);
+    }
+
+    [[noreturn]] void invalid(OpCode op, const Value &left, const Value &right) {
+        throw RuntimeError(FORMAT("{} on {} and {}", op, left, right));
+    }
+
+    /// Division by a zero lane gives infinity or NaN there, which store() clears like any other unused lane.
+    [[nodiscard]] Value vectorArithmetic(OpCode op, const Value &left, const Value &right, Lanes &out) {
+        const std::uint8_t size = left.kind == ValueKind::VECTOR ? left.size : right.size;
+        const Vec4 first = broadcast(left);
+        const Vec4 second = broadcast(right);
+        switch(op) {
+            using enum OpCode;
+        case ADD:
+            return store(first + second, size, out);
+        case SUB:
+            return store(first - second, size, out);
+        case MUL:
+            return store(first * second, size, out);
+        case DIV:
+            return store(first / second, size, out);
+        default:
+            invalid(op, left, right);
+        }
+    }
+
+    [[nodiscard]] Value matrixArithmetic(OpCode op, const Value &left, const Value &right, Lanes &out) {
+        const bool leftMatrix = left.kind == ValueKind::MATRIX;
+        const bool rightMatrix = right.kind == ValueKind::MATRIX;
+        if(op == OpCode::MUL && left.kind == ValueKind::VECTOR) { return store(loadVector(left) * loadMatrix(right), left.size, out); }
+        if(op == OpCode::MUL && right.kind == ValueKind::VECTOR) { return store(loadMatrix(left) * loadVector(right), right.size, out); }
+        if(leftMatrix && rightMatrix) {
+            switch(op) {
+                using enum OpCode;
+            case ADD:
+                return store(loadMatrix(left) + loadMatrix(right), left.size, out);
+            case SUB:
+                return store(loadMatrix(left) - loadMatrix(right), left.size, out);
+            case MUL:
+                return store(loadMatrix(left) * loadMatrix(right), left.size, out);
+            default:
+                invalid(op, left, right);
+            }
+        }
+        if(rightMatrix && op == OpCode::MUL && !left.isWide()) {
+            return store(static_cast<float>(left.asDouble()) * loadMatrix(right), right.size, out);
+        }
+        if(!leftMatrix || right.isWide()) { invalid(op, left, right); }
+        const auto factor = static_cast<float>(right.asDouble());
+        switch(op) {
+            using enum OpCode;
+        case MUL:
+            return store(loadMatrix(left) * factor, left.size, out);
+        case DIV:
+            return store(loadMatrix(left) / factor, left.size, out);
+        default:
+            invalid(op, left, right);
+        }
+    }
+}  // namespace
+
+Value wideArithmetic(OpCode op, const Value &left, const Value &right, Lanes &out) {
+    if(op == OpCode::NEG) {
+        if(left.kind == ValueKind::VECTOR) { return store(-loadVector(left), left.size, out); }
+        return store(-loadMatrix(left), left.size, out);
+    }
+    if(left.kind == ValueKind::MATRIX || right.kind == ValueKind::MATRIX) { return matrixArithmetic(op, left, right, out); }
+    return vectorArithmetic(op, left, right, out);
+}
+
+Value buildWide(VectorShape shape, const Value *arguments, Lanes &out) {
+    // NOLINTBEGIN(*-pro-bounds-pointer-arithmetic)
+    if(!shape.matrix) {
+        Vec4 vector(0.0F);
+        if(shape.arguments == 1) { vector = broadcast(arguments[0]); }
+        for(std::size_t i = 0; shape.arguments > 1 && i < std::min<std::size_t>(shape.arguments, 4); ++i) {
+            vector[static_cast<glm::length_t>(i)] = static_cast<float>(arguments[i].asDouble());
+        }
+        return store(vector, shape.size, out);
+    }
+    Mat4 matrix(0.0F);
+    if(shape.arguments == 1) { matrix = Mat4(static_cast<float>(arguments[0].asDouble())); }
+    for(std::size_t column = 0; shape.arguments > 1 && column < std::min<std::size_t>(shape.arguments, 4); ++column) {
+        if(arguments[column].kind != ValueKind::VECTOR) [[unlikely]] {
+            throw RuntimeError(FORMAT("column {} of a mat{} is {}", column, shape.size, arguments[column]));
+        }
+        matrix[static_cast<glm::length_t>(column)] = loadVector(arguments[column]);
+    }
+    // NOLINTEND(*-pro-bounds-pointer-arithmetic)
+    return store(matrix, shape.size, out);
+}
+
+Value swizzle(const Value &source, std::uint16_t pattern, Lanes &out) {
+    if(source.kind != ValueKind::VECTOR) [[unlikely]] { throw RuntimeError(FORMAT("swizzle of {}", source)); }
+    const unsigned count = pattern >> 8U;
+    const auto lane = [pattern](unsigned i) { return static_cast<glm::length_t>((pattern >> (2 * i)) & 3U); };
+    const Vec4 vector = loadVector(source);
+    if(count == 1) { return Value::fromDouble(vector[lane(0)]); }
+    Vec4 picked(0.0F);
+    for(unsigned i = 0; i < count; ++i) { picked[static_cast<glm::length_t>(i)] = vector[lane(i)]; }
+    return store(picked, static_cast<std::uint8_t>(count), out);
+}
+
+/// A product of vectors across iterations has no identity that works for both `v *= w` and `v *= m`.
+Value wideIdentity(OpCode op, const Value &variable, Lanes &out) {
+    if(variable.kind == ValueKind::VECTOR) {
+        if(op == OpCode::MUL) [[unlikely]] { throw RuntimeError("a parallel for cannot multiply a vector across iterations"); }
+        return store(Vec4(0.0F), variable.size, out);
+    }
+    return store(Mat4(op == OpCode::MUL ? 1.0F : 0.0F), variable.size, out);
+}
+
+DISABLE_WARNINGS_POP()
@@ -0,0 +1,440 @@
+#include "Dersbiander/VirtualMachine.hpp"
+#include "Dersbiander/ArrayMath.hpp"
+#include "Dersbiander/NativeCompiler.hpp"
+#include "Dersbiander/Profiler.hpp"
+#include "Dersbiander/ThreadPool.hpp"
+#include "Dersbiander/VectorMath.hpp"
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+#if defined(__GNUC__) || defined(__clang__)
+#define DERSBIANDER_COMPUTED_GOTO
+#endif
+
+namespace {
+    [[nodiscard]] inline bool bothIntegral(const Value &left, const Value &right) noexcept {
+        return left.kind <= ValueKind::INT && right.kind <= ValueKind::INT;
+    }
+
+    /**
+     * @brief A vector, matrix or array result, which goes to the storage of its register @p target.
+     *
+     * evaluate() alone has no storage.
+     */
+    [[nodiscard]] Value outOfLine(OpCode op, const Value &left, const Value &right, const RegisterStorage &storage,
+                                  std::uint16_t target) {
+        // NOLINTBEGIN(*-pro-bounds-pointer-arithmetic)
+        if(left.kind == ValueKind::ARRAY || right.kind == ValueKind::ARRAY) {
+            if(storage.arrays == nullptr) [[unlikely]] { throw RuntimeError(FORMAT("{} of an array outside a register", op)); }
+            return arrayArithmetic(op, left, right, storage.arrays[target]);
+        }
+        if(storage.lanes == nullptr) [[unlikely]] {
+            throw RuntimeError(FORMAT("{} of a vector or a matrix outside a register", op));
+        }
+        return wideArithmetic(op, left, right, storage.lanes[target]);
+        // NOLINTEND(*-pro-bounds-pointer-arithmetic)
+    }
+
+    // Integer arithmetic wraps around instead of overflowing into undefined behaviour.
+    [[nodiscard]] inline std::int64_t wrap(std::uint64_t value) noexcept { return static_cast<std::int64_t>(value); }
+    [[nodiscard]] inline std::uint64_t bits(std::int64_t value) noexcept { return static_cast<std::uint64_t>(value); }
+
+    [[nodiscard]] inline Value add(const Value &left, const Value &right, const RegisterStorage &storage, std::uint16_t target) {
+        if(bothIntegral(left, right)) [[likely]] { return Value::fromInt(wrap(bits(left.asInt()) + bits(right.asInt()))); }
+        if(!left.isScalar() || !right.isScalar()) [[unlikely]] { return outOfLine(OpCode::ADD, left, right, storage, target); }
+        return Value::fromDouble(left.asDouble() + right.asDouble());
+    }
+    [[nodiscard]] inline Value subtract(const Value &left, const Value &right, const RegisterStorage &storage,
+                                        std::uint16_t target) {
+        if(bothIntegral(left, right)) [[likely]] { return Value::fromInt(wrap(bits(left.asInt()) - bits(right.asInt()))); }
+        if(!left.isScalar() || !right.isScalar()) [[unlikely]] { return outOfLine(OpCode::SUB, left, right, storage, target); }
+        return Value::fromDouble(left.asDouble() - right.asDouble());
+    }
+    [[nodiscard]] inline Value multiply(const Value &left, const Value &right, const RegisterStorage &storage,
+                                        std::uint16_t target) {
+        if(bothIntegral(left, right)) [[likely]] { return Value::fromInt(wrap(bits(left.asInt()) * bits(right.asInt()))); }
+        if(!left.isScalar() || !right.isScalar()) [[unlikely]] { return outOfLine(OpCode::MUL, left, right, storage, target); }
+        return Value::fromDouble(left.asDouble() * right.asDouble());
+    }
+    [[nodiscard]] Value divide(const Value &left, const Value &right, const RegisterStorage &storage, std::uint16_t target) {
+        if(bothIntegral(left, right)) [[likely]] {
+            const std::int64_t divisor = right.asInt();
+            if(divisor == 0) [[unlikely]] { throw RuntimeError("Integer division by zero"); }
+            if(divisor == -1) { return Value::fromInt(wrap(0 - bits(left.asInt()))); }
+            return Value::fromInt(left.asInt() / divisor);
+        }
+        if(!left.isScalar() || !right.isScalar()) [[unlikely]] { return outOfLine(OpCode::DIV, left, right, storage, target); }
+        return Value::fromDouble(left.asDouble() / right.asDouble());
+    }
+    [[nodiscard]] inline Value negate(const Value &value, const RegisterStorage &storage, std::uint16_t target) {
+        if(value.kind <= ValueKind::INT) [[likely]] { return Value::fromInt(wrap(0 - bits(value.asInt()))); }
+        if(!value.isScalar()) [[unlikely]] { return outOfLine(OpCode::NEG, value, value, storage, target); }
+        return Value::fromDouble(-value.real);
+    }
+    [[nodiscard]] inline Value step(const Value &value, std::int64_t delta) noexcept {
+        if(value.kind != ValueKind::DOUBLE) [[likely]] { return Value::fromInt(wrap(bits(value.asInt()) + bits(delta))); }
+        return Value::fromDouble(value.real + static_cast<double>(delta));
+    }
+    /// Integers compare exactly, anything mixed with a double compares as double, and a NaN is unordered, which fails
+    /// every test but `!= 0`. Vectors and matrices are only equal or greater, for not equal.
+    [[nodiscard]] inline std::partial_ordering compare(const Value &left, const Value &right) noexcept {
+        if(bothIntegral(left, right)) [[likely]] { return left.asInt() <=> right.asInt(); }
+        if(left.isWide() || right.isWide()) [[unlikely]] {
+            return left == right ? std::partial_ordering::equivalent : std::partial_ordering::greater;
+        }
+        return left.asDouble() <=> right.asDouble();
+    }
+    /// A comparison of @p op, whose @p test of the compare() result is its scalar value; arrays compare element-wise.
+    template <typename Test>
+    [[nodiscard]] inline Value relation(OpCode op, const Value &left, const Value &right, const RegisterStorage &storage,
+                                        std::uint16_t target, Test test) {
+        if(left.kind == ValueKind::ARRAY || right.kind == ValueKind::ARRAY) [[unlikely]] {
+            return outOfLine(op, left, right, storage, target);
+        }
+        return Value::fromBool(test(compare(left, right)));
+    }
+    [[nodiscard]] inline Value raise(const Value &left, const Value &right, const RegisterStorage &storage,
+                                     std::uint16_t target) {
+        if(left.kind == ValueKind::ARRAY || right.kind == ValueKind::ARRAY) [[unlikely]] {
+            return outOfLine(OpCode::POW, left, right, storage, target);
+        }
+        return VirtualMachine::power(left, right);
+    }
+
+    /// Ranges of iterations per pool thread in a parallel for.
+    inline constexpr std::size_t rangesPerThread = 4;
+
+    /// The value a reduction starts from in every range: 0 for ADD and 1 for MUL, of the kind of the variable.
+    [[nodiscard]] inline Value identity(OpCode op, const Value &variable) noexcept {
+        const std::int64_t unit = op == OpCode::MUL ? 1 : 0;
+        return variable.kind == ValueKind::DOUBLE ? Value::fromDouble(static_cast<double>(unit)) : Value::fromInt(unit);
+    }
+}  // namespace
+
+VirtualMachine::VirtualMachine(const Chunk &program) : chunk(program) {}
+
+Value VirtualMachine::power(const Value &left, const Value &right) noexcept {
+    if(bothIntegral(left, right) && right.asInt() >= 0) {
+        std::uint64_t base = bits(left.asInt());
+        std::uint64_t result = 1;
+        for(std::int64_t exponent = right.asInt(); exponent > 0; exponent >>= 1) {
+            if((exponent & 1) != 0) { result *= base; }
+            base *= base;
+        }
+        return Value::fromInt(wrap(result));
+    }
+    return Value::fromDouble(std::pow(left.asDouble(), right.asDouble()));
+}
+
+Value VirtualMachine::evaluate(OpCode op, const Value &left, const Value &right) {
+    switch(op) {
+        using enum OpCode;
+    case ADD:
+        return add(left, right, {}, 0);
+    case SUB:
+        return subtract(left, right, {}, 0);
+    case MUL:
+        return multiply(left, right, {}, 0);
+    case DIV:
+        return divide(left, right, {}, 0);
+    case POW:
+        return raise(left, right, {}, 0);
+    case NEG:
+        return negate(left, {}, 0);
+    case NOT:
+        return Value::fromBool(!left.isTruthy());
+    case AND:
+        return Value::fromBool(left.isTruthy() && right.isTruthy());
+    case OR:
+        return Value::fromBool(left.isTruthy() || right.isTruthy());
+    case EQ:
+        return relation(EQ, left, right, {}, 0, [](auto order) { return order == 0; });
+    case NE:
+        return relation(NE, left, right, {}, 0, [](auto order) { return order != 0; });
+    case LT:
+        return relation(LT, left, right, {}, 0, [](auto order) { return order < 0; });
+    case LE:
+        return relation(LE, left, right, {}, 0, [](auto order) { return order <= 0; });
+    case GT:
+        return relation(GT, left, right, {}, 0, [](auto order) { return order > 0; });
+    case GE:
+        return relation(GE, left, right, {}, 0, [](auto order) { return order >= 0; });
+    default:
+        throw RuntimeError(FORMAT("{} computes no value", op));
+    }
+}
+
+void VirtualMachine::prepare() {
+    registers.assign(chunk.registerCount, Value{});
+    lanes.assign(chunk.vectors ? chunk.registerCount : 0, Lanes{});
+    arrays.assign(chunk.arrays ? chunk.registerCount : 0, Array{});
+    std::ranges::copy(chunk.constants, registers.begin() + chunk.constantBase);
+}
+
+void VirtualMachine::run(const NativeProgram &program) {
+    PROFILE_ZONE("run native code");
+    prepare();
+    if(program(registers.data()) != 0) [[unlikely]] { throw RuntimeError("Integer division by zero"); }
+}
+
+void VirtualMachine::run() {
+    PROFILE_ZONE("run bytecode");
+    prepare();
+    execute(registers.data(), {lanes.data(), arrays.data()}, 0);
+}
+
+/// The loop variable ends one step past the last iteration, as after the sequential loop. Each range also copies the
+/// Lanes, which stay alive until its vector and matrix reductions are combined, and gets empty Arrays for the arrays
+/// it computes: the ones of the registers it starts from stay shared.
+void VirtualMachine::parallelFor(const ParallelLoop &loop, Value *reg, RegisterStorage storage) const {
+    const std::int64_t start = reg[loop.variable].asInt();
+    const std::int64_t bound = reg[loop.bound].asInt();
+    const std::int64_t stride = reg[loop.step].asInt();
+    if(start >= bound) { return; }
+    if(stride <= 0) [[unlikely]] { throw RuntimeError(FORMAT("parallel for with a step of {}", stride)); }
+    const std::uint64_t distance = bits(bound) - bits(start);
+    const std::uint64_t count = distance / bits(stride) + (distance % bits(stride) != 0 ? 1 : 0);
+    ThreadPool &threads = pool == nullptr ? ThreadPool::shared() : *pool;
+    const auto ranges = static_cast<std::size_t>(std::min<std::uint64_t>(count, threads.size() * rangesPerThread));
+    std::vector<std::vector<Value>> partials(ranges);
+    std::vector<std::vector<Lanes>> partialLanes(ranges);
+    threads.run(ranges, [&](std::size_t range) {
+        PROFILE_ZONE("parallel for range");
+        const std::uint64_t first = range * (count / ranges) + std::min<std::uint64_t>(range, count % ranges);
+        const std::uint64_t last = first + count / ranges + (range < count % ranges ? 1 : 0);
+        std::vector<Value> local(reg, reg + chunk.registerCount);
+        std::vector<Lanes> &localLanes = partialLanes[range];
+        if(chunk.vectors) { localLanes.assign(storage.lanes, storage.lanes + chunk.registerCount); }
+        std::vector<Array> localArrays(chunk.arrays ? chunk.registerCount : 0);
+        for(const auto &[target, op] : loop.reductions) {
+            if(reg[target].kind == ValueKind::ARRAY) [[unlikely]] { throw RuntimeError("a parallel for cannot reduce an array"); }
+            local[target] = reg[target].isWide() ? wideIdentity(op, reg[target], localLanes[target]) : identity(op, reg[target]);
+        }
+        for(std::uint64_t iteration = first; iteration < last; ++iteration) {
+            local[loop.variable] = Value::fromInt(wrap(bits(start) + iteration * bits(stride)));
+            execute(local.data(), {localLanes.data(), localArrays.data()}, loop.body);
+        }
+        partials[range].reserve(loop.reductions.size());
+        for(const auto &[target, op] : loop.reductions) { partials[range].push_back(local[target]); }
+    });
+    for(const std::vector<Value> &partial : partials) {
+        for(std::size_t i = 0; i < loop.reductions.size(); ++i) {
+            const auto &[target, op] = loop.reductions[i];
+            reg[target] = reg[target].isWide() ? wideArithmetic(op, reg[target], partial[i], storage.lanes[target])
+                                               : evaluate(op, reg[target], partial[i]);
+        }
+    }
+    reg[loop.variable] = Value::fromInt(wrap(bits(start) + count * bits(stride)));
+}
+
+#ifdef DERSBIANDER_COMPUTED_GOTO
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+
+// NOLINTBEGIN(*-avoid-goto, *-pro-bounds-pointer-arithmetic, *-macro-usage)
+void VirtualMachine::execute(Value *const reg, const RegisterStorage storage, std::size_t entry) const {
+    const Bytecode *const code = chunk.code.data();
+    const Bytecode *ip = code + entry;
+
+#ifdef DERSBIANDER_COMPUTED_GOTO
+    // Same order as OpCode.
+    static const std::array<void *, 32> labels{
+        &&op_MOVE,    &&op_ADD,     &&op_SUB,    &&op_MUL,     &&op_DIV,        &&op_POW,   &&op_NEG,   &&op_NOT,
+        &&op_AND,     &&op_OR,      &&op_EQ,     &&op_NE,      &&op_LT,         &&op_LE,    &&op_GT,    &&op_GE,
+        &&op_POSTINC, &&op_POSTDEC, &&op_VECTOR, &&op_SWIZZLE, &&op_ARRAY,      &&op_FILL,  &&op_INDEX, &&op_ELEMENT,
+        &&op_STORE,   &&op_LENGTH,  &&op_BOUND,  &&op_JUMP,    &&op_JUMP_FALSE, &&op_FOR_TEST, &&op_PARALLEL_FOR, &&op_HALT};
+    static_assert(static_cast<std::size_t>(OpCode::HALT) + 1 == 32);
+#define VM_CASE(name) op_##name:
+#define VM_DISPATCH() goto *labels[static_cast<std::size_t>(ip->op)]
+    VM_DISPATCH();
+#else
+#define VM_CASE(name) case OpCode::name:
+#define VM_DISPATCH() continue
+    for(;;) {
+        switch(ip->op) {
+#endif
+    VM_CASE(MOVE) {
+        reg[ip->a] = reg[ip->b];
+        // A copied vector, matrix or array gets its own storage: the source register may compute another one later.
+        if(reg[ip->a].isWide()) [[unlikely]] {
+            storage.lanes[ip->a] = *reg[ip->b].lanes;
+            reg[ip->a].lanes = &storage.lanes[ip->a];
+        } else if(reg[ip->a].kind == ValueKind::ARRAY) [[unlikely]] {
+            storage.arrays[ip->a] = *reg[ip->b].array;
+            reg[ip->a].array = &storage.arrays[ip->a];
+        }
+        ++ip;
+        VM_DISPATCH();
+    }
+    VM_CASE(ADD) {
+        reg[ip->a] = add(reg[ip->b], reg[ip->c], storage, ip->a);
+        ++ip;
+        VM_DISPATCH();
+    }
+    VM_CASE(SUB) {
+        reg[ip->a] = subtract(reg[ip->b], reg[ip->c], storage, ip->a);
+        ++ip;
+        VM_DISPATCH();
+    }
+    VM_CASE(MUL) {
+        reg[ip->a] = multiply(reg[ip->b], reg[ip->c], storage, ip->a);
+        ++ip;
+        VM_DISPATCH();
+    }
+    VM_CASE(DIV) {
+        reg[ip->a] = divide(reg[ip->b], reg[ip->c], storage, ip->a);
+        ++ip;
+        VM_DISPATCH();
+    }
+    VM_CASE(POW) {
+        reg[ip->a] = raise(reg[ip->b], reg[ip->c], storage, ip->a);
+        ++ip;
+        VM_DISPATCH();
+    }
+    VM_CASE(NEG) {
+        reg[ip->a] = negate(reg[ip->b], storage, ip->a);
+        ++ip;
+        VM_DISPATCH();
+    }
+    VM_CASE(NOT) {
+        reg[ip->a] = Value::fromBool(!reg[ip->b].isTruthy());
+        ++ip;
+        VM_DISPATCH();
+    }
+    VM_CASE(AND) {
+        reg[ip->a] = Value::fromBool(reg[ip->b].isTruthy() && reg[ip->c].isTruthy());
+        ++ip;
+        VM_DISPATCH();
+    }
+    VM_CASE(OR) {
+        reg[ip->a] = Value::fromBool(reg[ip->b].isTruthy() || reg[ip->c].isTruthy());
+        ++ip;
+        VM_DISPATCH();
+    }
+    VM_CASE(EQ) {
+        reg[ip->a] = relation(OpCode::EQ, reg[ip->b], reg[ip->c], storage, ip->a, [](auto order) { return order == 0; });
+        ++ip;
+        VM_DISPATCH();
+    }
+    VM_CASE(NE) {
+        reg[ip->a] = relation(OpCode::NE, reg[ip->b], reg[ip->c], storage, ip->a, [](auto order) { return order != 0; });
+        ++ip;
+        VM_DISPATCH();
+    }
+    VM_CASE(LT) {
+        reg[ip->a] = relation(OpCode::LT, reg[ip->b], reg[ip->c], storage, ip->a, [](auto order) { return order < 0; });
+        ++ip;
+        VM_DISPATCH();
+    }
+    VM_CASE(LE) {
+        reg[ip->a] = relation(OpCode::LE, reg[ip->b], reg[ip->c], storage, ip->a, [](auto order) { return order <= 0; });
+        ++ip;
+        VM_DISPATCH();
+    }
+    VM_CASE(GT) {
+        reg[ip->a] = relation(OpCode::GT, reg[ip->b], reg[ip->c], storage, ip->a, [](auto order) { return order > 0; });
+        ++ip;
+        VM_DISPATCH();
+    }
+    VM_CASE(GE) {
+        reg[ip->a] = relation(OpCode::GE, reg[ip->b], reg[ip->c], storage, ip->a, [](auto order) { return order >= 0; });
+        ++ip;
+        VM_DISPATCH();
+    }
+    VM_CASE(POSTINC) {
+        const Value previous = reg[ip->b];
+        reg[ip->b] = step(previous, 1);
+        reg[ip->a] = previous;
+        ++ip;
+        VM_DISPATCH();
+    }
+    VM_CASE(POSTDEC) {
+        const Value previous = reg[ip->b];
+        reg[ip->b] = step(previous, -1);
+        reg[ip->a] = previous;
+        ++ip;
+        VM_DISPATCH();
+    }
+    VM_CASE(VECTOR) {
+        reg[ip->a] = buildWide(VectorShape::decode(ip->c), reg + ip->b, storage.lanes[ip->a]);
+        ++ip;
+        VM_DISPATCH();
+    }
+    VM_CASE(SWIZZLE) {
+        reg[ip->a] = swizzle(reg[ip->b], ip->c, storage.lanes[ip->a]);
+        ++ip;
+        VM_DISPATCH();
+    }
+    VM_CASE(ARRAY) {
+        reg[ip->a] = buildArray(reg + ip->b, ip->c, storage.arrays[ip->a]);
+        ++ip;
+        VM_DISPATCH();
+    }
+    VM_CASE(FILL) {
+        reg[ip->a] = fillArray(reg[ip->b], reg[ip->c], storage.arrays[ip->a]);
+        ++ip;
+        VM_DISPATCH();
+    }
+    VM_CASE(INDEX) {
+        reg[ip->a] = indexArray(reg[ip->b], reg[ip->c], storage.arrays[ip->a]);
+        ++ip;
+        VM_DISPATCH();
+    }
+    VM_CASE(ELEMENT) {
+        reg[ip->a] = element(*reg[ip->b].array, C_ST(reg[ip->c].asInt()), storage.arrays[ip->a]);
+        ++ip;
+        VM_DISPATCH();
+    }
+    VM_CASE(STORE) {
+        storeElement(reg[ip->a], reg[ip->b], reg[ip->c]);
+        ++ip;
+        VM_DISPATCH();
+    }
+    VM_CASE(LENGTH) {
+        reg[ip->a] = arrayLength(reg[ip->b]);
+        ++ip;
+        VM_DISPATCH();
+    }
+    VM_CASE(BOUND) {
+        checkBound(reg[ip->a], reg[ip->b], reg[ip->c]);
+        ++ip;
+        VM_DISPATCH();
+    }
+    VM_CASE(JUMP) {
+        ip = code + ip->target();
+        VM_DISPATCH();
+    }
+    VM_CASE(JUMP_FALSE) {
+        ip = reg[ip->a].isTruthy() ? ip + 1 : code + ip->target();
+        VM_DISPATCH();
+    }
+    VM_CASE(FOR_TEST) {
+        // A bool condition is tested as is, a number is the exclusive upper bound of the loop variable.
+        const Value &condition = reg[ip->a];
+        const bool proceed = condition.kind == ValueKind::BOOL ? condition.boolean : compare(reg[ip->b], condition) < 0;
+        ip += proceed ? 2 : 1;
+        VM_DISPATCH();
+    }
+    VM_CASE(PARALLEL_FOR) {
+        parallelFor(chunk.loops[ip->a], reg, storage);
+        ++ip;
+        VM_DISPATCH();
+    }
+    VM_CASE(HALT) { return; }
+#ifndef DERSBIANDER_COMPUTED_GOTO
+        default:
+            return;
+        }
+    }
+#endif
+#undef VM_CASE
+#undef VM_DISPATCH
+}
+// NOLINTEND(*-avoid-goto, *-pro-bounds-pointer-arithmetic, *-macro-usage)
+
+#ifdef DERSBIANDER_COMPUTED_GOTO
+#pragma GCC diagnostic pop
+#endif
+
+DISABLE_WARNINGS_POP()
@@ -0,0 +1,236 @@
+#include "Dersbiander/dersbiander.hpp"
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+
+DISABLE_WARNINGS_PUSH(
+    4005 4201 4459 4514 4625 4626 4820 6244 6285 6385 6386 26409 26415 26418 26429 26432 26437 26438 26440 26446 26447 26450 26451 26455 26457 26459 26460 26461 26467 26472 26473 26474 26475 26481 26482 26485 26490 26491 26493 26494 26495 26496 26497 26498 26800 26814 26818 26821 26826)
+
+#include <CLI/CLI.hpp>
+
+DISABLE_WARNINGS_POP()
+
+DISABLE_WARNINGS_PUSH(26446 26481 26482)
+
+namespace {
+#ifndef DERSBIANDER_TRACK_ALLOCATIONS
+    std::atomic_uint64_t allocations = 0;
+#endif
+
+    /// The throughput and the allocations of one run a measurement is compared with.
+    struct Baseline {
+        double mbPerSecond = 0.0;
+        std::uint64_t allocations = 0;
+    };
+
+    /// The baselines of every benchmark and the toolchain whose allocations they hold.
+    struct BaselineFile {
+        std::string toolchain;
+        std::map<std::string, Baseline> baselines;
+    };
+
+    /// The ctest SKIP_RETURN_CODE of the perf tests.
+    constexpr int skipReturnCode = 77;
+
+    /// The compiler and the standard library of this build: each of them allocates differently, debug iterators most.
+    constexpr std::string_view toolchain =
+#if defined(__clang__)
+        "clang "
+#elif defined(_MSC_VER)
+        "msvc "
+#elif defined(__GNUC__)
+        "gcc "
+#else
+        "unknown "
+#endif
+#if defined(_LIBCPP_VERSION)
+        "libc++"
+#elif defined(__GLIBCXX__)
+        "libstdc++"
+#elif defined(_MSVC_STL_VERSION)
+        "msvc-stl"
+#else
+        "unknown"
+#endif
+#if defined(_GLIBCXX_DEBUG) || (defined(_ITERATOR_DEBUG_LEVEL) && _ITERATOR_DEBUG_LEVEL > 0)
+        "-debug"
+#endif
+        ;
+
+    /// A fixed generated program: the same seed and options give the same bytes on every machine.
+    struct Corpus {
+        std::string_view name;
+        GeneratorOptions options;
+    };
+
+    const std::array<Corpus, 2> corpora{{
+        {"mixed", GeneratorOptions{.seed = 1, .size = std::uint64_t{1} << 20U}},
+        {"nested", GeneratorOptions{.seed = 2, .size = std::uint64_t{1} << 20U, .depth = 5, .expressionDepth = 5}},
+    }};
+
+    /// A `toolchain compiler library` line and lines of `name mb_per_s allocations`, `#` starts a comment.
+    [[nodiscard]] BaselineFile readBaseline(const std::string &path) {
+        BaselineFile file;
+        std::ifstream in(path);
+        for(std::string line; std::getline(in, line);) {
+            if(line.empty() || line.starts_with('#')) { continue; }
+            if(line.starts_with("toolchain ")) {
+                file.toolchain = line.substr(std::string_view{"toolchain "}.size());
+                continue;
+            }
+            std::istringstream fields(line);
+            std::string name;
+            Baseline baseline;
+            if(!(fields >> name >> baseline.mbPerSecond >> baseline.allocations)) [[unlikely]] {
+                throw RuntimeError(FORMAT("malformed baseline line in {}: {}", path, line));
+            }
+            file.baselines[name] = baseline;
+        }
+        return file;
+    }
+
+    void writeBaseline(const std::string &path, const BaselineFile &file) {
+        std::ofstream out(path);
+        out << "# Throughput and allocations of the perf tests, rewritten by the update_perf_baseline target.\n"
+               "# The throughput is the one of the machine that ran the update: refresh it on the CI machine.\n"
+               "# The allocations hold for the compiler and the standard library on the toolchain line only.\n";
+        out << FORMAT("toolchain {}\n# name mb_per_s allocations\n", file.toolchain);
+        for(const auto &[name, baseline] : file.baselines) {
+            out << FORMAT("{} {:.2f} {}\n", name, baseline.mbPerSecond, baseline.allocations);
+        }
+        if(!out) [[unlikely]] { throw RuntimeError(FORMAT("cannot write {}", path)); }
+    }
+
+    [[nodiscard]] std::uint64_t allocationCount() noexcept {
+#ifdef DERSBIANDER_TRACK_ALLOCATIONS
+        return AllocationTracker::global().totalAllocations();
+#else
+        return allocations.load(std::memory_order_relaxed);
+#endif
+    }
+
+    /// Allocations made by one call of @p body.
+    template <typename Body> [[nodiscard]] std::uint64_t countAllocations(Body &&body) {
+        const std::uint64_t before = allocationCount();
+        body();
+        return allocationCount() - before;
+    }
+}  // namespace
+
+// Builds that track allocations already count them in the library's operator new.
+#ifndef DERSBIANDER_TRACK_ALLOCATIONS
+// Every allocation of the process is counted: the bodies run on the calling thread alone. The deallocations are kept
+// out of line, where the compiler does not pair a new expression with their free().
+void *operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if(void *pointer = std::malloc(size == 0 ? 1 : size); pointer != nullptr) [[likely]] { return pointer; }
+    throw std::bad_alloc();
+}
+ATTR_NOINLINE void operator delete(void *pointer) noexcept { std::free(pointer); }
+ATTR_NOINLINE void operator delete(void *pointer, std::size_t) noexcept { std::free(pointer); }
+#endif
+
+/**
+ * Runs the tokenizer or the validator on fixed generated programs and compares their throughput and allocations with
+ * the baseline file: a throughput lower than the baseline by more than --tolerance, or more allocations than the
+ * baseline by more than --allocation-tolerance, fails the run, and so does a benchmark missing from the baseline.
+ * A build whose compiler or standard library differ from the baseline's skips the comparison, as its allocations differ.
+ * --update writes the measurements to the baseline instead. Everything runs locally, on programs generated in memory.
+ */
+// NOLINTNEXTLINE(bugprone-exception-escape)
+int main(int argc, const char **argv) {
+    try {
+        CLI::App app{"Dersbiander performance regression tests"};
+        std::string suite;
+        std::string baselinePath;
+        double tolerance = 0.3;
+        double allocationTolerance = 0.0;
+        bool allocationsOnly = false;
+        bool update = false;
+        BenchmarkOptions options{.warmup = 0.1, .sampleTime = 0.05, .samples = 10};
+        app.add_option("--suite", suite, "tokenize or validate, every suite when empty");
+        app.add_option("--baseline", baselinePath, "The baseline file")->required();
+        app.add_option("--tolerance", tolerance, "Share of the baseline throughput a benchmark may lose");
+        app.add_option("--allocation-tolerance", allocationTolerance, "Share of allocations a benchmark may add");
+        app.add_flag("--allocations-only", allocationsOnly, "Compare the allocations only, as in unoptimized builds");
+        app.add_flag("--update", update, "Write the measurements to the baseline file instead of comparing them");
+        app.add_option("--samples", options.samples, "Timed samples of every benchmark");
+        CLI11_PARSE(app, argc, argv);
+        initLogger(0);
+
+        BaselineFile file = readBaseline(baselinePath);
+        if(update) {
+            file.toolchain = toolchain;
+        } else if(file.toolchain != toolchain) {
+            LWARN("{} holds the allocations of {}, this build uses {}: skipped", baselinePath, file.toolchain, toolchain);
+            return skipReturnCode;
+        }
+        std::map<std::string, Baseline> &baselines = file.baselines;
+        Benchmark benchmark(options);
+        std::size_t failures = 0;
+        const auto check = [&](const std::string &name, const BenchmarkResult &result, std::uint64_t allocated) {
+            const double mbPerSecond = C_D(result.bytes) * 1e3 / result.mean;
+            LINFO("{}: {:.2f} MB/s ± {:.2f}%, {} allocations", name, mbPerSecond, result.resolution() * 100.0, allocated);
+            if(update) {
+                baselines[name] = Baseline{mbPerSecond, allocated};
+                return;
+            }
+            const auto found = baselines.find(name);
+            if(found == baselines.end()) [[unlikely]] {
+                LERROR("{}: no baseline, run the update_perf_baseline target", name);
+                ++failures;
+                return;
+            }
+            const Baseline &baseline = found->second;
+            if(!allocationsOnly && mbPerSecond < baseline.mbPerSecond * (1.0 - tolerance)) {
+                LERROR("{}: {:.2f} MB/s, the baseline is {:.2f} MB/s", name, mbPerSecond, baseline.mbPerSecond);
+                ++failures;
+            }
+            if(C_D(allocated) > C_D(baseline.allocations) * (1.0 + allocationTolerance)) {
+                LERROR("{}: {} allocations, the baseline is {}", name, allocated, baseline.allocations);
+                ++failures;
+            }
+        };
+        for(const Corpus &corpus : corpora) {
+            const std::string text = ProgramGenerator(corpus.options).generate();
+            Tokenizer tokenizer(text);
+            const std::vector<Token> tokens = tokenizer.tokenize();
+            if(suite.empty() || suite == "tokenize") {
+                const auto body = [&text] {
+                    Tokenizer bodyTokenizer(text);
+                    doNotOptimize(bodyTokenizer.tokenize());
+                };
+                BenchmarkResult result = benchmark.run(FORMAT("tokenize/{}", corpus.name), body);
+                result.bytes = text.size();
+                check(result.name, result, countAllocations(body));
+            }
+            if(suite.empty() || suite == "validate") {
+                const auto body = [&tokens] {
+                    Validator validator(tokens);
+                    doNotOptimize(validator.validate());
+                };
+                BenchmarkResult result = benchmark.run(FORMAT("validate/{}", corpus.name), body);
+                result.bytes = text.size();
+                check(result.name, result, countAllocations(body));
+            }
+        }
+        if(update) {
+            writeBaseline(baselinePath, file);
+            LINFO("{} updated", baselinePath);
+        } else if(failures > 0) [[unlikely]] {
+            LERROR("{} regressions", failures);
+            return EXIT_FAILURE;
+        }
+    } catch(const std::exception &e) {
+        LERROR("Unhandled exception in the perf tests: {}", e.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+DISABLE_WARNINGS_POP()
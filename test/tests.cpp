@@ -2,6 +2,44 @@
 
 #include <catch2/catch_test_macros.hpp>
 
+namespace {
+    /// The front-end stages checkedPipeline() requires to pass, each one including the ones before it.
+    enum class Stage : std::uint8_t { SYNTAX, NAMES, TYPES };
+
+    /// Builds @p ast while validating @p tokens, which must be valid.
+    const Ast &validated(Ast &ast, const std::vector<Token> &tokens) {
+        AstBuilder builder(ast);
+        Validator validator(tokens);
+        validator.setAstBuilder(&builder);
+        REQUIRE(validator.validate().empty());
+        return ast;
+    }
+
+    const NameResolver &resolved(NameResolver &resolver, Stage last) {
+        if(last != Stage::SYNTAX) { REQUIRE(resolver.resolve().empty()); }
+        return resolver;
+    }
+
+    /// A program taken through the front end, the starting point of the tests of the later stages.
+    struct Pipeline {
+        std::vector<Token> tokens;
+        Ast ast;
+        NameResolver resolver;
+        /// Only usable when the names were resolved before its construction, that is past Stage::SYNTAX.
+        TypeChecker checker;
+
+        Pipeline(const std::string &input, Stage last)
+          : tokens(Tokenizer(input).tokenize()), ast(tokens), resolver(validated(ast, tokens)), checker(ast, resolved(resolver, last)) {
+            if(last == Stage::TYPES) { REQUIRE(checker.check().empty()); }
+        }
+    };
+
+    /// Tokenizes @p input and runs the stages up to @p last, requiring each of them to report nothing.
+    std::unique_ptr<Pipeline> checkedPipeline(const std::string &input, Stage last = Stage::TYPES) {
+        return std::make_unique<Pipeline>(input, last);
+    }
+}  // namespace
+
 TEST_CASE("corrected format for Tokentype", "[token_type]") {
     using enum TokenType;
     REQUIRE(FORMAT("{}", IDENTIFIER) == "IDENTIFIER");
@@ -30,10 +68,915 @@ TEST_CASE("corrected format for Tokentype", "[token_type]") {
     REQUIRE(FORMAT("{}", KEYWORD_VAR) == "KEYWORD_VAR");
     REQUIRE(FORMAT("{}", KEYWORD_STRUCTURE) == "KEYWORD_STRUCTURE");
     REQUIRE(FORMAT("{}", KEYWORD_FOR) == "KEYWORD_FOR");
+    REQUIRE(FORMAT("{}", KEYWORD_PARALLEL) == "KEYWORD_PARALLEL");
     REQUIRE(FORMAT("{}", KEYWORD_FUNC) == "KEYWORD_FUNC");
     REQUIRE(FORMAT("{}", KEYWORD_RETURN) == "KEYWORD_RETURN");
     REQUIRE(FORMAT("{}", COMMENT) == "COMMENT");
     REQUIRE(FORMAT("{}", EOFT) == "EOF");
     REQUIRE(FORMAT("{}", ERROR) == "ERROR");
     REQUIRE(FORMAT("{}", UNKNOWN) == "UNKNOWN");
-}
\ No newline at end of file
+}
+TEST_CASE("Tokenizer stays in bounds on truncated input", "[tokenizer]") {
+    const auto types = [](const std::string &input) {
+        Tokenizer tokenizer(input);
+        tokenizer.setExitOnError(false);
+        std::vector<TokenType> result;
+        for(const Token &token : tokenizer.tokenize()) { result.push_back(token.getType()); }
+        return result;
+    };
+    using enum TokenType;
+    REQUIRE(types("s = \"") == std::vector<TokenType>{IDENTIFIER, EQUAL_OPERATOR, UNKNOWN, EOFT});
+    REQUIRE(types("c = '") == std::vector<TokenType>{IDENTIFIER, EQUAL_OPERATOR, UNKNOWN, EOFT});
+    REQUIRE(types("x // comment") == std::vector<TokenType>{IDENTIFIER, COMMENT, EOFT});
+    REQUIRE(types("x /") == std::vector<TokenType>{IDENTIFIER, OPERATOR, EOFT});
+    REQUIRE(types("x @ 1") == std::vector<TokenType>{IDENTIFIER, UNKNOWN, INTEGER, EOFT});
+}
+
+TEST_CASE("Tokenizer splits a run of operators in one pass", "[tokenizer]") {
+    const std::string input = "a +=-!= b";
+    Tokenizer tokenizer(input);
+    const std::vector<Token> tokens = tokenizer.tokenize();
+    REQUIRE(tokens.size() == 6);
+    REQUIRE(tokens[1] == Token{TokenType::OPERATION_EQUAL, "+=", 1, 3});
+    REQUIRE(tokens[2] == Token{TokenType::MINUS_OPERATOR, "-", 1, 5});
+    REQUIRE(tokens[3] == Token{TokenType::BOOLEAN_OPERATOR, "!=", 1, 6});
+}
+
+TEST_CASE("Validator reports every error in one run", "[validator]") {
+    const std::string input = "main {\n\tvariable = 1 +\n\tvariable = ) 2\n\tvar x: type = 3\n}\n";
+    Tokenizer tokenizer(input);
+    const std::vector<Token> tokens = tokenizer.tokenize();
+    Validator validator(tokens);
+    const std::vector<Diagnostic> diagnostics = validator.validate();
+    REQUIRE(diagnostics.size() == 2);
+    REQUIRE(diagnostics[0].getKind() == DiagnosticKind::UNEXPECTED_ENDL);
+    REQUIRE(diagnostics[0].getLine() == 2);
+    REQUIRE(diagnostics[1].getKind() == DiagnosticKind::UNEXPECTED_TOKEN);
+    REQUIRE(diagnostics[1].getValue() == ")");
+    REQUIRE(diagnostics[1].getLine() == 3);
+}
+
+TEST_CASE("Validator accepts a valid program", "[validator]") {
+    const std::string input = "main {\n\tvar x: type = 3\n\tx = x + (1 *\n\t2)\n}\n";
+    Tokenizer tokenizer(input);
+    const std::vector<Token> tokens = tokenizer.tokenize();
+    Validator validator(tokens);
+    REQUIRE(validator.validate().empty());
+    REQUIRE(validator.getInstructionCount() == 5);
+}
+
+TEST_CASE("Validator caches statements by token types", "[validator]") {
+    const std::string input = "main {\n\ta = b + 1\n\tc = d + 2\n\te = ) 3\n\tf = ) 4\n}\n";
+    Tokenizer tokenizer(input);
+    const std::vector<Token> tokens = tokenizer.tokenize();
+    Validator validator(tokens);
+    const std::vector<Diagnostic> diagnostics = validator.validate();
+    REQUIRE(diagnostics.size() == 2);
+    REQUIRE(diagnostics[0].getLine() == 4);
+    REQUIRE(diagnostics[1].getLine() == 5);
+    REQUIRE(diagnostics[1].getColumn() == diagnostics[0].getColumn());
+    REQUIRE(validator.getCache().getHits() == 2);
+    REQUIRE(validator.getCache().getHits() + validator.getCache().getMisses() == validator.getInstructionCount());
+    // A line that ends its statement keeps no Instruction, and a full cache starts over.
+    ValidationCache cache;
+    bool kept = false;
+    for(std::uint64_t key = 0; key <= ValidationCache::maxEntries; ++key) {
+        kept |= cache.insert(key, tokens, Instruction{}, ValidationCache::noError, 0).state.has_value();
+    }
+    REQUIRE_FALSE(kept);
+    REQUIRE(cache.size() == 1);
+}
+
+TEST_CASE("RunStats reports the counts gathered while tokenizing and validating", "[stats]") {
+    const std::string input = "main {\n\tvar a: type = (1 + f(2))\n\ta = a + 1\n}\n";
+    Tokenizer tokenizer(input);
+    const std::vector<Token> tokens = tokenizer.tokenize();
+    Validator validator(tokens);
+    REQUIRE(validator.validate().empty());
+    RunStats stats;
+    stats.inputBytes = input.size();
+    stats.lines = tokenizer.getLineCount();
+    stats.tokens = tokenizer.getTypeCounts();
+    stats.instructions = validator.getInstructionTypeCounts();
+    stats.maxDepth = validator.getBrackets().getMaxDepth();
+    stats.phases.push_back({"validate", 1000});
+    REQUIRE(stats.lines == 5);
+    REQUIRE(stats.tokens[static_cast<std::size_t>(TokenType::INTEGER)] == 3);
+    REQUIRE(stats.tokens[static_cast<std::size_t>(eofTokenType)] == 1);
+    std::size_t tokenCount = 0;
+    for(const std::size_t count : stats.tokens) { tokenCount += count; }
+    REQUIRE(tokenCount == tokens.size());
+    std::size_t instructionCount = 0;
+    for(const std::size_t count : stats.instructions) { instructionCount += count; }
+    REQUIRE(instructionCount == validator.getInstructionCount());
+    REQUIRE(stats.maxDepth == 3);
+    const std::string json = stats.to_json();
+    REQUIRE(json.starts_with(R"({"input_bytes":)"));
+    REQUIRE(json.find(R"("INTEGER":3)") != std::string::npos);
+    REQUIRE(json.find(R"("max_depth":3)") != std::string::npos);
+    REQUIRE(json.find(R"("validate":{"ns":1000,"mb_per_s":)") != std::string::npos);
+    REQUIRE(json.ends_with("}}"));
+    // The counts are the ones of the last tokenize() call, not a running total.
+    const std::vector<Token> rest = tokenizer.tokenize();
+    tokenCount = 0;
+    for(const std::size_t count : tokenizer.getTypeCounts()) { tokenCount += count; }
+    REQUIRE(tokenCount == rest.size());
+}
+
+TEST_CASE("BracketIndex pairs brackets and reports unbalanced ones", "[brackets]") {
+    const std::string input = "main {\n\tx = f(a[1], (2))\n\ty = (3]\n\tz = [4\n}\n";
+    Tokenizer tokenizer(input);
+    const std::vector<Token> tokens = tokenizer.tokenize();
+    const BracketIndex brackets(tokens);
+    // main { x = f ( a [ 1 ] , ( 2 ) ) y = ( 3 ] z = [ 4 }
+    REQUIRE(brackets.partner(1) == 24);
+    REQUIRE(brackets.partner(5) == 14);
+    REQUIRE(brackets.partner(14) == 5);
+    REQUIRE(brackets.partner(7) == 9);
+    REQUIRE(brackets.partner(2) == BracketIndex::noPartner);
+    REQUIRE(brackets.depth(8) == 2);
+    REQUIRE(brackets.depth(15) == 0);
+    const std::vector<Diagnostic> &diagnostics = brackets.getDiagnostics();
+    REQUIRE(diagnostics.size() == 3);
+    REQUIRE(diagnostics[0].getValue() == "(");
+    REQUIRE(diagnostics[0].getExpected() == std::vector<TokenType>{TokenType::CLOSED_BRACKETS});
+    REQUIRE(diagnostics[1].getValue() == "]");
+    REQUIRE(diagnostics[1].getExpected().empty());
+    REQUIRE(diagnostics[2].getValue() == "[");
+    REQUIRE(diagnostics[2].getLine() == 4);
+    // `)` closes the `[` inside its pair, which leaves the last `]` stray; n `(` then n `]` are all unbalanced.
+    const std::string crossedInput = "( [ ) ]";
+    Tokenizer crossed(crossedInput);
+    const BracketIndex crossedBrackets(crossed.tokenize());
+    REQUIRE(crossedBrackets.partner(0) == 2);
+    REQUIRE(crossedBrackets.getDiagnostics().size() == 2);
+    const std::string strayInput = std::string(50000, '(') + std::string(50000, ']');
+    Tokenizer stray(strayInput);
+    REQUIRE(BracketIndex(stray.tokenize()).getDiagnostics().size() == 100000);
+}
+
+TEST_CASE("AstBuilder builds the tree while validating", "[ast]") {
+    const std::string input = "main {\n\tvar a, b: type[2] = 1 + 2 * 3, f(4)[0]\n\tfor i = 0, 10 {\n\t\ta += -i\n\t}\n}\n";
+    const auto pipeline = checkedPipeline(input, Stage::SYNTAX);
+    auto &[tokens, ast, resolver, checker] = *pipeline;
+    const auto program = ast.children(ast.getRoot());
+    REQUIRE(program.size() == 1);
+    REQUIRE(ast.node(program[0]).kind == AstKind::MAIN);
+    const auto body = ast.children(ast.children(program[0])[0]);
+    REQUIRE(body.size() == 2);
+    REQUIRE(ast.node(body[0]).kind == AstKind::DECLARATION);
+    REQUIRE(ast.node(body[1]).kind == AstKind::FOR);
+    const auto values = ast.children(ast.children(body[0])[2]);
+    REQUIRE(values.size() == 2);
+    REQUIRE(ast.node(values[0]).kind == AstKind::EXPRESSION);
+    REQUIRE(ExpressionParser::to_string(tokens, ast.code(values[0])) == "1 2 3 * +");
+    REQUIRE(ExpressionParser::to_string(tokens, ast.code(values[1])) == "f 4 call/2 0 []");
+}
+
+TEST_CASE("ExpressionParser resolves precedence into postfix", "[expression]") {
+    const auto postfix = [](const std::string &input) {
+        Tokenizer tokenizer(input);
+        const std::vector<Token> tokens = tokenizer.tokenize();
+        std::vector<PostfixOp> code;
+        ExpressionParser parser(tokens, 0, tokens.size());
+        parser.parse(code);
+        return ExpressionParser::to_string(tokens, code);
+    };
+    REQUIRE(postfix("true || 12 > variable + (12 / 3 * true)") == "true 12 variable 12 3 / true * + > ||");
+    REQUIRE(postfix("variable.method(\"Ciao\", .24e-15) * -5") == "variable .method \"Ciao\" .24e-15 call/3 5 u- *");
+    REQUIRE(postfix("2 ^ 3 ^ 2 - !a[1]--") == "2 3 2 ^ ^ a 1 [] p-- u! -");
+    REQUIRE(postfix("[1, [2], []] && ()") == "1 2 array/1 array/0 array/3 () &&");
+    REQUIRE(postfix("-2 ^ 2 * -x ^ -1") == "2 2 ^ u- x 1 u- ^ u- *");
+}
+
+TEST_CASE("NameResolver reports undeclared, duplicate and constant names", "[names]") {
+    const std::string input = "main {\n\tconst c: type = 1\n\tvar x: type = y\n\tvar x: type\n\tc = 2\n\tc++\n"
+                              "\t{\n\t\tvar x: type = c\n\t}\n\tf(x)\n}\nfunc f(p: type) {\n\treturn p\n}\n"
+                              "func f() {\n\treturn p\n}\n";
+    const auto pipeline = checkedPipeline(input, Stage::SYNTAX);
+    auto &[tokens, ast, resolver, checker] = *pipeline;
+    const std::vector<Diagnostic> diagnostics = resolver.resolve();
+    REQUIRE(diagnostics.size() == 5);
+    REQUIRE(diagnostics[0].getKind() == DiagnosticKind::UNDECLARED_IDENTIFIER);
+    REQUIRE(diagnostics[0].getValue() == "y");
+    REQUIRE(diagnostics[1].getKind() == DiagnosticKind::DUPLICATE_DECLARATION);
+    REQUIRE(diagnostics[1].getLine() == 4);
+    REQUIRE(diagnostics[2].getKind() == DiagnosticKind::CONST_REASSIGNMENT);
+    REQUIRE(diagnostics[3].getKind() == DiagnosticKind::CONST_REASSIGNMENT);
+    REQUIRE(diagnostics[3].getLine() == 6);
+    REQUIRE(diagnostics[4].getKind() == DiagnosticKind::UNDECLARED_IDENTIFIER);
+    REQUIRE(diagnostics[4].getLine() == 16);
+}
+
+TEST_CASE("NameResolver checks the variable of a for loop without var", "[names]") {
+    const std::string input = "main {\n\tfor i = 0, 3 {\n\t}\n\tconst c: int = 0\n\tfor c = 0, 3 {\n\t}\n"
+                              "\tvar k: int\n\tfor k = 0, 3 {\n\t}\n}\n";
+    const auto pipeline = checkedPipeline(input, Stage::SYNTAX);
+    auto &[tokens, ast, resolver, checker] = *pipeline;
+    const std::vector<Diagnostic> diagnostics = resolver.resolve();
+    REQUIRE(diagnostics.size() == 2);
+    REQUIRE(diagnostics[0].getKind() == DiagnosticKind::UNDECLARED_IDENTIFIER);
+    REQUIRE(diagnostics[0].getValue() == "i");
+    REQUIRE(diagnostics[0].getLine() == 2);
+    REQUIRE(diagnostics[1].getKind() == DiagnosticKind::CONST_REASSIGNMENT);
+    REQUIRE(diagnostics[1].getValue() == "c");
+    REQUIRE(diagnostics[1].getLine() == 5);
+}
+
+TEST_CASE("SymbolTable restores shadowed names on scope exit", "[names]") {
+    SymbolTable table;
+    table.openScope();
+    REQUIRE(table.declare("a", SymbolKind::VARIABLE, 0) == noSymbol);
+    table.openScope();
+    REQUIRE(table.declare("a", SymbolKind::CONSTANT, 1) == noSymbol);
+    REQUIRE(table.declare("a", SymbolKind::VARIABLE, 2) != noSymbol);
+    REQUIRE(table.symbol(table.lookup("a")).token == 1);
+    table.closeScope();
+    REQUIRE(table.symbol(table.lookup("a")).token == 0);
+    table.closeScope();
+    REQUIRE(table.lookup("a") == noSymbol);
+}
+
+TEST_CASE("TypeTable interns structurally equal types once", "[types]") {
+    TypeTable types;
+    REQUIRE(types.named("int") == TypeTable::intType);
+    REQUIRE(types.named("type") == types.named("type"));
+    REQUIRE(types.array(types.array(TypeTable::intType, 3), TypeTable::dynamicLength) ==
+            types.array(types.array(TypeTable::intType, 3), TypeTable::dynamicLength));
+    REQUIRE(types.array(TypeTable::intType, 3) != types.array(TypeTable::intType, 4));
+    REQUIRE(types.to_string(types.array(types.array(TypeTable::charType, 3), TypeTable::dynamicLength)) == "char[3][]");
+}
+
+TEST_CASE("TypeChecker infers expression types bottom-up", "[types]") {
+    const std::string input = "func f(a: int): double {\n\treturn a * 2.5\n}\nmain {\n\tvar x: int = 1 + 'c'\n"
+                              "\tvar s: string = \"n\" + x\n\tvar b: bool = x < f(x) && !s[0]\n\tx = f(1)\n"
+                              "\tvar v: int[2] = [1, 2, 3]\n\tif(v) {\n\t}\n\tx = f(true, 2)\n}\n";
+    const auto pipeline = checkedPipeline(input, Stage::NAMES);
+    auto &[tokens, ast, resolver, checker] = *pipeline;
+    const std::vector<Diagnostic> diagnostics = checker.check();
+    REQUIRE(diagnostics.size() == 5);
+    REQUIRE(diagnostics[0].getMessage() == "cannot assign double to int");
+    REQUIRE(diagnostics[0].getLine() == 8);
+    REQUIRE(diagnostics[1].getMessage() == "cannot assign int[3] to int[2]");
+    REQUIRE(diagnostics[2].getMessage() == "condition of type int[2]");
+    REQUIRE(diagnostics[3].getMessage() == "2 arguments given, 1 expected");
+    REQUIRE(diagnostics[4].getMessage() == "cannot assign double to int");
+}
+
+TEST_CASE("VirtualMachine runs compiled bytecode", "[bytecode]") {
+    const std::string input = "main {\n\tvar sum: int = 0\n\tvar h: double = 0.0\n\tfor var i: int = 1, 11 {\n\t\tsum += i\n"
+                              "\t\th = h + 1.0 / i\n\t}\n\tvar a, b: int = 0, 1\n\twhile(b < 100) {\n\t\ta, b = b, a + b\n\t}\n"
+                              "\tvar big: bool = 2 ^ 10 == 1024 && !(sum < 0)\n}\n";
+    const auto pipeline = checkedPipeline(input);
+    auto &[tokens, ast, resolver, checker] = *pipeline;
+    BytecodeCompiler compiler(ast, resolver, checker);
+    REQUIRE(compiler.compile().empty());
+    VirtualMachine machine(compiler.getChunk());
+    machine.run();
+    std::map<std::string, Value> values;
+    for(const auto &[name, reg] : compiler.getChunk().variables) { values[name] = machine.get(reg); }
+    REQUIRE(values["sum"] == Value::fromInt(55));
+    REQUIRE(values["h"].kind == ValueKind::DOUBLE);
+    REQUIRE(std::abs(values["h"].real - 2.9289682539682538) < 1e-12);
+    REQUIRE(values["a"] == Value::fromInt(89));
+    REQUIRE(values["b"] == Value::fromInt(144));
+    REQUIRE(values["big"] == Value::fromBool(true));
+}
+
+TEST_CASE("BytecodeCompiler reports unsupported constructs", "[bytecode]") {
+    const std::string input = "main {\n\tvar s: string = \"text\"\n\tvar x: int = 1\n}\n";
+    const auto pipeline = checkedPipeline(input);
+    auto &[tokens, ast, resolver, checker] = *pipeline;
+    BytecodeCompiler compiler(ast, resolver, checker);
+    const std::vector<Diagnostic> diagnostics = compiler.compile();
+    REQUIRE(diagnostics.size() == 1);
+    REQUIRE(diagnostics[0].getKind() == DiagnosticKind::UNSUPPORTED);
+    REQUIRE(diagnostics[0].getLine() == 2);
+}
+
+TEST_CASE("ConstantFolder folds constant expressions and propagates constants", "[constants]") {
+    const std::string input = "main {\n\tconst k: int = 12 / 3 * true\n\tconst n: int = 1 + 1 + \"AAAA\".len()\n"
+                              "\tvar v: int[k + n / 2]\n\tvar same: bool = (1 + 2) == 3\n\tvar y: int = 1\n\tvar x: int = k - y\n"
+                              "\tvar unordered: bool = 0.0 / 0.0 == 0.0 / 0.0 || 0.0 / 0.0 >= 1.0\n}\n";
+    const auto pipeline = checkedPipeline(input, Stage::NAMES);
+    auto &[tokens, ast, resolver, checker] = *pipeline;
+    ConstantFolder folder(ast, resolver);
+    REQUIRE(folder.fold().empty());
+    std::map<std::string, std::optional<Value>> values;
+    for(NodeIndex index = 0; index < ast.size(); ++index) {
+        if(ast.node(index).kind != AstKind::DECLARATION) { continue; }
+        const auto children = ast.children(index);
+        const std::string &name = ast.token(ast.children(children[0])[0]).getValue();
+        if(!ast.children(children[2]).empty()) { values[name] = folder.value(ast.children(children[2])[0]); }
+    }
+    REQUIRE(values["k"] == Value::fromInt(4));
+    REQUIRE(values["n"] == Value::fromInt(6));
+    REQUIRE(values["same"] == Value::fromBool(true));
+    REQUIRE(values["unordered"] == Value::fromBool(false));
+    REQUIRE_FALSE(values["x"].has_value());
+    checker.setFolder(&folder);
+    REQUIRE(checker.check().empty());
+    for(SymbolIndex symbol = 0; symbol < resolver.getSymbols().symbolCount(); ++symbol) {
+        if(ast.getTokens()[resolver.getSymbols().symbol(symbol).token].getValue() == "v") {
+            REQUIRE(checker.getTypes().to_string(checker.symbolType(symbol)) == "int[7]");
+        }
+    }
+}
+
+TEST_CASE("ConstantFolder reports division by zero and indices out of range", "[constants]") {
+    const std::string input = "main {\n\tconst zero: int = 0\n\tvar a: int = 10 / zero\n\tvar v: int[3]\n"
+                              "\tvar b: int = v[1] + v[3]\n\tvar c: int = [1, 2][-1]\n\tvar d: double = 1.0 / zero\n}\n";
+    const auto pipeline = checkedPipeline(input, Stage::NAMES);
+    auto &[tokens, ast, resolver, checker] = *pipeline;
+    ConstantFolder folder(ast, resolver);
+    const std::vector<Diagnostic> diagnostics = folder.fold();
+    REQUIRE(diagnostics.size() == 3);
+    REQUIRE(diagnostics[0].getKind() == DiagnosticKind::CONSTANT_ERROR);
+    REQUIRE(diagnostics[0].getMessage() == "Integer division by zero");
+    REQUIRE(diagnostics[0].getLine() == 3);
+    REQUIRE(diagnostics[1].getMessage() == "index 3 out of range for length 3");
+    REQUIRE(diagnostics[1].getLine() == 5);
+    REQUIRE(diagnostics[2].getMessage() == "negative index -1");
+}
+
+TEST_CASE("BytecodeCompiler emits folded constants instead of their operations", "[constants]") {
+    const std::string input = "main {\n\tconst scale: int = 2 ^ 4\n\tvar sum: int = 0\n\tfor var i: int = 0, 10 {\n"
+                              "\t\tsum += i * (scale - 6) + 12 / 3\n\t}\n}\n";
+    const auto pipeline = checkedPipeline(input, Stage::NAMES);
+    auto &[tokens, ast, resolver, checker] = *pipeline;
+    ConstantFolder folder(ast, resolver);
+    REQUIRE(folder.fold().empty());
+    checker.setFolder(&folder);
+    REQUIRE(checker.check().empty());
+    BytecodeCompiler plain(ast, resolver, checker);
+    REQUIRE(plain.compile().empty());
+    BytecodeCompiler folded(ast, resolver, checker);
+    folded.setFolder(&folder);
+    REQUIRE(folded.compile().empty());
+    REQUIRE(folded.getChunk().code.size() + 2 == plain.getChunk().code.size());
+    for(const Chunk *chunk : {&plain.getChunk(), &folded.getChunk()}) {
+        VirtualMachine machine(*chunk);
+        machine.run();
+        for(const auto &[name, reg] : chunk->variables) {
+            if(name == "sum") { REQUIRE(machine.get(reg) == Value::fromInt(490)); }
+        }
+    }
+}
+
+TEST_CASE("SSA passes remove redundant work and keep the results", "[ssa]") {
+    const std::string input = "main {\n\tvar n: int = 7\n\tvar total: int = 0\n\tvar t: int = n * 5\n\tt = 2\n"
+                              "\tfor var i: int = 0, 10 {\n\t\ttotal += n * n + i\n\t\ttotal += n * n\n\t}\n"
+                              "\tvar a, b: int = 0, 1\n\twhile(b < 100) {\n\t\ta, b = b, a + b\n\t}\n"
+                              "\tif(n > 3) {\n\t\ttotal = total + 1\n\t}\n\tif(false) {\n\t\ttotal = 0\n\t}\n"
+                              "\tvar x: int = total / 1\n\tx++\n}\n";
+    const auto pipeline = checkedPipeline(input);
+    auto &[tokens, ast, resolver, checker] = *pipeline;
+    BytecodeCompiler compiler(ast, resolver, checker);
+    REQUIRE(compiler.compile().empty());
+    VirtualMachine reference(compiler.getChunk());
+    reference.run();
+    IrBuilder irBuilder(ast, resolver, checker);
+    REQUIRE(irBuilder.build().empty());
+    IrFunction &function = irBuilder.getFunction();
+    const std::size_t before = function.instructionCount();
+    IrPassManager passes = IrPassManager::standard();
+    passes.run(function);
+    REQUIRE(passes.getRuns().size() == 4);
+    REQUIRE(passes.getRuns()[1].changes > 0);
+    REQUIRE(passes.getRuns()[2].changes > 0);
+    REQUIRE(function.instructionCount() < before);
+    IrCompiler irCompiler(ast, resolver, function);
+    REQUIRE(irCompiler.compile().empty());
+    VirtualMachine optimized(irCompiler.getChunk());
+    optimized.run();
+    REQUIRE(irCompiler.getChunk().variables.size() == compiler.getChunk().variables.size());
+    for(const auto &[name, reg] : compiler.getChunk().variables) {
+        INFO(name);
+        REQUIRE(optimized.get(reg) == reference.get(reg));
+    }
+}
+
+TEST_CASE("IrBuilder reports the arrays the BytecodeCompiler accepts", "[ssa]") {
+    const std::string input = "main {\n\tvar values: int[2] = [1, 2]\n\tvar x: int = values[0]\n}\n";
+    const auto pipeline = checkedPipeline(input);
+    auto &[tokens, ast, resolver, checker] = *pipeline;
+    BytecodeCompiler compiler(ast, resolver, checker);
+    REQUIRE(compiler.compile().empty());
+    IrBuilder irBuilder(ast, resolver, checker);
+    const std::vector<Diagnostic> diagnostics = irBuilder.build();
+    REQUIRE_FALSE(diagnostics.empty());
+    REQUIRE(std::ranges::all_of(diagnostics, [](const Diagnostic &diagnostic) {
+        return diagnostic.getKind() == DiagnosticKind::UNSUPPORTED;
+    }));
+    REQUIRE(diagnostics.front().getLine() == 2);
+}
+
+TEST_CASE("ThreadPool runs every task once and rethrows their errors", "[parallel]") {
+    ThreadPool pool(3);
+    REQUIRE(pool.size() == 4);
+    std::vector<std::atomic<int>> counts(1000);
+    std::atomic<long> nested{0};
+    pool.run(counts.size(), [&](std::size_t task) {
+        ++counts[task];
+        if(task % 100 == 0) { pool.run(10, [&](std::size_t inner) { nested += static_cast<long>(inner); }); }
+    });
+    REQUIRE(std::ranges::all_of(counts, [](const std::atomic<int> &count) { return count == 1; }));
+    REQUIRE(nested == 450);
+    REQUIRE_THROWS_AS(pool.run(8, [](std::size_t task) {
+        if(task == 5) { throw RuntimeError("task 5"); }
+    }), RuntimeError);
+}
+
+TEST_CASE("parallel for reduces into the same results as the sequential loop", "[parallel]") {
+    const std::string input = "main {\n\tvar n: int = 2000\n\tvar sum, count: int = 0, 0\n\tvar product: int = 1\n"
+                              "\tconst scale: int = 3\n\tvar h: double = 0.0\n\tparallel for var i: int = 0, n {\n"
+                              "\t\tvar square: int = i * i\n\t\tsum += square * scale - i\n\t\tif(i - i / 7 * 7 == 0) {\n"
+                              "\t\t\tcount++\n\t\t}\n\t\th += 0.5\n\t}\n\tparallel for var k: int = 1, 21, 2 {\n"
+                              "\t\tproduct *= k\n\t}\n}\n";
+    const auto pipeline = checkedPipeline(input);
+    auto &[tokens, ast, resolver, checker] = *pipeline;
+    ParallelChecker parallelChecker(ast, resolver);
+    REQUIRE(parallelChecker.check().empty());
+    REQUIRE(parallelChecker.getLoopCount() == 2);
+    BytecodeCompiler sequential(ast, resolver, checker);
+    REQUIRE(sequential.compile().empty());
+    BytecodeCompiler parallel(ast, resolver, checker);
+    parallel.setParallel(&parallelChecker);
+    REQUIRE(parallel.compile().empty());
+    REQUIRE(parallel.getChunk().loops.size() == 2);
+    REQUIRE(parallel.getChunk().loops[0].reductions.size() == 3);
+    VirtualMachine reference(sequential.getChunk());
+    reference.run();
+    ThreadPool pool(3);
+    VirtualMachine machine(parallel.getChunk());
+    machine.setPool(&pool);
+    machine.run();
+    std::map<std::string, Value> values;
+    for(const auto &[name, reg] : parallel.getChunk().variables) {
+        INFO(name);
+        if(name != "square") { REQUIRE(machine.get(reg) == reference.get(reg)); }
+        values[name] = machine.get(reg);
+    }
+    REQUIRE(values["count"] == Value::fromInt(286));
+    REQUIRE(values["product"] == Value::fromInt(654729075));
+    REQUIRE(values["h"] == Value::fromDouble(1000.0));
+    REQUIRE(values["i"] == Value::fromInt(2000));
+}
+
+TEST_CASE("ParallelChecker reports dependencies between iterations", "[parallel]") {
+    const std::string input = "main {\n\tvar n: int = 10\n\tvar last, total: int = 0, 0\n\tparallel for var i: int = 0, n {\n"
+                              "\t\tlast = i\n\t\ttotal += total\n\t}\n\tparallel for var j: int = 0, n {\n\t\tn += 1\n\t}\n"
+                              "\tparallel for var k: int = 0, 5 {\n\t\tk = 2\n\t}\n}\n";
+    const auto pipeline = checkedPipeline(input, Stage::NAMES);
+    auto &[tokens, ast, resolver, checker] = *pipeline;
+    ParallelChecker parallelChecker(ast, resolver);
+    const std::vector<Diagnostic> diagnostics = parallelChecker.check();
+    REQUIRE(diagnostics.size() == 4);
+    REQUIRE(std::ranges::all_of(diagnostics, [](const Diagnostic &diagnostic) {
+        return diagnostic.getKind() == DiagnosticKind::LOOP_DEPENDENCY;
+    }));
+    REQUIRE(diagnostics[0].getLine() == 5);
+    REQUIRE(diagnostics[1].getLine() == 6);
+    REQUIRE(diagnostics[2].getLine() == 8);
+    REQUIRE(diagnostics[3].getLine() == 12);
+    REQUIRE(parallelChecker.getLoopCount() == 0);
+
+    const std::string invalid = "main {\n\tparallel var i: int = 0, 4 {\n\t}\n}\n";
+    Tokenizer invalidTokenizer(invalid);
+    const std::vector<Token> invalidTokens = invalidTokenizer.tokenize();
+    Validator invalidValidator(invalidTokens);
+    REQUIRE(invalidValidator.validate().size() == 1);
+}
+
+TEST_CASE("Vector and matrix values compute like their components", "[vectors]") {
+    const std::string input = "main {\n\tvar a: vec3 = vec3(1.0, 2.0, 3.0)\n\tvar b: vec3 = vec3(0.5)\n"
+                              "\tvar c: vec3 = a * 2 + b / 0.5 - a\n\tvar n: vec3 = -a\n\tvar m: mat3 = mat3(2.0)\n"
+                              "\tvar r: mat2 = mat2(vec2(0.0, 1.0), vec2(-1.0, 0.0))\n\tvar p: vec2 = r * vec2(1.0, 0.0)\n"
+                              "\tvar q: vec3 = m * a + a * m\n\tvar s: double = a.x + a.b\n\tvar t: vec2 = a.zy\n\tvar z: vec4\n"
+                              "\tvar e: bool = a == vec3(1, 2, 3) && a != b\n\tvar acc: vec3\n\tvar turn: mat2 = mat2(1)\n"
+                              "\tparallel for var i: int = 0, 40 {\n\t\tacc += a * i\n\t\tturn *= r\n\t}\n}\n";
+    const auto pipeline = checkedPipeline(input);
+    auto &[tokens, ast, resolver, checker] = *pipeline;
+    ParallelChecker parallelChecker(ast, resolver);
+    REQUIRE(parallelChecker.check().empty());
+    BytecodeCompiler compiler(ast, resolver, checker);
+    compiler.setParallel(&parallelChecker);
+    REQUIRE(compiler.compile().empty());
+    REQUIRE(compiler.getChunk().vectors);
+    ThreadPool pool(3);
+    VirtualMachine machine(compiler.getChunk());
+    machine.setPool(&pool);
+    machine.run();
+    std::map<std::string, std::string> values;
+    for(const auto &[name, reg] : compiler.getChunk().variables) { values[name] = machine.get(reg).to_string(); }
+    REQUIRE(values["c"] == "vec3(2, 3, 4)");
+    REQUIRE(values["n"] == "vec3(-1, -2, -3)");
+    REQUIRE(values["r"] == "mat2(vec2(0, 1), vec2(-1, 0))");
+    REQUIRE(values["p"] == "vec2(0, 1)");
+    REQUIRE(values["q"] == "vec3(4, 8, 12)");
+    REQUIRE(values["s"] == "4");
+    REQUIRE(values["t"] == "vec2(3, 2)");
+    REQUIRE(values["z"] == "vec4(0, 0, 0, 0)");
+    REQUIRE(values["e"] == "true");
+    REQUIRE(values["acc"] == "vec3(780, 1560, 2340)");
+    // 40 quarter turns are a full turn ten times over.
+    REQUIRE(values["turn"] == "mat2(vec2(1, 0), vec2(0, 1))");
+    REQUIRE_THROWS_AS(VirtualMachine::evaluate(OpCode::ADD, machine.get(0), machine.get(0)), RuntimeError);
+}
+
+TEST_CASE("TypeChecker checks vector and matrix operations", "[vectors]") {
+    const std::string input = "main {\n\tvar a: vec3 = vec3(1.0, 2.0)\n\tvar b: vec2 = vec3(1.0).xy\n\tvar c: double = b.z\n"
+                              "\tvar d: vec3 = b + vec3(1.0)\n\tvar e: bool = b < b\n\tvar f: vec3 = vec3\n"
+                              "\tvar g: mat2 = mat2(b, b) * mat2(1) * 2 / 4 - mat2()\n\tvar h: double = g.x\n}\n";
+    const auto pipeline = checkedPipeline(input, Stage::NAMES);
+    auto &[tokens, ast, resolver, checker] = *pipeline;
+    const std::vector<Diagnostic> diagnostics = checker.check();
+    REQUIRE(diagnostics.size() == 6);
+    REQUIRE(diagnostics[0].getMessage() == "2 arguments given to vec3, 0, 1 or 3 expected");
+    REQUIRE(diagnostics[1].getMessage() == "member z of vec2");
+    REQUIRE(diagnostics[2].getMessage() == "operator + on vec2 and vec3");
+    REQUIRE(diagnostics[3].getMessage() == "operator < on vec2 and vec2");
+    REQUIRE(diagnostics[4].getMessage() == "vec3 is a type, it can only be called");
+    REQUIRE(diagnostics[5].getMessage() == "member x of mat2");
+    REQUIRE(diagnostics[5].getLine() == 9);
+}
+
+TEST_CASE("Arrays compute element by element and check their indices", "[arrays]") {
+    const std::string input = "main {\n\tvar a: int[3] = [1, 2, 3]\n\tvar h: double[3] = [0.5, 0.5, 0.5]\n"
+                              "\tvar b: double[3] = a * 2 + h\n\tvar c: bool[3] = a > 1\n"
+                              "\tvar n: int[][] = [[12, 5], [7, 6, 8], []]\n\tvar z: int[3]\n"
+                              "\tvar e: int = n[1][2] + a.len()\n\tvar sum: int = 0\n\tfor var i: int = 0, a.len() {\n"
+                              "\t\tsum += a[i]\n\t\tz[i] = a[i] * a[i]\n\t}\n\tz[0] -= 4\n\tvar m: int[3] = -a\n"
+                              "\tvar w: double[4]\n\tparallel for var j: int = 0, 4 {\n\t\tw[j] = j / 2.0\n\t}\n}\n";
+    const auto pipeline = checkedPipeline(input);
+    auto &[tokens, ast, resolver, checker] = *pipeline;
+    ParallelChecker parallelChecker(ast, resolver);
+    REQUIRE(parallelChecker.check().empty());
+    BytecodeCompiler compiler(ast, resolver, checker);
+    compiler.setParallel(&parallelChecker);
+    REQUIRE(compiler.compile().empty());
+    const Chunk &chunk = compiler.getChunk();
+    REQUIRE(chunk.arrays);
+    // The bounds do not change in the loops: a BOUND for `a`, `z` and `w` before them replaces the checks of the reads.
+    REQUIRE(std::ranges::count(chunk.code, OpCode::BOUND, &Bytecode::op) == 3);
+    REQUIRE(std::ranges::count(chunk.code, OpCode::ELEMENT, &Bytecode::op) == 3);
+    ThreadPool pool(3);
+    VirtualMachine machine(chunk);
+    machine.setPool(&pool);
+    machine.run();
+    std::map<std::string, std::string> values;
+    for(const auto &[name, reg] : chunk.variables) { values[name] = machine.get(reg).to_string(); }
+    REQUIRE(values["b"] == "[2.5, 4.5, 6.5]");
+    REQUIRE(values["c"] == "[false, true, true]");
+    REQUIRE(values["n"] == "[[12, 5], [7, 6, 8], []]");
+    REQUIRE(values["e"] == "11");
+    REQUIRE(values["sum"] == "6");
+    REQUIRE(values["z"] == "[-3, 4, 9]");
+    REQUIRE(values["m"] == "[-1, -2, -3]");
+    REQUIRE(values["w"] == "[0, 0.5, 1, 1.5]");
+    Array left;
+    Array right;
+    Array out;
+    const Value three = buildArray(chunk.constants.data(), 0, left);
+    REQUIRE_THROWS_AS(indexArray(three, Value::fromInt(0), out), RuntimeError);
+    const std::array<Value, 2> pair{Value::fromInt(1), Value::fromDouble(2.5)};
+    const Value mixed = buildArray(pair.data(), pair.size(), right);
+    REQUIRE(mixed.to_string() == "[1, 2.5]");
+    REQUIRE_THROWS_AS(arrayArithmetic(OpCode::ADD, three, mixed, out), RuntimeError);
+    REQUIRE_THROWS_AS(checkBound(mixed, Value::fromInt(3), Value::fromInt(0)), RuntimeError);
+    REQUIRE_NOTHROW(checkBound(mixed, Value::fromInt(3), Value::fromInt(3)));
+}
+
+TEST_CASE("TypeChecker types element-wise array operations", "[arrays]") {
+    const std::string input = "main {\n\tvar a: int[3] = [1, 2, 3]\n\tvar b: double[3] = a / 2.0\n"
+                              "\tvar c: int[2] = [1, 2] + a\n\tvar d: bool = a > 1\n}\n";
+    const auto pipeline = checkedPipeline(input, Stage::NAMES);
+    auto &[tokens, ast, resolver, checker] = *pipeline;
+    const std::vector<Diagnostic> diagnostics = checker.check();
+    REQUIRE(diagnostics.size() == 2);
+    REQUIRE(diagnostics[0].getMessage() == "operator + on int[2] and int[3]");
+    REQUIRE(diagnostics[0].getLine() == 4);
+    REQUIRE(diagnostics[1].getLine() == 5);
+}
+
+#ifdef DERSBIANDER_NATIVE_X86_64
+TEST_CASE("NativeCompiler matches the interpreter", "[native]") {
+    const std::string input = "main {\n\tvar sum, odd: int = 0, 0\n\tvar h: double = 0.0\n\tfor var i: int = 1, 20 {\n"
+                              "\t\tsum += i * i - i / 3\n\t\th = h + 1.0 / i + h / -10\n\t\tif(i - i / 2 * 2 == 1 && !(h > 100.0)) {\n"
+                              "\t\t\todd++\n\t\t}\n\t}\n\tvar cube: int = odd ^ 3\n\tvar half: double = 2.0 ^ -1\n"
+                              "\tvar flag: bool = sum >= 1000 || h <= 0.5\n\tvar d: int = -7 / 2\n\tvar z: double = 0.0\n"
+                              "\tvar same: bool = z / z == z / z || z / z <= z || z / z >= z\n"
+                              "\tvar apart: bool = z / z != z / z && !(z / z < z || z / z > z)\n}\n";
+    const auto pipeline = checkedPipeline(input);
+    auto &[tokens, ast, resolver, checker] = *pipeline;
+    BytecodeCompiler compiler(ast, resolver, checker);
+    REQUIRE(compiler.compile().empty());
+    const Chunk &chunk = compiler.getChunk();
+    NativeCompiler nativeCompiler(chunk);
+    REQUIRE(nativeCompiler.compile());
+    VirtualMachine interpreter(chunk);
+    interpreter.run();
+    VirtualMachine native(chunk);
+    native.run(nativeCompiler.load());
+    std::map<std::string, Value> values;
+    for(const auto &[name, reg] : chunk.variables) {
+        INFO(name);
+        REQUIRE(native.get(reg) == interpreter.get(reg));
+        values[name] = interpreter.get(reg);
+    }
+    // A NaN is unordered: it is only different, from itself too.
+    REQUIRE(values["same"] == Value::fromBool(false));
+    REQUIRE(values["apart"] == Value::fromBool(true));
+}
+#endif
+
+#ifdef DERSBIANDER_C_BACKEND
+TEST_CASE("CTranspiler output matches the interpreter and is cached", "[c]") {
+    const std::string input = "main {\n\tvar sum: int = 0\n\tvar h: double = 0.0\n\tfor var i: int = 1, 11 {\n\t\tsum += i\n"
+                              "\t\th = h + 1.0 / i\n\t}\n\tvar a, b: int = 0, 1\n\twhile(b < 100) {\n\t\ta, b = b, a + b\n\t}\n"
+                              "\tvar big: bool = 2 ^ 10 == 1024 && !(sum < 0)\n\tvar d: int = -7 / 2\n\tvar c: char = 'x'\n"
+                              "\tc++\n\tvar z: double = 0.0\n\tvar same: bool = z / z == z / z || z / z <= 1.0\n"
+                              "\tvar apart: bool = z / z != z / z && !(z / z >= z)\n}\n";
+    const auto pipeline = checkedPipeline(input);
+    auto &[tokens, ast, resolver, checker] = *pipeline;
+    BytecodeCompiler compiler(ast, resolver, checker);
+    REQUIRE(compiler.compile().empty());
+    VirtualMachine machine(compiler.getChunk());
+    machine.run();
+    CTranspiler transpiler(ast, resolver, checker);
+    REQUIRE(transpiler.transpile().empty());
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "dersbiander-cache-test";
+    std::filesystem::remove_all(directory);
+    CBuildCache cache(directory);
+    const SharedLibrary library = cache.load(transpiler.getSource());
+    REQUIRE_FALSE(cache.lastWasHit());
+    std::vector<Value> registers(transpiler.getRegisterCount());
+    REQUIRE(library(registers.data()) == 0);
+    REQUIRE(transpiler.getVariables().size() == 11);
+    for(const auto &[name, reg] : transpiler.getVariables()) {
+        INFO(name);
+        REQUIRE(registers[reg] == machine.get(reg));
+    }
+    const SharedLibrary cached = cache.load(transpiler.getSource());
+    REQUIRE(cache.lastWasHit());
+    using std::filesystem::perms;
+    REQUIRE((std::filesystem::status(directory).permissions() & perms::all) == perms::owner_all);
+    std::filesystem::permissions(directory, perms::others_write, std::filesystem::perm_options::add);
+    REQUIRE_THROWS_AS(static_cast<void>(cache.load(transpiler.getSource())), RuntimeError);
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("CTranspiler compiles functions and arrays", "[c]") {
+    const std::string input = "func square(x: int): int {\n\treturn x * x\n}\nmain {\n\tvar values: int[4] = [1, 2, 3, 4]\n"
+                              "\tvalues[3] = 5\n\tvar grid: int[2][2] = [[1, 2], [3, 4]]\n\tvar result: int = 0\n"
+                              "\tfor var i: int = 0, 4 {\n\t\tresult += square(values[i])\n\t}\n\tvar corner: int = grid[1][0]\n}\n";
+    const auto pipeline = checkedPipeline(input);
+    auto &[tokens, ast, resolver, checker] = *pipeline;
+    CTranspiler transpiler(ast, resolver, checker);
+    REQUIRE(transpiler.transpile().empty());
+    // The quote in the directory reaches the cc command line, which must keep the path one word.
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "dersbiander-cache-test-functions's";
+    CBuildCache cache(directory);
+    const SharedLibrary library = cache.load(transpiler.getSource());
+    std::vector<Value> registers(transpiler.getRegisterCount());
+    REQUIRE(library(registers.data()) == 0);
+    std::map<std::string, Value> values;
+    for(const auto &[name, reg] : transpiler.getVariables()) { values[name] = registers[reg]; }
+    REQUIRE(values["result"] == Value::fromInt(39));
+    REQUIRE(values["corner"] == Value::fromInt(3));
+    REQUIRE_FALSE(values.contains("values"));
+    // Literal indices within the length go unchecked, any other index stops the program when it is out of bounds.
+    REQUIRE(transpiler.getSource().find("_grid[1LL][0LL]") != std::string::npos);
+    REQUIRE(transpiler.getSource().find("_values[dsb_index(") != std::string::npos);
+    const auto outside = checkedPipeline("main {\n\tvar a: int[3]\n\tfor var i: int = 0, 10 {\n\t\ta[i] = 1\n\t}\n}\n");
+    auto &[outsideTokens, outsideAst, outsideResolver, outsideChecker] = *outside;
+    CTranspiler outsideTranspiler(outsideAst, outsideResolver, outsideChecker);
+    REQUIRE(outsideTranspiler.transpile().empty());
+    const SharedLibrary outsideLibrary = cache.load(outsideTranspiler.getSource());
+    std::vector<Value> outsideRegisters(outsideTranspiler.getRegisterCount());
+    REQUIRE(outsideLibrary(outsideRegisters.data()) == CTranspiler::indexOutOfBounds);
+    // Both backends evaluate the right side of && even when the left side is false, and stop on its division by zero.
+    const auto eager = checkedPipeline("main {\n\tvar n: int = 0\n\tvar b: bool = n != 0 && 1 / n > 0\n}\n");
+    auto &[eagerTokens, eagerAst, eagerResolver, eagerChecker] = *eager;
+    BytecodeCompiler eagerCompiler(eagerAst, eagerResolver, eagerChecker);
+    REQUIRE(eagerCompiler.compile().empty());
+    VirtualMachine eagerMachine(eagerCompiler.getChunk());
+    REQUIRE_THROWS_AS(eagerMachine.run(), RuntimeError);
+    CTranspiler eagerTranspiler(eagerAst, eagerResolver, eagerChecker);
+    REQUIRE(eagerTranspiler.transpile().empty());
+    const SharedLibrary eagerLibrary = cache.load(eagerTranspiler.getSource());
+    std::vector<Value> eagerRegisters(eagerTranspiler.getRegisterCount());
+    REQUIRE(eagerLibrary(eagerRegisters.data()) == CTranspiler::divisionByZero);
+    std::filesystem::remove_all(directory);
+    // 2 ^ n is a double in the interpreter for a negative n: only literal exponents are known to stay integers.
+    const auto power = checkedPipeline("main {\n\tvar n: int = -1\n\tvar p: int = 2 ^ n\n}\n");
+    auto &[powerTokens, powerAst, powerResolver, powerChecker] = *power;
+    CTranspiler powerTranspiler(powerAst, powerResolver, powerChecker);
+    const std::vector<Diagnostic> diagnostics = powerTranspiler.transpile();
+    REQUIRE(diagnostics.size() == 1);
+    REQUIRE(diagnostics[0].getMessage() == "integer power with a variable exponent in the C transpiler");
+}
+#endif
+
+TEST_CASE("BinaryLog formats the recorded arguments when it is read", "[log]") {
+    BinaryLog log;
+    log.record(SPDLOG_LEVEL_INFO, "{} = {}", std::string{"x"}, -42);
+    log.record(SPDLOG_LEVEL_TRACE, "{} {:.1f} {} {} {}", true, 2.5, 'c', std::size_t{7}, TokenType::INTEGER);
+    log.record(SPDLOG_LEVEL_INFO, "{} = {}", "y", 1U);
+    REQUIRE(log.size() == 3);
+    const std::vector<std::string> lines = log.format();
+    REQUIRE(lines == std::vector<std::string>{"[info] x = -42", "[trace] true 2.5 c 7 INTEGER", "[info] y = 1"});
+    std::stringstream file;
+    log.write(file);
+    REQUIRE(BinaryLog::read(file) == lines);
+    std::stringstream truncated(file.str().substr(0, file.str().size() - 3));
+    REQUIRE_THROWS_AS(BinaryLog::read(truncated), RuntimeError);
+    std::stringstream other("not a trace");
+    REQUIRE_THROWS_AS(BinaryLog::read(other), RuntimeError);
+    // A record ends with its level, its argument count, the BOOL tag and the bool byte.
+    BinaryLog flags;
+    flags.record(SPDLOG_LEVEL_INFO, "{}", false);
+    std::stringstream flagFile;
+    flags.write(flagFile);
+    std::string corrupt = flagFile.str();
+    corrupt.back() = '\x02';
+    std::stringstream nonZero(corrupt);
+    REQUIRE(BinaryLog::read(nonZero) == std::vector<std::string>{"[info] true"});
+    corrupt[corrupt.size() - 4] = '\x40';
+    std::stringstream badLevel(corrupt);
+    REQUIRE_THROWS_AS(BinaryLog::read(badLevel), RuntimeError);
+    corrupt[corrupt.size() - 4] = static_cast<char>(SPDLOG_LEVEL_INFO);
+    corrupt[corrupt.size() - 2] = '\x40';
+    std::stringstream badTag(corrupt);
+    REQUIRE_THROWS_AS(BinaryLog::read(badTag), RuntimeError);
+    std::string manyFormats = flagFile.str();
+    manyFormats.replace(8, 4, 4, '\xFF');
+    std::stringstream formatCount(manyFormats);
+    REQUIRE_THROWS_AS(BinaryLog::read(formatCount), RuntimeError);
+}
+
+TEST_CASE("Profiler records nested zones of every thread", "[profile]") {
+    Profiler &profiler = Profiler::global();
+    profiler.clear();
+    profiler.setEnabled(true);
+    {
+        PROFILE_ZONE("outer");
+        ThreadPool pool(2);
+        pool.run(8, [](std::size_t) {
+            PROFILE_ZONE("task");
+            const std::string name = "inner";
+            const ProfileZone inner(name);
+        });
+    }
+    profiler.setEnabled(false);
+    { PROFILE_ZONE("disabled"); }
+    const std::vector<Profiler::ZoneStats> summary = profiler.summary();
+    REQUIRE(summary.size() == 3);
+    REQUIRE(summary.front().name == "outer");
+    for(const Profiler::ZoneStats &zone : summary) {
+        REQUIRE(zone.count == (zone.name == "outer" ? 1 : 8));
+        REQUIRE((zone.min <= zone.p50 && zone.p50 <= zone.p99 && zone.p99 <= zone.max && zone.max <= zone.total));
+    }
+    std::stringstream trace;
+    profiler.writeChromeTrace(trace);
+    REQUIRE(trace.str().starts_with(R"({"displayTimeUnit":"ns","traceEvents":[)"));
+    REQUIRE(trace.str().find(R"("name":"inner","cat":"dersbiander","ph":"X")") != std::string::npos);
+    REQUIRE(trace.str().find(R"("args":{"depth":1})") != std::string::npos);
+    REQUIRE(trace.str().find("disabled") == std::string::npos);
+    profiler.clear();
+    REQUIRE(profiler.summary().empty());
+    Profiler::ThreadBuffer buffer{};
+    const std::string first = "zone";
+    const std::string second = "zone";
+    REQUIRE(buffer.intern(first) == buffer.intern(second));
+    REQUIRE(buffer.names.size() == 1);
+}
+
+TEST_CASE("AllocationTracker counts the allocations of the innermost zone", "[profile]") {
+    AllocationTracker &tracker = AllocationTracker::global();
+    const auto phase = [&tracker](std::string_view name) {
+        const std::vector<AllocationTracker::PhaseStats> summary = tracker.summary();
+        const auto found = std::ranges::find(summary, name, &AllocationTracker::PhaseStats::name);
+        return found == summary.end() ? AllocationTracker::PhaseStats{} : *found;
+    };
+    void *outer = nullptr;
+    void *inner = nullptr;
+    {
+        const std::uint32_t previous = tracker.enter("tracker outer");
+        outer = tracker.allocate(100);
+        const std::uint32_t nested = tracker.enter("tracker inner");
+        inner = tracker.allocate(40);
+        tracker.leave(nested);
+        tracker.deallocate(inner);
+        tracker.leave(previous);
+    }
+    const AllocationTracker::PhaseStats innerStats = phase("tracker inner");
+    REQUIRE(innerStats.allocations == 1);
+    REQUIRE(innerStats.deallocations == 1);
+    REQUIRE(innerStats.live == 0);
+    REQUIRE(innerStats.peak == 40);
+    REQUIRE(phase("tracker outer").live == 100);
+    tracker.deallocate(outer);
+    REQUIRE(phase("tracker outer").live == 0);
+    REQUIRE(phase("tracker outer").peak >= 100);
+    REQUIRE(tracker.report().find("tracker inner") != std::string::npos);
+    REQUIRE(tracker.allocate(std::numeric_limits<std::size_t>::max()) == nullptr);
+}
+
+TEST_CASE("Instrumentation sums the counters of every thread", "[instrument]") {
+    Instrumentation &instrumentation = Instrumentation::global();
+    const std::uint32_t counter = instrumentation.counter("test.counter");
+    const std::uint32_t timer = instrumentation.timer("test.timer");
+    REQUIRE(instrumentation.counter("test.counter") == counter);
+    // A timer named like a counter gets its own two slots.
+    const std::uint32_t shadow = instrumentation.timer("test.counter");
+    REQUIRE(shadow != counter);
+    REQUIRE(shadow + 1 != counter);
+    REQUIRE(instrumentation.timer("test.counter") == shadow);
+    ThreadPool pool(2);
+    pool.run(8, [counter, timer](std::size_t) {
+        Instrumentation::add(counter, 2);
+        const InstrumentTimer scope(timer);
+    });
+    const std::vector<Instrumentation::Stats> summary = instrumentation.summary();
+    const auto find = [&summary](std::string_view name) {
+        return *std::ranges::find(summary, name, &Instrumentation::Stats::name);
+    };
+    REQUIRE(find("test.counter").count == 16);
+    REQUIRE_FALSE(find("test.counter").timer);
+    REQUIRE(find("test.timer").count == 8);
+    REQUIRE(find("test.timer").timer);
+    REQUIRE(instrumentation.report().find("test.timer") != std::string::npos);
+    // A full table still registers new names, each kind on overflow slots of its own.
+    Instrumentation full;
+    std::set<std::uint32_t> nanoseconds;
+    for(std::size_t i = 0; i < Instrumentation::maxSlots / 2; ++i) { nanoseconds.insert(full.timer(FORMAT("t{}", i)) + 1); }
+    static_cast<void>(full.counter("last.counter"));
+    const std::uint32_t late = full.counter("late.counter");
+    REQUIRE_FALSE(nanoseconds.contains(late));
+    REQUIRE(full.counter("late.counter") == late);
+    REQUIRE(full.report().find("late.counter (overflow)") != std::string::npos);
+    // A subsystem that is switched off does not even evaluate the arguments of its points.
+    int evaluated = 0;
+    INSTRUMENT_COUNT(LEXER, "test.lexer", ++evaluated);
+    REQUIRE(evaluated == DERSBIANDER_INSTRUMENT_LEXER);
+}
+
+TEST_CASE("Benchmark summarizes samples with a confidence interval", "[benchmark]") {
+    const std::string input = "var a = 1 + 2 * 3\nvar b = a - 4\n";
+    Benchmark benchmark({.warmup = 0.001, .sampleTime = 0.0005, .samples = 10});
+    BenchmarkResult result = benchmark.run("tokenize", [&input] {
+        Tokenizer tokenizer(input);
+        doNotOptimize(tokenizer.tokenize());
+    });
+    result.bytes = input.size();
+    REQUIRE(result.iterations >= 1);
+    REQUIRE(result.samples + result.outliers == 10);
+    REQUIRE((result.min <= result.median && result.median <= result.max));
+    REQUIRE((result.low <= result.mean && result.mean <= result.high));
+    REQUIRE(result.to_string().find("MB/s") != std::string::npos);
+    const std::string json = Benchmark::toJson(std::vector{result});
+    REQUIRE(json.starts_with(R"({"benchmarks":[)"));
+    REQUIRE(json.find(R"("name":"tokenize","iterations":)") != std::string::npos);
+    REQUIRE(json.find(R"("items_per_s":null)") != std::string::npos);
+    BenchmarkResult slower = result;
+    slower.mean *= 2;
+    slower.low = result.high * 1.5;
+    slower.high = result.high * 2.5;
+    REQUIRE(Benchmark::compare(result, slower).starts_with("tokenize: +100.00%"));
+    REQUIRE(Benchmark::compare(result, result).ends_with("within the noise"));
+    Benchmark narrow({.warmup = 0.0, .sampleTime = 0.0001, .samples = 2, .outlierFences = 0.0});
+    const BenchmarkResult kept = narrow.run("narrow", [&input] { doNotOptimize(input.size()); });
+    REQUIRE(kept.samples >= 1);
+    REQUIRE(kept.samples + kept.outliers == 2);
+}
+
+TEST_CASE("ProgramGenerator writes the same valid program for the same seed", "[generator]") {
+    GeneratorOptions options{.seed = 42, .size = 16384};
+    const std::string text = ProgramGenerator(options).generate();
+    REQUIRE(text.size() >= options.size);
+    REQUIRE(ProgramGenerator(options).generate() == text);
+    options.seed = 43;
+    REQUIRE(ProgramGenerator(options).generate() != text);
+    for(const std::string_view construct : {"func ", "main {", "const ", "parallel for ", "while(", "if(", ".len()", "]", "//"}) {
+        INFO(construct);
+        REQUIRE(text.find(construct) != std::string::npos);
+    }
+    const auto pipeline = checkedPipeline(text, Stage::NAMES);
+    auto &[tokens, ast, resolver, checker] = *pipeline;
+    ConstantFolder folder(ast, resolver);
+    REQUIRE(folder.fold().empty());
+    checker.setFolder(&folder);
+    REQUIRE(checker.check().empty());
+    ParallelChecker parallelChecker(ast, resolver);
+    REQUIRE(parallelChecker.check().empty());
+
+    options.errorRate = 0.1;
+    ProgramGenerator generator(options);
+    const std::string faulty = generator.generate();
+    Tokenizer faultyTokenizer(faulty);
+    const std::vector<Token> faultyTokens = faultyTokenizer.tokenize();
+    Validator faultyValidator(faultyTokens);
+    REQUIRE(generator.getErrors() > 0);
+    REQUIRE(faultyValidator.validate().size() == generator.getErrors());
+}